@@ -0,0 +1,78 @@
+#pragma once
+
+/**
+ * @file bench.h
+ * @brief Минимальная инфраструктура микробенчмарков Pascal--
+ *
+ * Бенчмарки регистрируются макросом BENCHMARK и запускаются из bench_main.cpp.
+ * Аргумент командной строки задаёт подстроку для фильтрации по имени.
+ */
+
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+struct Case {
+    std::string name;
+    std::function<void()> body;
+};
+
+inline std::vector<Case>& registry() {
+    static std::vector<Case> cases;
+    return cases;
+}
+
+struct Registrar {
+    Registrar(const std::string& name, std::function<void()> body) {
+        registry().push_back({ name, std::move(body) });
+    }
+};
+
+// Не даёт компилятору выбросить вычисление результата
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    // Пустая вставка, которая "читает" адрес значения и всю память
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+    static_cast<void>(sink);
+#endif
+}
+
+/**
+ * Замеряет время выполнения fn (лучшее из repeats прогонов)
+ * @param label Подпись строки отчёта
+ * @param operations Число операций в одном прогоне (для нс/оп)
+ * @return Лучшее время прогона в секундах
+ */
+inline double measure(const std::string& label, size_t operations, const std::function<void()>& fn, int repeats = 5) {
+    double best = 1e300;
+    for (int r = 0; r < repeats; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed.count() < best)
+            best = elapsed.count();
+    }
+    std::cout << "  " << std::left << std::setw(40) << label
+              << std::right << std::setw(12) << std::fixed << std::setprecision(3) << best * 1e3 << " ms"
+              << std::setw(12) << std::setprecision(2) << (operations ? best * 1e9 / operations : 0.0) << " ns/op"
+              << std::endl;
+    return best;
+}
+
+} // namespace bench
+
+#define BENCH_CONCAT_INNER(a, b) a##b
+#define BENCH_CONCAT(a, b) BENCH_CONCAT_INNER(a, b)
+#define BENCHMARK(name) \
+    static void name(); \
+    static ::bench::Registrar BENCH_CONCAT(name, _registrar)(#name, name); \
+    static void name()
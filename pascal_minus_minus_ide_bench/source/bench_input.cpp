@@ -0,0 +1,93 @@
+#include "bench.h"
+#include "input_source.h"
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const size_t COUNT = 10000000;
+const char* FILE_NAME = "pmm_bench_input.txt";
+
+std::string makeInput() {
+    std::mt19937 random(1);
+    std::string text;
+    text.reserve(COUNT * 8);
+    for (size_t i = 0; i < COUNT; ++i) {
+        text += std::to_string(static_cast<int>(random() % 2000000) - 1000000);
+        text += i % 10 == 9 ? '\n' : ' ';
+    }
+    return text;
+}
+
+long long sumAll(IInputSource& source) {
+    long long sum = 0;
+    int value;
+    while (source.readInt(value))
+        sum += value;
+    return sum;
+}
+
+} // namespace
+
+// read(n) для 10 млн целых: operator>> против разбора из буфера
+BENCHMARK(Input_Read10MIntegers) {
+    const std::string text = makeInput();
+    {
+        std::ofstream file(FILE_NAME, std::ios::binary);
+        file << text;
+    }
+
+    bench::measure("istringstream >> int", COUNT, [&]() {
+        std::istringstream stream(text);
+        long long sum = 0;
+        int value;
+        while (stream >> value)
+            sum += value;
+        bench::doNotOptimize(sum);
+    }, 3);
+
+    bench::measure("StreamInputSource (istringstream)", COUNT, [&]() {
+        std::istringstream stream(text);
+        StreamInputSource source(stream);
+        bench::doNotOptimize(sumAll(source));
+    }, 3);
+
+    bench::measure("MemoryInputSource", COUNT, [&]() {
+        MemoryInputSource source(text);
+        bench::doNotOptimize(sumAll(source));
+    }, 3);
+
+    bench::measure("FdInputSource (file)", COUNT, [&]() {
+#ifdef _WIN32
+        int fd = _open(FILE_NAME, _O_RDONLY | _O_BINARY);
+#else
+        int fd = open(FILE_NAME, O_RDONLY);
+#endif
+        {
+            FdInputSource source(fd);
+            bench::doNotOptimize(sumAll(source));
+        }
+#ifdef _WIN32
+        _close(fd);
+#else
+        close(fd);
+#endif
+    }, 3);
+
+    bench::measure("MappedFileInputSource", COUNT, [&]() {
+        MappedFileInputSource source(FILE_NAME);
+        bench::doNotOptimize(sumAll(source));
+    }, 3);
+
+    std::remove(FILE_NAME);
+}
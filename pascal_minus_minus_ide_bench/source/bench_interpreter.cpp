@@ -0,0 +1,118 @@
+#include "bench.h"
+#include "compiled_interpreter.h"
+#include "interpreter.h"
+#include "parser.h"
+#include "lexer.h"
+
+namespace {
+
+struct Program {
+    const char* name;
+    size_t iterations;  // Число итераций самого внутреннего тела (для нс/итерацию)
+    const char* source;
+};
+
+// Циклы ограничены 10000 итерациями, поэтому объём работы набирается вложенностью
+const Program PROGRAMS[] = {
+    { "arithmetic", 10000,
+      "program Bench;\n"
+      "var i, s: integer; x: real;\n"
+      "begin\n"
+      "  s := 0; x := 0;\n"
+      "  for i := 1 to 10000 do begin\n"
+      "    s := s + i * 3 mod 7 - i div 5;\n"
+      "    x := x + i / 2\n"
+      "  end\n"
+      "end." },
+    { "nested-if", 10000,
+      "program Bench;\n"
+      "var i, j, c: integer;\n"
+      "begin\n"
+      "  c := 0;\n"
+      "  for i := 1 to 100 do\n"
+      "    for j := 1 to 100 do\n"
+      "      if (i + j) mod 2 = 0 then c := c + 1 else c := c - 1\n"
+      "end." },
+    { "while-bool", 10000,
+      "program Bench;\n"
+      "var n, k: integer; even: boolean;\n"
+      "begin\n"
+      "  n := 0; k := 0;\n"
+      "  while n < 10000 do begin\n"
+      "    n := n + 1;\n"
+      "    even := n mod 2 = 0;\n"
+      "    if even and (n mod 3 = 0) then k := k + n\n"
+      "  end\n"
+      "end." },
+};
+
+std::shared_ptr<ASTNode> parseProgram(const char* source, const std::shared_ptr<NameTable>& names) {
+    Lexer lexer(source, nullptr, names);
+    Parser parser(lexer.tokenize());
+    return parser.parse();
+}
+
+} // namespace
+
+BENCHMARK(Interpreter_TreeWalkingVsClosures) {
+    for (const auto& program : PROGRAMS) {
+        auto names = std::make_shared<NameTable>();
+        auto ast = parseProgram(program.source, names);
+        std::string name = program.name;
+
+        Interpreter tree;
+        tree.setNames(names);
+        bench::measure(name + " Interpreter::run", program.iterations, [&]() {
+            tree.run(ast);
+        });
+
+        CompiledInterpreter compiled;
+        compiled.setNames(names);
+        bench::measure(name + " compile+execute", program.iterations, [&]() {
+            compiled.run(ast);
+        });
+
+        auto code = compiled.compile(ast);
+        bench::measure(name + " execute", program.iterations, [&]() {
+            compiled.execute(*code);
+        });
+
+        auto shared = CompiledProgram::compile(ast, names);
+        bench::measure(name + " ExecutionContext per run", program.iterations, [&]() {
+            ExecutionContext context(*shared);
+            shared->run(context);
+        });
+    }
+}
+
+// Цена профилирования: точного по узлам и выборочного по строкам
+BENCHMARK(Interpreter_Profilers) {
+    for (const auto& program : PROGRAMS) {
+        auto names = std::make_shared<NameTable>();
+        auto ast = parseProgram(program.source, names);
+        std::string name = program.name;
+
+        Interpreter plain;
+        plain.setNames(names);
+        bench::measure(name + " no profiler", program.iterations, [&]() {
+            plain.run(ast);
+        });
+
+        Interpreter exact;
+        exact.setNames(names);
+        NodeProfiler profiler;
+        exact.setProfiler(&profiler);
+        bench::measure(name + " NodeProfiler", program.iterations, [&]() {
+            exact.run(ast);
+        });
+
+        Interpreter sampled;
+        sampled.setNames(names);
+        SamplingProfiler sampler;
+        sampler.start(sampled.getPosition());
+        bench::measure(name + " SamplingProfiler", program.iterations, [&]() {
+            sampled.run(ast);
+        });
+        sampler.stop();
+    }
+}
@@ -0,0 +1,69 @@
+// Отладочные вызовы оставлены в коде, чтобы замерить именно проверку уровня во время выполнения
+#define LOG_MIN_LEVEL 0
+
+#include "bench.h"
+#include "logger.h"
+
+namespace {
+
+const size_t CALLS = 1000000;
+
+} // namespace
+
+// Стоимость отключённого LOG_DEBUG с построением сообщения, как в Interpreter::executeFor
+BENCHMARK(Logger_DisabledDebug) {
+    Logger::getInstance().setLogLevel(LogLevel::Info);
+
+    bench::measure("empty loop", CALLS, [&]() {
+        for (size_t i = 0; i < CALLS; ++i)
+            bench::doNotOptimize(i);
+    });
+
+    bench::measure("eager debug() call", CALLS, [&]() {
+        for (size_t i = 0; i < CALLS; ++i) {
+            bench::doNotOptimize(i);
+            Logger::getInstance().debug("Завершение цикла for после " + std::to_string(i) + " итераций");
+        }
+    });
+
+    bench::measure("LOG_DEBUG (runtime level)", CALLS, [&]() {
+        for (size_t i = 0; i < CALLS; ++i) {
+            bench::doNotOptimize(i);
+            LOG_DEBUG("Завершение цикла for после " + std::to_string(i) + " итераций");
+        }
+    });
+}
+
+// Стоимость включённого сообщения для вызывающего потока: синхронная запись против очереди
+BENCHMARK(Logger_SyncVsAsync) {
+#ifdef _WIN32
+    const char* nullDevice = "NUL";
+#else
+    const char* nullDevice = "/dev/null";
+#endif
+    Logger& logger = Logger::getInstance();
+    logger.setConsoleOutput(false);
+    logger.setLogFile(nullDevice);
+    logger.setLogLevel(LogLevel::Info);
+
+    const size_t messages = 200000;
+    bench::measure("sync LOG_INFO", messages, [&]() {
+        for (size_t i = 0; i < messages; ++i)
+            LOG_INFO("Завершение цикла for после " + std::to_string(i) + " итераций");
+    });
+
+    logger.startAsync({ 1 << 16, LogOverflow::Block });
+    bench::measure("async LOG_INFO (enqueue)", messages, [&]() {
+        for (size_t i = 0; i < messages; ++i)
+            LOG_INFO("Завершение цикла for после " + std::to_string(i) + " итераций");
+    });
+    bench::measure("async LOG_INFO + flush", messages, [&]() {
+        for (size_t i = 0; i < messages; ++i)
+            LOG_INFO("Завершение цикла for после " + std::to_string(i) + " итераций");
+        logger.flush();
+    });
+    logger.stopAsync();
+
+    logger.setLogFile("");
+    logger.setConsoleOutput(true);
+}
@@ -0,0 +1,14 @@
+#include "bench.h"
+
+// Запуск всех зарегистрированных бенчмарков (или только содержащих подстроку argv[1])
+int main(int argc, char** argv) {
+    std::string filter = argc > 1 ? argv[1] : "";
+    for (const auto& benchCase : bench::registry()) {
+        if (!filter.empty() && benchCase.name.find(filter) == std::string::npos)
+            continue;
+        std::cout << benchCase.name << std::endl;
+        benchCase.body();
+        std::cout << std::endl;
+    }
+    return 0;
+}
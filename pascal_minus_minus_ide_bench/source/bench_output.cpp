@@ -0,0 +1,51 @@
+#include "bench.h"
+#include "output_sink.h"
+#include <cstdio>
+#include <fstream>
+
+namespace {
+
+#ifdef _WIN32
+const char* NULL_DEVICE = "NUL";
+#else
+const char* NULL_DEVICE = "/dev/null";
+#endif
+
+const int LINES = 200000;
+
+} // namespace
+
+// writeln: поток с std::endl на каждой строке против буферизованных приёмников
+BENCHMARK(Output_WritelnNumbers) {
+    std::ofstream file(NULL_DEVICE);
+    bench::measure("ostream << endl", LINES, [&]() {
+        for (int i = 0; i < LINES; ++i)
+            file << i << ' ' << i * 0.5 << std::endl;
+    });
+
+    StreamOutputSink stream(file);
+    bench::measure("StreamOutputSink", LINES, [&]() {
+        for (int i = 0; i < LINES; ++i) {
+            writeValue(stream, Value(i));
+            stream.write(" ", 1);
+            writeValue(stream, Value(i * 0.5));
+            stream.endLine();
+        }
+        stream.flush();
+    });
+
+    FILE* device = std::fopen(NULL_DEVICE, "w");
+    if (!device)
+        return;
+    FdOutputSink fd(fileno(device));
+    bench::measure("FdOutputSink", LINES, [&]() {
+        for (int i = 0; i < LINES; ++i) {
+            writeValue(fd, Value(i));
+            fd.write(" ", 1);
+            writeValue(fd, Value(i * 0.5));
+            fd.endLine();
+        }
+        fd.flush();
+    });
+    std::fclose(device);
+}
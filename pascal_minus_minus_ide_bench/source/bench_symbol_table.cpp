@@ -0,0 +1,137 @@
+#include "bench.h"
+#include "symbol_table.h"
+#include <functional>
+#include <type_traits>
+
+namespace {
+
+// Прежняя реализация таблицы символов (цепочки без перехеширования) - база для сравнения
+class ChainedSymbolTable {
+    struct ChainNode {
+        SymbolInfo data;
+        ChainNode* next;
+        ChainNode(const SymbolInfo& s, ChainNode* n) : data(s), next(n) {}
+    };
+
+    ChainNode** buckets;
+    size_t capacity;
+
+    size_t hashKey(const string& key) const { return hash<string>{}(key) % capacity; }
+
+public:
+    explicit ChainedSymbolTable(size_t cap = 128) : capacity(cap) {
+        buckets = new ChainNode*[capacity]();
+    }
+
+    ~ChainedSymbolTable() {
+        for (size_t i = 0; i < capacity; ++i) {
+            ChainNode* node = buckets[i];
+            while (node) {
+                ChainNode* tmp = node;
+                node = node->next;
+                delete tmp;
+            }
+        }
+        delete[] buckets;
+    }
+
+    void addSymbol(const SymbolInfo& symbol) {
+        size_t idx = hashKey(symbol.name);
+        for (ChainNode* node = buckets[idx]; node; node = node->next) {
+            if (node->data.name == symbol.name) {
+                node->data.type = symbol.type;
+                node->data.value = symbol.value;
+                return;
+            }
+        }
+        buckets[idx] = new ChainNode(symbol, buckets[idx]);
+    }
+
+    SymbolInfo* findSymbol(const string& name) {
+        for (ChainNode* node = buckets[hashKey(name)]; node; node = node->next)
+            if (node->data.name == name)
+                return &node->data;
+        return nullptr;
+    }
+
+    void removeSymbol(const string& name) {
+        size_t idx = hashKey(name);
+        ChainNode* prev = nullptr;
+        for (ChainNode* node = buckets[idx]; node; prev = node, node = node->next) {
+            if (node->data.name == name) {
+                (prev ? prev->next : buckets[idx]) = node->next;
+                delete node;
+                return;
+            }
+        }
+    }
+};
+
+std::vector<std::string> makeNames(size_t n, const std::string& prefix) {
+    std::vector<std::string> names;
+    names.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+        names.push_back(prefix + std::to_string(i));
+    return names;
+}
+
+template <typename Table>
+void runWorkload(size_t symbols, const std::string& label) {
+    auto names = makeNames(symbols, "var");
+    auto misses = makeNames(symbols, "missing");
+    const size_t lookups = 200000;
+
+    bench::measure(label + " insert x" + std::to_string(symbols), symbols, [&]() {
+        Table table;
+        for (const auto& name : names)
+            table.addSymbol(SymbolInfo(name, "integer", "0"));
+        bench::doNotOptimize(table);
+    });
+
+    Table table;
+    for (const auto& name : names)
+        table.addSymbol(SymbolInfo(name, "integer", "0"));
+
+    bench::measure(label + " find hit", lookups, [&]() {
+        size_t found = 0;
+        for (size_t i = 0; i < lookups; ++i)
+            found += table.findSymbol(names[i % symbols]) != nullptr;
+        bench::doNotOptimize(found);
+    });
+
+    bench::measure(label + " find miss", lookups, [&]() {
+        size_t found = 0;
+        for (size_t i = 0; i < lookups; ++i)
+            found += table.findSymbol(misses[i % symbols]) != nullptr;
+        bench::doNotOptimize(found);
+    });
+
+    // Интерпретатор ищет символы по уже интернированному имени
+    if constexpr (std::is_same_v<Table, SymbolTable>) {
+        std::vector<NameId> ids;
+        for (const auto& name : names)
+            ids.push_back(table.getNames().find(name));
+        bench::measure(label + " find by NameId", lookups, [&]() {
+            size_t found = 0;
+            for (size_t i = 0; i < lookups; ++i)
+                found += table.findSymbol(ids[i % symbols]) != nullptr;
+            bench::doNotOptimize(found);
+        });
+    }
+
+    bench::measure(label + " remove+add", symbols, [&]() {
+        for (const auto& name : names) {
+            table.removeSymbol(name);
+            table.addSymbol(SymbolInfo(name, "integer", "1"));
+        }
+    });
+}
+
+} // namespace
+
+BENCHMARK(SymbolTable_OpenAddressingVsChained) {
+    for (size_t symbols : { 100, 1000, 10000 }) {
+        runWorkload<ChainedSymbolTable>(symbols, "chained");
+        runWorkload<SymbolTable>(symbols, "swiss  ");
+    }
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+/**
+ * @file allocation_profiler.h
+ * @brief Профиль выделений памяти кучи по фазам, структурам данных и операторам
+ *
+ * Выделения перехватываются заменой глобальных operator new/delete
+ * (allocation_hooks.cpp). Замена не входит в библиотеку: её компонуют только
+ * исполняемые файлы, которым нужен профиль (pascal_minus_minus_ide_runner и
+ * тесты). Без замены профилировщик ничего не видит (hooksInstalled() == false).
+ *
+ * Выделение относится к фазе (PhaseScope) и к структуре данных (SiteScope)
+ * вызывающего потока на момент выделения, освобождение - туда же, где
+ * выделено. Интерпретатор с setAllocationProfiler() дополнительно считает
+ * собственные выделения каждого выполненного оператора (без вложенных).
+ * Сопрограмма (coroutine.h) ведёт это состояние отдельно, как свой поток:
+ * области, открытые до yield(), не действуют на код, продолжающий работу.
+ */
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+struct ASTNode;
+
+// Фаза обработки программы
+enum class AllocationPhase : std::uint8_t {
+    Other,
+    Lexing,
+    Parsing,
+    Execution
+};
+
+// Структура данных, ради которой выделяется память
+enum class AllocationSite : std::uint8_t {
+    Other,
+    Tokens,       // Вектор токенов и их тексты (Lexer::tokenize)
+    Ast,          // Узлы AST и их списки детей (Parser::parse)
+    Symbols,      // Привязки таблицы символов
+    Postfix,      // Постфиксная форма выражения и стек значений
+    Strings       // Строки значений Value при вычислении, вводе и преобразовании
+};
+
+constexpr std::size_t ALLOCATION_PHASE_COUNT = 4;
+constexpr std::size_t ALLOCATION_SITE_COUNT = 6;
+
+/**
+ * Счётчики одной ячейки (или итог)
+ */
+struct AllocationStats {
+    std::uint64_t allocations = 0;
+    std::uint64_t bytes = 0;        // Выделено всего
+    std::int64_t liveBytes = 0;     // Ещё не освобождено
+    std::int64_t peakLiveBytes = 0;
+};
+
+/**
+ * Выделения одного оператора AST
+ */
+struct StatementAllocations {
+    const ASTNode* node = nullptr;
+    std::uint64_t executions = 0;
+    std::uint64_t allocations = 0;  // Собственные, без вложенных операторов
+    std::uint64_t bytes = 0;
+};
+
+class AllocationProfiler {
+public:
+    /**
+     * Фаза вызывающего потока на время жизни объекта
+     */
+    class PhaseScope {
+    public:
+        explicit PhaseScope(AllocationPhase phase);
+        ~PhaseScope();
+        PhaseScope(const PhaseScope&) = delete;
+        PhaseScope& operator=(const PhaseScope&) = delete;
+    private:
+        AllocationPhase saved;
+    };
+
+    /**
+     * Структура данных вызывающего потока; вне профилирования стоит одной загрузки флага
+     */
+    class SiteScope {
+    public:
+        explicit SiteScope(AllocationSite site) {
+            if (active.load(std::memory_order_relaxed))
+                enter(site);
+        }
+        ~SiteScope() {
+            if (entered)
+                leave();
+        }
+        SiteScope(const SiteScope&) = delete;
+        SiteScope& operator=(const SiteScope&) = delete;
+    private:
+        bool entered = false;
+        AllocationSite saved = AllocationSite::Other;
+        void enter(AllocationSite site);
+        void leave();
+    };
+
+    /**
+     * Выполнение оператора; без профилировщика ничего не делает
+     */
+    class StatementScope {
+    public:
+        StatementScope(AllocationProfiler* profiler, const ASTNode* node) : profiler(profiler), node(node) {
+            if (profiler)
+                enter();
+        }
+        ~StatementScope() {
+            if (profiler)
+                leave();
+        }
+        StatementScope(const StatementScope&) = delete;
+        StatementScope& operator=(const StatementScope&) = delete;
+    private:
+        friend class AllocationProfiler;
+        AllocationProfiler* profiler;
+        const ASTNode* node;
+        StatementScope* parent = nullptr;
+        std::uint64_t allocationsAtStart = 0;
+        std::uint64_t bytesAtStart = 0;
+        std::uint64_t nestedAllocations = 0;    // Выделения вложенных операторов
+        std::uint64_t nestedBytes = 0;
+        void enter();
+        void leave();
+    };
+
+    /**
+     * Фаза, структура и цепочка операторов одного потока выполнения
+     */
+    struct ExecutionState {
+        AllocationPhase phase = AllocationPhase::Other;
+        AllocationSite site = AllocationSite::Other;
+        unsigned suppressed = 0;                // > 0: выделения самого профилировщика
+        std::uint64_t allocations = 0;          // Учтённые выделения (для операторов)
+        std::uint64_t bytes = 0;
+        StatementScope* statement = nullptr;
+    };
+
+    /**
+     * Меняет местами состояние вызывающего потока и other
+     * Вызывается Coroutine::resume() при входе в сопрограмму и возврате из неё
+     */
+    static void swapExecutionState(ExecutionState& other) noexcept;
+
+    AllocationProfiler();
+    ~AllocationProfiler();
+
+    AllocationProfiler(const AllocationProfiler&) = delete;
+    AllocationProfiler& operator=(const AllocationProfiler&) = delete;
+
+    /**
+     * Начинает учёт; одновременно активен один профилировщик
+     * @throws logic_error, если активен другой
+     */
+    void start();
+    void stop();
+    bool running() const { return active.load(std::memory_order_relaxed) == this; }
+
+    // Скомпонована ли замена operator new/delete
+    static bool hooksInstalled();
+
+    AllocationStats stats(AllocationPhase phase, AllocationSite site) const;
+    AllocationStats stats(AllocationPhase phase) const;     // Итог фазы
+    AllocationStats total() const;
+
+    // Операторы по убыванию собственных выделений; дерево должно быть ещё живо
+    std::vector<StatementAllocations> statements() const;
+
+    /**
+     * Таблица фаз и структур, затем top операторов с наибольшим числом выделений
+     */
+    void writeReport(std::ostream& out, std::size_t top = 20) const;
+
+    /**
+     * Вызываются из замены operator new/delete; не выделяют память
+     * @return Метка выделения, которую надо передать в onFree
+     */
+    static std::uint32_t onAllocate(std::size_t size);
+    static void onFree(std::uint32_t tag, std::size_t size);
+
+    // Вызывается заменой operator new/delete при статической инициализации
+    static void markHooksInstalled();
+
+private:
+    struct Cell {
+        std::atomic<std::uint64_t> allocations{ 0 };
+        std::atomic<std::uint64_t> bytes{ 0 };
+        std::atomic<std::int64_t> liveBytes{ 0 };
+        std::atomic<std::int64_t> peakLiveBytes{ 0 };
+    };
+
+    static std::atomic<AllocationProfiler*> active;
+
+    const std::uint32_t generation;             // Отличает выделения прежних запусков
+    std::array<Cell, ALLOCATION_PHASE_COUNT * ALLOCATION_SITE_COUNT> cells;
+    std::array<Cell, ALLOCATION_PHASE_COUNT> phases;   // Пик фазы - не сумма пиков ячеек
+    Cell overall;
+    mutable std::mutex mutex;                   // Защищает statementTable
+    std::unordered_map<const ASTNode*, StatementAllocations> statementTable;
+
+    void record(const StatementScope& scope, std::uint64_t allocations, std::uint64_t bytes);
+    static void charge(Cell& cell, std::size_t size);
+    static void release(Cell& cell, std::size_t size);
+    static AllocationStats snapshot(const Cell& cell);
+};
@@ -12,6 +12,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include "name_table.h"
 
 // Предварительное объявление типов для устранения циклических зависимостей
 struct Token;
@@ -77,10 +78,16 @@ class ASTNode {
 public:
     ASTNodeType type;                              // Тип узла
     string value;                                  // Значение (например, имя переменной или литерал)
+    NameId name;                                   // Номер имени в таблице лексера (Identifier, VarDecl, ConstDecl, ForLoop) или NO_NAME
     vector<shared_ptr<ASTNode>> children;          // Дочерние узлы (например, аргументы, тело блока)
+    int line = 0;                                  // Позиция начала конструкции в исходном тексте
+    int column = 0;                                // (0 - неизвестна, например, у узлов, созданных вручную)
 
-    ASTNode(ASTNodeType t, const string& v = "") : type(t), value(v) {}
-    ASTNode(ASTNodeType t, const string& v, const shared_ptr<ASTNode>& child) : type(t), value(v) { children.push_back(child); }
+    // Узлы, созданные вручную, не имеют номера: имя находится по тексту value
+    ASTNode(ASTNodeType t, const string& v = "") : type(t), value(v), name(NO_NAME) {}
+    ASTNode(ASTNodeType t, const string& v, const shared_ptr<ASTNode>& child) : type(t), value(v), name(NO_NAME) { children.push_back(child); }
+    // Имя уже интернировано лексером
+    ASTNode(ASTNodeType t, const string& v, NameId n) : type(t), value(v), name(n) {}
     virtual ~ASTNode() = default;
 };
 
@@ -0,0 +1,129 @@
+#pragma once
+
+/**
+ * @file batch_runner.h
+ * @brief Пакетное выполнение множества программ Pascal--
+ *
+ * Каждая программа проходит Lexer, Parser и Interpreter в отдельной задаче пула
+ * WorkStealingPool со своим вводом, выводом и обработчиком ошибок в памяти,
+ * без общего журнала. Результаты возвращаются в порядке заданий.
+ */
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+class TraceRecorder;
+class MetricsRegistry;
+struct InterpreterMetrics;
+
+/**
+ * Задание: программа и данные для read/readln
+ */
+struct BatchJob {
+    std::string name;    // Имя для отчёта (обычно путь к файлу)
+    std::string source;  // Текст программы
+    std::string input;   // Содержимое стандартного ввода
+};
+
+/**
+ * Результат выполнения одного задания
+ */
+struct BatchResult {
+    std::string name;
+    bool success = false;       // Выполнена без исключений и без зарегистрированных ошибок
+    std::string output;         // Вывод write/writeln
+    std::string diagnostics;    // Сообщения ErrorReporter
+    std::string error;          // Текст исключения, прервавшего выполнение
+    double seconds = 0;         // Время разбора и выполнения
+    std::size_t memoryBytes = 0;        // Память программы после выполнения (см. MemoryAccount)
+    std::size_t peakMemoryBytes = 0;    // Пик памяти программы
+};
+
+/**
+ * Сводка по пакету
+ */
+struct BatchSummary {
+    std::size_t programs = 0;
+    std::size_t succeeded = 0;
+    std::size_t failed = 0;
+    std::size_t threads = 0;
+    std::size_t stolen = 0;         // Задания, перехваченные чужими потоками
+    std::size_t restarts = 0;       // Перезапуски рабочих процессов (многопроцессный режим)
+    double wallSeconds = 0;         // Время пакета целиком
+    double jobSeconds = 0;          // Сумма времени заданий
+    double programsPerSecond = 0;
+};
+
+/**
+ * Загружает одну программу; файл с тем же именем и расширением .in, если есть, становится вводом
+ * @throws runtime_error, если файл не читается
+ */
+BatchJob loadBatchProgram(const std::string& path);
+
+/**
+ * Загружает все файлы *.pas каталога (в порядке имён)
+ * Рядом лежащий файл с тем же именем и расширением .in становится вводом программы
+ * @throws runtime_error, если каталог или файл не читается
+ */
+std::vector<BatchJob> loadBatchDirectory(const std::string& directory);
+
+/**
+ * Загружает задания из списка: строка "программа.pas [ввод.in]", пути относительно
+ * каталога списка; пустые строки и строки, начинающиеся с '#', пропускаются
+ * @throws runtime_error, если список или файл не читается
+ */
+std::vector<BatchJob> loadBatchManifest(const std::string& manifest);
+
+class BatchRunner {
+public:
+    /**
+     * @param threads Число рабочих потоков (0 - по числу аппаратных потоков)
+     * @param timeLimitSeconds Срок выполнения одного задания (0 - без ограничения)
+     * @param memoryLimitBytes Лимит памяти интерпретатора одного задания (0 - без ограничения)
+     */
+    explicit BatchRunner(std::size_t threads = 0, double timeLimitSeconds = 0, std::size_t memoryLimitBytes = 0)
+        : threads(threads), timeLimitSeconds(timeLimitSeconds), memoryLimitBytes(memoryLimitBytes) {}
+
+    /**
+     * Выполняет задания параллельно
+     * @return Результаты в порядке заданий
+     */
+    std::vector<BatchResult> run(const std::vector<BatchJob>& jobs);
+
+    // Сводка последнего вызова run()
+    const BatchSummary& getSummary() const { return summary; }
+
+    /**
+     * Включает запись временной шкалы заданий по потокам (см. trace_recorder.h)
+     * @param target Трасса (не владеет ею) или nullptr - выключить
+     */
+    void setTracer(TraceRecorder* target) { tracer = target; }
+
+    /**
+     * Включает счётчики выполнения: все задания пишут в одни метрики реестра (см. metrics.h)
+     * @param registry Реестр (должен пережить пакет) или nullptr - выключить
+     */
+    void setMetrics(MetricsRegistry* registry);
+
+    /**
+     * Выполняет одно задание в вызывающем потоке
+     * @param timeLimitSeconds Срок от начала разбора (0 - без ограничения); по его
+     * истечении выполнение прерывается, а задание считается неуспешным
+     * @param memoryLimitBytes Лимит памяти интерпретатора (0 - без ограничения); при
+     * превышении выполнение также прерывается
+     * @param tracer Трасса для отрезков задания, его фаз, операторов и циклов (необязательно)
+     * @param metrics Счётчики выполнения (необязательно)
+     */
+    static BatchResult runJob(const BatchJob& job, double timeLimitSeconds = 0, std::size_t memoryLimitBytes = 0,
+                              TraceRecorder* tracer = nullptr, const InterpreterMetrics* metrics = nullptr);
+
+private:
+    std::size_t threads;
+    double timeLimitSeconds;
+    std::size_t memoryLimitBytes;
+    TraceRecorder* tracer = nullptr;
+    std::shared_ptr<const InterpreterMetrics> metrics;
+    BatchSummary summary;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+/**
+ * @file cancellation.h
+ * @brief Внешняя отмена выполнения программы и срок выполнения
+ *
+ * Интерпретатор проверяет признак отмены между операторами и на обратных переходах
+ * циклов, а срок - на каждой 64-й такой проверке, поэтому проверка почти ничего не
+ * стоит. Сработавшая проверка раскручивает выполнение до Interpreter::run, который
+ * сообщает причину через обработчик ошибок и выбрасывает ExecutionInterrupted.
+ * Так же завершается выполнение при превышении лимита памяти (см. memory_account.h).
+ */
+
+#include <atomic>
+#include <stdexcept>
+
+/**
+ * Признак отмены; cancel() можно вызывать из любого потока
+ */
+class CancellationToken {
+public:
+    void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+    bool isCancelled() const { return cancelled.load(std::memory_order_relaxed); }
+
+    // Снимает отмену, чтобы использовать признак для следующего запуска
+    void reset() { cancelled.store(false, std::memory_order_relaxed); }
+
+private:
+    std::atomic<bool> cancelled{ false };
+};
+
+enum class InterruptReason {
+    Cancelled,          // Сработал CancellationToken
+    DeadlineExceeded,   // Истёк срок выполнения
+    MemoryLimit         // Превышен лимит памяти интерпретатора
+};
+
+/**
+ * Исключение Interpreter::run при прерывании выполнения
+ */
+class ExecutionInterrupted : public std::runtime_error {
+public:
+    explicit ExecutionInterrupted(InterruptReason reason)
+        : std::runtime_error(describe(reason)), reason(reason) {}
+
+    InterruptReason getReason() const { return reason; }
+
+private:
+    InterruptReason reason;
+
+    static const char* describe(InterruptReason reason) {
+        switch (reason) {
+        case InterruptReason::Cancelled:
+            return "Выполнение прервано: программа отменена";
+        case InterruptReason::DeadlineExceeded:
+            return "Выполнение прервано: истёк срок выполнения";
+        default:
+            return "Выполнение прервано: превышен лимит памяти";
+        }
+    }
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+/**
+ * @file compiled_interpreter.h
+ * @brief Интерпретатор Pascal-- с предварительной компиляцией AST в замыкания
+ *
+ * Дерево программы один раз переводится в дерево заранее связанных функциональных
+ * объектов: переменные разрешаются в номера слотов, литералы декодируются, а для
+ * каждой операции выбирается реализация под статически известные типы операндов.
+ * Выполнение оператора - это прямой косвенный вызов, без разбора типа узла и без
+ * работы со строками имён.
+ */
+
+#include "compiled_program.h"
+#include <map>
+#include <memory>
+#include <string>
+
+/**
+ * Интерпретатор, выполняющий программу после компиляции в замыкания
+ *
+ * Семантика совпадает с Interpreter, включая тексты сообщений об ошибках
+ * и ограничение числа итераций циклов. Отличие одно: строковые литералы
+ * в выражениях вычисляются в строки. Для выполнения одной программы из
+ * нескольких потоков используйте CompiledProgram и ExecutionContext напрямую.
+ */
+class CompiledInterpreter : public IInterpreter {
+public:
+    CompiledInterpreter();
+    explicit CompiledInterpreter(shared_ptr<IErrorReporter> errorReporter);
+
+    /**
+     * Компилирует и выполняет программу
+     * @param ast Корневой узел AST программы
+     */
+    void run(const shared_ptr<ASTNode>& ast) override;
+
+    /**
+     * Компилирует программу, не выполняя её
+     * Заданные к этому моменту переменные становятся входными переменными программы
+     * @param ast Корневой узел AST программы
+     * @return Скомпилированная программа для execute()
+     */
+    shared_ptr<const CompiledProgram> compile(const shared_ptr<ASTNode>& ast) const;
+
+    /**
+     * Выполняет ранее скомпилированную программу со стандартными потоками ввода-вывода
+     * Значения глобальных переменных после выполнения сохраняются в интерпретаторе
+     */
+    void execute(const CompiledProgram& program);
+
+    /**
+     * Задаёт таблицу имён, которой лексер пронумеровал следующие программы
+     * Переменные между запусками хранятся по тексту имён и сохраняются
+     */
+    void setNames(shared_ptr<NameTable> names);
+
+    /**
+     * Таблица имён для компиляции (передаётся лексеру программы)
+     */
+    const shared_ptr<NameTable>& getNames() const { return names; }
+
+    Value evaluate(const string& expression) override;
+    bool isDeclared(const string& name) const override;
+    Value getVariable(const string& name) const override;
+    void setVariable(const string& name, const Value& value) override;
+    void clearSymbols() override;
+    const map<string, Value>& getAllSymbols() const override;
+    string getComponentName() const override { return "CompiledInterpreter"; }
+
+private:
+    shared_ptr<IErrorReporter> errorReporter;
+    shared_ptr<NameTable> names;  // Таблица имён лексера компилируемых программ
+    map<string, Value> symbols;   // Глобальные переменные между запусками
+};
@@ -0,0 +1,133 @@
+#pragma once
+
+/**
+ * @file compiled_program.h
+ * @brief Скомпилированная программа Pascal-- и состояние её выполнения
+ *
+ * CompiledProgram строится один раз из AST и после этого не изменяется, поэтому один
+ * экземпляр можно выполнять одновременно из нескольких потоков. Всё, что меняется во
+ * время выполнения (значения переменных, потоки ввода-вывода, обработчик ошибок),
+ * хранится в ExecutionContext - отдельном для каждого запуска.
+ *
+ * Глобальные переменные программы адресуются номерами имён из таблицы лексера,
+ * разобравшего дерево; программа держит эту таблицу и переводит через неё текстовые
+ * имена внешнего API. Пока программа выполняется в нескольких потоках, в таблицу
+ * нельзя добавлять имена (например, разбирая ею другую программу).
+ */
+
+#include "ast.h"
+#include "interfaces.h"
+#include "error_reporter.h"
+#include "value.h"
+#include "name_table.h"
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class CompiledProgram;
+
+/**
+ * Состояние одного запуска скомпилированной программы
+ *
+ * Переменные лежат в слотах, номера которых назначены при компиляции; замыкания
+ * программы обращаются к ним напрямую. Контекст дёшев в создании и не разделяется
+ * между потоками.
+ */
+class ExecutionContext {
+public:
+    /**
+     * Создаёт контекст для программы: слоты заполняются входными значениями программы
+     * @param program Программа, для которой создаётся контекст (должна пережить контекст)
+     * @param input Поток для read/readln
+     * @param output Поток для write/writeln
+     * @param errorReporter Обработчик ошибок выполнения (по умолчанию - новый ErrorReporter)
+     */
+    explicit ExecutionContext(const CompiledProgram& program, std::istream& input = std::cin,
+        std::ostream& output = std::cout, shared_ptr<IErrorReporter> errorReporter = nullptr);
+
+    /**
+     * Проверяет, объявлена ли глобальная переменная к текущему моменту выполнения
+     */
+    bool isDeclared(const string& name) const;
+
+    /**
+     * Значение глобальной переменной
+     * @throws runtime_error, если переменная не объявлена
+     */
+    Value getVariable(const string& name) const;
+
+    /**
+     * Задаёт значение глобальной переменной программы (с приведением к её типу)
+     * @throws runtime_error, если программа не знает такой переменной
+     */
+    void setVariable(const string& name, const Value& value);
+
+    /**
+     * Снимок объявленных глобальных переменных
+     */
+    map<string, Value> getAllSymbols() const;
+
+    const CompiledProgram& program;      // Выполняемая программа
+    vector<Value> slots;                 // Значения переменных по номерам слотов
+    vector<char> declared;               // Объявлена ли переменная в слоте
+    std::istream& input;                 // Ввод для read/readln
+    std::ostream& output;                // Вывод для write/writeln
+    shared_ptr<IErrorReporter> errors;   // Обработчик ошибок выполнения
+};
+
+/**
+ * Неизменяемая программа, скомпилированная в дерево замыканий
+ *
+ * Переменные разрешены в номера слотов, литералы декодированы, операции
+ * специализированы под статически известные типы операндов. Семантика совпадает
+ * с Interpreter, кроме строковых литералов: они вычисляются в строки.
+ */
+class CompiledProgram {
+public:
+    // Скомпилированный оператор
+    using Statement = std::function<void(ExecutionContext&)>;
+
+    /**
+     * Компилирует программу
+     * @param ast Корневой узел AST программы
+     * @param names Таблица имён, которой лексер пронумеровал дерево
+     * @param inputs Переменные, заданные до запуска: видны программе без объявления,
+     *               их типы фиксируются, а значения становятся начальными для каждого контекста
+     * @return Программа, которую можно разделять между потоками
+     * @throws logic_error, если дерево пронумеровано другой таблицей имён
+     */
+    static shared_ptr<const CompiledProgram> compile(const shared_ptr<ASTNode>& ast, shared_ptr<NameTable> names,
+        const map<string, Value>& inputs = {});
+
+    /**
+     * Выполняет программу в указанном контексте и сбрасывает его поток вывода
+     * Контекст должен быть создан для этой программы
+     */
+    void run(ExecutionContext& context) const;
+
+    // Число слотов переменных
+    size_t slotCount() const { return slots; }
+
+private:
+    friend class ExecutionContext;
+
+    // Глобальная переменная: слот и её тип после последнего объявления
+    struct Global {
+        size_t slot;
+        ValueType type;
+    };
+
+    CompiledProgram() : slots(0) {}
+
+    Statement body;                                 // Корень дерева замыканий
+    size_t slots;                                   // Число слотов
+    shared_ptr<const NameTable> names;              // Таблица имён, которой пронумерованы globals
+    unordered_map<NameId, Global> globals;          // Глобальные переменные по номерам имён
+    vector<std::pair<size_t, Value>> initialValues; // Входные значения: слот -> значение
+
+    const Global* findGlobal(const string& name) const;
+};
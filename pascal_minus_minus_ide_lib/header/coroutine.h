@@ -0,0 +1,74 @@
+#pragma once
+
+/**
+ * @file coroutine.h
+ * @brief Сопрограммы с собственным стеком (зелёные потоки)
+ *
+ * Тело сопрограммы выполняется на отдельном стеке и может приостановиться в
+ * любой глубине вызовов через Coroutine::yield(): интерпретатору не нужно
+ * перестраивать рекурсивный обход дерева. Переключение - ucontext в POSIX,
+ * волокна (fibers) в Windows. Сопрограмма возобновляется только из того
+ * потока, в котором была запущена.
+ */
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+
+/**
+ * Исключение, которым yield() раскручивает стек сопрограммы, уничтожаемой до завершения
+ * Не наследует std::exception, поэтому не перехватывается обработчиками интерпретатора
+ */
+struct CoroutineCancelled {};
+
+class Coroutine {
+public:
+    using Body = std::function<void()>;
+
+    static constexpr std::size_t DEFAULT_STACK_SIZE = 256 * 1024;
+
+    /**
+     * Создаёт приостановленную сопрограмму; тело начинает выполняться при первом resume()
+     * @throws runtime_error, если не удалось выделить стек
+     */
+    explicit Coroutine(Body body, std::size_t stackSize = DEFAULT_STACK_SIZE);
+
+    // Незавершённая сопрограмма возобновляется с CoroutineCancelled, чтобы раскрутить стек
+    ~Coroutine();
+
+    Coroutine(const Coroutine&) = delete;
+    Coroutine& operator=(const Coroutine&) = delete;
+
+    /**
+     * Выполняет тело до следующего yield() или до завершения
+     * @return true, если тело завершилось
+     * @throws Исключение, которым завершилось тело
+     */
+    bool resume();
+
+    bool finished() const { return done; }
+
+    /**
+     * Приостанавливает текущую сопрограмму и возвращает управление в resume()
+     * Вне сопрограммы ничего не делает
+     * @throws CoroutineCancelled, если сопрограмма уничтожается
+     */
+    static void yield();
+
+    // Выполняемая в текущем потоке сопрограмма (nullptr - вне сопрограммы)
+    static Coroutine* current();
+
+private:
+    struct Context;
+
+    Body body;
+    Context* context;
+    bool started = false;
+    bool done = false;
+    bool cancelling = false;
+    std::exception_ptr error;
+
+    void enter();
+    void switchIn();
+    void switchOut();
+};
@@ -2,42 +2,56 @@
 #define ERROR_REPORTER_H
 
 #include "interfaces.h"
-#include <vector>
-#include <string>
+#include <cstddef>
 #include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 /**
  * Реализация интерфейса IErrorReporter для обработки и отображения ошибок и предупреждений
  * Класс отвечает за сбор, хранение и форматированный вывод сообщений в процессе компиляции и выполнения
+ *
+ * Одинаковые сообщения (тот же уровень, текст, строка и позиция) хранятся один раз
+ * со счётчиком повторов, число хранимых различных сообщений ограничено. Вывод
+ * накапливается и выполняется одной записью в flush() - в конце этапа.
  */
 class ErrorReporter : public IErrorReporter {
 public:
     /**
      * Структура для хранения ошибок и предупреждений
-     * Содержит уровень важности, текст сообщения и позицию в исходном коде
+     * Содержит уровень важности, текст сообщения, позицию в исходном коде и число повторов
      */
     struct Message {
         enum class Level { Error, Warning } level;
         std::string text;
         int line;
         int column;
+        size_t count;   // Сколько раз сообщение было зарегистрировано
 
         Message(Level l, const std::string& t, int ln, int col)
-            : level(l), text(t), line(ln), column(col) {}
+            : level(l), text(t), line(ln), column(col), count(1) {}
     };
 
+    // Предел числа хранимых различных сообщений по умолчанию
+    static constexpr size_t DEFAULT_MAX_MESSAGES = 1000;
+
+    /**
+     * @param output Поток для вывода сообщений
+     * @param maxMessages Сколько различных сообщений хранить; остальные только подсчитываются
+     */
+    explicit ErrorReporter(std::ostream& output = std::cerr, size_t maxMessages = DEFAULT_MAX_MESSAGES);
+
+    // Выводит ещё не выведенные сообщения
+    ~ErrorReporter() override;
+
     /**
      * Сообщить об ошибке
      * @param message Текст сообщения об ошибке
      * @param line Номер строки в исходном коде (если известно)
      * @param column Номер столбца в исходном коде (если известно)
      */
-    void reportError(const std::string& message, int line = -1, int column = -1) override {
-        messages.emplace_back(Message::Level::Error, message, line, column);
-        std::cerr << "\033[1;31mОшибка" << (line >= 0 ? " [Строка " + std::to_string(line) + "]" : "") 
-                  << (column >= 0 ? " [Позиция " + std::to_string(column) + "]" : "") 
-                  << ": " << message << "\033[0m" << std::endl;
-    }
+    void reportError(const std::string& message, int line = -1, int column = -1) override;
 
     /**
      * Сообщить предупреждение
@@ -45,49 +59,73 @@ public:
      * @param line Номер строки в исходном коде (если известно)
      * @param column Номер столбца в исходном коде (если известно)
      */
-    void reportWarning(const std::string& message, int line = -1, int column = -1) override {
-        messages.emplace_back(Message::Level::Warning, message, line, column);
-        std::cerr << "\033[1;33mПредупреждение" << (line >= 0 ? " [Строка " + std::to_string(line) + "]" : "") 
-                  << (column >= 0 ? " [Позиция " + std::to_string(column) + "]" : "") 
-                  << ": " << message << "\033[0m" << std::endl;
-    }
+    void reportWarning(const std::string& message, int line = -1, int column = -1) override;
+
+    /**
+     * Выводит накопленные с прошлого вызова сообщения одной записью
+     * Повторявшиеся сообщения выводятся один раз с числом повторов
+     */
+    void flush() override;
 
     /**
      * Проверить, есть ли ошибки
      * @return true, если были зарегистрированы ошибки, иначе false
      */
-    bool hasErrors() const override {
-        for (const auto& msg : messages) {
-            if (msg.level == Message::Level::Error)
-                return true;
-        }
-        return false;
-    }
+    bool hasErrors() const override { return errorCount != 0; }
 
     /**
      * Проверить, есть ли предупреждения
      * @return true, если были зарегистрированы предупреждения, иначе false
      */
-    bool hasWarnings() const {
-        for (const auto& msg : messages) {
-            if (msg.level == Message::Level::Warning)
-                return true;
-        }
-        return false;
-    }
+    bool hasWarnings() const { return warningCount != 0; }
+
+    // Число зарегистрированных ошибок и предупреждений (с повторами)
+    size_t getErrorCount() const { return errorCount; }
+    size_t getWarningCount() const { return warningCount; }
+
+    // Число различных сообщений, не сохранённых из-за ограничения
+    size_t getSuppressedCount() const { return suppressedCount; }
 
-    // u041fu043eu043bu0443u0447u0438u0442u044c u0432u0441u0435 u0441u043eu043eu0431u0449u0435u043du0438u044f
+    // Получить все сохранённые сообщения (без повторов, в порядке первого появления)
     const std::vector<Message>& getMessages() const {
         return messages;
     }
 
-    // u041eu0447u0438u0441u0442u0438u0442u044c u0432u0441u0435 u0441u043eu043eu0431u0449u0435u043du0438u044f
-    void clear() {
-        messages.clear();
-    }
+    // Изменить предел числа хранимых различных сообщений
+    void setMaxMessages(size_t limit) { maxMessages = limit; }
+
+    // Очистить все сообщения и счётчики (невыведенные сообщения отбрасываются)
+    void clear();
 
 private:
+    // Ключ дедупликации: уровень, текст и позиция
+    struct Key {
+        Message::Level level;
+        std::string text;
+        int line;
+        int column;
+
+        bool operator==(const Key& other) const {
+            return level == other.level && line == other.line && column == other.column && text == other.text;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    std::ostream& output;
+    size_t maxMessages;
     std::vector<Message> messages;
+    std::unordered_map<Key, size_t, KeyHash> index;   // Ключ -> номер в messages
+    std::vector<size_t> reportedCounts;                // Сколько повторов уже выведено
+    std::vector<size_t> pending;                       // Сообщения с невыведенными повторами
+    size_t errorCount = 0;
+    size_t warningCount = 0;
+    size_t suppressedCount = 0;
+    size_t reportedSuppressed = 0;
+
+    void report(Message::Level level, const std::string& message, int line, int column);
 };
 
 #endif // ERROR_REPORTER_H
@@ -0,0 +1,64 @@
+#pragma once
+
+/**
+ * @file fork_server.h
+ * @brief Fork-сервер: запуск программ из заранее прогретого процесса
+ *
+ * Родительский процесс один раз инициализирует общее состояние (таблицы ключевых
+ * слов и операторов, журнал) и, при необходимости, разбирает и компилирует
+ * программу. На каждый запрос порождается дочерний процесс, который получает всё
+ * это через страницы copy-on-write и сразу начинает выполнение. Результат
+ * возвращается родителю через канал (pipe); процесс, не уложившийся в
+ * ограничение времени, завершается сигналом SIGKILL.
+ *
+ * Поддерживается только в POSIX-системах.
+ */
+
+#include "batch_runner.h"
+#include "compiled_program.h"
+#include <memory>
+#include <string>
+
+/**
+ * Результат запроса к fork-серверу
+ */
+struct ForkResult {
+    BatchResult result;
+    double startupSeconds = 0;  // От запроса до начала работы дочернего процесса
+    double totalSeconds = 0;    // От запроса до получения результата
+};
+
+class ForkServer {
+public:
+    /**
+     * Прогревает общее состояние процесса
+     * @param timeLimitSeconds Время на один запрос (0 - без ограничения)
+     */
+    explicit ForkServer(double timeLimitSeconds = 0);
+
+    /**
+     * Разбирает и компилирует программу в родительском процессе
+     * @throws runtime_error при ошибках разбора
+     */
+    void preload(const std::string& source);
+
+    bool hasProgram() const { return program != nullptr; }
+
+    /**
+     * Выполняет загруженную программу в дочернем процессе
+     * @param input Содержимое стандартного ввода
+     * @throws runtime_error, если программа не загружена или процесс не создан
+     */
+    ForkResult run(const std::string& input);
+
+    /**
+     * Разбирает и выполняет программу задания в дочернем процессе
+     * @throws runtime_error, если процесс не создан
+     */
+    ForkResult run(const BatchJob& job);
+
+private:
+    double timeLimitSeconds;
+    std::shared_ptr<ASTNode> ast;                    // Держит дерево, на которое ссылается программа
+    std::shared_ptr<const CompiledProgram> program;
+};
@@ -0,0 +1,133 @@
+#pragma once
+
+/**
+ * @file green_scheduler.h
+ * @brief Кооперативный планировщик интерпретаторов на сопрограммах
+ *
+ * Каждая программа выполняется своим Interpreter в сопрограмме (Coroutine) и
+ * уступает поток через каждые sliceBackEdges обратных переходов циклов, а также
+ * когда read/readln нечего читать. Небольшой пул потоков по очереди возобновляет
+ * готовые задачи: по кругу или по приоритету. Ввод, поступивший для ожидающей
+ * задачи, снова делает её готовой. Задача закреплена за одним потоком пула,
+ * поэтому её сопрограмма всегда возобновляется в одном и том же потоке.
+ */
+
+#include "batch_runner.h"
+#include "coroutine.h"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+enum class SchedulingPolicy {
+    RoundRobin,     // Готовые задачи по очереди
+    Priority        // Сначала задачи с большим приоритетом, среди равных - по очереди
+};
+
+/**
+ * Параметры планировщика
+ */
+struct GreenSchedulerOptions {
+    std::size_t threads = 1;                            // Потоков пула (0 - по числу аппаратных потоков)
+    std::size_t sliceBackEdges = 1000;                  // Обратных переходов циклов в одном кванте
+    std::size_t stackSize = Coroutine::DEFAULT_STACK_SIZE;
+    SchedulingPolicy policy = SchedulingPolicy::RoundRobin;
+};
+
+enum class GreenTaskState {
+    Ready,          // Ждёт своего кванта
+    Running,        // Выполняется в потоке пула
+    WaitingInput,   // read/readln ждёт ввода
+    Finished
+};
+
+/**
+ * Состояние и учёт времени задачи
+ */
+struct GreenTaskInfo {
+    GreenTaskState state = GreenTaskState::Ready;
+    int priority = 0;
+    std::size_t slices = 0;         // Число полученных квантов
+    std::size_t inputWaits = 0;     // Сколько раз задача ждала ввода
+    double cpuSeconds = 0;          // Суммарное время квантов
+    std::uint64_t firstSlice = 0;   // Номер первого и последнего кванта задачи в общей
+    std::uint64_t lastSlice = 0;    // последовательности квантов планировщика (с 1)
+    BatchResult result;             // Заполняется после завершения
+};
+
+class GreenScheduler {
+public:
+    using TaskId = std::size_t;
+
+    explicit GreenScheduler(const GreenSchedulerOptions& options = GreenSchedulerOptions());
+
+    // Останавливает пул; незавершённые задачи прерываются (их стеки раскручиваются)
+    ~GreenScheduler();
+
+    GreenScheduler(const GreenScheduler&) = delete;
+    GreenScheduler& operator=(const GreenScheduler&) = delete;
+
+    /**
+     * Разбирает программу и ставит её в очередь на выполнение
+     * Ошибка разбора сразу завершает задачу с неуспешным результатом
+     * @param job Программа и начальный ввод
+     * @param priority Приоритет (учитывается в SchedulingPolicy::Priority)
+     * @param keepInputOpen Не закрывать ввод после job.input: остальное придёт через provideInput()
+     */
+    TaskId spawn(const BatchJob& job, int priority = 0, bool keepInputOpen = false);
+
+    /**
+     * Добавляет ввод задаче; ожидающая ввода задача снова становится готовой
+     * @throws out_of_range при неизвестном идентификаторе
+     */
+    void provideInput(TaskId id, const std::string& text);
+
+    /**
+     * Закрывает ввод задачи: read/readln после оставшихся данных получат конец ввода
+     * @throws out_of_range при неизвестном идентификаторе
+     */
+    void closeInput(TaskId id);
+
+    /**
+     * Ждёт, пока не останется готовых и выполняющихся задач
+     * (все задачи завершены или ждут ввода)
+     */
+    void wait();
+
+    /**
+     * Снимок состояния задачи
+     * @throws out_of_range при неизвестном идентификаторе
+     */
+    GreenTaskInfo info(TaskId id) const;
+
+    std::size_t taskCount() const;
+    std::size_t threadCount() const { return workers.size(); }
+
+private:
+    struct Task;
+    using ReadyQueue = std::map<std::pair<int, std::uint64_t>, Task*>;  // (-приоритет, очередь) -> задача
+
+    GreenSchedulerOptions options;
+    mutable std::mutex mutex;
+    std::condition_variable wake;           // Будит потоки пула
+    std::condition_variable idle;           // Сообщает wait() об отсутствии готовых задач
+    std::vector<std::unique_ptr<Task>> tasks;
+    std::vector<ReadyQueue> ready;          // Готовые задачи по потокам пула
+    std::size_t readyCount = 0;
+    std::size_t runningCount = 0;
+    std::uint64_t sequence = 0;             // Порядок постановки в очередь
+    std::uint64_t slicesRun = 0;            // Выданные кванты
+    bool stopping = false;
+    std::vector<std::thread> workers;
+
+    Task& find(TaskId id) const;
+    void makeReady(Task& task);
+    void workerLoop(std::size_t index);
+    static void finish(Task& task);
+};
@@ -0,0 +1,154 @@
+#pragma once
+
+/**
+ * @file input_source.h
+ * @brief Источники ввода программы Pascal--
+ *
+ * Ввод read/readln разбирается прямо из буфера: числа - через std::from_chars,
+ * пробельные символы пропускаются блоками по 16 байт (SSE2, где доступно).
+ * Семантика повторяет operator>> для std::cin в локали "C": при ошибке разбора
+ * лексема остаётся во вводе, при переполнении цифры считаются прочитанными.
+ */
+
+#include "interfaces.h"
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Базовый источник, разбирающий лексемы из буфера
+ * Наследники либо дочитывают данные в буфер через read(), либо сразу
+ * отдают все данные целиком через setWindow()
+ */
+class BufferedInputSource : public IInputSource {
+public:
+    static constexpr std::size_t DEFAULT_CAPACITY = 64 * 1024;
+
+    explicit BufferedInputSource(std::size_t capacity = DEFAULT_CAPACITY);
+    BufferedInputSource(const BufferedInputSource&) = delete;
+    BufferedInputSource& operator=(const BufferedInputSource&) = delete;
+
+    bool readInt(int& value) override;
+    bool readReal(double& value) override;
+    bool readWord(std::string& word) override;
+    void skipLine() override;
+    void tie(IOutputSink* sink) override { tied = sink; }
+
+protected:
+    /**
+     * Дочитывает данные
+     * @return Число прочитанных байт (0 - конец ввода)
+     */
+    virtual std::size_t read(char* /*data*/, std::size_t /*capacity*/) { return 0; }
+
+    // Все данные уже в памяти: read() больше не вызывается
+    void setWindow(const char* data, std::size_t size);
+
+private:
+    // Число длиннее этого разбирается только после поиска конца лексемы
+    static constexpr std::ptrdiff_t MAX_NUMBER_LOOKAHEAD = 64;
+
+    std::vector<char> buffer;
+    const char* pos;      // Первый непрочитанный байт
+    const char* end;      // Конец прочитанных данных
+    bool exhausted;       // read() сообщил о конце ввода
+    IOutputSink* tied = nullptr;  // Сбрасывается перед каждым read()
+
+    bool refill();
+    std::size_t nextToken();
+    const char* numberBound();
+
+    template <typename T>
+    bool readNumber(T& value);
+};
+
+/**
+ * Ввод из строки в памяти
+ */
+class MemoryInputSource : public BufferedInputSource {
+public:
+    explicit MemoryInputSource(std::string text);
+
+private:
+    std::string text;
+};
+
+/**
+ * Ввод из std::istream (по умолчанию интерпретатор читает std::cin)
+ * Если поток не отдаёт уже буферизованные данные, читается по одной строке,
+ * поэтому интерактивный ввод не ждёт заполнения буфера
+ */
+class StreamInputSource : public BufferedInputSource {
+public:
+    explicit StreamInputSource(std::istream& stream, std::size_t capacity = DEFAULT_CAPACITY);
+
+protected:
+    std::size_t read(char* data, std::size_t capacity) override;
+
+private:
+    std::istream& stream;
+};
+
+/**
+ * Ввод, поступающий частями через push() (в том числе из другого потока)
+ * Когда данные кончились, а ввод не закрыт, read() вызывает функцию ожидания и
+ * проверяет снова: функция может приостановить сопрограмму выполняющейся программы
+ * до появления ввода. Число в конце порции без разделителя ждёт следующей порции.
+ */
+class PushInputSource : public BufferedInputSource {
+public:
+    using Wait = std::function<void()>;
+
+    explicit PushInputSource(Wait wait, std::size_t capacity = DEFAULT_CAPACITY);
+
+    // Добавляет данные в конец ввода
+    void push(const std::string& text);
+
+    // Закрывает ввод: после оставшихся данных read/readln получат конец ввода
+    void close();
+
+    // Есть непрочитанные данные или ввод закрыт, то есть read() не будет ждать
+    bool ready() const;
+
+protected:
+    std::size_t read(char* data, std::size_t capacity) override;
+
+private:
+    Wait wait;
+    mutable std::mutex mutex;
+    std::string pending;    // Поступившие и ещё не переданные в буфер данные
+    bool closed = false;
+};
+
+/**
+ * Ввод из файлового дескриптора (без владения дескриптором)
+ * @throws runtime_error при ошибке чтения
+ */
+class FdInputSource : public BufferedInputSource {
+public:
+    explicit FdInputSource(int fd, std::size_t capacity = DEFAULT_CAPACITY);
+
+protected:
+    std::size_t read(char* data, std::size_t capacity) override;
+
+private:
+    int fd;
+};
+
+/**
+ * Ввод из файла, отображённого в память
+ * @throws runtime_error, если файл не удалось открыть или отобразить
+ */
+class MappedFileInputSource : public BufferedInputSource {
+public:
+    explicit MappedFileInputSource(const std::string& path);
+    ~MappedFileInputSource() override;
+
+private:
+    void* mapping;        // Отображение (HANDLE в Windows)
+    const char* data;
+    std::size_t size;
+};
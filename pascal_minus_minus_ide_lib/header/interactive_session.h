@@ -0,0 +1,92 @@
+#pragma once
+
+/**
+ * @file interactive_session.h
+ * @brief Интерактивное выполнение программы без блокировки потока на вводе
+ *
+ * Программа выполняется в сопрограмме. Если read/readln нечего читать, программа
+ * приостанавливается: вывод к этому моменту уже сброшен в приёмник. Управление
+ * возвращается вызывающему, а выполнение продолжается, когда ввод передан через
+ * provideInput(). Так один поток обслуживает сколько угодно интерактивных
+ * программ. Сессию продолжают из того же потока, в котором она начата.
+ */
+
+#include "coroutine.h"
+#include "error_reporter.h"
+#include "input_source.h"
+#include "interpreter.h"
+#include "output_sink.h"
+#include <cstddef>
+#include <memory>
+#include <sstream>
+#include <string>
+
+enum class SessionStatus {
+    Ready,          // Создана, start() ещё не вызван
+    NeedsInput,     // Приостановлена в read/readln до поступления ввода
+    Finished
+};
+
+class InteractiveSession {
+public:
+    /**
+     * Разбирает программу; выполнение начинается в start()
+     * @param source Текст программы
+     * @param output Приёмник вывода (по умолчанию - в памяти, см. takeOutput())
+     * @param stackSize Размер стека сопрограммы
+     * @throws runtime_error при ошибках разбора
+     */
+    explicit InteractiveSession(const std::string& source, shared_ptr<IOutputSink> output = nullptr,
+        std::size_t stackSize = Coroutine::DEFAULT_STACK_SIZE);
+
+    /**
+     * Выполняет программу до первого ожидания ввода или до завершения
+     * @throws logic_error, если сессия уже начата
+     */
+    SessionStatus start();
+
+    /**
+     * Добавляет ввод и, если программа его ждала, продолжает выполнение
+     * до следующего ожидания или до завершения
+     */
+    SessionStatus provideInput(const std::string& text);
+
+    /**
+     * Закрывает ввод: ожидающий read/readln получит конец ввода
+     */
+    SessionStatus closeInput();
+
+    SessionStatus getStatus() const { return status; }
+
+    // Программа завершилась без исключений и зарегистрированных ошибок
+    bool succeeded() const { return success; }
+
+    // Текст исключения, прервавшего выполнение
+    const std::string& getError() const { return error; }
+
+    // Сообщения об ошибках и предупреждениях
+    std::string getDiagnostics() const { return diagnostics.str(); }
+
+    /**
+     * Забирает вывод, накопленный с прошлого вызова
+     * Пусто, если в конструктор передан собственный приёмник
+     */
+    std::string takeOutput();
+
+    // Интерпретатор сессии: переменные доступны и во время ожидания ввода
+    Interpreter& getInterpreter() { return *interpreter; }
+
+private:
+    std::ostringstream diagnostics;
+    shared_ptr<ErrorReporter> reporter;
+    shared_ptr<MemoryOutputSink> memoryOutput;  // Приёмник по умолчанию
+    shared_ptr<PushInputSource> input;
+    shared_ptr<ASTNode> program;
+    std::unique_ptr<Interpreter> interpreter;
+    std::unique_ptr<Coroutine> coroutine;
+    SessionStatus status = SessionStatus::Ready;
+    bool success = false;
+    std::string error;
+
+    SessionStatus resume();
+};
@@ -9,6 +9,7 @@
  * что обеспечивает модульность и возможность замены конкретных реализаций.
  */
 
+#include <cstddef>
 #include <string>
 #include <memory>
 #include <vector>
@@ -40,6 +41,42 @@ public:
     virtual void reportError(const std::string& message, int line = -1, int column = -1) = 0;
     virtual void reportWarning(const std::string& message, int line = -1, int column = -1) = 0;
     virtual bool hasErrors() const = 0;
+    // Конец этапа: вывести накопленные сообщения
+    virtual void flush() {}
+};
+
+/**
+ * Интерфейс приёмника вывода программы (write/writeln)
+ * Реализации сами решают, когда передавать накопленные данные дальше;
+ * flush() обязан передать всё, что было записано до него
+ */
+class IOutputSink {
+public:
+    virtual ~IOutputSink() = default;
+    virtual void write(const char* data, std::size_t size) = 0;
+    virtual void endLine() { write("\n", 1); }
+    virtual void flush() = 0;
+};
+
+/**
+ * Интерфейс источника ввода программы (read/readln)
+ * Чтение пропускает пробельные символы; при неудаче значение не изменяется,
+ * а некорректная лексема остаётся во вводе
+ */
+class IInputSource {
+public:
+    virtual ~IInputSource() = default;
+    virtual bool readInt(int& value) = 0;
+    virtual bool readReal(double& value) = 0;
+    virtual bool readWord(std::string& word) = 0;
+    virtual void skipLine() = 0;
+
+    /**
+     * Связывает ввод с приёмником вывода (как std::cin.tie): перед ожиданием новых
+     * данных приёмник сбрасывается, и пользователь видит вывод, предшествующий запросу
+     * @param sink Приёмник (не владеет им) или nullptr - снять связь
+     */
+    virtual void tie(IOutputSink*) {}
 };
 
 /**
@@ -1,43 +1,51 @@
 #pragma once
 
+#include "allocation_profiler.h"
 #include "ast.h"
+#include "cancellation.h"
 #include "interfaces.h"
 #include "error_reporter.h"
 #include "postfix.h"  // Включаем полное определение PostfixCalculator
+#include "output_sink.h"
+#include "input_source.h"
+#include "value.h"
+#include "logger.h"
+#include "memory_account.h"
+#include "metrics.h"
+#include "node_profiler.h"
+#include "sampling_profiler.h"
+#include "trace_recorder.h"
+#include "scoped_symbol_table.h"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <functional>
 #include <map>
 #include <vector>
 #include <string>
 #include <memory>
 
-enum class ValueType { Integer, Real, Boolean, String };
-
 /**
- * Универсальная структура для хранения значений разных типов в Pascal--
- * Поддерживает четыре основных типа данных: Integer, Real, Boolean и String
- * и предоставляет методы для преобразования между ними
+ * Метрики выполнения, регистрируемые в реестре (см. metrics.h)
+ * Один набор разделяют все интерпретаторы, пишущие в реестр, в том числе из разных потоков
  */
-struct Value {
-    ValueType type;        // Тип значения (Integer, Real, Boolean, String)
-    int intValue;          // Целочисленное значение (для типа Integer)
-    double realValue;      // Вещественное значение (для типа Real)
-    bool boolValue;        // Логическое значение (для типа Boolean)
-    string stringValue;    // Строковое значение (для типа String)
-    
-    /**
-     * Методы для безопасного преобразования между типами
-     * Генерируют исключения при невозможности преобразования
-     */
-    int toInt() const;      // Преобразование к целому числу
-    double toReal() const;  // Преобразование к вещественному числу
-    bool toBool() const;    // Преобразование к логическому значению
-    string toString() const; // Преобразование к строке
-    
-    // Конструкторы для различных типов данных
-    Value();                  // Конструктор по умолчанию (создает нулевое значение)
-    explicit Value(int v);    // Создание из целого числа
-    explicit Value(double v); // Создание из вещественного числа
-    explicit Value(bool v);   // Создание из логического значения
-    explicit Value(const string& v); // Создание из строки
+struct InterpreterMetrics {
+    static constexpr std::size_t OPERATOR_COUNT = static_cast<std::size_t>(OperatorType::Not) + 1;
+    static constexpr std::size_t TYPE_COUNT = static_cast<std::size_t>(ValueType::String) + 1;
+
+    explicit InterpreterMetrics(MetricsRegistry& registry);
+
+    MetricsRegistry::Counter programs;          // Вызовы run()
+    MetricsRegistry::Counter expressions;       // Вычисленные выражения
+    MetricsRegistry::Counter variableReads;     // Чтения переменных в выражениях
+    MetricsRegistry::Counter variableWrites;    // Присваивания, шаги for, read/readln
+    MetricsRegistry::Counter bytesWritten;      // Байт выведено write/writeln
+    MetricsRegistry::Counter valuesRead;        // Значений прочитано read/readln
+    MetricsRegistry::Counter warnings;          // Предупреждения интерпретатора
+    std::array<MetricsRegistry::Counter, OPERATOR_COUNT> operators;  // По OperatorType
+    // Неявные преобразования при присваивании: [из типа][в тип]
+    std::array<std::array<MetricsRegistry::Counter, TYPE_COUNT>, TYPE_COUNT> conversions;
+    MetricsRegistry::Histogram loopIterations;  // Итераций на выполнение цикла for/while
 };
 
 /**
@@ -49,16 +57,25 @@ struct Value {
 class Interpreter : public IInterpreter {
 public:
     /**
-     * Конструктор по умолчанию
-     * Создает интерпретатор без обработчика ошибок
+     * Конструктор по умолчанию для консольного запуска
+     * Создает интерпретатор без обработчика ошибок, читающий std::cin и пишущий
+     * в буферизованный std::cout; журнал не ведётся
      */
     Interpreter();
     
     /**
      * Конструктор с обработчиком ошибок
+     * Стандартные потоки процесса не используются, пока их не передали явно
      * @param errorReporter Обработчик ошибок для вывода сообщений об ошибках и предупреждениях
+     * @param outputSink Приёмник вывода write/writeln (по умолчанию - MemoryOutputSink)
+     * @param inputSource Источник ввода read/readln (по умолчанию - пустой MemoryInputSource)
+     * @param logger Журнал (не владеет им; по умолчанию журнал не ведётся)
      */
-    explicit Interpreter(shared_ptr<IErrorReporter> errorReporter);
+    explicit Interpreter(shared_ptr<IErrorReporter> errorReporter, shared_ptr<IOutputSink> outputSink = nullptr,
+        shared_ptr<IInputSource> inputSource = nullptr, Logger* logger = nullptr);
+
+    // Снимает связь источника ввода с приёмником вывода
+    ~Interpreter() override;
     
     /**
      * Реализация методов интерфейса IInterpreter
@@ -103,6 +120,124 @@ public:
      */
     void clearSymbols() override;
     
+    /**
+     * Задаёт таблицу имён запуска - ту же, которой лексер нумеровал дерево
+     * Номера имён узлов тогда используются без перевода; все переменные удаляются
+     * @param names Таблица имён лексера этой программы
+     */
+    void setNames(shared_ptr<NameTable> names);
+
+    /**
+     * Таблица имён, которой нумеруются переменные (передаётся лексеру следующей программы)
+     */
+    const shared_ptr<NameTable>& getNames() const { return symbols.getNames(); }
+
+    /**
+     * Заменяет приёмник вывода write/writeln
+     * Накопленный в прежнем приёмнике вывод сбрасывается
+     * @param outputSink Новый приёмник (nullptr - MemoryOutputSink)
+     */
+    void setOutputSink(shared_ptr<IOutputSink> outputSink);
+
+    /**
+     * Возвращает текущий приёмник вывода
+     */
+    const shared_ptr<IOutputSink>& getOutputSink() const { return output; }
+
+    /**
+     * Заменяет источник ввода read/readln
+     * Источник связывается с приёмником вывода (IInputSource::tie): вывод сбрасывается
+     * перед ожиданием ввода
+     * @param inputSource Новый источник (nullptr - пустой MemoryInputSource)
+     */
+    void setInputSource(shared_ptr<IInputSource> inputSource);
+
+    /**
+     * Возвращает текущий источник ввода
+     */
+    const shared_ptr<IInputSource>& getInputSource() const { return input; }
+
+    /**
+     * Заменяет журнал отладочных сообщений интерпретатора (по умолчанию журнал не ведётся)
+     * Интерпретаторам, работающим в параллельных потоках, следует передавать собственные
+     * экземпляры, чтобы не делить блокировку общего журнала (Logger::getInstance())
+     * @param logger Журнал (не владеет им) или nullptr - не вести журнал
+     */
+    void setLogger(Logger* logger);
+
+    Logger* getLogger() const { return logger; }
+
+    /**
+     * Задаёт точку кооперативного переключения: hook вызывается через каждые
+     * interval обратных переходов циклов for и while (например, Coroutine::yield)
+     * @param hook Функция переключения (пустая - отключить)
+     * @param interval Число обратных переходов между вызовами (0 считается за 1)
+     */
+    void setYieldHook(std::function<void()> hook, std::size_t interval);
+
+    /**
+     * Задаёт признак внешней отмены выполнения (см. cancellation.h)
+     * @param token Признак (nullptr - без отмены)
+     */
+    void setCancellationToken(shared_ptr<const CancellationToken> token);
+
+    /**
+     * Задаёт срок, после которого run() прерывает выполнение (см. cancellation.h)
+     * @param deadline Срок (time_point::max() - без срока)
+     */
+    void setDeadline(std::chrono::steady_clock::time_point deadline);
+
+    /**
+     * Задаёт лимит памяти программы (см. memory_account.h); при превышении run()
+     * сообщает об ошибке и прерывает выполнение с ExecutionInterrupted
+     * @param bytes Лимит в байтах (0 - без лимита)
+     */
+    void setMemoryLimit(std::size_t bytes) { memory.setLimit(bytes); }
+
+    /**
+     * Учёт памяти: текущее значение и пик последнего run() (доступны и после выполнения)
+     */
+    const MemoryAccount& getMemoryAccount() const { return memory; }
+
+    /**
+     * Задаёт арену для временных значений вычисления выражений (см. run_arena.h)
+     * Арена должна пережить интерпретатор
+     * @param arena Арена или nullptr - общая куча
+     */
+    void setArena(RunArena* arena) { postfixCalculator->setArena(arena); }
+
+    /**
+     * Включает профилирование по узлам AST (см. node_profiler.h)
+     * Статистика копится между запусками одного дерева; перед другим деревом - NodeProfiler::reset()
+     * @param target Профилировщик (не владеет им) или nullptr - выключить
+     */
+    void setProfiler(NodeProfiler* target) { profiler = target; }
+
+    /**
+     * Выполняемый сейчас узел, для выборочного профилирования (см. sampling_profiler.h)
+     */
+    const ExecutionPosition& getPosition() const { return position; }
+
+    /**
+     * Включает запись временной шкалы: выполнение, операторы главного блока и циклы
+     * с числом итераций (см. trace_recorder.h)
+     * @param target Трасса (не владеет ею) или nullptr - выключить
+     */
+    void setTracer(TraceRecorder* target) { tracer = target; }
+
+    /**
+     * Включает учёт выделений памяти по выполненным операторам (см. allocation_profiler.h)
+     * Фаза и структуры данных учитываются и без этого, пока профилировщик запущен
+     * @param target Профилировщик (не владеет им) или nullptr - выключить
+     */
+    void setAllocationProfiler(AllocationProfiler* target) { allocationProfiler = target; }
+
+    /**
+     * Включает счётчики выполнения (см. InterpreterMetrics)
+     * @param target Метрики (не владеет ими) или nullptr - выключить
+     */
+    void setMetrics(const InterpreterMetrics* target);
+
     /**
      * Возвращает имя компонента
      * @return Строка "Interpreter"
@@ -136,10 +271,10 @@ public:
     ValueType getValueType(const string& name) const;
 
     /**
-     * Возвращает ссылку на таблицу символов (все переменные)
-     * @return Константная ссылка на карту символов
+     * Возвращает снимок таблицы символов (все видимые переменные)
+     * @return Константная ссылка на карту символов (действительна до следующего вызова)
      */
-    const map<string, Value>& getAllSymbols() const { return symbols; }
+    const map<string, Value>& getAllSymbols() const override;
     
     /**
      * Методы для репортинга ошибок и предупреждений
@@ -162,11 +297,61 @@ public:
     void reportWarning(const string& message, int line = 0, int column = 0) const;
 
 private:
-    map<string, Value> symbols;
+    ScopedSymbolTable symbols;                // Переменные и константы с областями видимости
+    mutable map<string, Value> symbolsSnapshot; // Снимок для getAllSymbols
     shared_ptr<IErrorReporter> errorReporter;
     unique_ptr<PostfixCalculator> postfixCalculator;
+    VariableLookup variableLookup;            // Поиск переменных для калькулятора
+    shared_ptr<IOutputSink> output;           // Приёмник вывода write/writeln
+    shared_ptr<IInputSource> input;           // Источник ввода read/readln
+    Logger* logger;                           // Журнал (nullptr - отключён)
+    std::function<void()> yieldHook;          // Кооперативное переключение (пусто - отключено)
+    std::size_t yieldInterval = 1;
+    std::size_t backEdgesToYield = 1;         // Обратных переходов до следующего вызова yieldHook
+
+    shared_ptr<const CancellationToken> cancellation;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    bool interruptible = false;               // Задан признак отмены или срок
+    unsigned checksToClock = 1;               // Проверок до следующего чтения часов
+
+    // Обратный переход цикла: точка кооперативного переключения и проверки прерывания
+    void onBackEdge() {
+        checkInterrupt();
+        if (yieldHook && --backEdgesToYield == 0) {
+            backEdgesToYield = yieldInterval;
+            yieldHook();
+        }
+    }
+
+    void checkInterrupt() {
+        if (interruptible)
+            pollInterrupt();
+    }
+
+    // Выбрасывает внутренний сигнал прерывания, если выполнение отменено или срок истёк
+    void pollInterrupt();
+
+    // Сообщает о прерывании, сбрасывает вывод и выбрасывает ExecutionInterrupted
+    [[noreturn]] void interrupt(InterruptReason reason);
+
+    NodeProfiler* profiler = nullptr;         // Профилирование по узлам (nullptr - выключено)
+    ExecutionPosition position{ nullptr };    // Публикуется для SamplingProfiler
+    TraceRecorder* tracer = nullptr;          // Временная шкала (nullptr - выключена)
+    const ASTNode* tracedBlock = nullptr;     // Главный блок: его операторы - отрезки трассы
+    const InterpreterMetrics* metrics = nullptr; // Счётчики выполнения (nullptr - выключены)
+    AllocationProfiler* allocationProfiler = nullptr; // Выделения по операторам (nullptr - выключено)
+    MemoryAccount memory;                     // Память программы
+    std::size_t symbolBytes = 0;              // Списано за привязки таблицы символов
+
+    // Объявление и присваивание со списанием памяти строк и привязок
+    Value* declareSymbol(NameId name, Value value);
+    void storeValue(Value& target, Value value);
+
+    // Приводит списание за привязки к текущему размеру таблицы символов
+    void accountSymbols();
     
     // Методы выполнения операторов
+    void executeStatement(const std::shared_ptr<ASTNode>& node);
     void executeAssignment(const std::shared_ptr<ASTNode>& node);
     void executeIf(const std::shared_ptr<ASTNode>& node);
     void executeWhile(const std::shared_ptr<ASTNode>& node);
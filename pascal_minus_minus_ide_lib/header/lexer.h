@@ -9,6 +9,7 @@
 #include <memory>
 #include "interfaces.h"
 #include "error_reporter.h"
+#include "name_table.h"
 
 using namespace std;
 
@@ -48,6 +49,7 @@ using PascalToken::TokenType;
 struct Token {
     TokenType type;   // Тип токена (ключевое слово, оператор, идентификатор и т.д.)
     string value;     // Значение токена (текст)
+    NameId name;      // Номер имени в таблице лексера (только для идентификаторов, иначе NO_NAME)
     int line;         // Номер строки в исходном коде
     int column;       // Позиция (столбец) в строке
 
@@ -63,6 +65,7 @@ private:
     int line;                     // Текущая строка
     int column;                   // Текущий столбец
     std::shared_ptr<IErrorReporter> errorReporter; // Обработчик ошибок
+    std::shared_ptr<NameTable> names; // Таблица имён запуска, выдающая номера токенов
 
     // Вспомогательные методы для анализа текста
     char current() const;
@@ -79,12 +82,14 @@ private:
 
 public:
     explicit Lexer(const string& source); // Конструктор принимает исходный текст
-    Lexer(const string& source, std::shared_ptr<IErrorReporter> reporter); // Конструктор с обработчиком ошибок
+    // Конструктор с обработчиком ошибок; names - таблица имён запуска, общая с интерпретатором (nullptr - своя)
+    Lexer(const string& source, std::shared_ptr<IErrorReporter> reporter, std::shared_ptr<NameTable> names = nullptr);
     vector<Token> tokenize() override;    // Основной метод: разбить текст на токены
     
     // Дополнительные методы
     int getLine() const { return line; }
     int getColumn() const { return column; }
+    const std::shared_ptr<NameTable>& getNames() const { return names; } // Таблица имён, выдавшая номера токенов
     std::string getSourceFragment(int line, int column, int length = 10) const; // Получить фрагмент исходного кода
 };
 
@@ -7,14 +7,16 @@
  * 
  * Обеспечивает запись сообщений о работе компилятора в консоль и файл
  * с различными уровнями важности и форматированием.
+ *
+ * Макросы LOG_* не вычисляют аргумент, если уровень отключён: уровни ниже
+ * LOG_MIN_LEVEL удаляются при компиляции, остальные проверяются до форматирования.
  */
 
+#include <atomic>
+#include <cstddef>
 #include <string>
 #include <fstream>
-#include <iostream>
-#include <chrono>
-#include <iomanip>
-#include <memory>
+#include <mutex>
 
 /**
  * Уровни важности сообщений в системе логирования
@@ -28,9 +30,51 @@ enum class LogLevel {
     Fatal     // Критические ошибки
 };
 
+/**
+ * Минимальный уровень, вызовы ниже которого не попадают в код
+ * (0 - Debug, 1 - Info, 2 - Warning, 3 - Error, 4 - Fatal).
+ * По умолчанию в сборке с NDEBUG отладочные сообщения удаляются
+ */
+#ifndef LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define LOG_MIN_LEVEL 1
+#else
+#define LOG_MIN_LEVEL 0
+#endif
+#endif
+
+// Размер текста одной записи асинхронного логгера
+constexpr std::size_t LOG_RECORD_TEXT = 240;
+
+/**
+ * Поведение асинхронного логгера при заполненном кольцевом буфере
+ */
+enum class LogOverflow {
+    Drop,   // Сообщение отбрасывается, писатель позже сообщит число пропущенных
+    Block   // Поток ждёт, пока писатель освободит место
+};
+
+/**
+ * Параметры асинхронного режима логгера
+ */
+struct AsyncLogOptions {
+    size_t capacity = 8192;                   // Число записей в буфере (округляется до степени двойки)
+    LogOverflow overflow = LogOverflow::Drop; // Поведение при переполнении
+};
+
+class AsyncLogBackend;
+
 /**
  * Класс для ведения логов компилятора
- * Реализован как синглтон (Singleton) для удобства использования в разных частях программы
+ * Реализован как синглтон (Singleton) для удобства использования в разных частях программы.
+ * Компоненты, которым не нужен общий журнал (например, интерпретаторы в параллельных
+ * потоках), могут писать в собственный экземпляр или не вести журнал вовсе (LOG_TO).
+ * Минимальный уровень общий для всех экземпляров.
+ *
+ * По умолчанию сообщения пишутся синхронно в вызывающем потоке. В асинхронном
+ * режиме (startAsync) поток только копирует сообщение в запись кольцевого буфера,
+ * а форматирование и пакетную запись в консоль и файл выполняет фоновый поток.
+ * Сообщения длиннее LOG_RECORD_TEXT байт в асинхронном режиме обрезаются.
  */
 class Logger {
 public:
@@ -43,23 +87,35 @@ public:
         return instance;
     }
 
+    Logger() = default;
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
     /**
      * Устанавливает файл для записи логов
-     * @param path Путь к файлу логов
+     * @param path Путь к файлу логов (пустая строка - закрыть файл)
      */
-    void setLogFile(const std::string& path) {
-        if (logFile.is_open()) {
-            logFile.close();
-        }
-        logFile.open(path, std::ios::app);
-    }
+    void setLogFile(const std::string& path);
+
+    /**
+     * Включает или отключает вывод логов в консоль (std::cout)
+     */
+    void setConsoleOutput(bool enabled);
 
     /**
      * Устанавливает минимальный уровень важности сообщений для логирования
      * @param level Минимальный уровень важности для записи в лог
      */
     void setLogLevel(LogLevel level) {
-        currentLevel = level;
+        currentLevel.store(level, std::memory_order_relaxed);
+    }
+
+    /**
+     * Проверяет, будет ли записано сообщение указанного уровня
+     * Дешёвая проверка перед построением текста сообщения
+     */
+    static bool isEnabled(LogLevel level) {
+        return level >= currentLevel.load(std::memory_order_relaxed);
     }
 
     /**
@@ -67,37 +123,7 @@ public:
      * @param level Уровень важности сообщения
      * @param message Текст сообщения для записи в лог
      */
-    void log(LogLevel level, const std::string& message) {
-        if (level < currentLevel) return;
-
-        // Получаем текущее время
-        auto now = std::chrono::system_clock::now();
-        auto time = std::chrono::system_clock::to_time_t(now);
-        std::tm tm_buf;
-        localtime_s(&tm_buf, &time);
-
-        // Строка для уровня лога
-        std::string levelStr;
-        switch (level) {
-        case LogLevel::Debug: levelStr = "DEBUG"; break;
-        case LogLevel::Info: levelStr = "INFO"; break;
-        case LogLevel::Warning: levelStr = "WARNING"; break;
-        case LogLevel::Error: levelStr = "ERROR"; break;
-        case LogLevel::Fatal: levelStr = "FATAL"; break;
-        }
-
-        // Форматируем вывод
-        std::stringstream logMessage;
-        logMessage << std::put_time(&tm_buf, "%Y-%m-%d %H:%M:%S") << " [" 
-                  << std::setw(7) << std::left << levelStr << "] " 
-                  << message;
-
-        // Вывод в консоль и файл
-        std::cout << logMessage.str() << std::endl;
-        if (logFile.is_open()) {
-            logFile << logMessage.str() << std::endl;
-        }
-    }
+    void log(LogLevel level, const std::string& message);
 
     void debug(const std::string& message) { log(LogLevel::Debug, message); }
     void info(const std::string& message) { log(LogLevel::Info, message); }
@@ -105,29 +131,71 @@ public:
     void error(const std::string& message) { log(LogLevel::Error, message); }
     void fatal(const std::string& message) { log(LogLevel::Fatal, message); }
 
-    ~Logger() {
-        if (logFile.is_open()) {
-            logFile.close();
-        }
-    }
+    /**
+     * Переключает логгер в асинхронный режим с фоновым потоком записи
+     * Повторный вызов перезапускает асинхронный режим с новыми параметрами
+     */
+    void startAsync(const AsyncLogOptions& options = AsyncLogOptions());
+
+    /**
+     * Дописывает все поставленные в очередь сообщения и возвращает синхронный режим
+     */
+    void stopAsync();
+
+    /**
+     * Ждёт, пока все сообщения, записанные до вызова, попадут в консоль и файл
+     */
+    void flush();
+
+    bool isAsync() const { return backend.load(std::memory_order_acquire) != nullptr; }
+
+    /**
+     * Число сообщений, отброшенных из-за переполнения буфера с начала работы
+     */
+    unsigned long long droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+    ~Logger();
 
 private:
-    Logger() : currentLevel(LogLevel::Info) {}
-    Logger(const Logger&) = delete;
-    Logger& operator=(const Logger&) = delete;
+    friend class AsyncLogBackend;
+
+    // Записывает пакет отформатированных строк в консоль и файл
+    void writeLines(const std::string& lines);
+
+    // Статический, чтобы проверка уровня не требовала обращения к экземпляру
+    static inline std::atomic<LogLevel> currentLevel{ LogLevel::Info };
 
-    LogLevel currentLevel;
+    std::mutex outputMutex;                         // Защищает вывод и файл
     std::ofstream logFile;
+    bool consoleOutput = true;
+    std::atomic<AsyncLogBackend*> backend{ nullptr }; // Асинхронный режим (nullptr - синхронный)
+    std::atomic<int> activeProducers{ 0 };          // Потоки, работающие с backend прямо сейчас
+    std::atomic<unsigned long long> dropped{ 0 };
+    std::mutex asyncMutex;                          // Сериализует startAsync/stopAsync
 };
 
 /**
  * Макросы для удобства использования логгера в коде
- * Позволяют использовать краткие и понятные вызовы для разных уровней логирования
+ * Позволяют использовать краткие и понятные вызовы для разных уровней логирования.
+ * Выражение msg вычисляется только для включённого уровня.
+ * LOG_TO пишет в указанный экземпляр; при logger == nullptr сообщение отбрасывается
  */
-#define LOG_DEBUG(msg) Logger::getInstance().debug(msg)
-#define LOG_INFO(msg) Logger::getInstance().info(msg)
-#define LOG_WARNING(msg) Logger::getInstance().warning(msg)
-#define LOG_ERROR(msg) Logger::getInstance().error(msg)
-#define LOG_FATAL(msg) Logger::getInstance().fatal(msg)
+#define LOG_TO(logger, level, msg)                                                 \
+    do {                                                                           \
+        if (static_cast<int>(level) >= LOG_MIN_LEVEL &&                            \
+            Logger::isEnabled(level)) {                                            \
+            if (Logger* logTarget_ = (logger))                                     \
+                logTarget_->log(level, msg);                                       \
+        }                                                                          \
+    } while (0)
+
+// Запись в общий журнал
+#define LOG_AT(level, msg) LOG_TO(&Logger::getInstance(), level, msg)
+
+#define LOG_DEBUG(msg) LOG_AT(LogLevel::Debug, msg)
+#define LOG_INFO(msg) LOG_AT(LogLevel::Info, msg)
+#define LOG_WARNING(msg) LOG_AT(LogLevel::Warning, msg)
+#define LOG_ERROR(msg) LOG_AT(LogLevel::Error, msg)
+#define LOG_FATAL(msg) LOG_AT(LogLevel::Fatal, msg)
 
 #endif // LOGGER_H
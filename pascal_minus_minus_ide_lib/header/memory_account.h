@@ -0,0 +1,113 @@
+#pragma once
+
+/**
+ * @file memory_account.h
+ * @brief Учёт памяти одного интерпретатора и жёсткий лимит
+ *
+ * Интерпретатор списывает со счёта память, которой владеет выполняемая программа:
+ * дерево AST на время run(), привязки таблицы символов, содержимое строк и стек
+ * вычисления выражений. Размеры оцениваются по структурам данных (capacity строк
+ * и векторов, размеры узлов), а не перехватом распределителя, поэтому учёт
+ * не зависит от общей кучи процесса и от других интерпретаторов в том же процессе.
+ */
+
+#include "ast.h"
+#include "value.h"
+#include <array>
+#include <cstddef>
+#include <string>
+
+enum class MemoryCategory {
+    Ast,            // Дерево программы
+    Symbols,        // Привязки таблицы символов
+    Strings,        // Содержимое строковых значений переменных
+    Evaluation,     // Постфиксная форма и стек значений при вычислении выражения
+    Count
+};
+
+/**
+ * Исключение при превышении лимита
+ * Не наследует std::exception, чтобы обработчики ошибок в операторах (например,
+ * в while) его не перехватывали: Interpreter::run превращает его в ExecutionInterrupted
+ */
+struct MemoryLimitExceeded {
+    MemoryCategory category;    // На что запрашивалась память
+    std::size_t requested;      // Сколько байт запрошено
+};
+
+/**
+ * Счёт памяти с текущим и пиковым значением; не потокобезопасен
+ */
+class MemoryAccount {
+public:
+    /**
+     * RAII-списание: память списывается в конструкторе и возвращается в деструкторе
+     */
+    class ScopedCharge {
+    public:
+        ScopedCharge(MemoryAccount& account, MemoryCategory category, std::size_t bytes)
+            : account(account), category(category), bytes(bytes) { account.charge(category, bytes); }
+        ~ScopedCharge() { account.release(category, bytes); }
+        ScopedCharge(const ScopedCharge&) = delete;
+        ScopedCharge& operator=(const ScopedCharge&) = delete;
+    private:
+        MemoryAccount& account;
+        MemoryCategory category;
+        std::size_t bytes;
+    };
+
+    /**
+     * @param limit Лимит в байтах (0 - без лимита)
+     */
+    explicit MemoryAccount(std::size_t limit = 0) : limit(limit) {}
+
+    void setLimit(std::size_t bytes) { limit = bytes; }
+    std::size_t getLimit() const { return limit; }
+
+    /**
+     * Списывает память
+     * @throws MemoryLimitExceeded, если с учётом списания будет превышен лимит (ничего не списывается)
+     */
+    void charge(MemoryCategory category, std::size_t bytes);
+
+    /**
+     * Возвращает ранее списанную память
+     */
+    void release(MemoryCategory category, std::size_t bytes);
+
+    /**
+     * Списывает или возвращает разницу, когда объект меняет размер с before на after
+     * @throws MemoryLimitExceeded при превышении лимита (ничего не списывается)
+     */
+    void resize(MemoryCategory category, std::size_t before, std::size_t after) {
+        if (after > before)
+            charge(category, after - before);
+        else
+            release(category, before - after);
+    }
+
+    std::size_t current() const { return total; }
+    std::size_t current(MemoryCategory category) const { return byCategory[static_cast<std::size_t>(category)]; }
+    std::size_t peak() const { return peakBytes; }
+
+    // Начинает отсчёт пика с текущего значения
+    void resetPeak() { peakBytes = total; }
+
+    /**
+     * Память строки вне самого объекта std::string (0 для коротких строк,
+     * хранящихся внутри объекта)
+     */
+    static std::size_t heapBytes(const std::string& text);
+    static std::size_t heapBytes(const Value& value) { return heapBytes(value.stringValue); }
+
+    /**
+     * Оценка памяти дерева: узлы, их строки и массивы дочерних указателей
+     */
+    static std::size_t astBytes(const ASTNode& root);
+
+private:
+    std::size_t limit;
+    std::size_t total = 0;
+    std::size_t peakBytes = 0;
+    std::array<std::size_t, static_cast<std::size_t>(MemoryCategory::Count)> byCategory{};
+};
@@ -0,0 +1,129 @@
+#pragma once
+
+/**
+ * @file metrics.h
+ * @brief Реестр счётчиков и гистограмм времени выполнения
+ *
+ * Метрика регистрируется один раз и дальше изменяется через лёгкий описатель
+ * (Counter, Histogram). Каждый поток пишет в собственный сегмент реестра без
+ * блокировок и атомарных read-modify-write; значения складываются по сегментам
+ * только при чтении. Реестр выводится в JSON или в текстовом формате
+ * Prometheus (writeFile выбирает формат по расширению).
+ */
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Метки метрики: пары имя - значение
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+class MetricsRegistry {
+public:
+    static constexpr std::size_t MAX_SLOTS = 1024;  // Ячеек на сегмент потока
+
+    /**
+     * Описатель счётчика; по умолчанию не привязан и ничего не считает
+     */
+    class Counter {
+    public:
+        Counter() = default;
+        void add(std::uint64_t amount = 1) const {
+            if (registry)
+                registry->increment(slot, amount);
+        }
+    private:
+        friend class MetricsRegistry;
+        MetricsRegistry* registry = nullptr;
+        std::size_t slot = 0;
+    };
+
+    /**
+     * Описатель гистограммы: корзины с верхними границами bounds и корзина +Inf
+     */
+    class Histogram {
+    public:
+        Histogram() = default;
+        void observe(std::uint64_t value) const;
+    private:
+        friend class MetricsRegistry;
+        MetricsRegistry* registry = nullptr;
+        std::size_t slot = 0;                           // Корзины, затем сумма и число наблюдений
+        const std::vector<std::uint64_t>* bounds = nullptr;
+    };
+
+    MetricsRegistry();
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    /**
+     * Регистрирует счётчик или возвращает уже зарегистрированный с тем же именем и метками
+     * @throws length_error, если ячейки реестра кончились
+     */
+    Counter counter(const std::string& name, const std::string& help, const MetricLabels& labels = MetricLabels());
+
+    /**
+     * Регистрирует гистограмму (или возвращает существующую)
+     * @param bounds Возрастающие верхние границы корзин
+     * @throws length_error, если ячейки реестра кончились
+     */
+    Histogram histogram(const std::string& name, const std::string& help, const std::vector<std::uint64_t>& bounds,
+                        const MetricLabels& labels = MetricLabels());
+
+    /**
+     * Текущее значение счётчика (сумма по потокам) или число наблюдений гистограммы
+     * 0, если метрика не зарегистрирована
+     */
+    std::uint64_t value(const std::string& name, const MetricLabels& labels = MetricLabels()) const;
+
+    void writeJson(std::ostream& out) const;
+    void writePrometheus(std::ostream& out) const;
+
+    /**
+     * Записывает реестр в файл: JSON для расширения .json, иначе формат Prometheus
+     * @throws runtime_error, если файл не записан
+     */
+    void writeFile(const std::string& path) const;
+
+private:
+    enum class Kind { Counter, Histogram };
+
+    struct Metric {
+        std::string name;
+        std::string help;
+        MetricLabels labels;
+        Kind kind;
+        std::size_t slot;
+        std::vector<std::uint64_t> bounds;
+    };
+
+    // Ячейки одного потока: пишет только он, поэтому хватает load/store
+    struct Shard {
+        std::thread::id thread;
+        std::array<std::atomic<std::uint64_t>, MAX_SLOTS> slots;
+    };
+
+    const std::uint64_t id;                     // Отличает реестры в кэше потока
+    mutable std::mutex mutex;                   // Защищает метрики и список сегментов
+    std::deque<Metric> metrics;                 // deque: описатели ссылаются на bounds
+    std::size_t slotsUsed = 0;
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    void increment(std::size_t slot, std::uint64_t amount) {
+        std::atomic<std::uint64_t>& cell = shard().slots[slot];
+        cell.store(cell.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+    Shard& shard();
+    const Metric* find(const std::string& name, const MetricLabels& labels) const;
+    std::uint64_t total(std::size_t slot) const;
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+/**
+ * @file name_table.h
+ * @brief Таблица интернирования идентификаторов Pascal--
+ *
+ * Каждому различному идентификатору сопоставляется небольшое целое число (NameId).
+ * Одна таблица обслуживает один запуск: лексер нумерует ею идентификаторы
+ * программы, а таблица символов интерпретатора (или компилятор замыканий)
+ * получает ту же таблицу через std::shared_ptr и берёт номера из дерева как есть.
+ * Номера из разных таблиц несравнимы; общей таблицы процесса нет, поэтому память
+ * таблицы пропорциональна именам одного запуска.
+ */
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Номер интернированного имени
+using NameId = uint32_t;
+
+// Отсутствие имени (узлы и токены, не являющиеся идентификаторами)
+constexpr NameId NO_NAME = 0;
+
+/**
+ * Таблица интернирования имён одного владельца
+ *
+ * Не синхронизирована: заполняется одним потоком. Константные методы можно
+ * вызывать из нескольких потоков, пока таблица не меняется. Строки хранятся
+ * в deque и не перемещаются, поэтому ссылки, возвращённые text(), остаются
+ * действительными до уничтожения таблицы.
+ */
+class NameTable {
+public:
+    NameTable();
+
+    NameTable(const NameTable&) = delete;
+    NameTable& operator=(const NameTable&) = delete;
+    NameTable(NameTable&&) = default;
+    NameTable& operator=(NameTable&&) = default;
+
+    /**
+     * Возвращает номер имени, добавляя его в таблицу при первом обращении
+     * @param text Текст идентификатора
+     * @return Номер имени (никогда не NO_NAME)
+     * @throws runtime_error при переполнении таблицы
+     */
+    NameId intern(std::string_view text);
+
+    /**
+     * Ищет уже интернированное имя, не добавляя его
+     * @param text Текст идентификатора
+     * @return Номер имени или NO_NAME, если имя ещё не встречалось
+     */
+    NameId find(std::string_view text) const;
+
+    /**
+     * Номер имени узла дерева или токена, проверенный по этой таблице
+     * @param id Номер из дерева (NO_NAME - узел без номера, например построенный вручную)
+     * @param text Текст имени из того же узла
+     * @return id или, для NO_NAME, номер text (добавляется при первом обращении)
+     * @throws logic_error, если дерево пронумеровано другой таблицей
+     */
+    NameId resolve(NameId id, std::string_view text);
+
+    /**
+     * Текст имени по номеру (для NO_NAME - пустая строка)
+     * @throws out_of_range для номера, не выданного этой таблицей
+     */
+    const std::string& text(NameId id) const;
+
+    /**
+     * Число интернированных имён
+     */
+    size_t size() const { return texts.size() - 1; }
+
+private:
+    std::deque<std::string> texts;                     // Номер -> текст (texts[NO_NAME] - пустая строка)
+    std::unordered_map<std::string_view, NameId> ids;  // Текст -> номер (ключи ссылаются на строки в texts)
+};
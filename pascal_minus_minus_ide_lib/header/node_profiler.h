@@ -0,0 +1,109 @@
+#pragma once
+
+/**
+ * @file node_profiler.h
+ * @brief Профилировщик выполнения по узлам AST
+ *
+ * Включается Interpreter::setProfiler(). Для каждого выполненного оператора и
+ * каждого вычисленного выражения учитываются число выполнений, включающее время
+ * (с вложенными узлами) и собственное время (без них) с привязкой к строке и
+ * столбцу исходного текста. Выражение вычисляется калькулятором целиком, поэтому
+ * учитывается его корневой узел. В языке нет подпрограмм, и путь выполнения до
+ * узла совпадает с его путём в дереве: стек для flame graph - цепочка предков.
+ *
+ * Без профилировщика интерпретатор платит одной проверкой указателя на узел.
+ */
+
+#include "ast.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Статистика одного узла
+ */
+struct NodeProfile {
+    const ASTNode* node = nullptr;
+    std::string label;              // Вид узла, значение и позиция, например "While (5:3)"
+    int line = 0;
+    int column = 0;
+    std::uint64_t count = 0;        // Число выполнений
+    double inclusiveSeconds = 0;    // С вложенными узлами
+    double exclusiveSeconds = 0;    // Без вложенных узлов
+};
+
+class NodeProfiler {
+public:
+    /**
+     * RAII-замер узла; без профилировщика ничего не делает
+     */
+    class Scope {
+    public:
+        Scope(NodeProfiler* profiler, const ASTNode* node) : profiler(profiler) {
+            if (profiler)
+                profiler->enter(node);
+        }
+        ~Scope() {
+            if (profiler)
+                profiler->leave();
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        NodeProfiler* profiler;
+    };
+
+    void enter(const ASTNode* node);
+    void leave();
+
+    // Забывает собранную статистику (дерево прежних запусков может быть уже уничтожено)
+    void reset();
+
+    /**
+     * Статистика узлов по убыванию собственного времени
+     */
+    std::vector<NodeProfile> results() const;
+
+    /**
+     * Текстовый отчёт: таблица узлов по убыванию собственного времени
+     * @param top Число строк (0 - все)
+     */
+    void writeReport(std::ostream& out, std::size_t top = 0) const;
+
+    /**
+     * Свёрнутые стеки для flamegraph.pl и speedscope: строка "предок;...;узел N",
+     * где N - собственное время узла в микросекундах
+     */
+    void writeFoldedStacks(std::ostream& out) const;
+
+    /**
+     * Подпись узла: вид, значение и позиция (без ';', разделяющего кадры стека)
+     */
+    static std::string label(const ASTNode& node);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        const ASTNode* node;
+        std::size_t parent;         // Индекс родителя при первом выполнении или NO_PARENT
+        std::uint64_t count = 0;
+        Clock::duration inclusive{};
+        Clock::duration children{};
+    };
+    struct Frame {
+        std::size_t entry;
+        Clock::time_point start;
+    };
+    static constexpr std::size_t NO_PARENT = static_cast<std::size_t>(-1);
+
+    std::vector<Entry> entries;
+    std::unordered_map<const ASTNode*, std::size_t> index;  // Узел -> entries
+    std::vector<Frame> stack;
+
+    std::string stackOf(std::size_t entry) const;
+};
@@ -0,0 +1,118 @@
+#pragma once
+
+/**
+ * @file output_sink.h
+ * @brief Приёмники вывода программы Pascal--
+ *
+ * Вывод write/writeln накапливается в буфере и передаётся получателю крупными
+ * блоками, а не построчно: writeln не сбрасывает поток, если этого не требует
+ * политика сброса. Числа форматируются через std::to_chars, без локали iostream.
+ */
+
+#include "interfaces.h"
+#include "value.h"
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * Когда буферизованный приёмник передаёт данные получателю
+ * (помимо заполнения буфера и явного flush())
+ */
+enum class FlushPolicy {
+    WhenFull,   // Только при заполнении буфера и явном flush()
+    EachLine,   // После каждого writeln
+    EachWrite   // После каждой записи
+};
+
+/**
+ * Выводит значение в приёмник в формате write: целые и вещественные числа -
+ * через std::to_chars (вещественные как %g с 6 значащими цифрами, как у iostream)
+ * @return Число выведенных байт
+ */
+std::size_t writeValue(IOutputSink& sink, const Value& value);
+
+/**
+ * Базовый буферизованный приёмник
+ * Наследники реализуют drain() - передачу готового блока получателю
+ */
+class BufferedOutputSink : public IOutputSink {
+public:
+    static constexpr std::size_t DEFAULT_CAPACITY = 64 * 1024;
+
+    explicit BufferedOutputSink(std::size_t capacity = DEFAULT_CAPACITY, FlushPolicy policy = FlushPolicy::WhenFull);
+
+    void write(const char* data, std::size_t size) override;
+    void endLine() override;
+    void flush() override;
+
+    void setPolicy(FlushPolicy newPolicy) { policy = newPolicy; }
+    FlushPolicy getPolicy() const { return policy; }
+
+    // Число байт в буфере, ещё не переданных получателю
+    std::size_t pending() const { return used; }
+
+protected:
+    // Передаёт блок данных получателю
+    virtual void drain(const char* data, std::size_t size) = 0;
+
+    // Сбрасывает буферы самого получателя (вызывается в конце flush)
+    virtual void sync() {}
+
+    // Сброс для деструкторов наследников: ошибки получателя игнорируются
+    void flushQuietly() noexcept;
+
+private:
+    std::vector<char> buffer;
+    std::size_t used;
+    FlushPolicy policy;
+};
+
+/**
+ * Буферизованный вывод в std::ostream (по умолчанию - в std::cout)
+ */
+class StreamOutputSink : public BufferedOutputSink {
+public:
+    explicit StreamOutputSink(std::ostream& stream, std::size_t capacity = DEFAULT_CAPACITY,
+        FlushPolicy policy = FlushPolicy::WhenFull);
+    ~StreamOutputSink() override;
+
+protected:
+    void drain(const char* data, std::size_t size) override;
+    void sync() override;
+
+private:
+    std::ostream& stream;
+};
+
+/**
+ * Буферизованный вывод в файловый дескриптор (без владения дескриптором)
+ * @throws runtime_error из flush/write при ошибке записи
+ */
+class FdOutputSink : public BufferedOutputSink {
+public:
+    explicit FdOutputSink(int fd, std::size_t capacity = DEFAULT_CAPACITY, FlushPolicy policy = FlushPolicy::WhenFull);
+    ~FdOutputSink() override;
+
+protected:
+    void drain(const char* data, std::size_t size) override;
+
+private:
+    int fd;
+};
+
+/**
+ * Накопление вывода в памяти (для тестов и IDE)
+ */
+class MemoryOutputSink : public IOutputSink {
+public:
+    void write(const char* data, std::size_t size) override { text.append(data, size); }
+    void flush() override {}
+
+    const std::string& str() const { return text; }
+    void clear() { text.clear(); }
+
+private:
+    std::string text;
+};
@@ -13,6 +13,8 @@
 #include "lexer.h"
 #include "interfaces.h"
 #include "error_reporter.h"
+#include "run_arena.h"
+#include <utility>
 
 /**
  * Класс синтаксического анализатора (парсера)
@@ -40,6 +42,18 @@ public:
      */
     explicit Parser(const vector<Token>& tokens, std::shared_ptr<IErrorReporter> errorReporter = nullptr);
 
+    /**
+     * Конструктор, забирающий токены без копирования (например, результат Lexer::tokenize())
+     */
+    explicit Parser(vector<Token>&& tokens, std::shared_ptr<IErrorReporter> errorReporter = nullptr);
+
+    /**
+     * Задаёт арену, в которой создаются узлы дерева (см. run_arena.h)
+     * Арена должна пережить дерево
+     * @param target Арена или nullptr - общая куча
+     */
+    void setArena(RunArena* target) { arena = target; }
+
     /**
      * Реализация метода интерфейса IParser для синтаксического анализа
      * @return Указатель на корневой узел построенного абстрактного синтаксического дерева
@@ -56,9 +70,21 @@ private:
     std::vector<Token> tokens;   // Список токенов для разбора
     size_t pos;                  // Текущая позиция в списке токенов
     std::shared_ptr<IErrorReporter> errorReporter; // Обработчик ошибок
+    RunArena* arena = nullptr;   // Арена узлов дерева (nullptr - общая куча)
+
+    // Создаёт узел дерева с позицией токена at: узел и счётчик ссылок лежат одним фрагментом арены или кучи
+    template <class... Args>
+    shared_ptr<ASTNode> makeNode(const Token& at, Args&&... args) {
+        auto node = std::allocate_shared<ASTNode>(ArenaAllocator<ASTNode>(arena), std::forward<Args>(args)...);
+        node->line = at.line;
+        node->column = at.column;
+        return node;
+    }
 
     // Получить текущий токен
     const Token& current() const;
+    // Получить последний пройденный токен
+    const Token& previous() const { return tokens[pos - 1]; }
     // Если текущий токен совпадает с ожидаемым типом — перейти к следующему
     bool match(TokenType type);
     // Проверить, что текущий токен нужного типа, иначе выбросить исключение с сообщением
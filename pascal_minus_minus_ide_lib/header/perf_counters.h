@@ -0,0 +1,123 @@
+#pragma once
+
+/**
+ * @file perf_counters.h
+ * @brief Аппаратные счётчики производительности по фазам обработки программы
+ *
+ * PerfCounters открывает через perf_event_open счётчики тактов, инструкций,
+ * промахов кэша и ошибок предсказания переходов для текущего потока (только
+ * пользовательский режим). PhaseCounters замеряет ими фазы - лексический
+ * анализ, разбор, компиляцию, выполнение - и печатает IPC и MPKI (промахов на
+ * тысячу инструкций). По ним видно, во что упирается цикл интерпретатора:
+ * в ошибки предсказания диспетчеризации или в память.
+ *
+ * Если счётчики недоступны (не Linux, виртуальная машина без PMU, запрет
+ * kernel.perf_event_paranoid), замеряется только время, а причина сообщается
+ * в отчёте. Исключений из-за недоступности счётчиков нет.
+ */
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+enum class PerfEvent {
+    Cycles,
+    Instructions,
+    CacheMisses,        // Промахи последнего уровня кэша
+    BranchMisses,       // Ошибки предсказания переходов
+    Count
+};
+
+constexpr std::size_t PERF_EVENT_COUNT = static_cast<std::size_t>(PerfEvent::Count);
+
+/**
+ * Показания счётчиков (накопленные или разность двух показаний)
+ */
+struct PerfReading {
+    std::array<std::uint64_t, PERF_EVENT_COUNT> values{};
+    std::array<bool, PERF_EVENT_COUNT> valid{};     // Счётчик открыт и хоть раз работал
+    double seconds = 0;
+
+    bool has(PerfEvent event) const { return valid[static_cast<std::size_t>(event)]; }
+    std::uint64_t get(PerfEvent event) const { return values[static_cast<std::size_t>(event)]; }
+
+    // Инструкций за такт (0, если нет тактов или инструкций)
+    double ipc() const;
+
+    // Событий event на тысячу инструкций (0, если нет данных)
+    double mpki(PerfEvent event) const;
+
+    // Показания за промежуток от earlier до этого
+    PerfReading since(const PerfReading& earlier) const;
+};
+
+class PerfCounters {
+public:
+    // Открывает счётчики для вызывающего потока; не бросает исключений
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // Открыт хотя бы один счётчик
+    bool available() const;
+
+    // Почему счётчики (или часть их) недоступны; пусто, если открыты все
+    const std::string& unavailableReason() const { return reason; }
+
+    /**
+     * Накопленные с открытия значения. При мультиплексировании счётчиков
+     * ядром значения масштабируются по доле времени, когда счётчик работал
+     */
+    PerfReading read() const;
+
+private:
+    std::array<int, PERF_EVENT_COUNT> fds;
+    std::chrono::steady_clock::time_point opened;
+    std::string reason;
+};
+
+/**
+ * Показания одной фазы
+ */
+struct PhaseReport {
+    std::string name;
+    PerfReading counts;
+};
+
+class PhaseCounters {
+public:
+    /**
+     * RAII-замер фазы: по выходе из области видимости фаза добавляется в отчёт
+     */
+    class Phase {
+    public:
+        Phase(PhaseCounters& owner, const std::string& name)
+            : owner(owner), name(name), start(owner.counters.read()) {}
+        ~Phase() { owner.phases.push_back({ name, owner.counters.read().since(start) }); }
+        Phase(const Phase&) = delete;
+        Phase& operator=(const Phase&) = delete;
+    private:
+        PhaseCounters& owner;
+        std::string name;
+        PerfReading start;
+    };
+
+    bool available() const { return counters.available(); }
+    const std::vector<PhaseReport>& results() const { return phases; }
+
+    /**
+     * Таблица фаз: время, такты, инструкции, IPC, промахи кэша и ошибки
+     * предсказания с MPKI; недоступные значения печатаются как "-"
+     */
+    void writeReport(std::ostream& out) const;
+
+private:
+    PerfCounters counters;
+    std::vector<PhaseReport> phases;
+};
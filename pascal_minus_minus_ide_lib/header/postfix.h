@@ -17,9 +17,14 @@
 #include <stdexcept>
 #include "interfaces.h"
 #include "ast.h"
+#include "logger.h"
+#include "run_arena.h"
+#include "metrics.h"
 
 using namespace std;
 
+class MemoryAccount;
+
 /**
  * Типы операторов для вычисления выражений в обратной польской записи (ОПЗ, postfix notation)
  * Перечисление всех поддерживаемых операторов в языке Pascal--
@@ -53,6 +58,13 @@ struct OperatorInfo {
     bool rightAssoc;    // Ассоциативность справа (для унарных операторов)
 };
 
+/**
+ * Функция поиска переменной для вычисления выражений: по интернированному имени
+ * узла AST или по тексту, если имени нет (NO_NAME - токен без узла или узел, созданный вручную)
+ * Возвращает указатель на значение или nullptr, если переменная не найдена
+ */
+using VariableLookup = std::function<const Value*(NameId name, const std::string& text)>;
+
 /**
  * Класс для вычисления выражений в обратной польской записи (ОПЗ, postfix notation)
  * Реализует алгоритм вычисления выражений с использованием стека
@@ -66,9 +78,13 @@ public:
     Value evaluate(const std::shared_ptr<ASTNode>& node, const std::map<std::string, Value>& variables) override;
     Value performOperation(const std::string& op, const std::vector<Value>& operands) override;
     
+    // Вычислить выражение, получая значения переменных через функцию поиска
+    Value evaluate(const std::shared_ptr<ASTNode>& node, const VariableLookup& lookup);
+    
     // Дополнительные методы для работы с постфиксными выражениями
     // Вычислить значение выражения, представленного в виде вектора токенов (postfix)
     Value evaluatePostfix(const std::vector<std::string>& tokens, const std::map<std::string, Value>& variables);
+    Value evaluatePostfix(const std::vector<std::string>& tokens, const VariableLookup& lookup);
     
     // Преобразовать инфиксное выражение (как строку) в вектор токенов в постфиксной форме
     std::vector<std::string> infixToPostfix(const std::vector<std::string>& infix);
@@ -76,11 +92,27 @@ public:
     // Преобразовать АСТ в постфиксную форму
     std::vector<std::string> astToPostfix(const std::shared_ptr<ASTNode>& node);
 
+    // Журнал отладочных сообщений (по умолчанию - общий Logger, nullptr - не вести)
+    void setLogger(Logger* target) { logger = target; }
+
+    // Счёт, на который списывается память вычисления выражений (nullptr - без учёта)
+    void setMemoryAccount(MemoryAccount* account) { memory = account; }
+
+    // Арена для стека значений (nullptr - общая куча), см. run_arena.h
+    void setArena(RunArena* target) { arena = target; }
+
+    // Счётчики операторов, по одному на OperatorType (nullptr - не считать)
+    void setOperatorCounters(const MetricsRegistry::Counter* counters) { operatorCounters = counters; }
+
 private:
-    std::map<std::string, OperatorInfo> operatorMap;
+    const std::map<std::string, OperatorInfo>& operatorMap;  // Общая таблица операторов
+    Logger* logger;
+    MemoryAccount* memory = nullptr;
+    RunArena* arena = nullptr;
+    const MetricsRegistry::Counter* operatorCounters = nullptr;
     
-    // Инициализация карты операторов
-    void initOperatorMap();
+    // Таблица операторов (создаётся при первом обращении)
+    static const std::map<std::string, OperatorInfo>& operatorTable();
     
     // Проверка, является ли токен оператором
     bool isOperator(const std::string& token) const;
@@ -94,8 +126,15 @@ private:
     // Вспомогательный метод для выполнения унарной операции
     Value performUnaryOperation(const std::string& op, const Value& a);
     
-    // Рекурсивный метод для преобразования АСТ в постфиксную форму
-    void processASTNode(const std::shared_ptr<ASTNode>& node, std::vector<std::string>& output);
+    // Рекурсивный метод для преобразования АСТ в постфиксную форму;
+    // names заполняется параллельно output: имя для идентификаторов, NO_NAME для остальных токенов
+    void processASTNode(const std::shared_ptr<ASTNode>& node, std::vector<std::string>& output, std::vector<NameId>& names);
+    
+    // Постфиксная форма АСТ вместе с интернированными именами идентификаторов
+    std::vector<std::string> astToPostfix(const std::shared_ptr<ASTNode>& node, std::vector<NameId>& names);
+    
+    // Вычисление постфиксной формы; переменные с известным именем ищутся по номеру без разбора текста
+    Value evaluatePostfix(const std::vector<std::string>& tokens, const std::vector<NameId>& names, const VariableLookup& lookup);
 };
 
 #endif // POSTFIX_H
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+/**
+ * @file process_batch_runner.h
+ * @brief Многопроцессное пакетное выполнение программ Pascal--
+ *
+ * Координатор порождает (fork) рабочие процессы, которые забирают задания из
+ * кольцевой очереди в разделяемой памяти и возвращают вывод и сообщения через
+ * свой участок той же памяти - без сокетов и внешних сервисов. Падение процесса
+ * или превышение ограничения времени или памяти завершает с ошибкой только
+ * текущее задание, а процесс перезапускается. Задание, которое умерший процесс
+ * не успел захватить, остаётся в очереди.
+ *
+ * Поддерживается только в POSIX-системах. Вызывать из процесса, в котором нет
+ * других активно работающих потоков: fork копирует только вызывающий поток.
+ */
+
+#include "batch_runner.h"
+#include <cstddef>
+#include <vector>
+
+/**
+ * Параметры многопроцессного режима
+ */
+struct ProcessRunnerOptions {
+    std::size_t workers = 0;                    // Число процессов (0 - по числу аппаратных потоков)
+    double timeLimitSeconds = 0;                // Время на одно задание (0 - без ограничения)
+    std::size_t memoryLimitBytes = 0;           // Ограничение адресного пространства процесса (0 - нет); при нехватке процесс завершается
+    std::size_t queueCapacity = 1024;           // Ёмкость очереди заданий (округляется до степени двойки)
+    std::size_t resultCapacity = 1 << 20;       // Байт на вывод, сообщения и ошибку одного задания
+};
+
+class ProcessBatchRunner {
+public:
+    explicit ProcessBatchRunner(const ProcessRunnerOptions& options = ProcessRunnerOptions()) : options(options) {}
+
+    /**
+     * Выполняет задания в рабочих процессах
+     * @return Результаты в порядке заданий
+     * @throws runtime_error, если не удалось выделить память или создать процесс,
+     *         а также в Windows
+     */
+    std::vector<BatchResult> run(const std::vector<BatchJob>& jobs);
+
+    // Сводка последнего вызова run()
+    const BatchSummary& getSummary() const { return summary; }
+
+private:
+    ProcessRunnerOptions options;
+    BatchSummary summary;
+};
@@ -0,0 +1,127 @@
+#pragma once
+
+/**
+ * @file run_arena.h
+ * @brief Арена одного запуска программы: дерево AST и временные значения
+ *
+ * Память выделяется сдвигом указателя в крупных блоках. Небольшие запросы
+ * округляются до класса размера (кратного ALIGNMENT); освобождённый фрагмент
+ * попадает в список своего класса и достаётся следующему запросу того же
+ * класса, поэтому временные значения, создаваемые на каждой итерации цикла,
+ * не наращивают арену. Освобождённые фрагменты крупнее MAX_CLASS_SIZE (стеки
+ * значений длинных выражений) хранятся в общем списке и достаются следующему
+ * запросу того же размера. Всё выделенное возвращается разом в reset(): между
+ * запусками куча процесса не дробится узлами деревьев и значениями.
+ *
+ * Арена не потокобезопасна и должна пережить всё, что из неё выделено:
+ * reset() вызывают, когда дерево и интерпретатор запуска уже уничтожены.
+ */
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+class RunArena {
+public:
+    static constexpr std::size_t ALIGNMENT = 16;                 // Выравнивание всех фрагментов
+    static constexpr std::size_t MAX_CLASS_SIZE = 512;           // Наибольший класс размера
+    static constexpr std::size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+    /**
+     * @param chunkSize Размер блока, из которого выделяются фрагменты
+     */
+    explicit RunArena(std::size_t chunkSize = DEFAULT_CHUNK_SIZE);
+    ~RunArena();
+
+    RunArena(const RunArena&) = delete;
+    RunArena& operator=(const RunArena&) = delete;
+
+    /**
+     * Выделяет фрагмент
+     * @throws bad_alloc, если выравнивание больше ALIGNMENT или памяти нет
+     */
+    void* allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t));
+
+    /**
+     * Возвращает фрагмент: небольшой - в список его класса, крупный - в список крупных
+     */
+    void deallocate(void* pointer, std::size_t bytes) noexcept;
+
+    /**
+     * Освобождает всё выделенное; первый блок остаётся для следующего запуска
+     */
+    void reset();
+
+    // Память, занятая блоками арены
+    std::size_t bytesReserved() const { return reserved; }
+
+    // Выделено и ещё не возвращено
+    std::size_t bytesInUse() const { return inUse; }
+
+    // Сколько раз выделение потребовало нового блока у кучи (с создания арены)
+    std::size_t chunkAllocations() const { return chunkAllocationCount; }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+    struct LargeFreeBlock {
+        LargeFreeBlock* next;
+        std::size_t size;
+    };
+    static constexpr std::size_t CLASS_COUNT = MAX_CLASS_SIZE / ALIGNMENT;
+
+    std::size_t chunkSize;
+    std::vector<char*> chunks;              // Блоки сдвигового выделения (первый сохраняется в reset())
+    std::vector<char*> large;               // Отдельные блоки для запросов крупнее четверти блока
+    char* cursor = nullptr;                 // Свободное место текущего блока
+    char* limit = nullptr;
+    FreeBlock* freeLists[CLASS_COUNT] = {}; // Освобождённые фрагменты по классам размера
+    LargeFreeBlock* largeFree = nullptr;    // Освобождённые фрагменты крупнее MAX_CLASS_SIZE
+    std::size_t reserved = 0;
+    std::size_t inUse = 0;
+    std::size_t chunkAllocationCount = 0;
+
+    static std::size_t roundUp(std::size_t bytes) { return (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT; }
+    void* bump(std::size_t bytes);
+    void* takeLarge(std::size_t size);
+};
+
+/**
+ * Распределитель для контейнеров и allocate_shared поверх RunArena
+ * Без арены (nullptr) обращается к общей куче
+ */
+template <class T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(RunArena* arena = nullptr) noexcept : arena(arena) {}
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.getArena()) {}
+
+    T* allocate(std::size_t count) {
+        if (count > static_cast<std::size_t>(-1) / sizeof(T))
+            throw std::bad_array_new_length();
+        if (!arena)
+            return static_cast<T*>(::operator new(count * sizeof(T)));
+        return static_cast<T*>(arena->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* pointer, std::size_t count) noexcept {
+        if (arena)
+            arena->deallocate(pointer, count * sizeof(T));
+        else
+            ::operator delete(pointer);
+    }
+
+    RunArena* getArena() const noexcept { return arena; }
+
+    template <class U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept { return arena == other.getArena(); }
+    template <class U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept { return arena != other.getArena(); }
+
+private:
+    RunArena* arena;
+};
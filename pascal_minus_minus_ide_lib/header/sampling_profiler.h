@@ -0,0 +1,118 @@
+#pragma once
+
+/**
+ * @file sampling_profiler.h
+ * @brief Выборочный профилировщик по строкам исходного текста
+ *
+ * Интерпретатор публикует в атомарной переменной узел, который выполняется в
+ * данный момент (ExecutionPosition). Профилировщик по таймеру процессорного
+ * времени потока (timer_create + SIGPROF в Linux) снимает значение этой
+ * переменной и по окончании группирует выборки по строкам. Интерпретатор
+ * ничего не замеряет сам: в отличие от NodeProfiler, выполнение почти не
+ * замедляется, зато результат статистический.
+ *
+ * В других системах выборки снимает отдельный поток по настенному времени.
+ */
+
+#include "ast.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Выполняемый узел интерпретатора (nullptr - вне программы)
+using ExecutionPosition = std::atomic<const ASTNode*>;
+
+/**
+ * RAII-публикация узла на время его выполнения; по выходе восстанавливает
+ * внешний узел, чтобы время заголовка цикла не приписывалось телу
+ */
+class PositionScope {
+public:
+    PositionScope(ExecutionPosition& position, const ASTNode* node)
+        : position(position), saved(position.load(std::memory_order_relaxed)) {
+        position.store(node, std::memory_order_relaxed);
+    }
+    ~PositionScope() { position.store(saved, std::memory_order_relaxed); }
+    PositionScope(const PositionScope&) = delete;
+    PositionScope& operator=(const PositionScope&) = delete;
+private:
+    ExecutionPosition& position;
+    const ASTNode* saved;
+};
+
+/**
+ * Выборки одной строки
+ */
+struct LineSamples {
+    int line = 0;                   // 0 - узлы без позиции
+    std::uint64_t samples = 0;
+    double share = 0;               // Доля от выборок внутри программы
+};
+
+class SamplingProfiler {
+public:
+    /**
+     * @param interval Период выборок (процессорное время потока)
+     * @param capacity Наибольшее число выборок; лишние отбрасываются
+     */
+    explicit SamplingProfiler(std::chrono::microseconds interval = std::chrono::microseconds(1000),
+        std::size_t capacity = 1 << 18);
+
+    ~SamplingProfiler();
+
+    SamplingProfiler(const SamplingProfiler&) = delete;
+    SamplingProfiler& operator=(const SamplingProfiler&) = delete;
+
+    /**
+     * Начинает снимать выборки позиции. Вызывается из потока интерпретатора:
+     * таймер считает процессорное время именно этого потока
+     * Прежние выборки сохраняются
+     * @throws logic_error, если в процессе уже работает другой профилировщик
+     * @throws runtime_error, если таймер не создан
+     */
+    void start(const ExecutionPosition& position);
+
+    // Останавливает выборки (из того же потока, что и start())
+    void stop();
+
+    bool isRunning() const { return running; }
+
+    // Забывает выборки
+    void reset();
+
+    std::uint64_t sampleCount() const;                          // Все сохранённые выборки
+    std::uint64_t idleSamples() const;                          // Из них вне программы
+    std::uint64_t droppedSamples() const { return dropped.load(std::memory_order_relaxed); }
+
+    /**
+     * Строки по убыванию числа выборок
+     * Узлы разыменовываются здесь: дерево должно быть ещё живо
+     */
+    std::vector<LineSamples> hotLines() const;
+
+    /**
+     * Отчёт по горячим строкам
+     * @param top Число строк (0 - все)
+     * @param source Текст программы, чтобы показать сами строки (необязательно)
+     */
+    void writeReport(std::ostream& out, std::size_t top = 0, const std::string& source = std::string()) const;
+
+private:
+    struct Timer;
+
+    std::chrono::microseconds interval;
+    std::vector<const ASTNode*> samples;        // Заполнено до recorded
+    std::atomic<std::size_t> recorded{ 0 };
+    std::atomic<std::uint64_t> dropped{ 0 };
+    const ExecutionPosition* position = nullptr;
+    Timer* timer = nullptr;
+    bool running = false;
+
+    // Снимает одну выборку; безопасна для обработчика сигнала
+    void sample();
+    static void onSignal(int);
+};
@@ -0,0 +1,170 @@
+#pragma once
+
+/**
+ * @file scoped_symbol_table.h
+ * @brief Таблица символов с вложенными областями видимости
+ *
+ * Хранит значения переменных интерпретатора. Вход в блок добавляет кадр области
+ * видимости, выход из блока снимает его, восстанавливая перекрытые внешние символы.
+ */
+
+#include "value.h"
+#include "name_table.h"
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Стек областей видимости со "связыванием через журнал отмены"
+ *
+ * Все объявления лежат в стеке привязок в порядке объявления; этот стек одновременно
+ * служит журналом отмены. Индекс, адресуемый номером имени в таблице имён запуска, хранит
+ * для каждого имени видимую (самую внутреннюю) привязку, а привязка помнит перекрытую
+ * ею внешнюю. Поэтому:
+ *  - enterScope() - O(1): запоминается вершина стека;
+ *  - exitScope() - O(k), где k - число объявлений в снимаемом кадре;
+ *  - lookup(NameId) - одно обращение к массиву, без хеширования и сравнения строк.
+ *
+ * Таблица имён разделяется с лексером того же запуска (setNames), поэтому номера
+ * из дерева используются без перевода, а индекс растёт только с числом имён запуска.
+ * Перегрузки со string_view предназначены для внешнего API и тестов: они переводят
+ * текст в номер через ту же таблицу имён.
+ *
+ * Привязки хранятся в deque, поэтому указатели на значения остаются действительными
+ * до выхода из области видимости, в которой символ объявлен.
+ */
+class ScopedSymbolTable {
+public:
+    /**
+     * RAII-охранник: открывает область видимости в конструкторе и закрывает в деструкторе
+     */
+    class ScopeGuard {
+    public:
+        explicit ScopeGuard(ScopedSymbolTable& table) : table(table) { table.enterScope(); }
+        ~ScopeGuard() { table.exitScope(); }
+        ScopeGuard(const ScopeGuard&) = delete;
+        ScopeGuard& operator=(const ScopeGuard&) = delete;
+
+    private:
+        ScopedSymbolTable& table;
+    };
+
+    /**
+     * @param names Таблица имён запуска (nullptr - собственная пустая таблица)
+     */
+    explicit ScopedSymbolTable(std::shared_ptr<NameTable> names = nullptr);
+
+    /**
+     * Переключает таблицу на имена другого запуска
+     * Все символы удаляются, индекс освобождается
+     * @param names Таблица имён, которой пронумерован следующий запуск
+     */
+    void setNames(std::shared_ptr<NameTable> names);
+
+    /**
+     * Таблица имён, которой нумеруются символы
+     */
+    const std::shared_ptr<NameTable>& getNames() const { return names; }
+
+    /**
+     * Номер имени в таблице имён запуска (добавляется при первом обращении)
+     */
+    NameId intern(std::string_view name) { return names->intern(name); }
+
+    /**
+     * Открывает новую (вложенную) область видимости
+     */
+    void enterScope();
+
+    /**
+     * Закрывает текущую область видимости и восстанавливает перекрытые символы
+     * @throws runtime_error при попытке закрыть глобальную область
+     */
+    void exitScope();
+
+    /**
+     * Глубина вложенности (0 - глобальная область)
+     */
+    size_t depth() const { return frames.size(); }
+
+    /**
+     * Объявляет символ в текущей области видимости
+     * Повторное объявление в той же области перезаписывает значение,
+     * объявление во вложенной области перекрывает внешний символ
+     * @param name Интернированное имя символа
+     * @param value Начальное значение
+     * @return Указатель на хранимое значение
+     */
+    Value* declare(NameId name, const Value& value);
+    Value* declare(std::string_view name, const Value& value) { return declare(names->intern(name), value); }
+
+    /**
+     * Ищет видимый символ (от внутренней области к внешней)
+     * @param name Интернированное имя символа
+     * @return Указатель на значение или nullptr, если символ не объявлен
+     */
+    Value* lookup(NameId name) {
+        return name < index.size() && index[name] != NO_BINDING ? &bindings[index[name]].value : nullptr;
+    }
+    const Value* lookup(NameId name) const {
+        return name < index.size() && index[name] != NO_BINDING ? &bindings[index[name]].value : nullptr;
+    }
+    Value* lookup(std::string_view name) { return lookup(names->find(name)); }
+    const Value* lookup(std::string_view name) const { return lookup(names->find(name)); }
+
+    /**
+     * Проверяет, виден ли символ в текущей области
+     */
+    bool contains(NameId name) const { return lookup(name) != nullptr; }
+    bool contains(std::string_view name) const { return lookup(name) != nullptr; }
+
+    /**
+     * Проверяет, объявлен ли символ именно в текущей области
+     * (повторное объявление перезапишет его, а не перекроет)
+     */
+    bool declaredInCurrentScope(NameId name) const {
+        return name < index.size() && index[name] != NO_BINDING && bindings[index[name]].scope == frames.size();
+    }
+
+    /**
+     * Число видимых символов
+     */
+    size_t size() const { return visibleCount; }
+
+    /**
+     * Оценка памяти привязок и индексов (без содержимого строк)
+     */
+    size_t storageBytes() const {
+        return bindings.size() * sizeof(Binding) + (index.capacity() + frames.capacity()) * sizeof(size_t);
+    }
+
+    /**
+     * Удаляет все символы и все области видимости (номера имён остаются действительными)
+     */
+    void clear();
+
+    /**
+     * Возвращает копию видимых символов в виде упорядоченной карты
+     */
+    std::map<std::string, Value> snapshot() const;
+
+private:
+    // Привязка имени к значению в конкретной области видимости
+    struct Binding {
+        NameId name;
+        Value value;
+        size_t scope;     // Глубина области, в которой объявлен символ
+        size_t shadowed;  // Индекс перекрытой привязки или NO_BINDING
+    };
+
+    static constexpr size_t NO_BINDING = static_cast<size_t>(-1);
+
+    std::shared_ptr<NameTable> names; // Имена запуска (общие с лексером)
+    std::deque<Binding> bindings;    // Стек привязок (журнал отмены)
+    std::vector<size_t> index;       // NameId -> видимая привязка или NO_BINDING
+    std::vector<size_t> frames;      // Размер стека привязок при входе в каждую область
+    size_t visibleCount;             // Число имён с видимой привязкой
+};
@@ -3,15 +3,17 @@
 /**
  * @file symbol_table.h
  * @brief Таблица символов для компилятора Pascal--
- * 
- * Реализует хеш-таблицу для эффективного хранения и поиска символов
- * (переменных, констант, процедур, функций)
+ *
+ * Реализует хеш-таблицу с открытой адресацией (в стиле Swiss table) для эффективного
+ * хранения и поиска символов (переменных, констант, процедур, функций)
  */
 
 #include <iostream>
 #include <string>
 #include <vector>
 #include <memory>
+#include <cstdint>
+#include "name_table.h"
 
 using namespace std;
 
@@ -21,49 +23,72 @@ using namespace std;
 class SymbolInfo {
 public:
     string name;  // Имя символа
+    NameId id;    // Номер имени в таблице имён SymbolTable (ключ); NO_NAME - назначит addSymbol
     string type;  // Тип символа (Integer, Real, Boolean, String и т.д.)
     string value; // Значение символа (для констант)
     shared_ptr<SymbolInfo> table; // Для вложенных таблиц
 
     /**
      * Конструктор SymbolInfo
-     * @param n Имя символа
+     * @param n Имя символа (или его номер, полученный от той же таблицы символов)
      * @param t Тип символа
      * @param v Значение символа
      */
     SymbolInfo(const string& n, const string& t, const string& v);
+    SymbolInfo(NameId n, const string& t, const string& v);
 };
 
 /**
- * Таблица символов - хеш-таблица для эффективного хранения и поиска символов
+ * Таблица символов - хеш-таблица с открытой адресацией для эффективного хранения и поиска символов
  * Используется для проверки объявления переменных и хранения значений во время интерпретации
+ *
+ * Каждому слоту соответствует управляющий байт: старший бит означает пустой слот,
+ * младшие 7 бит у занятого слота - часть хеша (H2). Поиск сравнивает сразу группу
+ * из GROUP_WIDTH управляющих байтов (SSE2, если доступно), а сами ключи сравниваются
+ * только у совпавших по H2 слотов. Ключом служит номер имени (NameId) в собственной таблице имён, поэтому
+ * проверка совпадения - одно сравнение целых чисел, а хеш не требует чтения строки. Пробирование линейное, поэтому удаление выполняется
+ * обратным сдвигом без "надгробий". Таблица растёт вдвое при превышении
+ * коэффициента заполнения MAX_LOAD_NUM / MAX_LOAD_DEN.
+ *
+ * Указатели, возвращённые findSymbol, действительны до следующего addSymbol/removeSymbol.
  */
 class SymbolTable {
 protected:
-    /**
-     * Структура узла для разрешения коллизий в хеш-таблице
-     * Реализует связный список для цепочек в хеш-таблице
-     */
-    struct ChainNode {
-        SymbolInfo data; // Данные о символе
-        ChainNode* next; // Указатель на следующий элемент в цепочке
-        ChainNode(const SymbolInfo& s, ChainNode* n) : data(s), next(n) {}
-    };
+    static constexpr uint8_t CTRL_EMPTY = 0x80; // Управляющий байт пустого слота
+    static constexpr size_t GROUP_WIDTH = 16;   // Число слотов, проверяемых за одно сравнение
 
-    ChainNode** buckets;
-    size_t capacity;
-    size_t count;
+    uint8_t* ctrl;       // Управляющие байты: capacity + GROUP_WIDTH - 1 (хвост дублирует начало)
+    SymbolInfo* slots;   // Хранилище символов (инициализированы только занятые слоты)
+    size_t capacity;     // Число слотов (степень двойки)
+    size_t count;        // Число занятых слотов
+    NameTable names;     // Имена символов этой таблицы
 
-    size_t hashKey(const string& key) const;
+    size_t hashKey(NameId key) const;
+    size_t findSlot(NameId id, size_t hash) const;
+    void setCtrl(size_t index, uint8_t value);
+    void allocate(size_t cap);
+    void release();
+    void rehash(size_t newCapacity);
 
 public:
     static constexpr size_t DEFAULT_CAPACITY = 128;
+    static constexpr size_t MAX_LOAD_NUM = 7;
+    static constexpr size_t MAX_LOAD_DEN = 8;
 
     SymbolTable(size_t cap = DEFAULT_CAPACITY);
     ~SymbolTable();
 
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
     void addSymbol(const SymbolInfo& symbol);
     SymbolInfo* findSymbol(const string& name);
+    SymbolInfo* findSymbol(NameId id);
     void removeSymbol(const string& name);
+    void removeSymbol(NameId id);
     void printTable();
-};
\ No newline at end of file
+
+    size_t size() const { return count; }
+    size_t getCapacity() const { return capacity; }
+    const NameTable& getNames() const { return names; } // Выдаёт номера для findSymbol(NameId)
+};
@@ -0,0 +1,111 @@
+#pragma once
+
+/**
+ * @file trace_recorder.h
+ * @brief Запись временной шкалы в формате Chrome trace_event
+ *
+ * Отрезки (фазы разбора, операторы главного блока, циклы, задания пакета)
+ * накапливаются в памяти, у каждого потока в своём буфере: запись не берёт
+ * блокировок, кроме первой записи потока. Файл пишется целиком в конце
+ * (writeJson) и открывается в chrome://tracing или Perfetto.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * Завершённый отрезок (событие "X")
+ */
+struct TraceEvent {
+    std::string name;
+    const char* category;       // Строковый литерал: "phase", "statement", "loop", "job"
+    std::int64_t start;         // Микросекунды от создания трассы
+    std::int64_t duration;
+    std::string args;           // Поля объекта args без фигурных скобок или пусто
+};
+
+class TraceRecorder {
+public:
+    /**
+     * RAII-отрезок; без трассы ничего не делает
+     */
+    class Span {
+    public:
+        Span(TraceRecorder* recorder, const char* category, std::string name)
+            : recorder(recorder), category(category) {
+            if (recorder) {
+                this->name = std::move(name);
+                start = recorder->now();
+            }
+        }
+        ~Span() {
+            if (recorder)
+                recorder->complete(category, std::move(name), start, recorder->now() - start, std::move(args));
+        }
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+        // Добавляет числовой аргумент, видимый в просмотрщике
+        void setArg(const char* key, std::int64_t value);
+
+    private:
+        TraceRecorder* recorder;
+        const char* category;
+        std::string name;
+        std::int64_t start = 0;
+        std::string args;
+    };
+
+    /**
+     * @param maxEventsPerThread Сколько отрезков хранить на поток; лишние отбрасываются
+     */
+    explicit TraceRecorder(std::size_t maxEventsPerThread = 1 << 20);
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    // Микросекунды от создания трассы
+    std::int64_t now() const;
+
+    // Добавляет завершённый отрезок в буфер вызывающего потока
+    void complete(const char* category, std::string name, std::int64_t start, std::int64_t duration,
+                  std::string args = std::string());
+
+    // Имя вызывающего потока на шкале (по умолчанию "поток N")
+    void setThreadName(const std::string& name);
+
+    std::size_t eventCount() const;
+    std::size_t droppedEvents() const { return dropped.load(std::memory_order_relaxed); }
+
+    /**
+     * Пишет трассу в формате JSON Object Format. Вызывается, когда потоки,
+     * писавшие в трассу, уже закончили работу
+     */
+    void writeJson(std::ostream& out) const;
+
+private:
+    struct ThreadBuffer {
+        std::thread::id thread;
+        std::uint32_t tid;
+        std::string name;
+        std::vector<TraceEvent> events;
+    };
+
+    const std::uint64_t id;                     // Отличает трассы в кэше потока
+    const std::size_t maxEvents;
+    const std::chrono::steady_clock::time_point origin;
+    mutable std::mutex mutex;                   // Защищает список буферов
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::atomic<std::size_t> dropped{ 0 };
+
+    ThreadBuffer& buffer();
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+/**
+ * @file value.h
+ * @brief Значения времени выполнения Pascal--
+ *
+ * Вынесено из interpreter.h, чтобы таблицы символов и калькулятор
+ * могли работать со значениями, не завися от интерпретатора.
+ */
+
+#include <string>
+
+enum class ValueType { Integer, Real, Boolean, String };
+
+/**
+ * Универсальная структура для хранения значений разных типов в Pascal--
+ * Поддерживает четыре основных типа данных: Integer, Real, Boolean и String
+ * и предоставляет методы для преобразования между ними
+ */
+struct Value {
+    ValueType type;        // Тип значения (Integer, Real, Boolean, String)
+    int intValue;          // Целочисленное значение (для типа Integer)
+    double realValue;      // Вещественное значение (для типа Real)
+    bool boolValue;        // Логическое значение (для типа Boolean)
+    std::string stringValue; // Строковое значение (для типа String)
+    
+    /**
+     * Методы для безопасного преобразования между типами
+     * Генерируют исключения при невозможности преобразования
+     */
+    int toInt() const;      // Преобразование к целому числу
+    double toReal() const;  // Преобразование к вещественному числу
+    bool toBool() const;    // Преобразование к логическому значению
+    std::string toString() const; // Преобразование к строке
+    
+    // Конструкторы для различных типов данных
+    Value();                  // Конструктор по умолчанию (создает нулевое значение)
+    explicit Value(int v);    // Создание из целого числа
+    explicit Value(double v); // Создание из вещественного числа
+    explicit Value(bool v);   // Создание из логического значения
+    explicit Value(const std::string& v); // Создание из строки
+};
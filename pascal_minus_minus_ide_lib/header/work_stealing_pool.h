@@ -0,0 +1,78 @@
+#pragma once
+
+/**
+ * @file work_stealing_pool.h
+ * @brief Пул потоков с перехватом задач (work stealing)
+ *
+ * У каждого рабочего потока своя очередь: поток берёт задачи с её конца,
+ * а освободившиеся потоки забирают задачи с начала чужих очередей. Задачи,
+ * поставленные из рабочего потока, попадают в его собственную очередь.
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * @param threads Число рабочих потоков (0 - по числу аппаратных потоков)
+     */
+    explicit WorkStealingPool(std::size_t threads = 0);
+
+    // Дожидается завершения поставленных задач и останавливает потоки
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * Ставит задачу в очередь
+     * Из рабочего потока - в его очередь, из внешнего - по очереди во все
+     */
+    void submit(Task task);
+
+    /**
+     * Ждёт завершения всех поставленных задач, включая поставленные ими
+     * Не вызывается из самих задач
+     * @throws Первое исключение, выброшенное задачей с прошлого вызова wait()
+     */
+    void wait();
+
+    std::size_t threadCount() const { return workers.size(); }
+
+    // Число задач, выполненных не тем потоком, в чью очередь они были поставлены
+    std::size_t stolenCount() const { return stolen.load(std::memory_order_relaxed); }
+
+private:
+    struct alignas(64) Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<std::size_t> queued{ 0 };       // Задачи в очередях
+    std::atomic<std::size_t> unfinished{ 0 };   // Поставленные и ещё не завершённые задачи
+    std::atomic<std::size_t> nextQueue{ 0 };    // Очередь для следующей внешней задачи
+    std::atomic<std::size_t> stolen{ 0 };
+    std::atomic<bool> stopping{ false };
+    std::mutex sleepMutex;
+    std::condition_variable wake;               // Будит простаивающие потоки
+    std::condition_variable done;               // Сообщает wait() о завершении задач
+    std::exception_ptr firstError;              // Защищается sleepMutex
+
+    void workerLoop(std::size_t index);
+    bool popLocal(std::size_t index, Task& task);
+    bool steal(std::size_t index, Task& task);
+    void execute(Task& task);
+};
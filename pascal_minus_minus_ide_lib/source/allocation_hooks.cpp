@@ -0,0 +1,75 @@
+/**
+ * @file allocation_hooks.cpp
+ * @brief Замена глобальных operator new/delete для AllocationProfiler
+ *
+ * Файл не входит в библиотеку: его добавляют в исполняемый файл, которому нужен
+ * профиль выделений. Перед каждым блоком хранится заголовок с размером и меткой
+ * выделения, чтобы освобождение вернулось в ту же ячейку профиля. Выровненные
+ * формы (std::align_val_t) не заменяются и идут мимо профиля.
+ */
+
+#include "allocation_profiler.h"
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+struct alignas(16) BlockHeader {
+    std::size_t size;
+    std::uint32_t tag;
+};
+
+static_assert(sizeof(BlockHeader) % alignof(std::max_align_t) == 0, "Заголовок нарушает выравнивание блока");
+
+void* allocateBlock(std::size_t size) {
+    void* block = std::malloc(sizeof(BlockHeader) + size);
+    if (!block)
+        return nullptr;
+    BlockHeader* header = static_cast<BlockHeader*>(block);
+    header->size = size;
+    header->tag = AllocationProfiler::onAllocate(size);
+    return header + 1;
+}
+
+void* allocateOrThrow(std::size_t size) {
+    for (;;) {
+        if (void* block = allocateBlock(size))
+            return block;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+void* allocateOrNull(std::size_t size) noexcept {
+    try {
+        return allocateOrThrow(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void freeBlock(void* pointer) noexcept {
+    if (!pointer)
+        return;
+    BlockHeader* header = static_cast<BlockHeader*>(pointer) - 1;
+    AllocationProfiler::onFree(header->tag, header->size);
+    std::free(header);
+}
+
+[[maybe_unused]] const bool installed = (AllocationProfiler::markHooksInstalled(), true);
+
+} // namespace
+
+void* operator new(std::size_t size) { return allocateOrThrow(size); }
+void* operator new[](std::size_t size) { return allocateOrThrow(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocateOrNull(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocateOrNull(size); }
+
+void operator delete(void* pointer) noexcept { freeBlock(pointer); }
+void operator delete[](void* pointer) noexcept { freeBlock(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { freeBlock(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { freeBlock(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { freeBlock(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { freeBlock(pointer); }
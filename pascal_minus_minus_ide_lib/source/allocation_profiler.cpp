@@ -0,0 +1,233 @@
+#include "allocation_profiler.h"
+#include "node_profiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+// Метка выделения: поколение профилировщика в старших 24 битах, ячейка в младших 8
+constexpr std::uint32_t UNTRACKED = 0;
+
+// Состояние потока; инициализируется константой, чтобы обращение из operator new не требовало инициализации
+thread_local AllocationProfiler::ExecutionState state{};
+
+std::atomic<std::uint32_t> nextGeneration{ 1 };
+std::atomic<bool> hooks{ false };
+
+// Выделения на время записи в таблицу операторов не учитываются
+struct Suppress {
+    Suppress() { ++state.suppressed; }
+    ~Suppress() { --state.suppressed; }
+};
+
+const char* phaseName(std::size_t phase) {
+    static const char* const names[ALLOCATION_PHASE_COUNT] = {
+        "прочее", "лексический анализ", "синтаксический анализ", "выполнение"
+    };
+    return names[phase];
+}
+
+const char* siteName(std::size_t site) {
+    static const char* const names[ALLOCATION_SITE_COUNT] = {
+        "прочее", "токены", "AST", "символы", "постфиксная форма", "строки Value"
+    };
+    return names[site];
+}
+
+} // namespace
+
+std::atomic<AllocationProfiler*> AllocationProfiler::active{ nullptr };
+
+AllocationProfiler::PhaseScope::PhaseScope(AllocationPhase phase) : saved(state.phase) {
+    state.phase = phase;
+}
+
+AllocationProfiler::PhaseScope::~PhaseScope() {
+    state.phase = saved;
+}
+
+void AllocationProfiler::SiteScope::enter(AllocationSite site) {
+    entered = true;
+    saved = state.site;
+    state.site = site;
+}
+
+void AllocationProfiler::SiteScope::leave() {
+    state.site = saved;
+}
+
+void AllocationProfiler::StatementScope::enter() {
+    parent = state.statement;
+    state.statement = this;
+    allocationsAtStart = state.allocations;
+    bytesAtStart = state.bytes;
+}
+
+void AllocationProfiler::StatementScope::leave() {
+    state.statement = parent;
+    std::uint64_t allocations = state.allocations - allocationsAtStart;
+    std::uint64_t bytes = state.bytes - bytesAtStart;
+    if (parent) {
+        parent->nestedAllocations += allocations;
+        parent->nestedBytes += bytes;
+    }
+    profiler->record(*this, allocations - nestedAllocations, bytes - nestedBytes);
+}
+
+void AllocationProfiler::swapExecutionState(ExecutionState& other) noexcept {
+    std::swap(state, other);
+}
+
+AllocationProfiler::AllocationProfiler() : generation(nextGeneration.fetch_add(1) & 0xFFFFFF) {}
+
+AllocationProfiler::~AllocationProfiler() {
+    stop();
+}
+
+void AllocationProfiler::start() {
+    AllocationProfiler* expected = nullptr;
+    if (!active.compare_exchange_strong(expected, this) && expected != this)
+        throw std::logic_error("Уже активен другой профилировщик выделений");
+}
+
+void AllocationProfiler::stop() {
+    AllocationProfiler* expected = this;
+    active.compare_exchange_strong(expected, nullptr);
+}
+
+bool AllocationProfiler::hooksInstalled() {
+    return hooks.load(std::memory_order_relaxed);
+}
+
+void AllocationProfiler::markHooksInstalled() {
+    hooks.store(true, std::memory_order_relaxed);
+}
+
+void AllocationProfiler::charge(Cell& cell, std::size_t size) {
+    cell.allocations.fetch_add(1, std::memory_order_relaxed);
+    cell.bytes.fetch_add(size, std::memory_order_relaxed);
+    std::int64_t live = cell.liveBytes.fetch_add(static_cast<std::int64_t>(size), std::memory_order_relaxed)
+        + static_cast<std::int64_t>(size);
+    std::int64_t peak = cell.peakLiveBytes.load(std::memory_order_relaxed);
+    while (live > peak && !cell.peakLiveBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+}
+
+void AllocationProfiler::release(Cell& cell, std::size_t size) {
+    cell.liveBytes.fetch_sub(static_cast<std::int64_t>(size), std::memory_order_relaxed);
+}
+
+std::uint32_t AllocationProfiler::onAllocate(std::size_t size) {
+    AllocationProfiler* profiler = active.load(std::memory_order_acquire);
+    if (!profiler || state.suppressed)
+        return UNTRACKED;
+    std::size_t phase = static_cast<std::size_t>(state.phase);
+    std::size_t cell = phase * ALLOCATION_SITE_COUNT + static_cast<std::size_t>(state.site);
+    charge(profiler->cells[cell], size);
+    charge(profiler->phases[phase], size);
+    charge(profiler->overall, size);
+    ++state.allocations;
+    state.bytes += size;
+    return profiler->generation << 8 | static_cast<std::uint32_t>(cell);
+}
+
+void AllocationProfiler::onFree(std::uint32_t tag, std::size_t size) {
+    if (tag == UNTRACKED)
+        return;
+    // Освобождения после stop() и блоки прежних профилировщиков не учитываются
+    AllocationProfiler* profiler = active.load(std::memory_order_acquire);
+    if (!profiler || tag >> 8 != profiler->generation)
+        return;
+    std::size_t cell = tag & 0xFF;
+    release(profiler->cells[cell], size);
+    release(profiler->phases[cell / ALLOCATION_SITE_COUNT], size);
+    release(profiler->overall, size);
+}
+
+void AllocationProfiler::record(const StatementScope& scope, std::uint64_t allocations, std::uint64_t bytes) {
+    Suppress suppress;
+    std::lock_guard<std::mutex> lock(mutex);
+    StatementAllocations& entry = statementTable[scope.node];
+    entry.node = scope.node;
+    ++entry.executions;
+    entry.allocations += allocations;
+    entry.bytes += bytes;
+}
+
+AllocationStats AllocationProfiler::snapshot(const Cell& cell) {
+    AllocationStats stats;
+    stats.allocations = cell.allocations.load(std::memory_order_relaxed);
+    stats.bytes = cell.bytes.load(std::memory_order_relaxed);
+    stats.liveBytes = cell.liveBytes.load(std::memory_order_relaxed);
+    stats.peakLiveBytes = cell.peakLiveBytes.load(std::memory_order_relaxed);
+    return stats;
+}
+
+AllocationStats AllocationProfiler::stats(AllocationPhase phase, AllocationSite site) const {
+    return snapshot(cells[static_cast<std::size_t>(phase) * ALLOCATION_SITE_COUNT + static_cast<std::size_t>(site)]);
+}
+
+AllocationStats AllocationProfiler::stats(AllocationPhase phase) const {
+    return snapshot(phases[static_cast<std::size_t>(phase)]);
+}
+
+AllocationStats AllocationProfiler::total() const {
+    return snapshot(overall);
+}
+
+std::vector<StatementAllocations> AllocationProfiler::statements() const {
+    std::vector<StatementAllocations> result;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        result.reserve(statementTable.size());
+        for (const auto& entry : statementTable)
+            result.push_back(entry.second);
+    }
+    std::sort(result.begin(), result.end(), [](const StatementAllocations& a, const StatementAllocations& b) {
+        if (a.allocations != b.allocations)
+            return a.allocations > b.allocations;
+        return a.node->line != b.node->line ? a.node->line < b.node->line : a.node->column < b.node->column;
+    });
+    return result;
+}
+
+void AllocationProfiler::writeReport(std::ostream& out, std::size_t top) const {
+    if (!hooksInstalled())
+        out << "Замена operator new/delete не скомпонована: выделения не учитываются\n";
+
+    // Заголовок выровнен вручную: printf считает байты, а не буквы кириллицы
+    out << "   выделений          байт    пик живых  фаза / структура\n";
+    char line[96];
+    auto row = [&](const AllocationStats& stats, const std::string& name) {
+        std::snprintf(line, sizeof(line), "%12llu %13llu %12lld  ", static_cast<unsigned long long>(stats.allocations),
+                      static_cast<unsigned long long>(stats.bytes), static_cast<long long>(stats.peakLiveBytes));
+        out << line << name << '\n';
+    };
+    for (std::size_t phase = 0; phase < ALLOCATION_PHASE_COUNT; ++phase) {
+        AllocationStats phaseStats = snapshot(phases[phase]);
+        if (phaseStats.allocations == 0)
+            continue;
+        row(phaseStats, phaseName(phase));
+        for (std::size_t site = 0; site < ALLOCATION_SITE_COUNT; ++site) {
+            AllocationStats siteStats = snapshot(cells[phase * ALLOCATION_SITE_COUNT + site]);
+            if (siteStats.allocations != 0)
+                row(siteStats, std::string("  ") + siteName(site));
+        }
+    }
+    row(total(), "всего");
+
+    std::vector<StatementAllocations> list = statements();
+    if (list.empty())
+        return;
+    if (top == 0 || top > list.size())
+        top = list.size();
+    out << "\n  выполнений    выделений          байт  на выполнение  оператор\n";
+    for (std::size_t i = 0; i < top && list[i].allocations > 0; ++i) {
+        const StatementAllocations& entry = list[i];
+        std::snprintf(line, sizeof(line), "%12llu %12llu %13llu %14.2f  ", static_cast<unsigned long long>(entry.executions),
+                      static_cast<unsigned long long>(entry.allocations), static_cast<unsigned long long>(entry.bytes),
+                      static_cast<double>(entry.allocations) / entry.executions);
+        out << line << NodeProfiler::label(*entry.node) << '\n';
+    }
+}
@@ -0,0 +1,159 @@
+#include "batch_runner.h"
+#include "work_stealing_pool.h"
+#include "error_reporter.h"
+#include "interpreter.h"
+#include "input_source.h"
+#include "output_sink.h"
+#include "parser.h"
+#include "lexer.h"
+#include "run_arena.h"
+#include "trace_recorder.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string readFile(const fs::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        throw std::runtime_error("Не удалось открыть файл: " + path.string());
+    std::ostringstream text;
+    text << file.rdbuf();
+    return text.str();
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+BatchJob loadBatchProgram(const std::string& path) {
+    fs::path input = path;
+    input.replace_extension(".in");
+    return { path, readFile(path), fs::exists(input) ? readFile(input) : std::string() };
+}
+
+std::vector<BatchJob> loadBatchDirectory(const std::string& directory) {
+    std::error_code error;
+    fs::directory_iterator it(directory, error);
+    if (error)
+        throw std::runtime_error("Не удалось открыть каталог: " + directory);
+
+    std::vector<fs::path> programs;
+    for (const auto& entry : it) {
+        if (entry.is_regular_file() && entry.path().extension() == ".pas")
+            programs.push_back(entry.path());
+    }
+    std::sort(programs.begin(), programs.end());
+
+    std::vector<BatchJob> jobs;
+    jobs.reserve(programs.size());
+    for (const auto& program : programs)
+        jobs.push_back(loadBatchProgram(program.string()));
+    return jobs;
+}
+
+std::vector<BatchJob> loadBatchManifest(const std::string& manifest) {
+    std::istringstream lines(readFile(manifest));
+    fs::path base = fs::path(manifest).parent_path();
+
+    std::vector<BatchJob> jobs;
+    std::string line;
+    while (std::getline(lines, line)) {
+        std::istringstream fields(line);
+        std::string program, input;
+        if (!(fields >> program) || program[0] == '#')
+            continue;
+        fields >> input;
+        fs::path programPath = base / program;
+        jobs.push_back({ programPath.string(), readFile(programPath), input.empty() ? std::string() : readFile(base / input) });
+    }
+    return jobs;
+}
+
+void BatchRunner::setMetrics(MetricsRegistry* registry) {
+    metrics = registry ? std::make_shared<InterpreterMetrics>(*registry) : nullptr;
+}
+
+BatchResult BatchRunner::runJob(const BatchJob& job, double timeLimitSeconds, std::size_t memoryLimitBytes,
+                                TraceRecorder* tracer, const InterpreterMetrics* metrics) {
+    BatchResult result;
+    result.name = job.name;
+    auto start = std::chrono::steady_clock::now();
+    TraceRecorder::Span jobSpan(tracer, "job", job.name);
+
+    // Дерево и временные значения задания живут в арене потока и освобождаются разом
+    thread_local RunArena arena;
+    std::ostringstream diagnostics;
+    {
+        auto reporter = std::make_shared<ErrorReporter>(diagnostics);
+        auto output = std::make_shared<MemoryOutputSink>();
+        Interpreter interpreter(reporter, output, std::make_shared<MemoryInputSource>(job.input));
+        interpreter.setArena(&arena);
+        interpreter.setMemoryLimit(memoryLimitBytes);
+        interpreter.setTracer(tracer);
+        interpreter.setMetrics(metrics);
+        if (timeLimitSeconds > 0)
+            interpreter.setDeadline(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(timeLimitSeconds)));
+        try {
+            std::vector<Token> tokens;
+            {
+                TraceRecorder::Span phase(tracer, "phase", "лексический анализ");
+                tokens = Lexer(job.source, reporter, interpreter.getNames()).tokenize();
+            }
+            std::shared_ptr<ASTNode> program;
+            {
+                TraceRecorder::Span phase(tracer, "phase", "синтаксический анализ");
+                Parser parser(std::move(tokens), reporter);
+                parser.setArena(&arena);
+                program = parser.parse();
+            }
+            interpreter.run(program);
+            result.success = !reporter->hasErrors();
+        } catch (const std::exception& e) {
+            result.error = e.what();
+        }
+        reporter->flush();
+        result.output = output->str();
+        result.memoryBytes = interpreter.getMemoryAccount().current();
+        result.peakMemoryBytes = interpreter.getMemoryAccount().peak();
+    }
+    arena.reset();
+    result.diagnostics = diagnostics.str();
+    result.seconds = secondsSince(start);
+    jobSpan.setArg("success", result.success);
+    return result;
+}
+
+std::vector<BatchResult> BatchRunner::run(const std::vector<BatchJob>& jobs) {
+    std::vector<BatchResult> results(jobs.size());
+    auto start = std::chrono::steady_clock::now();
+    WorkStealingPool pool(threads);
+    for (std::size_t i = 0; i < jobs.size(); ++i)
+        pool.submit([this, &jobs, &results, i]() { results[i] = runJob(jobs[i], timeLimitSeconds, memoryLimitBytes, tracer, metrics.get()); });
+    pool.wait();
+
+    summary = BatchSummary();
+    summary.programs = jobs.size();
+    summary.threads = pool.threadCount();
+    summary.stolen = pool.stolenCount();
+    summary.wallSeconds = secondsSince(start);
+    for (const auto& result : results) {
+        if (result.success)
+            ++summary.succeeded;
+        summary.jobSeconds += result.seconds;
+    }
+    summary.failed = summary.programs - summary.succeeded;
+    if (summary.wallSeconds > 0)
+        summary.programsPerSecond = summary.programs / summary.wallSeconds;
+    return results;
+}
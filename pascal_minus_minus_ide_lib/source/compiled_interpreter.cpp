@@ -0,0 +1,76 @@
+#include "compiled_interpreter.h"
+#include <iostream>
+#include <stdexcept>
+
+CompiledInterpreter::CompiledInterpreter() : CompiledInterpreter(nullptr) {}
+
+CompiledInterpreter::CompiledInterpreter(shared_ptr<IErrorReporter> reporter)
+    : errorReporter(reporter ? reporter : std::make_shared<ErrorReporter>()), names(std::make_shared<NameTable>()) {}
+
+void CompiledInterpreter::run(const shared_ptr<ASTNode>& ast) {
+    if (!ast) {
+        errorReporter->reportWarning("Пустая программа", 0, 0);
+        return;
+    }
+    execute(*compile(ast));
+}
+
+shared_ptr<const CompiledProgram> CompiledInterpreter::compile(const shared_ptr<ASTNode>& ast) const {
+    return CompiledProgram::compile(ast, names, symbols);
+}
+
+void CompiledInterpreter::setNames(shared_ptr<NameTable> table) {
+    if (!table)
+        throw std::invalid_argument("Интерпретатор без таблицы имён");
+    names = std::move(table);
+}
+
+void CompiledInterpreter::execute(const CompiledProgram& program) {
+    ExecutionContext context(program, std::cin, std::cout, errorReporter);
+    for (const auto& entry : symbols) {
+        if (context.isDeclared(entry.first))
+            context.setVariable(entry.first, entry.second);
+    }
+    // Переменные, объявленные до ошибки, остаются видны (как в Interpreter)
+    try {
+        program.run(context);
+    } catch (...) {
+        for (auto& entry : context.getAllSymbols())
+            symbols[entry.first] = std::move(entry.second);
+        errorReporter->flush();
+        throw;
+    }
+    for (auto& entry : context.getAllSymbols())
+        symbols[entry.first] = std::move(entry.second);
+    errorReporter->flush();
+}
+
+Value CompiledInterpreter::evaluate(const string& expression) {
+    Value result;
+    result.type = ValueType::String;
+    result.stringValue = "Not implemented: " + expression;
+    return result;
+}
+
+bool CompiledInterpreter::isDeclared(const string& name) const {
+    return symbols.count(name) != 0;
+}
+
+Value CompiledInterpreter::getVariable(const string& name) const {
+    auto it = symbols.find(name);
+    if (it == symbols.end())
+        throw std::runtime_error("Неизвестная переменная: " + name);
+    return it->second;
+}
+
+void CompiledInterpreter::setVariable(const string& name, const Value& value) {
+    symbols[name] = value;
+}
+
+void CompiledInterpreter::clearSymbols() {
+    symbols.clear();
+}
+
+const map<string, Value>& CompiledInterpreter::getAllSymbols() const {
+    return symbols;
+}
@@ -0,0 +1,851 @@
+#include "compiled_program.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+using Frame = ExecutionContext;
+using Statement = CompiledProgram::Statement;
+
+template <typename T>
+using Fn = std::function<T(Frame&)>;
+
+// Максимальное число итераций цикла (как в Interpreter)
+constexpr int MAX_ITERATIONS = 10000;
+
+// Скомпилированное выражение: заполнена только функция, соответствующая типу
+struct Expr {
+    ValueType type = ValueType::Integer;
+    Fn<int> integer;
+    Fn<double> real;
+    Fn<bool> boolean;
+    Fn<std::string> text;
+};
+
+Expr makeInt(Fn<int> fn) { Expr e; e.type = ValueType::Integer; e.integer = std::move(fn); return e; }
+Expr makeReal(Fn<double> fn) { Expr e; e.type = ValueType::Real; e.real = std::move(fn); return e; }
+Expr makeBool(Fn<bool> fn) { Expr e; e.type = ValueType::Boolean; e.boolean = std::move(fn); return e; }
+Expr makeString(Fn<std::string> fn) { Expr e; e.type = ValueType::String; e.text = std::move(fn); return e; }
+
+void report(Frame& f, const std::string& message) { f.errors->reportError(message, 0, 0); }
+void warn(Frame& f, const std::string& message) { f.errors->reportWarning(message, 0, 0); }
+
+// Значение выражения в виде Value (для вывода и общих преобразований)
+Fn<Value> boxed(const Expr& e) {
+    switch (e.type) {
+    case ValueType::Integer: return [fn = e.integer](Frame& f) { return Value(fn(f)); };
+    case ValueType::Real: return [fn = e.real](Frame& f) { return Value(fn(f)); };
+    case ValueType::Boolean: return [fn = e.boolean](Frame& f) { return Value(fn(f)); };
+    default: return [fn = e.text](Frame& f) { return Value(fn(f)); };
+    }
+}
+
+// Числовое значение операнда так, как его видит PostfixCalculator:
+// у нелогических и нестроковых операндов поле realValue равно 0.0
+Fn<double> numeric(const Expr& e) {
+    switch (e.type) {
+    case ValueType::Integer: return [fn = e.integer](Frame& f) { return static_cast<double>(fn(f)); };
+    case ValueType::Real: return e.real;
+    default: return [value = boxed(e)](Frame& f) { value(f); return 0.0; };
+    }
+}
+
+// Выражение, которое после вычисления операндов завершается ошибкой
+// (операция, недопустимая для статически известных типов операндов)
+Expr failing(std::string message, const std::vector<Expr>& operands = {}) {
+    std::vector<Fn<Value>> values;
+    for (const auto& operand : operands)
+        values.push_back(boxed(operand));
+    return makeInt([message = std::move(message), values = std::move(values)](Frame& f) -> int {
+        for (const auto& value : values)
+            value(f);
+        throw std::runtime_error(message);
+    });
+}
+
+// Операнды вычисляются слева направо, как в постфиксной записи
+template <typename R, typename A, typename B, typename Op>
+Fn<R> combine(Fn<A> a, Fn<B> b, Op op) {
+    return [a = std::move(a), b = std::move(b), op](Frame& f) -> R {
+        A x = a(f);
+        B y = b(f);
+        return op(x, y);
+    };
+}
+
+template <typename T>
+Fn<bool> compare(const std::string& op, Fn<T> a, Fn<T> b) {
+    if (op == "=") return combine<bool, T, T>(std::move(a), std::move(b), std::equal_to<T>());
+    if (op == "<>") return combine<bool, T, T>(std::move(a), std::move(b), std::not_equal_to<T>());
+    if (op == "<") return combine<bool, T, T>(std::move(a), std::move(b), std::less<T>());
+    if (op == "<=") return combine<bool, T, T>(std::move(a), std::move(b), std::less_equal<T>());
+    if (op == ">") return combine<bool, T, T>(std::move(a), std::move(b), std::greater<T>());
+    return combine<bool, T, T>(std::move(a), std::move(b), std::greater_equal<T>());
+}
+
+bool isNumeric(ValueType type) { return type == ValueType::Integer || type == ValueType::Real; }
+
+bool isComparison(const std::string& op) {
+    return op == "=" || op == "<>" || op == "<" || op == "<=" || op == ">" || op == ">=";
+}
+
+// Бинарная операция, специализированная под типы операндов (семантика PostfixCalculator)
+Expr binary(const std::string& op, const Expr& a, const Expr& b) {
+    bool integers = a.type == ValueType::Integer && b.type == ValueType::Integer;
+
+    if (op == "+" || op == "-" || op == "*") {
+        if (integers) {
+            if (op == "+") return makeInt(combine<int, int, int>(a.integer, b.integer, std::plus<int>()));
+            if (op == "-") return makeInt(combine<int, int, int>(a.integer, b.integer, std::minus<int>()));
+            return makeInt(combine<int, int, int>(a.integer, b.integer, std::multiplies<int>()));
+        }
+        if (op == "+") return makeReal(combine<double, double, double>(numeric(a), numeric(b), std::plus<double>()));
+        if (op == "-") return makeReal(combine<double, double, double>(numeric(a), numeric(b), std::minus<double>()));
+        return makeReal(combine<double, double, double>(numeric(a), numeric(b), std::multiplies<double>()));
+    }
+    if (op == "/")
+        return makeReal(combine<double, double, double>(numeric(a), numeric(b), std::divides<double>()));
+    if (op == "div" || op == "mod") {
+        if (!integers)
+            return failing("Оператор '" + op + "' требует целочисленных операндов", { a, b });
+        if (op == "div") {
+            return makeInt(combine<int, int, int>(a.integer, b.integer, [](int x, int y) {
+                if (y == 0)
+                    throw std::runtime_error("Деление на ноль");
+                return x / y;
+            }));
+        }
+        return makeInt(combine<int, int, int>(a.integer, b.integer, [](int x, int y) {
+            if (y == 0)
+                throw std::runtime_error("Деление на ноль в операции mod");
+            return x % y;
+        }));
+    }
+    if (isComparison(op)) {
+        if (integers)
+            return makeBool(compare<int>(op, a.integer, b.integer));
+        if (isNumeric(a.type) && isNumeric(b.type))
+            return makeBool(compare<double>(op, numeric(a), numeric(b)));
+        if (a.type == ValueType::Boolean && b.type == ValueType::Boolean) {
+            if (op != "=" && op != "<>")
+                return failing("Операторы <, <=, >, >= не применимы к логическим значениям", { a, b });
+            return makeBool(compare<bool>(op, a.boolean, b.boolean));
+        }
+        if (a.type == ValueType::String && b.type == ValueType::String)
+            return makeBool(compare<std::string>(op, a.text, b.text));
+        return failing("Несовместимые типы для сравнения", { a, b });
+    }
+    if (op == "and" || op == "or") {
+        if (a.type != ValueType::Boolean || b.type != ValueType::Boolean)
+            return failing("Логические операторы требуют логических операндов", { a, b });
+        // Без сокращённого вычисления: правый операнд вычисляется всегда, как в постфиксной записи
+        if (op == "and")
+            return makeBool(combine<bool, bool, bool>(a.boolean, b.boolean, std::logical_and<bool>()));
+        return makeBool(combine<bool, bool, bool>(a.boolean, b.boolean, std::logical_or<bool>()));
+    }
+    return failing("Неизвестный токен: " + op, { a, b });
+}
+
+Expr unary(const std::string& op, const Expr& a) {
+    if (op == "-") {
+        if (a.type == ValueType::Integer)
+            return makeInt([fn = a.integer](Frame& f) { return -fn(f); });
+        if (a.type == ValueType::Real)
+            return makeReal([fn = a.real](Frame& f) { return -fn(f); });
+        return failing("Унарный минус применим только к числам", { a });
+    }
+    if (op == "not") {
+        if (a.type != ValueType::Boolean)
+            return failing("Оператор 'not' требует логического операнда", { a });
+        return makeBool([fn = a.boolean](Frame& f) { return !fn(f); });
+    }
+    // Прочие унарные узлы постфиксная форма передаёт без изменений
+    return a;
+}
+
+// Вычисление выражения верхнего уровня. Как и Interpreter::evaluateUsingPostfix, ошибка
+// сообщается, а результатом считается Value() (целый ноль); этот случай возвращает false
+template <typename T>
+bool tryEvaluate(const Fn<T>& fn, Frame& f, T& out) {
+    try {
+        out = fn(f);
+        return true;
+    } catch (const std::exception& e) {
+        report(f, std::string("Ошибка вычисления выражения: ") + e.what());
+        return false;
+    }
+}
+
+// Поле значения заданного типа и значение Value(), приведённое к этому типу
+template <typename T> T& field(Value& v);
+template <> int& field<int>(Value& v) { return v.intValue; }
+template <> double& field<double>(Value& v) { return v.realValue; }
+template <> bool& field<bool>(Value& v) { return v.boolValue; }
+template <> std::string& field<std::string>(Value& v) { return v.stringValue; }
+
+template <typename T> T failedValue();
+template <> int failedValue<int>() { return 0; }
+template <> double failedValue<double>() { return 0.0; }
+template <> bool failedValue<bool>() { return false; }
+template <> std::string failedValue<std::string>() { return Value().toString(); }
+
+// Запись в слот того же статического типа
+template <typename T>
+Statement storeTyped(size_t slot, Fn<T> fn) {
+    return [slot, fn = std::move(fn)](Frame& f) {
+        T value;
+        if (!tryEvaluate(fn, f, value))
+            value = failedValue<T>();
+        field<T>(f.slots[slot]) = std::move(value);
+    };
+}
+
+// Присваивание с преобразованием к типу переменной (как в Interpreter::executeAssignment)
+void assignConverted(Frame& f, Value& target, ValueType type, Value value) {
+    if (value.type != type) {
+        try {
+            switch (type) {
+            case ValueType::Integer: value = Value(value.toInt()); break;
+            case ValueType::Real: value = Value(value.toReal()); break;
+            case ValueType::Boolean: value = Value(value.toBool()); break;
+            case ValueType::String: value = Value(value.toString()); break;
+            }
+        } catch (const std::exception& e) {
+            report(f, "Ошибка преобразования типов: " + std::string(e.what()));
+            throw;
+        }
+    }
+    target = std::move(value);
+}
+
+// Значение константы: как и Interpreter, берётся поле объявленного типа,
+// поэтому при несовпадении типов получается значение по умолчанию
+Value projectField(const Value& value, ValueType type) {
+    switch (type) {
+    case ValueType::Integer: return Value(value.intValue);
+    case ValueType::Real: return Value(value.realValue);
+    case ValueType::Boolean: return Value(value.boolValue);
+    default: return Value(value.stringValue);
+    }
+}
+
+bool decodeType(std::string typeName, ValueType& type) {
+    std::transform(typeName.begin(), typeName.end(), typeName.begin(), ::tolower);
+    if (typeName == "real" || typeName == "double") type = ValueType::Real;
+    else if (typeName == "integer") type = ValueType::Integer;
+    else if (typeName == "boolean") type = ValueType::Boolean;
+    else if (typeName == "string") type = ValueType::String;
+    else return false;
+    return true;
+}
+
+std::string normalizedTypeName(const std::shared_ptr<ASTNode>& node) {
+    std::string typeName = node->value;
+    std::transform(typeName.begin(), typeName.end(), typeName.begin(), ::tolower);
+    return typeName;
+}
+
+/**
+ * Компилятор AST в замыкания
+ *
+ * Области видимости существуют только во время компиляции: каждое объявление получает
+ * слот в ExecutionContext::slots, а обращения к переменной связываются с этим слотом
+ * и его типом. Все замыкания захватывают только неизменяемые данные.
+ */
+class ClosureCompiler {
+public:
+    struct Binding {
+        size_t slot;
+        ValueType type;
+    };
+
+    // Входные переменные объявляются в глобальной области до начала компиляции
+    ClosureCompiler(std::shared_ptr<NameTable> names, const map<string, Value>& inputs)
+        : nextSlot(0), names(std::move(names)) {
+        scopes.emplace_back();
+        for (const auto& input : inputs) {
+            size_t slot = nextSlot++;
+            scopes[0][this->names->intern(input.first)] = Binding{ slot, input.second.type };
+            inputValues.emplace_back(slot, input.second);
+        }
+    }
+
+    size_t slotCount() const { return nextSlot; }
+
+    // Глобальные переменные с типами после последнего объявления
+    const unordered_map<NameId, Binding>& globals() const { return scopes[0]; }
+
+    vector<std::pair<size_t, Value>> inputValues;  // Входные значения: слот -> значение
+
+    Statement compileStatement(const std::shared_ptr<ASTNode>& node) {
+        switch (node->type) {
+        case ASTNodeType::Program:
+        case ASTNodeType::Block:
+        case ASTNodeType::ConstSection:
+        case ASTNodeType::VarSection:
+            return compileSequence(node);
+        case ASTNodeType::ConstDecl:
+            return compileConstDecl(node);
+        case ASTNodeType::VarDecl:
+            return compileVarDecl(node);
+        case ASTNodeType::Assignment:
+            return compileAssignment(node);
+        case ASTNodeType::If:
+            return compileIf(node);
+        case ASTNodeType::While:
+            return compileWhile(node);
+        case ASTNodeType::ForLoop:
+            return compileFor(node);
+        case ASTNodeType::Write:
+        case ASTNodeType::Writeln:
+            return compileWrite(node);
+        case ASTNodeType::Read:
+        case ASTNodeType::Readln:
+            return compileRead(node);
+        case ASTNodeType::Number:
+        case ASTNodeType::Real:
+        case ASTNodeType::Boolean:
+        case ASTNodeType::String:
+        case ASTNodeType::Identifier:
+        case ASTNodeType::BinOp:
+        case ASTNodeType::UnOp:
+            // Выражение на месте оператора ничего не делает
+            return nullptr;
+        case ASTNodeType::Expression:
+        default: {
+            std::string message = "Неизвестный оператор типа: " + std::to_string(static_cast<int>(node->type));
+            return [message](Frame& f) {
+                report(f, message);
+                throw std::runtime_error("Неизвестный оператор");
+            };
+        }
+        }
+    }
+
+private:
+    std::vector<unordered_map<NameId, Binding>> scopes;  // Области видимости времени компиляции
+    size_t nextSlot;                                     // Первый свободный слот
+    std::shared_ptr<NameTable> names;                    // Таблица имён лексера, разобравшего дерево
+
+    // Номера дерева берутся как есть; узлы без номера (созданные вручную) нумеруются по тексту.
+    // Необъявленное имя такого узла не получает номера, и resolve его не находит
+    NameId nameOf(const std::shared_ptr<ASTNode>& node) { return names->resolve(node->name, node->value); }
+    NameId findName(const std::shared_ptr<ASTNode>& node) const {
+        return node->name != NO_NAME ? node->name : names->find(node->value);
+    }
+
+    const Binding* resolve(NameId name) const {
+        for (auto scope = scopes.rbegin(); scope != scopes.rend(); ++scope) {
+            auto it = scope->find(name);
+            if (it != scope->end())
+                return &it->second;
+        }
+        return nullptr;
+    }
+
+    bool isGlobalScope() const { return scopes.size() == 1; }
+
+    // Объявление в текущей области; повторное объявление в той же области переиспользует слот
+    Binding declare(NameId name, ValueType type) {
+        auto& scope = scopes.back();
+        auto it = scope.find(name);
+        size_t slot = it != scope.end() ? it->second.slot : nextSlot++;
+        scope[name] = Binding{ slot, type };
+        return scope[name];
+    }
+
+    static Statement nothing() { return [](Frame&) {}; }
+
+    Statement compileSequence(const std::shared_ptr<ASTNode>& node) {
+        std::vector<Statement> body;
+        for (const auto& child : node->children) {
+            if (Statement statement = compileStatement(child))
+                body.push_back(std::move(statement));
+        }
+        if (body.size() == 1)
+            return body.front();
+        return [body = std::move(body)](Frame& f) {
+            for (const auto& statement : body)
+                statement(f);
+        };
+    }
+
+    Statement compileConstDecl(const std::shared_ptr<ASTNode>& node) {
+        std::string typeName = normalizedTypeName(node->children[0]);
+        Fn<Value> value = boxed(compileExpression(node->children[1]));
+        ValueType type;
+        if (!decodeType(typeName, type)) {
+            return [typeName, value](Frame& f) {
+                Value ignored;
+                tryEvaluate(value, f, ignored);
+                throw std::runtime_error("Неизвестный тип константы: " + typeName);
+            };
+        }
+        bool global = isGlobalScope();
+        size_t slot = declare(nameOf(node), type).slot;
+        return [slot, type, global, value](Frame& f) {
+            Value result;
+            if (!tryEvaluate(value, f, result))
+                result = Value();
+            f.slots[slot] = projectField(result, type);
+            if (global)
+                f.declared[slot] = 1;
+        };
+    }
+
+    Statement compileVarDecl(const std::shared_ptr<ASTNode>& node) {
+        std::string typeName = normalizedTypeName(node->children[0]);
+        ValueType type;
+        if (!decodeType(typeName, type)) {
+            return [typeName](Frame& f) {
+                std::string message = "Неизвестный тип переменной: " + typeName;
+                report(f, message);
+                report(f, "Ошибка при объявлении переменной: " + message);
+                throw std::runtime_error(message);
+            };
+        }
+        Value initial;
+        switch (type) {
+        case ValueType::Integer: initial = Value(0); break;
+        case ValueType::Real: initial = Value(0.0); break;
+        case ValueType::Boolean: initial = Value(false); break;
+        case ValueType::String: initial = Value(std::string()); break;
+        }
+        bool global = isGlobalScope();
+        size_t slot = declare(nameOf(node), type).slot;
+        return [slot, global, initial](Frame& f) {
+            f.slots[slot] = initial;
+            if (global)
+                f.declared[slot] = 1;
+        };
+    }
+
+    Statement compileAssignment(const std::shared_ptr<ASTNode>& node) {
+        const auto& target = node->children[0];
+        const Binding* binding = resolve(findName(target));
+        if (!binding) {
+            std::string message = "Переменная не объявлена: " + target->value;
+            return [message](Frame& f) {
+                report(f, message);
+                report(f, "Ошибка при выполнении присваивания: " + message);
+                throw std::runtime_error(message);
+            };
+        }
+
+        size_t slot = binding->slot;
+        ValueType type = binding->type;
+        Expr value = compileExpression(node->children[1]);
+        if (value.type == type) {
+            switch (type) {
+            case ValueType::Integer: return storeTyped<int>(slot, value.integer);
+            case ValueType::Real: return storeTyped<double>(slot, value.real);
+            case ValueType::Boolean: return storeTyped<bool>(slot, value.boolean);
+            case ValueType::String: return storeTyped<std::string>(slot, value.text);
+            }
+        }
+        if (type == ValueType::Real && value.type == ValueType::Integer)
+            return storeTyped<double>(slot, numeric(value));
+        if (type == ValueType::Integer && value.type == ValueType::Real)
+            return storeTyped<int>(slot, [fn = value.real](Frame& f) { return static_cast<int>(fn(f)); });
+
+        // Остальные сочетания типов - общим путём через Value
+        return [slot, type, fn = boxed(value)](Frame& f) {
+            try {
+                Value result;
+                if (!tryEvaluate(fn, f, result))
+                    result = Value();
+                assignConverted(f, f.slots[slot], type, std::move(result));
+            } catch (const std::exception& e) {
+                report(f, std::string("Ошибка при выполнении присваивания: ") + e.what());
+                throw;
+            }
+        };
+    }
+
+    // Условие if/while: нелогическое значение сообщается предупреждением и приводится к bool
+    Fn<bool> compileCondition(const std::shared_ptr<ASTNode>& node, std::string warning) {
+        Expr cond = compileExpression(node);
+        if (cond.type == ValueType::Boolean) {
+            return [fn = cond.boolean, warning = std::move(warning)](Frame& f) {
+                bool value;
+                if (tryEvaluate(fn, f, value))
+                    return value;
+                warn(f, warning);
+                return false;
+            };
+        }
+        return [fn = boxed(cond), warning = std::move(warning)](Frame& f) {
+            Value value;
+            if (!tryEvaluate(fn, f, value))
+                value = Value();
+            warn(f, warning);
+            return value.toBool();
+        };
+    }
+
+    Statement compileBody(const std::shared_ptr<ASTNode>& node) {
+        Statement body = compileStatement(node);
+        return body ? body : nothing();
+    }
+
+    Statement compileIf(const std::shared_ptr<ASTNode>& node) {
+        Fn<bool> cond = compileCondition(node->children[0], "Условие в операторе if должно быть логического типа");
+        Statement thenBranch = compileBody(node->children[1]);
+        Statement elseBranch = node->children.size() > 2 ? compileBody(node->children[2]) : nothing();
+        return [cond, thenBranch, elseBranch](Frame& f) {
+            try {
+                if (cond(f))
+                    thenBranch(f);
+                else
+                    elseBranch(f);
+            } catch (const std::exception& e) {
+                report(f, std::string("Ошибка при выполнении условного оператора: ") + e.what());
+            }
+        };
+    }
+
+    Statement compileWhile(const std::shared_ptr<ASTNode>& node) {
+        Fn<bool> cond = compileCondition(node->children[0], "Условие в операторе while должно быть логического типа");
+        Statement body = compileBody(node->children[1]);
+        return [cond, body](Frame& f) {
+            try {
+                int iterations = 0;
+                while (cond(f)) {
+                    body(f);
+                    if (++iterations > MAX_ITERATIONS) {
+                        warn(f, "Возможный бесконечный цикл while (превышено максимальное число итераций)");
+                        break;
+                    }
+                }
+            } catch (const std::exception& e) {
+                report(f, std::string("Ошибка при выполнении цикла while: ") + e.what());
+            }
+        };
+    }
+
+    // Граница цикла for: вещественное значение усекается, остальные типы - ошибка
+    static int loopBound(Frame& f, const Fn<Value>& fn, const char* realWarning, const char* typeError) {
+        Value value;
+        if (!tryEvaluate(fn, f, value))
+            value = Value();
+        if (value.type == ValueType::Integer)
+            return value.intValue;
+        if (value.type == ValueType::Real) {
+            warn(f, realWarning);
+            return static_cast<int>(value.realValue);
+        }
+        report(f, typeError);
+        throw std::runtime_error(typeError);
+    }
+
+    Statement compileFor(const std::shared_ptr<ASTNode>& node) {
+        std::string varName = node->value;
+        bool isDownto = false;
+        size_t pipePos = varName.find('|');
+        if (pipePos != std::string::npos) {
+            isDownto = varName.substr(pipePos + 1) == "downto";
+            varName = varName.substr(0, pipePos);
+        }
+        NameId loopName = names->resolve(node->name, varName);
+
+        // Границы вычисляются во внешней области, переменная цикла видна только в теле
+        Fn<Value> from = boxed(compileExpression(node->children[0]));
+        Fn<Value> to = boxed(compileExpression(node->children[1]));
+        scopes.emplace_back();
+        size_t slot = declare(loopName, ValueType::Integer).slot;
+        Statement body = compileBody(node->children[2]);
+        scopes.pop_back();
+
+        return [from, to, body, slot, isDownto](Frame& f) {
+            try {
+                int first = loopBound(f, from, "Значение типа Real будет преобразовано в целое для цикла for",
+                    "Начальное значение цикла for должно быть числовым");
+                int last = loopBound(f, to, "Конечное значение типа Real будет преобразовано в целое для цикла for",
+                    "Конечное значение цикла for должно быть числовым");
+                f.slots[slot] = Value(first);
+                int& loopVar = f.slots[slot].intValue;
+                int iterations = 0;
+                try {
+                    if (isDownto) {
+                        for (int i = first; i >= last; --i) {
+                            loopVar = i;
+                            body(f);
+                            if (++iterations > MAX_ITERATIONS) {
+                                warn(f, "Возможный бесконечный цикл for downto (превышено максимальное число итераций)");
+                                break;
+                            }
+                        }
+                    } else {
+                        for (int i = first; i <= last; ++i) {
+                            loopVar = i;
+                            body(f);
+                            if (++iterations > MAX_ITERATIONS) {
+                                warn(f, "Возможный бесконечный цикл for to (превышено максимальное число итераций)");
+                                break;
+                            }
+                        }
+                    }
+                } catch (const std::exception& e) {
+                    report(f, std::string("Ошибка при выполнении цикла for: ") + e.what());
+                    throw;
+                }
+            } catch (const std::exception& e) {
+                report(f, std::string("Ошибка в цикле for: ") + e.what());
+                throw;
+            }
+        };
+    }
+
+    // Вывод значения; при ошибке вычисления выводится Value(), то есть 0
+    static Statement compilePrint(const Expr& e) {
+        switch (e.type) {
+        case ValueType::Integer:
+            return [fn = e.integer](Frame& f) {
+                int value;
+                if (tryEvaluate(fn, f, value)) f.output << value; else f.output << 0;
+            };
+        case ValueType::Real:
+            return [fn = e.real](Frame& f) {
+                double value;
+                if (tryEvaluate(fn, f, value)) f.output << value; else f.output << 0;
+            };
+        case ValueType::Boolean:
+            return [fn = e.boolean](Frame& f) {
+                bool value;
+                if (tryEvaluate(fn, f, value)) f.output << (value ? "true" : "false"); else f.output << 0;
+            };
+        default:
+            return [fn = e.text](Frame& f) {
+                std::string value;
+                if (tryEvaluate(fn, f, value)) f.output << value; else f.output << 0;
+            };
+        }
+    }
+
+    Statement compileWrite(const std::shared_ptr<ASTNode>& node) {
+        std::vector<Statement> items;
+        for (const auto& child : node->children)
+            items.push_back(compilePrint(compileExpression(child)));
+        bool newline = node->type == ASTNodeType::Writeln;
+        return [items = std::move(items), newline](Frame& f) {
+            try {
+                for (size_t i = 0; i < items.size(); ++i) {
+                    items[i](f);
+                    if (i + 1 < items.size())
+                        f.output << " ";
+                }
+            } catch (const std::exception& e) {
+                report(f, std::string("Ошибка при выполнении write/writeln: ") + e.what());
+            }
+            if (newline)
+                f.output << '\n';
+        };
+    }
+
+    Statement compileReadTarget(const std::shared_ptr<ASTNode>& node) const {
+        const Binding* binding = resolve(findName(node));
+        if (!binding) {
+            std::string message = "Попытка чтения в необъявленную переменную: " + node->value;
+            return [message](Frame& f) { report(f, message); };
+        }
+        size_t slot = binding->slot;
+        switch (binding->type) {
+        case ValueType::Integer:
+            return [slot](Frame& f) {
+                int v;
+                if (f.input >> v) f.slots[slot].intValue = v;
+                else { report(f, "Ошибка при чтении целого числа"); f.input.clear(); }
+            };
+        case ValueType::Real:
+            return [slot](Frame& f) {
+                double v;
+                if (f.input >> v) f.slots[slot].realValue = v;
+                else { report(f, "Ошибка при чтении вещественного числа"); f.input.clear(); }
+            };
+        case ValueType::Boolean:
+            return [slot](Frame& f) {
+                std::string input;
+                if (f.input >> input) {
+                    std::transform(input.begin(), input.end(), input.begin(), ::tolower);
+                    f.slots[slot].boolValue = input == "true" || input == "1" || input == "yes";
+                }
+                else { report(f, "Ошибка при чтении логического значения"); f.input.clear(); }
+            };
+        default:
+            return [slot](Frame& f) {
+                std::string v;
+                if (f.input >> v) f.slots[slot].stringValue = v;
+                else { report(f, "Ошибка при чтении строки"); f.input.clear(); }
+            };
+        }
+    }
+
+    Statement compileRead(const std::shared_ptr<ASTNode>& node) {
+        std::vector<Statement> targets;
+        for (const auto& child : node->children)
+            targets.push_back(compileReadTarget(child));
+        bool skipLine = node->type == ASTNodeType::Readln;
+        return [targets = std::move(targets), skipLine](Frame& f) {
+            try {
+                for (const auto& target : targets)
+                    target(f);
+                if (skipLine)
+                    f.input.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            } catch (const std::exception& e) {
+                report(f, std::string("Ошибка при выполнении read/readln: ") + e.what());
+                f.input.clear();
+                f.input.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            }
+        };
+    }
+
+    // Литерал декодируется один раз; ошибка разбора откладывается до выполнения
+    static Expr compileNumber(const std::string& text) {
+        try {
+            if (text.find('.') != std::string::npos) {
+                double value = std::stod(text);
+                return makeReal([value](Frame&) { return value; });
+            }
+            int value = std::stoi(text);
+            return makeInt([value](Frame&) { return value; });
+        } catch (const std::exception& e) {
+            return failing(e.what());
+        }
+    }
+
+    Expr compileVariable(const std::shared_ptr<ASTNode>& node) const {
+        const Binding* binding = resolve(findName(node));
+        if (!binding)
+            return failing("Неизвестный токен: " + node->value);
+        size_t slot = binding->slot;
+        switch (binding->type) {
+        case ValueType::Integer: return makeInt([slot](Frame& f) { return f.slots[slot].intValue; });
+        case ValueType::Real: return makeReal([slot](Frame& f) { return f.slots[slot].realValue; });
+        case ValueType::Boolean: return makeBool([slot](Frame& f) { return f.slots[slot].boolValue; });
+        default: return makeString([slot](Frame& f) { return f.slots[slot].stringValue; });
+        }
+    }
+
+    Expr compileExpression(const std::shared_ptr<ASTNode>& node) {
+        if (!node)
+            return failing("Пустое выражение");
+        switch (node->type) {
+        case ASTNodeType::Number:
+        case ASTNodeType::Real:
+            return compileNumber(node->value);
+        case ASTNodeType::String:
+            return makeString([text = node->value](Frame&) { return text; });
+        case ASTNodeType::Boolean:
+            if (node->value == "true" || node->value == "false") {
+                bool value = node->value == "true";
+                return makeBool([value](Frame&) { return value; });
+            }
+            return failing("Неизвестный токен: " + node->value);
+        case ASTNodeType::Identifier:
+            return compileVariable(node);
+        case ASTNodeType::UnOp:
+            if (node->children.empty())
+                return failing("Пустое выражение");
+            return unary(node->value, compileExpression(node->children[0]));
+        case ASTNodeType::BinOp:
+            if (node->children.size() < 2)
+                return failing("Пустое выражение");
+            return binary(node->value, compileExpression(node->children[0]), compileExpression(node->children[1]));
+        case ASTNodeType::Expression: {
+            if (node->children.size() == 1)
+                return compileExpression(node->children[0]);
+            std::vector<Expr> operands;
+            for (const auto& child : node->children)
+                operands.push_back(compileExpression(child));
+            return failing(operands.empty() ? "Пустое выражение" : "Лишние операнды в выражении", operands);
+        }
+        default:
+            return failing("Пустое выражение");
+        }
+    }
+};
+
+} // namespace
+
+ExecutionContext::ExecutionContext(const CompiledProgram& program, std::istream& input, std::ostream& output,
+    shared_ptr<IErrorReporter> errorReporter)
+    : program(program), slots(program.slotCount()), declared(program.slotCount(), 0), input(input), output(output),
+      errors(errorReporter ? errorReporter : std::make_shared<ErrorReporter>()) {
+    for (const auto& initial : program.initialValues) {
+        slots[initial.first] = initial.second;
+        declared[initial.first] = 1;
+    }
+}
+
+bool ExecutionContext::isDeclared(const string& name) const {
+    const CompiledProgram::Global* global = program.findGlobal(name);
+    return global && declared[global->slot];
+}
+
+Value ExecutionContext::getVariable(const string& name) const {
+    const CompiledProgram::Global* global = program.findGlobal(name);
+    if (!global || !declared[global->slot])
+        throw std::runtime_error("Неизвестная переменная: " + name);
+    return slots[global->slot];
+}
+
+// Замыкания программы рассчитывают на статический тип переменной, поэтому значение приводится к нему
+void ExecutionContext::setVariable(const string& name, const Value& value) {
+    const CompiledProgram::Global* global = program.findGlobal(name);
+    if (!global)
+        throw std::runtime_error("Неизвестная переменная: " + name);
+    Value& target = slots[global->slot];
+    switch (global->type) {
+    case ValueType::Integer: target = Value(value.toInt()); break;
+    case ValueType::Real: target = Value(value.toReal()); break;
+    case ValueType::Boolean: target = Value(value.toBool()); break;
+    case ValueType::String: target = Value(value.toString()); break;
+    }
+    declared[global->slot] = 1;
+}
+
+map<string, Value> ExecutionContext::getAllSymbols() const {
+    map<string, Value> result;
+    for (const auto& entry : program.globals) {
+        if (declared[entry.second.slot])
+            result.emplace(program.names->text(entry.first), slots[entry.second.slot]);
+    }
+    return result;
+}
+
+shared_ptr<const CompiledProgram> CompiledProgram::compile(const shared_ptr<ASTNode>& ast, shared_ptr<NameTable> names,
+    const map<string, Value>& inputs) {
+    if (!names)
+        throw std::invalid_argument("Программа компилируется без таблицы имён");
+    shared_ptr<CompiledProgram> program(new CompiledProgram());
+    program->names = names;
+    ClosureCompiler compiler(std::move(names), inputs);
+    if (ast)
+        program->body = compiler.compileStatement(ast);
+    if (!program->body)
+        program->body = [](ExecutionContext&) {};
+    program->slots = compiler.slotCount();
+    for (const auto& entry : compiler.globals())
+        program->globals.emplace(entry.first, Global{ entry.second.slot, entry.second.type });
+    program->initialValues = std::move(compiler.inputValues);
+    return program;
+}
+
+void CompiledProgram::run(ExecutionContext& context) const {
+    if (&context.program != this)
+        throw std::runtime_error("Контекст выполнения создан для другой программы");
+    // writeln не сбрасывает поток: вывод сбрасывается один раз в конце, в том числе при ошибке
+    try {
+        body(context);
+    } catch (...) {
+        context.output.flush();
+        throw;
+    }
+    context.output.flush();
+}
+
+const CompiledProgram::Global* CompiledProgram::findGlobal(const string& name) const {
+    auto it = globals.find(names->find(name));
+    return it != globals.end() ? &it->second : nullptr;
+}
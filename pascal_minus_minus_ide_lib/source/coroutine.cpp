@@ -0,0 +1,165 @@
+#include "coroutine.h"
+#include "allocation_profiler.h"
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+thread_local Coroutine* currentCoroutine = nullptr;
+
+} // namespace
+
+#ifdef _WIN32
+
+struct Coroutine::Context {
+    void* fiber = nullptr;      // Волокно сопрограммы
+    void* caller = nullptr;     // Волокно, вызвавшее resume()
+    AllocationProfiler::ExecutionState allocations;  // Состояние профиля выделений сопрограммы
+};
+
+Coroutine::Coroutine(Body body, std::size_t stackSize) : body(std::move(body)), context(new Context) {
+    context->fiber = CreateFiber(stackSize, [](void* self) { static_cast<Coroutine*>(self)->enter(); }, this);
+    if (!context->fiber) {
+        delete context;
+        throw std::runtime_error("Не удалось создать стек сопрограммы");
+    }
+}
+
+Coroutine::~Coroutine() {
+    if (started && !done) {
+        cancelling = true;
+        try {
+            resume();
+        } catch (...) {
+        }
+    }
+    DeleteFiber(context->fiber);
+    delete context;
+}
+
+void Coroutine::switchIn() {
+    if (!IsThreadAFiber())
+        ConvertThreadToFiber(nullptr);
+    context->caller = GetCurrentFiber();
+    SwitchToFiber(context->fiber);
+}
+
+void Coroutine::switchOut() {
+    SwitchToFiber(context->caller);
+}
+
+#else
+
+struct Coroutine::Context {
+    ucontext_t self;
+    ucontext_t caller;
+    void* stack = nullptr;      // Стек с защитной страницей внизу
+    std::size_t stackBytes = 0;
+    AllocationProfiler::ExecutionState allocations;  // Состояние профиля выделений сопрограммы
+};
+
+Coroutine::Coroutine(Body body, std::size_t stackSize) : body(std::move(body)), context(new Context) {
+    std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    context->stackBytes = (stackSize + page - 1) / page * page + page;
+    context->stack = mmap(nullptr, context->stackBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (context->stack == MAP_FAILED) {
+        int code = errno;
+        delete context;
+        throw std::runtime_error("Не удалось выделить стек сопрограммы: " + std::string(std::strerror(code)));
+    }
+    // Переполнение стека завершает процесс, а не портит соседнюю память
+    mprotect(context->stack, page, PROT_NONE);
+
+    getcontext(&context->self);
+    context->self.uc_stack.ss_sp = context->stack;
+    context->self.uc_stack.ss_size = context->stackBytes;
+    context->self.uc_link = nullptr;
+    // makecontext передаёт только аргументы int: указатель делится на две половины
+    void (*entry)(unsigned, unsigned) = [](unsigned high, unsigned low) {
+        reinterpret_cast<Coroutine*>((static_cast<std::uintptr_t>(high) << 16 << 16) | low)->enter();
+    };
+    auto address = reinterpret_cast<std::uintptr_t>(this);
+    makecontext(&context->self, reinterpret_cast<void (*)()>(entry), 2,
+                static_cast<unsigned>(address >> 16 >> 16), static_cast<unsigned>(address));
+}
+
+Coroutine::~Coroutine() {
+    if (started && !done) {
+        cancelling = true;
+        try {
+            resume();
+        } catch (...) {
+        }
+    }
+    munmap(context->stack, context->stackBytes);
+    delete context;
+}
+
+void Coroutine::switchIn() {
+    swapcontext(&context->caller, &context->self);
+}
+
+void Coroutine::switchOut() {
+    swapcontext(&context->self, &context->caller);
+}
+
+#endif
+
+// Точка входа на стеке сопрограммы
+void Coroutine::enter() {
+    try {
+        body();
+    } catch (const CoroutineCancelled&) {
+    } catch (...) {
+        error = std::current_exception();
+    }
+    done = true;
+    for (;;)
+        switchOut();
+}
+
+bool Coroutine::resume() {
+    if (done)
+        return true;
+    started = true;
+    Coroutine* previous = currentCoroutine;
+    currentCoroutine = this;
+    // Фаза, структура и операторы профиля выделений у сопрограммы свои, как у отдельного потока
+    AllocationProfiler::swapExecutionState(context->allocations);
+    switchIn();
+    AllocationProfiler::swapExecutionState(context->allocations);
+    currentCoroutine = previous;
+    if (error) {
+        std::exception_ptr thrown = error;
+        error = nullptr;
+        std::rethrow_exception(thrown);
+    }
+    return done;
+}
+
+void Coroutine::yield() {
+    Coroutine* self = currentCoroutine;
+    if (!self)
+        return;
+    self->switchOut();
+    if (self->cancelling)
+        throw CoroutineCancelled();
+}
+
+Coroutine* Coroutine::current() {
+    return currentCoroutine;
+}
@@ -0,0 +1,102 @@
+#include "error_reporter.h"
+#include <functional>
+
+namespace {
+
+void appendMessage(std::string& out, const ErrorReporter::Message& message) {
+    bool error = message.level == ErrorReporter::Message::Level::Error;
+    out += error ? "\033[1;31mОшибка" : "\033[1;33mПредупреждение";
+    if (message.line >= 0)
+        out += " [Строка " + std::to_string(message.line) + "]";
+    if (message.column >= 0)
+        out += " [Позиция " + std::to_string(message.column) + "]";
+    out += ": ";
+    out += message.text;
+}
+
+} // namespace
+
+size_t ErrorReporter::KeyHash::operator()(const Key& key) const {
+    size_t hash = std::hash<std::string>()(key.text);
+    hash ^= (static_cast<size_t>(key.line) * 0x9E3779B97F4A7C15ull) + (hash << 6) + (hash >> 2);
+    hash ^= (static_cast<size_t>(key.column) * 0xC2B2AE3D27D4EB4Full) + (hash << 6) + (hash >> 2);
+    return hash ^ static_cast<size_t>(key.level);
+}
+
+ErrorReporter::ErrorReporter(std::ostream& output, size_t maxMessages)
+    : output(output), maxMessages(maxMessages) {}
+
+ErrorReporter::~ErrorReporter() {
+    flush();
+}
+
+void ErrorReporter::reportError(const std::string& message, int line, int column) {
+    ++errorCount;
+    report(Message::Level::Error, message, line, column);
+}
+
+void ErrorReporter::reportWarning(const std::string& message, int line, int column) {
+    ++warningCount;
+    report(Message::Level::Warning, message, line, column);
+}
+
+void ErrorReporter::report(Message::Level level, const std::string& message, int line, int column) {
+    Key key{ level, message, line, column };
+    auto it = index.find(key);
+    if (it != index.end()) {
+        Message& existing = messages[it->second];
+        if (existing.count == reportedCounts[it->second])
+            pending.push_back(it->second);
+        ++existing.count;
+        return;
+    }
+    if (messages.size() >= maxMessages) {
+        ++suppressedCount;
+        return;
+    }
+    index.emplace(std::move(key), messages.size());
+    pending.push_back(messages.size());
+    messages.emplace_back(level, message, line, column);
+    reportedCounts.push_back(0);
+}
+
+void ErrorReporter::flush() {
+    if (pending.empty() && suppressedCount == reportedSuppressed)
+        return;
+
+    std::string text;
+    for (size_t i : pending) {
+        const Message& message = messages[i];
+        appendMessage(text, message);
+        size_t repeats = message.count - reportedCounts[i];
+        if (reportedCounts[i] == 0) {
+            if (repeats > 1)
+                text += " (повторений: " + std::to_string(repeats) + ")";
+        } else {
+            text += " (ещё повторений: " + std::to_string(repeats) + ")";
+        }
+        text += "\033[0m\n";
+        reportedCounts[i] = message.count;
+    }
+    pending.clear();
+
+    if (suppressedCount != reportedSuppressed) {
+        text += "\033[1;33mНе сохранено сообщений сверх предела " + std::to_string(maxMessages) + ": "
+              + std::to_string(suppressedCount - reportedSuppressed) + "\033[0m\n";
+        reportedSuppressed = suppressedCount;
+    }
+
+    output.write(text.data(), static_cast<std::streamsize>(text.size()));
+    output.flush();
+}
+
+void ErrorReporter::clear() {
+    messages.clear();
+    index.clear();
+    reportedCounts.clear();
+    pending.clear();
+    errorCount = 0;
+    warningCount = 0;
+    suppressedCount = 0;
+    reportedSuppressed = 0;
+}
@@ -0,0 +1,244 @@
+#include "fork_server.h"
+#include "error_reporter.h"
+#include "lexer.h"
+#include "parser.h"
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+// Небольшая программа, затрагивающая лексер, таблицу операторов, таблицу символов и read/write
+const char* WARMUP_PROGRAM =
+    "program Warmup;\n"
+    "var i, n, s: Integer; x: Double;\n"
+    "begin\n"
+    "  read(n);\n"
+    "  s := 0;\n"
+    "  x := 0.5;\n"
+    "  for i := 1 to n do\n"
+    "    s := s + i * 2 mod 5 div 1 - 1;\n"
+    "  while s < 10 do\n"
+    "    s := s + 1;\n"
+    "  if (s >= 10) and (x < 1) then\n"
+    "    writeln(s, x / 2)\n"
+    "  else\n"
+    "    write(s);\n"
+    "end.";
+
+} // namespace
+
+ForkServer::ForkServer(double timeLimitSeconds) : timeLimitSeconds(timeLimitSeconds) {
+    BatchRunner::runJob({ "warmup", WARMUP_PROGRAM, "3" });
+}
+
+void ForkServer::preload(const std::string& source) {
+    std::ostringstream diagnostics;
+    auto reporter = std::make_shared<ErrorReporter>(diagnostics);
+    Lexer lexer(source, reporter);
+    Parser parser(lexer.tokenize(), reporter);
+    std::shared_ptr<ASTNode> tree = parser.parse();
+    if (reporter->hasErrors() || !tree) {
+        reporter->flush();
+        throw std::runtime_error("Программа не загружена:\n" + diagnostics.str());
+    }
+    program = CompiledProgram::compile(tree, lexer.getNames());
+    ast = tree;
+}
+
+#ifdef _WIN32
+
+ForkResult ForkServer::run(const std::string&) {
+    throw std::runtime_error("Fork-сервер поддерживается только в POSIX-системах");
+}
+
+ForkResult ForkServer::run(const BatchJob&) {
+    throw std::runtime_error("Fork-сервер поддерживается только в POSIX-системах");
+}
+
+#else
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+// Заголовок ответа дочернего процесса; за ним идут ошибка, диагностика и вывод
+struct ReplyHeader {
+    int64_t startedAt;          // steady_clock в момент начала работы
+    double seconds;
+    uint64_t errorSize;
+    uint64_t diagnosticsSize;
+    uint64_t outputSize;
+    uint8_t success;
+};
+
+int64_t nowNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool writeAll(int fd, const void* data, std::size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = write(fd, bytes, size);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return false;
+        bytes += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+/**
+ * Читает канал до закрытия
+ * @param deadline Момент nowNanoseconds(), после которого чтение прекращается (0 - без срока)
+ * @return false, если срок истёк раньше, чем канал закрылся
+ */
+bool readAll(int fd, int64_t deadline, std::string& data) {
+    char buffer[65536];
+    for (;;) {
+        if (deadline > 0) {
+            int64_t left = deadline - nowNanoseconds();
+            if (left <= 0)
+                return false;
+            pollfd waitFd{ fd, POLLIN, 0 };
+            int ready = poll(&waitFd, 1, static_cast<int>((left + 999999) / 1000000));
+            if (ready < 0 && errno == EINTR)
+                continue;
+            if (ready == 0)
+                continue;
+        }
+        ssize_t count = read(fd, buffer, sizeof(buffer));
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count <= 0)
+            return true;
+        data.append(buffer, static_cast<std::size_t>(count));
+    }
+}
+
+// Дочерняя часть: выполняет задание и передаёт результат; не возвращается
+[[noreturn]] void childMain(int fd, const std::function<BatchResult()>& job) {
+    int64_t startedAt = nowNanoseconds();
+    BatchResult result;
+    try {
+        result = job();
+    } catch (...) {
+        // Исключение не должно выйти из дочернего процесса в код родителя
+        _exit(1);
+    }
+    ReplyHeader header{ startedAt, result.seconds, result.error.size(), result.diagnostics.size(),
+                        result.output.size(), static_cast<uint8_t>(result.success) };
+    bool sent = writeAll(fd, &header, sizeof(header))
+             && writeAll(fd, result.error.data(), result.error.size())
+             && writeAll(fd, result.diagnostics.data(), result.diagnostics.size())
+             && writeAll(fd, result.output.data(), result.output.size());
+    _exit(sent ? 0 : 1);
+}
+
+// Порождает дочерний процесс для задания и собирает его ответ
+ForkResult forkJob(const std::string& name, double limit, const std::function<BatchResult()>& job) {
+    int64_t requestedAt = nowNanoseconds();
+    int pipeFds[2];
+    if (pipe(pipeFds) != 0)
+        throw std::runtime_error("Не удалось создать канал: " + std::string(std::strerror(errno)));
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        int error = errno;
+        close(pipeFds[0]);
+        close(pipeFds[1]);
+        throw std::runtime_error("Не удалось создать процесс: " + std::string(std::strerror(error)));
+    }
+    if (pid == 0) {
+        close(pipeFds[0]);
+        childMain(pipeFds[1], job);
+    }
+
+    close(pipeFds[1]);
+    std::string reply;
+    int64_t deadline = limit > 0 ? requestedAt + static_cast<int64_t>(limit * 1e9) : 0;
+    bool timedOut = !readAll(pipeFds[0], deadline, reply);
+    close(pipeFds[0]);
+    if (timedOut)
+        kill(pid, SIGKILL);
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+
+    ForkResult response;
+    response.result.name = name;
+    response.totalSeconds = (nowNanoseconds() - requestedAt) / 1e9;
+
+    ReplyHeader header;
+    if (reply.size() >= sizeof(header)) {
+        std::memcpy(&header, reply.data(), sizeof(header));
+        std::size_t offset = sizeof(header);
+        if (reply.size() == offset + header.errorSize + header.diagnosticsSize + header.outputSize) {
+            response.result.error = reply.substr(offset, header.errorSize);
+            offset += header.errorSize;
+            response.result.diagnostics = reply.substr(offset, header.diagnosticsSize);
+            offset += header.diagnosticsSize;
+            response.result.output = reply.substr(offset);
+            response.result.success = header.success != 0;
+            response.result.seconds = header.seconds;
+            response.startupSeconds = (header.startedAt - requestedAt) / 1e9;
+        }
+    }
+
+    if (timedOut) {
+        response.result.success = false;
+        response.result.error = "Превышено ограничение времени (" + std::to_string(limit) + " с)";
+    } else if (WIFSIGNALED(status)) {
+        response.result.success = false;
+        response.result.error = "Процесс завершён сигналом " + std::to_string(WTERMSIG(status));
+    } else if (WEXITSTATUS(status) != 0) {
+        response.result.success = false;
+        response.result.error = "Процесс завершился с кодом " + std::to_string(WEXITSTATUS(status));
+    }
+    return response;
+}
+
+} // namespace
+
+ForkResult ForkServer::run(const std::string& input) {
+    if (!program)
+        throw std::runtime_error("Программа не загружена");
+    const CompiledProgram& compiled = *program;
+    return forkJob("preloaded", timeLimitSeconds, [&compiled, &input]() {
+        BatchResult result;
+        result.name = "preloaded";
+        auto start = std::chrono::steady_clock::now();
+        std::ostringstream diagnostics, output;
+        {
+            auto reporter = std::make_shared<ErrorReporter>(diagnostics);
+            std::istringstream in(input);
+            try {
+                ExecutionContext context(compiled, in, output, reporter);
+                compiled.run(context);
+                result.success = !reporter->hasErrors();
+            } catch (const std::exception& e) {
+                result.error = e.what();
+            }
+            reporter->flush();
+        }
+        result.output = output.str();
+        result.diagnostics = diagnostics.str();
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    });
+}
+
+ForkResult ForkServer::run(const BatchJob& job) {
+    return forkJob(job.name, timeLimitSeconds, [&job]() { return BatchRunner::runJob(job); });
+}
+
+#endif
@@ -0,0 +1,230 @@
+#include "green_scheduler.h"
+#include "error_reporter.h"
+#include "interpreter.h"
+#include "input_source.h"
+#include "output_sink.h"
+#include "parser.h"
+#include "lexer.h"
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+
+struct GreenScheduler::Task {
+    std::string name;
+    int priority = 0;
+    std::size_t worker = 0;                 // Поток пула, за которым закреплена задача
+    GreenTaskState state = GreenTaskState::Ready;
+    bool wantsInput = false;                // Квант закончился ожиданием ввода
+    std::size_t slices = 0;
+    std::size_t inputWaits = 0;
+    double cpuSeconds = 0;
+    std::uint64_t firstSlice = 0;
+    std::uint64_t lastSlice = 0;
+    BatchResult result;
+
+    std::ostringstream diagnostics;
+    std::shared_ptr<ErrorReporter> reporter;
+    std::shared_ptr<MemoryOutputSink> output;
+    std::shared_ptr<PushInputSource> input;
+    std::shared_ptr<ASTNode> program;
+    std::unique_ptr<Interpreter> interpreter;
+    std::unique_ptr<Coroutine> coroutine;
+};
+
+GreenScheduler::GreenScheduler(const GreenSchedulerOptions& options) : options(options) {
+    std::size_t count = options.threads ? options.threads : std::thread::hardware_concurrency();
+    if (count == 0)
+        count = 1;
+    ready.resize(count);
+    workers.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+        workers.emplace_back(&GreenScheduler::workerLoop, this, i);
+}
+
+GreenScheduler::~GreenScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+}
+
+GreenScheduler::TaskId GreenScheduler::spawn(const BatchJob& job, int priority, bool keepInputOpen) {
+    auto task = std::make_unique<Task>();
+    Task& t = *task;
+    t.name = job.name;
+    t.priority = priority;
+    t.result.name = job.name;
+    t.reporter = std::make_shared<ErrorReporter>(t.diagnostics);
+    t.output = std::make_shared<MemoryOutputSink>();
+    t.input = std::make_shared<PushInputSource>([&t]() {
+        t.wantsInput = true;
+        Coroutine::yield();
+    });
+    t.input->push(job.input);
+    if (!keepInputOpen)
+        t.input->close();
+
+    try {
+        Lexer lexer(job.source, t.reporter);
+        Parser parser(lexer.tokenize(), t.reporter);
+        t.program = parser.parse();
+        t.interpreter = std::make_unique<Interpreter>(t.reporter, t.output, t.input);
+        t.interpreter->setNames(lexer.getNames());
+        t.interpreter->setYieldHook(&Coroutine::yield, options.sliceBackEdges);
+        t.coroutine = std::make_unique<Coroutine>([&t]() {
+            try {
+                t.interpreter->run(t.program);
+                t.result.success = !t.reporter->hasErrors();
+            } catch (const std::exception& e) {
+                t.result.error = e.what();
+            }
+        }, options.stackSize);
+    } catch (const std::exception& e) {
+        t.result.error = e.what();
+        t.state = GreenTaskState::Finished;
+        finish(t);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    TaskId id = tasks.size();
+    t.worker = id % ready.size();
+    tasks.push_back(std::move(task));
+    if (t.state != GreenTaskState::Finished)
+        makeReady(t);
+    return id;
+}
+
+void GreenScheduler::provideInput(TaskId id, const std::string& text) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Task& task = find(id);
+    task.input->push(text);
+    if (task.state == GreenTaskState::WaitingInput)
+        makeReady(task);
+}
+
+void GreenScheduler::closeInput(TaskId id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Task& task = find(id);
+    task.input->close();
+    if (task.state == GreenTaskState::WaitingInput)
+        makeReady(task);
+}
+
+void GreenScheduler::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this]() { return readyCount == 0 && runningCount == 0; });
+}
+
+GreenTaskInfo GreenScheduler::info(TaskId id) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const Task& task = find(id);
+    GreenTaskInfo info;
+    info.state = task.state;
+    info.priority = task.priority;
+    info.slices = task.slices;
+    info.inputWaits = task.inputWaits;
+    info.cpuSeconds = task.cpuSeconds;
+    info.firstSlice = task.firstSlice;
+    info.lastSlice = task.lastSlice;
+    if (task.state == GreenTaskState::Finished)
+        info.result = task.result;
+    return info;
+}
+
+std::size_t GreenScheduler::taskCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return tasks.size();
+}
+
+GreenScheduler::Task& GreenScheduler::find(TaskId id) const {
+    if (id >= tasks.size())
+        throw std::out_of_range("Неизвестная задача: " + std::to_string(id));
+    return *tasks[id];
+}
+
+// Вызывается под mutex
+void GreenScheduler::makeReady(Task& task) {
+    int key = options.policy == SchedulingPolicy::Priority ? -task.priority : 0;
+    task.state = GreenTaskState::Ready;
+    ready[task.worker].emplace(std::make_pair(key, sequence++), &task);
+    ++readyCount;
+    wake.notify_all();
+}
+
+// Забирает вывод и сообщения завершённой задачи и освобождает её интерпретатор
+void GreenScheduler::finish(Task& task) {
+    task.reporter->flush();
+    task.result.output = task.output->str();
+    task.result.diagnostics = task.diagnostics.str();
+    if (task.interpreter) {
+        task.result.memoryBytes = task.interpreter->getMemoryAccount().current();
+        task.result.peakMemoryBytes = task.interpreter->getMemoryAccount().peak();
+    }
+    task.coroutine.reset();
+    task.interpreter.reset();
+    task.program.reset();
+}
+
+void GreenScheduler::workerLoop(std::size_t index) {
+    ReadyQueue& queue = ready[index];
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wake.wait(lock, [&]() { return stopping || !queue.empty(); });
+        if (stopping)
+            break;
+        Task& task = *queue.begin()->second;
+        queue.erase(queue.begin());
+        --readyCount;
+        ++runningCount;
+        task.state = GreenTaskState::Running;
+        task.lastSlice = ++slicesRun;
+        if (!task.firstSlice)
+            task.firstSlice = task.lastSlice;
+        lock.unlock();
+
+        auto start = std::chrono::steady_clock::now();
+        bool done;
+        try {
+            done = task.coroutine->resume();
+        } catch (...) {
+            task.result.error = "Необработанное исключение в задаче";
+            done = true;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (done)
+            finish(task);
+
+        lock.lock();
+        --runningCount;
+        ++task.slices;
+        task.cpuSeconds += seconds;
+        if (done) {
+            task.result.seconds = task.cpuSeconds;
+            task.state = GreenTaskState::Finished;
+        } else {
+            bool waiting = task.wantsInput && !task.input->ready();
+            task.wantsInput = false;
+            if (waiting) {
+                task.state = GreenTaskState::WaitingInput;
+                ++task.inputWaits;
+            } else {
+                makeReady(task);
+            }
+        }
+        if (readyCount == 0 && runningCount == 0)
+            idle.notify_all();
+    }
+
+    // Прерываем незавершённые задачи этого потока: сопрограмма возобновляется там же, где работала
+    std::vector<Task*> unfinished;
+    for (auto& task : tasks) {
+        if (task->worker == index && task->state != GreenTaskState::Finished)
+            unfinished.push_back(task.get());
+    }
+    lock.unlock();
+    for (Task* task : unfinished)
+        task->coroutine.reset();
+}
@@ -0,0 +1,355 @@
+#include "input_source.h"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define INPUT_SOURCE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Пробельные символы operator>> в локали "C": ' ' и '\t'..'\r'
+inline bool isSpace(char c) {
+    return c == ' ' || static_cast<unsigned char>(c - '\t') <= '\r' - '\t';
+}
+
+inline bool isDigit(char c) {
+    return static_cast<unsigned char>(c - '0') <= 9;
+}
+
+#ifdef INPUT_SOURCE_SSE2
+// Битовая маска пробельных символов среди 16 байт начиная с p
+inline unsigned spaceMask(const char* p) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i spaces = _mm_cmpeq_epi8(bytes, _mm_set1_epi8(' '));
+    __m128i shifted = _mm_sub_epi8(bytes, _mm_set1_epi8('\t'));
+    __m128i controls = _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8('\r' - '\t')), shifted);
+    return static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(spaces, controls)));
+}
+
+inline unsigned lowestBit(unsigned mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+#endif
+
+const char* skipSpaces(const char* p, const char* end) {
+    // Частый случай: лексемы разделены одним символом
+    if (p != end && !isSpace(*p))
+        return p;
+#ifdef INPUT_SOURCE_SSE2
+    while (end - p >= 16) {
+        unsigned mask = ~spaceMask(p) & 0xFFFF;
+        if (mask)
+            return p + lowestBit(mask);
+        p += 16;
+    }
+#endif
+    while (p != end && isSpace(*p))
+        ++p;
+    return p;
+}
+
+const char* findSpace(const char* p, const char* end) {
+#ifdef INPUT_SOURCE_SSE2
+    while (end - p >= 16) {
+        unsigned mask = spaceMask(p);
+        if (mask)
+            return p + lowestBit(mask);
+        p += 16;
+    }
+#endif
+    while (p != end && !isSpace(*p))
+        ++p;
+    return p;
+}
+
+// operator>> принимает ведущий '+', std::from_chars - нет
+inline const char* skipPlus(const char* first, const char* last) {
+    if (last - first > 1 && *first == '+' && (isDigit(first[1]) || first[1] == '.'))
+        return first + 1;
+    return first;
+}
+
+} // namespace
+
+BufferedInputSource::BufferedInputSource(std::size_t capacity)
+    : buffer(capacity ? capacity : 1), pos(buffer.data()), end(buffer.data()), exhausted(false) {}
+
+void BufferedInputSource::setWindow(const char* data, std::size_t size) {
+    buffer.clear();
+    buffer.shrink_to_fit();
+    pos = data;
+    end = data + size;
+    exhausted = true;
+}
+
+// Сохраняет непрочитанный остаток в начале буфера и дочитывает данные после него
+bool BufferedInputSource::refill() {
+    if (exhausted)
+        return false;
+    std::size_t tail = end - pos;
+    if (tail == buffer.size())
+        buffer.resize(buffer.size() * 2);  // Лексема занимает весь буфер (и уже лежит в его начале)
+    else if (tail)
+        std::memmove(buffer.data(), pos, tail);
+    if (tied)
+        tied->flush();
+    std::size_t count = read(buffer.data() + tail, buffer.size() - tail);
+    pos = buffer.data();
+    end = pos + tail + count;
+    if (!count)
+        exhausted = true;
+    return count != 0;
+}
+
+// Пропускает пробельные символы и дочитывает лексему целиком; возвращает её длину
+std::size_t BufferedInputSource::nextToken() {
+    for (;;) {
+        pos = skipSpaces(pos, end);
+        if (pos != end)
+            break;
+        if (!refill())
+            return 0;
+    }
+    for (;;) {
+        const char* stop = findSpace(pos, end);
+        if (stop != end || !refill())
+            return stop - pos;
+    }
+}
+
+// Пропускает пробельные символы и возвращает границу разбора числа. from_chars сам
+// остановится на конце числа, поэтому конец лексемы ищется только у края буфера
+const char* BufferedInputSource::numberBound() {
+    for (;;) {
+        pos = skipSpaces(pos, end);
+        if (pos != end)
+            break;
+        if (!refill())
+            return end;
+    }
+    if (exhausted || end - pos > MAX_NUMBER_LOOKAHEAD)
+        return end;
+    return pos + nextToken();
+}
+
+template <typename T>
+bool BufferedInputSource::readNumber(T& value) {
+    const char* last = numberBound();
+    const char* first = skipPlus(pos, last);
+    if (std::is_floating_point<T>::value) {
+        // from_chars понимает inf и nan, operator>> - нет
+        const char* mantissa = first != last && *first == '-' ? first + 1 : first;
+        if (mantissa == last || !(isDigit(*mantissa) || *mantissa == '.'))
+            return false;
+    }
+    T parsed;
+    auto result = std::from_chars(first, last, parsed);
+    if (result.ptr == end && !exhausted) {
+        // Очень длинная запись числа упёрлась в край буфера: дочитываем её целиком
+        std::size_t offset = first - pos;
+        last = pos + nextToken();
+        result = std::from_chars(pos + offset, last, parsed);
+    }
+    if (result.ec == std::errc::invalid_argument)
+        return false;
+    pos = result.ptr;
+    if (result.ec != std::errc())
+        return false;
+    value = parsed;
+    return true;
+}
+
+bool BufferedInputSource::readInt(int& value) {
+    return readNumber(value);
+}
+
+bool BufferedInputSource::readReal(double& value) {
+    return readNumber(value);
+}
+
+bool BufferedInputSource::readWord(std::string& word) {
+    std::size_t length = nextToken();
+    if (!length)
+        return false;
+    word.assign(pos, length);
+    pos += length;
+    return true;
+}
+
+void BufferedInputSource::skipLine() {
+    for (;;) {
+        if (pos != end) {
+            const void* newline = std::memchr(pos, '\n', end - pos);
+            if (newline) {
+                pos = static_cast<const char*>(newline) + 1;
+                return;
+            }
+            pos = end;
+        }
+        if (!refill())
+            return;
+    }
+}
+
+MemoryInputSource::MemoryInputSource(std::string text) : BufferedInputSource(0), text(std::move(text)) {
+    setWindow(this->text.data(), this->text.size());
+}
+
+StreamInputSource::StreamInputSource(std::istream& stream, std::size_t capacity)
+    : BufferedInputSource(capacity), stream(stream) {}
+
+std::size_t StreamInputSource::read(char* data, std::size_t capacity) {
+    std::streambuf* source = stream.rdbuf();
+    std::streamsize available = source->in_avail();
+    if (available > 0)
+        return static_cast<std::size_t>(source->sgetn(data, std::min<std::streamsize>(available, capacity)));
+    // Данных в буфере потока нет: читаем до конца строки, чтобы не ждать лишнего ввода
+    std::size_t count = 0;
+    while (count < capacity) {
+        int c = source->sbumpc();
+        if (c == std::char_traits<char>::eof()) {
+            stream.setstate(std::ios::eofbit);
+            break;
+        }
+        data[count++] = static_cast<char>(c);
+        if (c == '\n')
+            break;
+    }
+    return count;
+}
+
+PushInputSource::PushInputSource(Wait wait, std::size_t capacity)
+    : BufferedInputSource(capacity), wait(std::move(wait)) {}
+
+void PushInputSource::push(const std::string& text) {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending += text;
+}
+
+void PushInputSource::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    closed = true;
+}
+
+bool PushInputSource::ready() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return closed || !pending.empty();
+}
+
+std::size_t PushInputSource::read(char* data, std::size_t capacity) {
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!pending.empty()) {
+                std::size_t count = std::min(capacity, pending.size());
+                std::memcpy(data, pending.data(), count);
+                pending.erase(0, count);
+                return count;
+            }
+            if (closed)
+                return 0;
+        }
+        if (!wait)
+            return 0;
+        wait();
+    }
+}
+
+FdInputSource::FdInputSource(int fd, std::size_t capacity) : BufferedInputSource(capacity), fd(fd) {}
+
+std::size_t FdInputSource::read(char* data, std::size_t capacity) {
+    for (;;) {
+#ifdef _WIN32
+        int count = _read(fd, data, static_cast<unsigned>(std::min<std::size_t>(capacity, 0x40000000)));
+#else
+        ssize_t count = ::read(fd, data, capacity);
+#endif
+        if (count >= 0)
+            return static_cast<std::size_t>(count);
+        if (errno != EINTR)
+            throw std::runtime_error("Ошибка чтения из дескриптора " + std::to_string(fd) + ": " + std::strerror(errno));
+    }
+}
+
+MappedFileInputSource::MappedFileInputSource(const std::string& path)
+    : BufferedInputSource(0), mapping(nullptr), data(nullptr), size(0) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("Не удалось открыть файл ввода: " + path);
+    LARGE_INTEGER length;
+    if (!GetFileSizeEx(file, &length)) {
+        CloseHandle(file);
+        throw std::runtime_error("Не удалось определить размер файла ввода: " + path);
+    }
+    size = static_cast<std::size_t>(length.QuadPart);
+    if (size) {
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping)
+            data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    }
+    CloseHandle(file);
+    if (size && !data) {
+        if (mapping)
+            CloseHandle(mapping);
+        throw std::runtime_error("Не удалось отобразить файл ввода в память: " + path);
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("Не удалось открыть файл ввода: " + path);
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Не удалось определить размер файла ввода: " + path);
+    }
+    size = static_cast<std::size_t>(info.st_size);
+    if (size) {
+        void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED)
+            throw std::runtime_error("Не удалось отобразить файл ввода в память: " + path);
+        madvise(view, size, MADV_SEQUENTIAL);
+        data = static_cast<const char*>(view);
+    } else {
+        ::close(fd);
+    }
+#endif
+    setWindow(data ? data : "", size);
+}
+
+MappedFileInputSource::~MappedFileInputSource() {
+    if (!data)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle(mapping);
+#else
+    munmap(const_cast<char*>(data), size);
+#endif
+}
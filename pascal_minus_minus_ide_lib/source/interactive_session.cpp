@@ -0,0 +1,59 @@
+#include "interactive_session.h"
+#include "parser.h"
+#include "lexer.h"
+#include <stdexcept>
+
+InteractiveSession::InteractiveSession(const std::string& source, shared_ptr<IOutputSink> output, std::size_t stackSize)
+    : reporter(std::make_shared<ErrorReporter>(diagnostics)),
+      input(std::make_shared<PushInputSource>(&Coroutine::yield)) {
+    Lexer lexer(source, reporter);
+    Parser parser(lexer.tokenize(), reporter);
+    program = parser.parse();
+    if (reporter->hasErrors() || !program) {
+        reporter->flush();
+        throw std::runtime_error("Программа не загружена:\n" + diagnostics.str());
+    }
+
+    if (!output)
+        output = memoryOutput = std::make_shared<MemoryOutputSink>();
+    interpreter = std::make_unique<Interpreter>(reporter, output, input);
+    interpreter->setNames(lexer.getNames());
+    coroutine = std::make_unique<Coroutine>([this]() {
+        try {
+            interpreter->run(program);
+            success = !reporter->hasErrors();
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+    }, stackSize);
+}
+
+SessionStatus InteractiveSession::start() {
+    if (status != SessionStatus::Ready)
+        throw std::logic_error("Сессия уже начата");
+    return resume();
+}
+
+SessionStatus InteractiveSession::provideInput(const std::string& text) {
+    input->push(text);
+    return status == SessionStatus::NeedsInput ? resume() : status;
+}
+
+SessionStatus InteractiveSession::closeInput() {
+    input->close();
+    return status == SessionStatus::NeedsInput ? resume() : status;
+}
+
+std::string InteractiveSession::takeOutput() {
+    if (!memoryOutput)
+        return std::string();
+    std::string text = memoryOutput->str();
+    memoryOutput->clear();
+    return text;
+}
+
+// Сопрограмма приостанавливается только в ожидании ввода
+SessionStatus InteractiveSession::resume() {
+    status = coroutine->resume() ? SessionStatus::Finished : SessionStatus::NeedsInput;
+    return status;
+}
@@ -7,151 +7,222 @@
 #include "postfix.h"  // Добавляем включение postfix.h в исходный файл
 #include "logger.h"     // Для логирования
 
-// Реализация конструкторов Value (универсального контейнера значений)
-// ========================
+namespace {
 
-// Конструктор по умолчанию: значение типа Integer, равное 0
-Value::Value() : type(ValueType::Integer), intValue(0), realValue(0.0), boolValue(false), stringValue("") {}
+// Внутренний сигнал прерывания. Не наследует std::exception, поэтому обработчики
+// ошибок в операторах (например, в while) его не перехватывают
+struct InterruptSignal {
+    InterruptReason reason;
+};
 
-// Конструктор для целого значения
-Value::Value(int v) : type(ValueType::Integer), intValue(v), realValue(0.0), boolValue(false), stringValue("") {}
+// Часы читаются на каждой такой по счёту проверке прерывания
+constexpr unsigned CLOCK_CHECK_INTERVAL = 64;
 
-// Конструктор для вещественного значения
-Value::Value(double v) : type(ValueType::Real), intValue(0), realValue(v), boolValue(false), stringValue("") {}
+} // namespace
 
-// Конструктор для булевого значения
-Value::Value(bool v) : type(ValueType::Boolean), intValue(0), realValue(0.0), boolValue(v), stringValue("") {}
+// ========================
+// Интерпретатор
+// ========================
 
-// Конструктор для строкового значения
-Value::Value(const std::string& v) : type(ValueType::String), intValue(0), realValue(0.0), boolValue(false), stringValue(v) {}
+// Конструктор по умолчанию: консольная программа работает со стандартными потоками
+Interpreter::Interpreter()
+    : Interpreter(nullptr, std::make_shared<StreamOutputSink>(std::cout), std::make_shared<StreamInputSource>(std::cin)) {}
 
-// Методы преобразования типов
-int Value::toInt() const {
-    switch (type) {
-        case ValueType::Integer:
-            return intValue;
-        case ValueType::Real:
-            return static_cast<int>(realValue);
-        case ValueType::Boolean:
-            return boolValue ? 1 : 0;
-        case ValueType::String:
-            try {
-                return std::stoi(stringValue);
-            } catch (const std::exception&) {
-                throw std::runtime_error("Невозможно преобразовать строку \"" + stringValue + "\" в целое число");
-            }
-        default:
-            throw std::runtime_error("Неподдерживаемый тип для преобразования в целое");
+// Реализация константных методов для репортинга ошибок
+void Interpreter::reportError(const string& message, int line, int column) const {
+    if (errorReporter) {
+        errorReporter->reportError(message, line, column);
     }
 }
 
-double Value::toReal() const {
-    switch (type) {
-        case ValueType::Integer:
-            return static_cast<double>(intValue);
-        case ValueType::Real:
-            return realValue;
-        case ValueType::Boolean:
-            return boolValue ? 1.0 : 0.0;
-        case ValueType::String:
-            try {
-                return std::stod(stringValue);
-            } catch (const std::exception&) {
-                throw std::runtime_error("Невозможно преобразовать строку \"" + stringValue + "\" в вещественное число");
-            }
-        default:
-            throw std::runtime_error("Неподдерживаемый тип для преобразования в вещественное");
+void Interpreter::reportWarning(const string& message, int line, int column) const {
+    if (metrics)
+        metrics->warnings.add();
+    if (errorReporter) {
+        errorReporter->reportWarning(message, line, column);
     }
 }
 
-bool Value::toBool() const {
-    switch (type) {
-        case ValueType::Boolean:
-            return boolValue;
-        case ValueType::Integer:
-            return intValue != 0;
-        case ValueType::Real:
-            return realValue != 0.0;
-        case ValueType::String:
-            return !stringValue.empty() && stringValue != "0" && stringValue != "false";
-        default:
-            throw std::runtime_error("Неподдерживаемый тип для преобразования в логический");
-    }
+// Конструктор с указанием обработчика ошибок
+Interpreter::Interpreter(std::shared_ptr<IErrorReporter> reporter, std::shared_ptr<IOutputSink> outputSink,
+                         std::shared_ptr<IInputSource> inputSource, Logger* journal) 
+    : errorReporter(reporter ? reporter : std::make_shared<ErrorReporter>()), 
+      postfixCalculator(std::make_unique<PostfixCalculator>()),
+      variableLookup([this](NameId name, const std::string& text) -> const Value* {
+          const Value* variable = name != NO_NAME ? symbols.lookup(name) : symbols.lookup(text);
+          if (variable && metrics)
+              metrics->variableReads.add();
+          return variable;
+      }),
+      output(outputSink ? outputSink : std::make_shared<MemoryOutputSink>()),
+      input(inputSource ? inputSource : std::make_shared<MemoryInputSource>("")),
+      logger(journal) {
+    input->tie(output.get());
+    postfixCalculator->setMemoryAccount(&memory);
+    postfixCalculator->setLogger(journal);
 }
 
-std::string Value::toString() const {
-    std::ostringstream oss;
-    switch (type) {
-        case ValueType::String:
-            return stringValue;
-        case ValueType::Integer:
-            oss << intValue;
-            return oss.str();
-        case ValueType::Real:
-            oss << realValue;
-            return oss.str();
-        case ValueType::Boolean:
-            return boolValue ? "true" : "false";
-        default:
-            throw std::runtime_error("Неподдерживаемый тип для преобразования в строку");
+namespace {
+
+const char* const OPERATOR_NAMES[InterpreterMetrics::OPERATOR_COUNT] = {
+    "+", "-", "*", "/", "div", "mod", "=", "<>", "<", "<=", ">", ">=", "and", "or", "not"
+};
+const char* const TYPE_NAMES[InterpreterMetrics::TYPE_COUNT] = { "Integer", "Real", "Boolean", "String" };
+
+} // namespace
+
+InterpreterMetrics::InterpreterMetrics(MetricsRegistry& registry)
+    : programs(registry.counter("pmm_programs_total", "Запущено программ")),
+      expressions(registry.counter("pmm_expressions_total", "Вычислено выражений")),
+      variableReads(registry.counter("pmm_variable_reads_total", "Чтений переменных в выражениях")),
+      variableWrites(registry.counter("pmm_variable_writes_total", "Записей в переменные")),
+      bytesWritten(registry.counter("pmm_output_bytes_total", "Байт выведено write/writeln")),
+      valuesRead(registry.counter("pmm_input_values_total", "Значений прочитано read/readln")),
+      warnings(registry.counter("pmm_warnings_total", "Предупреждений интерпретатора")),
+      loopIterations(registry.histogram("pmm_loop_iterations", "Итераций на выполнение цикла",
+                                        { 1, 10, 100, 1000, 10000 })) {
+    for (std::size_t op = 0; op < OPERATOR_COUNT; ++op)
+        operators[op] = registry.counter("pmm_operators_total", "Выполнено операций", { { "operator", OPERATOR_NAMES[op] } });
+    for (std::size_t from = 0; from < TYPE_COUNT; ++from) {
+        for (std::size_t to = 0; to < TYPE_COUNT; ++to) {
+            if (from != to)
+                conversions[from][to] = registry.counter("pmm_conversions_total", "Неявных преобразований при присваивании",
+                                                         { { "from", TYPE_NAMES[from] }, { "to", TYPE_NAMES[to] } });
+        }
     }
 }
 
-// ========================
-// Интерпретатор
-// ========================
+Interpreter::~Interpreter() {
+    input->tie(nullptr);
+}
 
-// Конструктор по умолчанию
-Interpreter::Interpreter() : errorReporter(std::make_shared<ErrorReporter>()) {
-    // Создаём постфиксный калькулятор для вычисления выражений
-    postfixCalculator = std::make_unique<PostfixCalculator>();
+void Interpreter::setMetrics(const InterpreterMetrics* target) {
+    metrics = target;
+    postfixCalculator->setOperatorCounters(target ? target->operators.data() : nullptr);
 }
 
-// Реализация константных методов для репортинга ошибок
-void Interpreter::reportError(const string& message, int line, int column) const {
-    if (errorReporter) {
-        errorReporter->reportError(message, line, column);
-    }
+void Interpreter::setOutputSink(std::shared_ptr<IOutputSink> outputSink) {
+    output->flush();
+    output = outputSink ? outputSink : std::make_shared<MemoryOutputSink>();
+    input->tie(output.get());
 }
 
-void Interpreter::reportWarning(const string& message, int line, int column) const {
-    if (errorReporter) {
-        errorReporter->reportWarning(message, line, column);
+void Interpreter::setInputSource(std::shared_ptr<IInputSource> inputSource) {
+    input->tie(nullptr);
+    input = inputSource ? inputSource : std::make_shared<MemoryInputSource>("");
+    input->tie(output.get());
+}
+
+void Interpreter::setLogger(Logger* target) {
+    logger = target;
+    postfixCalculator->setLogger(target);
+}
+
+void Interpreter::setCancellationToken(std::shared_ptr<const CancellationToken> token) {
+    cancellation = std::move(token);
+    interruptible = cancellation || deadline != std::chrono::steady_clock::time_point::max();
+}
+
+void Interpreter::setDeadline(std::chrono::steady_clock::time_point newDeadline) {
+    deadline = newDeadline;
+    checksToClock = 1;
+    interruptible = cancellation || deadline != std::chrono::steady_clock::time_point::max();
+}
+
+void Interpreter::pollInterrupt() {
+    if (cancellation && cancellation->isCancelled())
+        throw InterruptSignal{ InterruptReason::Cancelled };
+    if (deadline != std::chrono::steady_clock::time_point::max() && --checksToClock == 0) {
+        checksToClock = CLOCK_CHECK_INTERVAL;
+        if (std::chrono::steady_clock::now() >= deadline)
+            throw InterruptSignal{ InterruptReason::DeadlineExceeded };
     }
 }
 
-// Конструктор с указанием обработчика ошибок
-Interpreter::Interpreter(std::shared_ptr<IErrorReporter> reporter) 
-    : errorReporter(reporter ? reporter : std::make_shared<ErrorReporter>()), 
-      postfixCalculator(std::make_unique<PostfixCalculator>()) {}
+void Interpreter::setYieldHook(std::function<void()> hook, std::size_t interval) {
+    yieldHook = std::move(hook);
+    yieldInterval = interval ? interval : 1;
+    backEdgesToYield = yieldInterval;
+}
       
 // Проверка существования переменной
 bool Interpreter::isDeclared(const std::string& name) const {
-    return symbols.find(name) != symbols.end();
+    return symbols.contains(name);
 }
 
 // Получение значения переменной
 Value Interpreter::getVariable(const std::string& name) const {
-    auto it = symbols.find(name);
-    if (it == symbols.end()) {
+    const Value* value = symbols.lookup(name);
+    if (!value) {
         throw std::runtime_error("Неизвестная переменная: " + name);
     }
-    return it->second;
+    return *value;
 }
 
-// Установка значения переменной
+// Установка значения переменной (необъявленная переменная объявляется в текущей области)
 void Interpreter::setVariable(const std::string& name, const Value& value) {
-    symbols[name] = value;
+    try {
+        if (Value* existing = symbols.lookup(name))
+            storeValue(*existing, value);
+        else
+            declareSymbol(symbols.intern(name), value);
+    } catch (const MemoryLimitExceeded&) {
+        throw std::runtime_error("Превышен лимит памяти интерпретатора: " + name);
+    }
+}
+
+Value* Interpreter::declareSymbol(NameId name, Value value) {
+    if (symbols.declaredInCurrentScope(name)) {
+        Value* existing = symbols.lookup(name);
+        storeValue(*existing, std::move(value));
+        return existing;
+    }
+    std::size_t stringBytes = MemoryAccount::heapBytes(value);
+    memory.charge(MemoryCategory::Strings, stringBytes);
+    AllocationProfiler::SiteScope site(AllocationSite::Symbols);
+    Value* declared = symbols.declare(name, value);
+    // Копия строки в таблице может занимать меньше исходной
+    memory.resize(MemoryCategory::Strings, stringBytes, MemoryAccount::heapBytes(*declared));
+    accountSymbols();
+    return declared;
+}
+
+// Строки учитываются по capacity: после перемещения она совпадает с capacity нового значения
+void Interpreter::storeValue(Value& target, Value value) {
+    if (target.type == ValueType::String || value.type == ValueType::String)
+        memory.resize(MemoryCategory::Strings, MemoryAccount::heapBytes(target), MemoryAccount::heapBytes(value));
+    target = std::move(value);
+}
+
+void Interpreter::accountSymbols() {
+    std::size_t bytes = symbols.storageBytes();
+    memory.resize(MemoryCategory::Symbols, symbolBytes, bytes);
+    symbolBytes = bytes;
+}
+
+// Снимок видимых переменных для интерфейса IInterpreter
+const std::map<std::string, Value>& Interpreter::getAllSymbols() const {
+    symbolsSnapshot = symbols.snapshot();
+    return symbolsSnapshot;
 }
 
 // Очистка всех символов
 void Interpreter::clearSymbols() {
     symbols.clear();
+    memory.release(MemoryCategory::Strings, memory.current(MemoryCategory::Strings));
+    accountSymbols();
+}
+
+// Переменные прежней таблицы имён недоступны по номерам новой
+void Interpreter::setNames(std::shared_ptr<NameTable> names) {
+    clearSymbols();
+    symbols.setNames(std::move(names));
+    accountSymbols();
 }
 
 // Оценка выражения по строке (интерфейсный метод)
 Value Interpreter::evaluate(const std::string& expression) {
-    LOG_INFO("Evaluating expression: " + expression);
+    LOG_TO(logger, LogLevel::Info, "Evaluating expression: " + expression);
     // Здесь должен быть код парсинга строки в AST
     // Для простоты вернем заглушку
     Value result;
@@ -173,18 +244,64 @@ Value Interpreter::evaluateExpression(const std::shared_ptr<ASTNode>& expression
 
 /**
  * Главный метод интерпретации программы Pascal--
- * Рекурсивно обрабатывает узлы AST, начиная с корневого узла
+ * Выполняет программу и сбрасывает накопленный вывод, в том числе при ошибке
  * @param root Корневой узел AST программы
  */
 void Interpreter::run(const std::shared_ptr<ASTNode>& root) {
+#ifdef ENABLE_LOGGING
+    LOG_TO(logger, LogLevel::Info, "Начало выполнения программы");
+#endif
+    memory.resetPeak();
+    if (metrics)
+        metrics->programs.add();
+    tracedBlock = nullptr;
+    if (tracer && root && root->type == ASTNodeType::Program) {
+        for (const auto& part : root->children) {
+            if (part->type == ASTNodeType::Block)
+                tracedBlock = part.get();
+        }
+    }
+    AllocationProfiler::PhaseScope phase(AllocationPhase::Execution);
+    try {
+        MemoryAccount::ScopedCharge program(memory, MemoryCategory::Ast, root ? MemoryAccount::astBytes(*root) : 0);
+        TraceRecorder::Span span(tracer, "phase", "выполнение");
+        executeStatement(root);
+    } catch (const InterruptSignal& signal) {
+        interrupt(signal.reason);
+    } catch (const MemoryLimitExceeded&) {
+        interrupt(InterruptReason::MemoryLimit);
+    } catch (...) {
+        output->flush();
+        errorReporter->flush();
+        throw;
+    }
+    output->flush();
+    errorReporter->flush();
+}
+
+// Сигналы прерывания проходят мимо обработчиков std::exception в операторах; переменные сохранены
+void Interpreter::interrupt(InterruptReason reason) {
+    ExecutionInterrupted interrupted(reason);
+    reportError(interrupted.what());
+    output->flush();
+    errorReporter->flush();
+    throw interrupted;
+}
+
+/**
+ * Рекурсивно обрабатывает узлы AST, начиная с указанного
+ * @param root Узел AST оператора
+ */
+void Interpreter::executeStatement(const std::shared_ptr<ASTNode>& root) {
+    checkInterrupt();
+    NodeProfiler::Scope profile(profiler, root.get());
+    AllocationProfiler::StatementScope allocations(allocationProfiler, root.get());
+    PositionScope at(position, root.get());
     if (!root) {
         reportWarning("Пустая программа");
         return; // Если узел пустой — ничего не делаем
     }
     
-#ifdef ENABLE_LOGGING
-    LOG_INFO("Начало выполнения программы");
-#endif
     switch (root->type) {
     case ASTNodeType::ConstDecl: {
         const std::string& name = root->value;
@@ -192,16 +309,18 @@ void Interpreter::run(const std::shared_ptr<ASTNode>& root) {
         // Используем постфиксный калькулятор для вычисления выражения
         Value val = evaluateUsingPostfix(root->children[1]);
         
-        LOG_DEBUG("Объявление константы " + name + " типа " + typeName);
+        LOG_TO(logger, LogLevel::Debug, "Объявление константы " + name + " типа " + typeName);
+        // Номер имени выдан общей с лексером таблицей имён и берётся как есть
+        NameId id = symbols.getNames()->resolve(root->name, name);
         
         if (typeName == "real" || typeName == "double")
-            symbols[name] = Value(val.realValue);
+            declareSymbol(id, Value(val.realValue));
         else if (typeName == "integer")
-            symbols[name] = Value(val.intValue);
+            declareSymbol(id, Value(val.intValue));
         else if (typeName == "boolean")
-            symbols[name] = Value(val.boolValue);
+            declareSymbol(id, Value(val.boolValue));
         else if (typeName == "string")
-            symbols[name] = Value(val.stringValue);
+            declareSymbol(id, Value(val.stringValue));
         else
             throw std::runtime_error("Неизвестный тип константы: " + typeName);
         break;
@@ -211,17 +330,18 @@ void Interpreter::run(const std::shared_ptr<ASTNode>& root) {
             const std::string& name = root->value;
             const std::string& typeName = normalizeTypeName(root->children[0]->value);
             
-            LOG_DEBUG("Объявление переменной " + name + " типа " + typeName);
+            LOG_TO(logger, LogLevel::Debug, "Объявление переменной " + name + " типа " + typeName);
+            NameId id = symbols.getNames()->resolve(root->name, name);
             
             // Создаем переменную с нулевым значением соответствующего типа
             if (typeName == "real" || typeName == "double") {
-                symbols[name] = Value(0.0);
+                declareSymbol(id, Value(0.0));
             } else if (typeName == "integer") {
-                symbols[name] = Value(0);
+                declareSymbol(id, Value(0));
             } else if (typeName == "boolean") {
-                symbols[name] = Value(false);
+                declareSymbol(id, Value(false));
             } else if (typeName == "string") {
-                symbols[name] = Value("");
+                declareSymbol(id, Value(std::string()));
             } else {
                 reportError("Неизвестный тип переменной: " + typeName);
                 throw std::runtime_error("Неизвестный тип переменной: " + typeName);
@@ -236,8 +356,15 @@ void Interpreter::run(const std::shared_ptr<ASTNode>& root) {
     case ASTNodeType::Block:
     case ASTNodeType::ConstSection:
     case ASTNodeType::VarSection:
+        if (tracer && root.get() == tracedBlock) {
+            for (const auto& stmt : root->children) {
+                TraceRecorder::Span span(tracer, "statement", NodeProfiler::label(*stmt));
+                executeStatement(stmt);
+            }
+            break;
+        }
         for (const auto& stmt : root->children)
-            run(stmt);
+            executeStatement(stmt);
         break;
     case ASTNodeType::Assignment:
         executeAssignment(root);
@@ -271,7 +398,7 @@ void Interpreter::run(const std::shared_ptr<ASTNode>& root) {
     // Удалены упоминания процедур и функций (Call, Return)
     case ASTNodeType::Expression:
     default:
-        std::cerr << "Неизвестный оператор типа: " << static_cast<int>(root->type) << std::endl;
+        reportError("Неизвестный оператор типа: " + std::to_string(static_cast<int>(root->type)));
         throw std::runtime_error("Неизвестный оператор");
     }
 }
@@ -281,7 +408,7 @@ void Interpreter::run(const std::shared_ptr<ASTNode>& root) {
 // Реализация executeFor как метода класса Interpreter
 void Interpreter::executeFor(const std::shared_ptr<ASTNode>& node) {
     try {
-        LOG_DEBUG("Выполнение цикла for");
+        LOG_TO(logger, LogLevel::Debug, "Выполнение цикла for");
         std::string varName = node->value;
         bool isDownto = false;
         size_t pipePos = varName.find('|');
@@ -310,36 +437,27 @@ void Interpreter::executeFor(const std::shared_ptr<ASTNode>& node) {
                 throw std::runtime_error("Конечное значение цикла for должно быть числовым");
             }
         }
-        Value oldValue;
-        bool varExists = isDeclared(varName);
-        if (varExists) {
-            oldValue = getVariable(varName);
+        // Переменная цикла живёт в собственной области видимости: после выхода
+        // из цикла (в том числе по исключению) внешнее значение восстанавливается
+        ScopedSymbolTable::ScopeGuard loopScope(symbols);
+        NameId loopName = symbols.getNames()->resolve(node->name, varName);
+        Value* loopVar;
+        {
+            AllocationProfiler::SiteScope site(AllocationSite::Symbols);
+            loopVar = symbols.declare(loopName, Value(fromVal.intValue));
         }
-        class VariableRestorer {
-        public:
-            VariableRestorer(std::map<std::string, Value>& symbols, const std::string& name, bool exists, const Value& oldVal) 
-                : symbols_(symbols), name_(name), exists_(exists), oldVal_(oldVal) {}
-            ~VariableRestorer() {
-                if (exists_) {
-                    symbols_[name_] = oldVal_;
-                } else {
-                    symbols_.erase(name_);
-                }
-            }
-        private:
-            std::map<std::string, Value>& symbols_;
-            std::string name_;
-            bool exists_;
-            Value oldVal_;
-        };
-        VariableRestorer restorer(symbols, varName, varExists, oldValue);
+        accountSymbols();
         int iterations = 0;
         const int MAX_ITERATIONS = 10000;
+        TraceRecorder::Span span(tracer, "loop", tracer ? NodeProfiler::label(*node) : std::string());
         try {
             if (isDownto) {
                 for (int i = fromVal.intValue; i >= toVal.intValue; --i) {
-                    symbols[varName] = Value(i);
-                    run(body);
+                    *loopVar = Value(i);
+                    if (metrics)
+                        metrics->variableWrites.add();
+                    executeStatement(body);
+                    onBackEdge();
                     iterations++;
                     if (iterations > MAX_ITERATIONS) {
                         reportWarning("Возможный бесконечный цикл for downto (превышено максимальное число итераций)");
@@ -348,8 +466,11 @@ void Interpreter::executeFor(const std::shared_ptr<ASTNode>& node) {
                 }
             } else {
                 for (int i = fromVal.intValue; i <= toVal.intValue; ++i) {
-                    symbols[varName] = Value(i);
-                    run(body);
+                    *loopVar = Value(i);
+                    if (metrics)
+                        metrics->variableWrites.add();
+                    executeStatement(body);
+                    onBackEdge();
                     iterations++;
                     if (iterations > MAX_ITERATIONS) {
                         reportWarning("Возможный бесконечный цикл for to (превышено максимальное число итераций)");
@@ -357,7 +478,10 @@ void Interpreter::executeFor(const std::shared_ptr<ASTNode>& node) {
                     }
                 }
             }
-            LOG_DEBUG("Завершение цикла for после " + std::to_string(iterations) + " итераций");
+            span.setArg("iterations", iterations);
+            if (metrics)
+                metrics->loopIterations.observe(iterations);
+            LOG_TO(logger, LogLevel::Debug, "Завершение цикла for после " + std::to_string(iterations) + " итераций");
         } catch (const std::exception& e) {
             reportError(std::string("Ошибка при выполнении цикла for: ") + e.what());
             throw;
@@ -366,6 +490,7 @@ void Interpreter::executeFor(const std::shared_ptr<ASTNode>& node) {
         reportError(std::string("Ошибка в цикле for: ") + e.what());
         throw;
     }
+    accountSymbols();
 }
 
 // Метод evaluateExpression реализован в другом месте файла
@@ -380,22 +505,27 @@ std::string Interpreter::normalizeTypeName(const std::string& typeName) {
 void Interpreter::executeAssignment(const shared_ptr<ASTNode>& node) {
     try {
         // Обычное присваивание переменной
-        std::string varName = node->children[0]->value;
+        const std::string& varName = node->children[0]->value;
         
         // Проверяем, что переменная объявлена
-        if (!isDeclared(varName)) {
+        NameId targetName = node->children[0]->name;
+        Value* target = targetName != NO_NAME ? symbols.lookup(targetName) : symbols.lookup(varName);
+        if (!target) {
             reportError("Переменная не объявлена: " + varName);
             throw std::runtime_error("Переменная не объявлена: " + varName);
         }
         
         // Получаем текущий тип переменной
-        ValueType varType = getValueType(varName);
+        ValueType varType = target->type;
         
         // Используем постфиксную форму для вычисления выражения
         Value value = evaluateUsingPostfix(node->children[1]);
         
         // Проверяем совместимость типов и выполняем преобразование если необходимо
         if (value.type != varType) {
+            AllocationProfiler::SiteScope site(AllocationSite::Strings);
+            if (metrics)
+                metrics->conversions[static_cast<std::size_t>(value.type)][static_cast<std::size_t>(varType)].add();
             try {
                 switch (varType) {
                     case ValueType::Integer:
@@ -421,7 +551,9 @@ void Interpreter::executeAssignment(const shared_ptr<ASTNode>& node) {
         }
         
         // Сохраняем новое значение
-        symbols[varName] = value;
+        storeValue(*target, std::move(value));
+        if (metrics)
+            metrics->variableWrites.add();
     } catch (const std::exception& e) {
         reportError(std::string("Ошибка при выполнении присваивания: ") + e.what());
         throw;
@@ -439,13 +571,13 @@ void Interpreter::executeIf(const shared_ptr<ASTNode>& node) {
             cond = Value(cond.toBool()); // Преобразуем к булевому типу
         }
         
-        LOG_DEBUG("Выполнение условного оператора if, условие: " + std::string(cond.boolValue ? "true" : "false"));
+        LOG_TO(logger, LogLevel::Debug, "Выполнение условного оператора if, условие: " + std::string(cond.boolValue ? "true" : "false"));
         
         // Выполняем соответствующую ветвь
         if (cond.boolValue)
-            run(node->children[1]); // then блок
+            executeStatement(node->children[1]); // then блок
         else if (node->children.size() > 2)
-            run(node->children[2]); // else блок (если есть)
+            executeStatement(node->children[2]); // else блок (если есть)
     } catch (const std::exception& e) {
         reportError(std::string("Ошибка при выполнении условного оператора: ") + e.what());
     }
@@ -453,11 +585,12 @@ void Interpreter::executeIf(const shared_ptr<ASTNode>& node) {
 
 void Interpreter::executeWhile(const shared_ptr<ASTNode>& node) {
     try {
-        LOG_DEBUG("Начало выполнения цикла while");
+        LOG_TO(logger, LogLevel::Debug, "Начало выполнения цикла while");
         
         // Счетчик итераций для защиты от бесконечных циклов
         int iterations = 0;
         const int MAX_ITERATIONS = 10000; // Максимальное число итераций
+        TraceRecorder::Span span(tracer, "loop", tracer ? NodeProfiler::label(*node) : std::string());
         
         while (true) {
             // Вычисляем условие с использованием постфиксной формы
@@ -474,7 +607,8 @@ void Interpreter::executeWhile(const shared_ptr<ASTNode>& node) {
                 break;
                 
             // Выполняем тело цикла
-            run(node->children[1]);
+            executeStatement(node->children[1]);
+            onBackEdge();
             
             // Проверка на бесконечный цикл
             iterations++;
@@ -483,8 +617,11 @@ void Interpreter::executeWhile(const shared_ptr<ASTNode>& node) {
                 break;
             }
         }
+        span.setArg("iterations", iterations);
+        if (metrics)
+            metrics->loopIterations.observe(iterations);
         
-        LOG_DEBUG("Завершение цикла while после " + std::to_string(iterations) + " итераций");
+        LOG_TO(logger, LogLevel::Debug, "Завершение цикла while после " + std::to_string(iterations) + " итераций");
     } catch (const std::exception& e) {
         reportError(std::string("Ошибка при выполнении цикла while: ") + e.what());
     }
@@ -492,101 +629,96 @@ void Interpreter::executeWhile(const shared_ptr<ASTNode>& node) {
 
 void Interpreter::executeWrite(const shared_ptr<ASTNode>& node) {
     try {
-        LOG_DEBUG("Выполнение оператора write/writeln");
+        LOG_TO(logger, LogLevel::Debug, "Выполнение оператора write/writeln");
         
         for (size_t i = 0; i < node->children.size(); ++i) {
             // Используем постфиксный калькулятор для вычисления выражения
             Value val = evaluateUsingPostfix(node->children[i]);
             
             // Выводим значение в зависимости от его типа
-            switch (val.type) {
-            case ValueType::Integer: 
-                cout << val.intValue; 
-                break;
-            case ValueType::Real: 
-                cout << val.realValue; 
-                break;
-            case ValueType::Boolean: 
-                cout << (val.boolValue ? "true" : "false"); 
-                break;
-            case ValueType::String: 
-                cout << val.stringValue; 
-                break;
-            default:
-                reportWarning("Неподдерживаемый тип данных для вывода");
-                cout << "[Неизвестный тип]";
-                break;
-            }
+            std::size_t bytes = writeValue(*output, val);
             
             // Добавляем пробел между элементами
-            if (i + 1 < node->children.size()) 
-                cout << " ";
+            if (i + 1 < node->children.size()) {
+                output->write(" ", 1);
+                ++bytes;
+            }
+            if (metrics)
+                metrics->bytesWritten.add(bytes);
         }
     } catch (const std::exception& e) {
         reportError(std::string("Ошибка при выполнении write/writeln: ") + e.what());
     }
-    if (node->type == ASTNodeType::Writeln) cout << endl;
+    if (node->type == ASTNodeType::Writeln) {
+        output->endLine();
+        if (metrics)
+            metrics->bytesWritten.add();
+    }
 }
 
 void Interpreter::executeRead(const shared_ptr<ASTNode>& node) {
+    // Вывод сбрасывается источником ввода (tie) только перед ожиданием новых данных
     try {
-        LOG_DEBUG("Выполнение оператора read/readln");
+        LOG_TO(logger, LogLevel::Debug, "Выполнение оператора read/readln");
         
         for (const auto& child : node->children) {
             // Получаем имя переменной
-            string varName = child->value;
+            const string& varName = child->value;
             
             // Проверяем, что переменная существует
-            if (!isDeclared(varName)) {
+            Value* target = child->name != NO_NAME ? symbols.lookup(child->name) : symbols.lookup(varName);
+            if (!target) {
                 reportError("Попытка чтения в необъявленную переменную: " + varName);
                 continue;
             }
             
             // Определяем тип переменной
-            ValueType varType = getValueType(varName);
+            ValueType varType = target->type;
             
             // Вводим значение в зависимости от типа переменной
+            AllocationProfiler::SiteScope site(AllocationSite::Strings);
+            bool stored = false;
             switch (varType) {
                 case ValueType::Integer: {
                     int v;
-                    if (cin >> v) {
-                        symbols[varName] = Value(v);
+                    if (input->readInt(v)) {
+                        *target = Value(v);
+                        stored = true;
                     } else {
                         reportError("Ошибка при чтении целого числа");
-                        cin.clear(); // Сбрасываем состояние ошибки
                     }
                     break;
                 }
                 case ValueType::Real: {
                     double v;
-                    if (cin >> v) {
-                        symbols[varName] = Value(v);
+                    if (input->readReal(v)) {
+                        *target = Value(v);
+                        stored = true;
                     } else {
                         reportError("Ошибка при чтении вещественного числа");
-                        cin.clear(); // Сбрасываем состояние ошибки
                     }
                     break;
                 }
                 case ValueType::Boolean: {
-                    string input;
-                    if (cin >> input) {
+                    string word;
+                    if (input->readWord(word)) {
                         // Преобразовываем введенный текст в булево значение
-                        transform(input.begin(), input.end(), input.begin(), ::tolower);
-                        bool value = (input == "true" || input == "1" || input == "yes");
-                        symbols[varName] = Value(value);
+                        transform(word.begin(), word.end(), word.begin(), ::tolower);
+                        bool value = (word == "true" || word == "1" || word == "yes");
+                        *target = Value(value);
+                        stored = true;
                     } else {
                         reportError("Ошибка при чтении логического значения");
-                        cin.clear(); // Сбрасываем состояние ошибки
                     }
                     break;
                 }
                 case ValueType::String: {
                     string v;
-                    if (cin >> v) {
-                        symbols[varName] = Value(v);
+                    if (input->readWord(v)) {
+                        storeValue(*target, Value(v));
+                        stored = true;
                     } else {
                         reportError("Ошибка при чтении строки");
-                        cin.clear(); // Сбрасываем состояние ошибки
                     }
                     break;
                 }
@@ -595,17 +727,20 @@ void Interpreter::executeRead(const shared_ptr<ASTNode>& node) {
                     break;
                 }
             }
+            if (stored && metrics) {
+                metrics->valuesRead.add();
+                metrics->variableWrites.add();
+            }
         }
         
         // Для readln пропускаем остаток строки
         if (node->type == ASTNodeType::Readln) {
-            LOG_DEBUG("Чтение до конца строки (readln)");
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            LOG_TO(logger, LogLevel::Debug, "Чтение до конца строки (readln)");
+            input->skipLine();
         }
     } catch (const std::exception& e) {
         reportError(std::string("Ошибка при выполнении read/readln: ") + e.what());
-        cin.clear(); // Сбрасываем состояние ошибки
-        cin.ignore(numeric_limits<streamsize>::max(), '\n'); // Пропускаем остаток строки
+        input->skipLine(); // Пропускаем остаток строки
     }
 }
 
@@ -613,21 +748,21 @@ void Interpreter::executeRead(const shared_ptr<ASTNode>& node) {
 int Interpreter::getVarValue(const string& name) const {
     try {
         // Проверяем существование переменной
-        auto it = symbols.find(name);
-        if (it == symbols.end()) {
+        const Value* value = symbols.lookup(name);
+        if (!value) {
             reportError("Переменная не найдена: " + name, 0, 0);  // Добавляем параметры line и column
             throw std::runtime_error("Переменная не найдена: " + name);
         }
         
         // Если переменная целого типа, возвращаем её значение
-        if (it->second.type == ValueType::Integer) {
-            return it->second.intValue;
+        if (value->type == ValueType::Integer) {
+            return value->intValue;
         } else {
             // Для других типов пытаемся преобразовать к целому
-            return it->second.toInt();
+            return value->toInt();
         }
     } catch (const std::exception& e) {
-        LOG_ERROR(std::string("Ошибка при получении значения переменной: ") + e.what());
+        LOG_TO(logger, LogLevel::Error, std::string("Ошибка при получении значения переменной: ") + e.what());
         throw; // Перебрасываем исключение дальше
     }
 }
@@ -637,18 +772,18 @@ int Interpreter::getVarValue(const string& name) const {
 ValueType Interpreter::getValueType(const string& name) const {
     try {
         // Проверяем существование переменной в таблице символов
-        auto it = symbols.find(name);
-        if (it == symbols.end()) {
+        const Value* value = symbols.lookup(name);
+        if (!value) {
             // Если переменная не найдена, генерируем ошибку с указанием нулевых координат
             reportError("Переменная не найдена: " + name, 0, 0);
             throw std::runtime_error("Переменная не найдена: " + name);
         }
         
         // Возвращаем тип переменной из таблицы символов
-        return it->second.type;
+        return value->type;
     } catch (const std::exception& e) {
         // Логируем ошибку и перебрасываем исключение дальше
-        LOG_ERROR(std::string("Ошибка при определении типа переменной: ") + e.what());
+        LOG_TO(logger, LogLevel::Error, std::string("Ошибка при определении типа переменной: ") + e.what());
         throw; // Перебрасываем исключение дальше
     }
 }
@@ -661,13 +796,16 @@ ValueType Interpreter::getValueType(const string& name) const {
  * @return Значение выражения
  */
 Value Interpreter::evaluateUsingPostfix(const std::shared_ptr<ASTNode>& node) {
+    NodeProfiler::Scope profile(profiler, node.get());
+    PositionScope at(position, node.get());
+    if (metrics)
+        metrics->expressions.add();
     try {
         // Используем метод evaluate из интерфейса IPostfixCalculator
         // Приводим типы к совместимым с интерфейсом
         if (postfixCalculator) {
-            // Передаем таблицу символов в калькулятор для доступа к переменным
-            const std::map<std::string, Value>& vars = symbols;
-            return postfixCalculator->evaluate(node, vars);
+            // Калькулятор получает переменные через поиск в таблице с областями видимости
+            return postfixCalculator->evaluate(node, variableLookup);
         } else {
             // Ошибка, если калькулятор не инициализирован
             throw std::runtime_error("PostfixCalculator not initialized");
@@ -1,10 +1,11 @@
 #include "lexer.h"
+#include "allocation_profiler.h"
 
 // Конструктор по умолчанию для токена: устанавливает тип EndOfFile и пустые значения
-Token::Token() : type(TokenType::EndOfFile), value(""), line(0), column(0) {}
+Token::Token() : type(TokenType::EndOfFile), value(""), name(NO_NAME), line(0), column(0) {}
 
 // Конструктор токена с параметрами: тип, значение, строка и столбец
-Token::Token(TokenType t, const string& v, int l, int c) : type(t), value(v), line(l), column(c) {}
+Token::Token(TokenType t, const string& v, int l, int c) : type(t), value(v), name(NO_NAME), line(l), column(c) {}
 
 // Проверка: является ли символ латинской или кириллической буквой (Windows-1251)
 bool isAlphaCyrillic(unsigned char c) {
@@ -18,11 +19,13 @@ bool isAlphaCyrillic(unsigned char c) {
 }
 
 // Конструктор лексера: принимает исходный текст программы
-Lexer::Lexer(const string& source) : source(source), position(0), line(1), column(1), errorReporter(nullptr) {}
+Lexer::Lexer(const string& source)
+    : source(source), position(0), line(1), column(1), errorReporter(nullptr), names(std::make_shared<NameTable>()) {}
 
-// Конструктор лексера с обработчиком ошибок
-Lexer::Lexer(const string& source, std::shared_ptr<IErrorReporter> reporter) 
-    : source(source), position(0), line(1), column(1), errorReporter(reporter) {}
+// Конструктор лексера с обработчиком ошибок и таблицей имён запуска (nullptr - своя таблица)
+Lexer::Lexer(const string& source, std::shared_ptr<IErrorReporter> reporter, std::shared_ptr<NameTable> nameTable)
+    : source(source), position(0), line(1), column(1), errorReporter(reporter),
+      names(nameTable ? std::move(nameTable) : std::make_shared<NameTable>()) {}
 
 // Получить текущий символ
 char Lexer::current() const {
@@ -91,7 +94,7 @@ Token Lexer::makeToken(TokenType type, const string& value) {
 
 // Получить таблицу ключевых слов Pascal
 const unordered_map<string, TokenType>& Lexer::getKeywords() const {
-    static unordered_map<string, TokenType> keywords = {
+    static const unordered_map<string, TokenType> keywords = {
         {"program", TokenType::Program},
         {"var", TokenType::Var},
         {"const", TokenType::Const},
@@ -168,7 +171,10 @@ Token Lexer::readIdentifierOrKeyword() {
     if (it != keywords.end())
         return makeToken(it->second, text);
 
-    return makeToken(TokenType::Identifier, text);
+    // Идентификаторы интернируются: дальше имена сравниваются по номеру
+    Token token = makeToken(TokenType::Identifier, text);
+    token.name = names->intern(text);
+    return token;
 }
 
 // Прочитать строковый литерал (в одинарных или двойных кавычках)
@@ -208,6 +214,8 @@ Token Lexer::readString() {
 
 // Основной метод: разбить исходный текст на токены
 vector<Token> Lexer::tokenize() {
+    AllocationProfiler::PhaseScope phase(AllocationPhase::Lexing);
+    AllocationProfiler::SiteScope site(AllocationSite::Tokens);
     vector<Token> tokens;
 
     while (current() != '\0') {
@@ -220,6 +228,8 @@ vector<Token> Lexer::tokenize() {
         char c = current();
         if (c == '\0')
             break;
+        int startLine = line;
+        int startCol = column;
 
         if (isAlphaCyrillic((unsigned char)c) || c == '_')
             tokens.push_back(readIdentifierOrKeyword());
@@ -307,6 +317,9 @@ vector<Token> Lexer::tokenize() {
                 throw runtime_error(error);
             }
         }
+        // Позиция токена - его начало, а не место, где лексер закончил чтение
+        tokens.back().line = startLine;
+        tokens.back().column = startCol;
     }
 
     tokens.push_back(makeToken(TokenType::EndOfFile, ""));
@@ -0,0 +1,318 @@
+#include "logger.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <thread>
+
+namespace {
+
+// Название уровня, дополненное пробелами до 7 символов
+const char* levelName(LogLevel level) {
+    switch (level) {
+    case LogLevel::Debug: return "DEBUG  ";
+    case LogLevel::Info: return "INFO   ";
+    case LogLevel::Warning: return "WARNING";
+    case LogLevel::Error: return "ERROR  ";
+    case LogLevel::Fatal: return "FATAL  ";
+    }
+    return "?      ";
+}
+
+// Метка времени, которая пересчитывается не чаще раза в секунду
+class TimestampCache {
+public:
+    const char* format(std::time_t time) {
+        if (time != second) {
+            std::tm tm_buf;
+#ifdef _WIN32
+            localtime_s(&tm_buf, &time);
+#else
+            localtime_r(&time, &tm_buf);
+#endif
+            std::strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", &tm_buf);
+            second = time;
+        }
+        return text;
+    }
+
+private:
+    std::time_t second = -1;
+    char text[32] = {};
+};
+
+void appendLine(std::string& out, TimestampCache& timestamps, std::time_t time, LogLevel level,
+                const char* text, std::size_t length) {
+    out.append(timestamps.format(time));
+    out.append(" [");
+    out.append(levelName(level));
+    out.append("] ");
+    out.append(text, length);
+    out.push_back('\n');
+}
+
+std::time_t currentTime() {
+    return std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+}
+
+} // namespace
+
+/**
+ * Асинхронный режим логгера: ограниченная очередь записей фиксированного размера
+ * (много производителей, один потребитель) и фоновый поток записи.
+ * Каждая ячейка хранит номер позиции: производитель занимает позицию CAS-ом по tail
+ * и публикует запись, записывая в ячейку номер позиции + 1; писатель освобождает
+ * ячейку, записывая номер позиции следующего круга.
+ */
+class AsyncLogBackend {
+public:
+    AsyncLogBackend(Logger& logger, const AsyncLogOptions& options)
+        : logger(logger), overflow(options.overflow) {
+        std::size_t capacity = 2;
+        while (capacity < options.capacity)
+            capacity *= 2;
+        cells.reset(new Cell[capacity]);
+        for (std::size_t i = 0; i < capacity; ++i)
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        mask = capacity - 1;
+        writer = std::thread([this]() { run(); });
+    }
+
+    // Дописывает оставшиеся записи и останавливает поток записи
+    ~AsyncLogBackend() {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            stopping.store(true);
+        }
+        wake.notify_one();
+        writer.join();
+    }
+
+    void push(LogLevel level, std::time_t time, const std::string& message) {
+        if (tryPush(level, time, message)) {
+            // Будит спящего писателя только первый производитель
+            if (writerWaiting.load() && writerWaiting.exchange(false))
+                wakeWriter();
+            return;
+        }
+        if (overflow == LogOverflow::Drop) {
+            logger.dropped.fetch_add(1, std::memory_order_relaxed);
+            unreportedDrops.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        do {
+            wakeWriter();
+            std::this_thread::yield();
+        } while (!tryPush(level, time, message));
+        if (writerWaiting.load() && writerWaiting.exchange(false))
+            wakeWriter();
+    }
+
+    void flush() {
+        std::size_t target = tail.load(std::memory_order_acquire);
+        wakeWriter();
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        progress.wait(lock, [&]() { return written.load(std::memory_order_acquire) >= target; });
+    }
+
+private:
+    struct Record {
+        std::time_t time;
+        LogLevel level;
+        std::uint16_t length;
+        bool truncated;
+        char text[LOG_RECORD_TEXT];
+    };
+
+    struct alignas(64) Cell {
+        std::atomic<std::size_t> sequence;
+        Record record;
+    };
+
+    Logger& logger;
+    LogOverflow overflow;
+    std::unique_ptr<Cell[]> cells;
+    std::size_t mask = 0;
+    alignas(64) std::atomic<std::size_t> tail{ 0 };     // Следующая позиция для производителей
+    alignas(64) std::atomic<std::size_t> written{ 0 };  // Позиции до этой уже записаны
+    std::size_t head = 0;                               // Следующая позиция писателя
+    std::atomic<unsigned long long> unreportedDrops{ 0 };
+    std::atomic<bool> writerWaiting{ false };
+    std::atomic<bool> stopping{ false };
+    std::mutex wakeMutex;
+    std::condition_variable wake;       // Будит писателя
+    std::condition_variable progress;   // Сообщает flush() о записанных позициях
+    std::thread writer;
+
+    bool tryPush(LogLevel level, std::time_t time, const std::string& message) {
+        std::size_t pos = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            std::intptr_t difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos);
+            if (difference == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (difference < 0) {
+                return false;  // Писатель ещё не освободил ячейку предыдущего круга
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+        Cell& cell = cells[pos & mask];
+        Record& record = cell.record;
+        std::size_t length = std::min(message.size(), LOG_RECORD_TEXT);
+        record.time = time;
+        record.level = level;
+        record.length = static_cast<std::uint16_t>(length);
+        record.truncated = length < message.size();
+        std::memcpy(record.text, message.data(), length);
+        cell.sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool hasRecord() const {
+        return cells[head & mask].sequence.load(std::memory_order_acquire) == head + 1;
+    }
+
+    void wakeWriter() {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        wake.notify_one();
+    }
+
+    // Форматирует опубликованные записи в batch
+    std::size_t drain(std::string& batch, TimestampCache& timestamps) {
+        std::size_t count = 0;
+        while (hasRecord() && batch.size() < 256 * 1024) {
+            Cell& cell = cells[head & mask];
+            const Record& record = cell.record;
+            appendLine(batch, timestamps, record.time, record.level, record.text, record.length);
+            if (record.truncated)
+                batch.insert(batch.size() - 1, "...");
+            cell.sequence.store(head + mask + 1, std::memory_order_release);
+            ++head;
+            ++count;
+        }
+        return count;
+    }
+
+    void run() {
+        std::string batch;
+        TimestampCache timestamps;
+        for (;;) {
+            batch.clear();
+            std::size_t count = drain(batch, timestamps);
+            unsigned long long drops = unreportedDrops.exchange(0, std::memory_order_relaxed);
+            if (drops) {
+                std::string notice = "Пропущено сообщений журнала из-за переполнения буфера: " + std::to_string(drops);
+                appendLine(batch, timestamps, currentTime(), LogLevel::Warning, notice.data(), notice.size());
+            }
+            if (!batch.empty())
+                logger.writeLines(batch);
+            if (count) {
+                written.store(head, std::memory_order_release);
+                {
+                    std::lock_guard<std::mutex> lock(wakeMutex);
+                }
+                progress.notify_all();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            if (stopping.load() && !hasRecord())
+                break;
+            writerWaiting.store(true);
+            // Таймаут страхует от гонки между публикацией записи и засыпанием писателя
+            wake.wait_for(lock, std::chrono::milliseconds(50), [&]() { return stopping.load() || hasRecord(); });
+            writerWaiting.store(false);
+        }
+    }
+};
+
+void Logger::setLogFile(const std::string& path) {
+    std::lock_guard<std::mutex> lock(outputMutex);
+    if (logFile.is_open()) {
+        logFile.close();
+    }
+    if (!path.empty())
+        logFile.open(path, std::ios::app);
+}
+
+void Logger::setConsoleOutput(bool enabled) {
+    std::lock_guard<std::mutex> lock(outputMutex);
+    consoleOutput = enabled;
+}
+
+void Logger::log(LogLevel level, const std::string& message) {
+    if (!isEnabled(level)) return;
+    std::time_t time = currentTime();
+
+    // Счётчик не даёт stopAsync удалить очередь, пока в неё пишут
+    activeProducers.fetch_add(1);
+    if (AsyncLogBackend* async = backend.load()) {
+        async->push(level, time, message);
+        activeProducers.fetch_sub(1, std::memory_order_release);
+        return;
+    }
+    activeProducers.fetch_sub(1, std::memory_order_release);
+
+    thread_local TimestampCache timestamps;
+    std::string line;
+    appendLine(line, timestamps, time, level, message.data(), message.size());
+    writeLines(line);
+}
+
+void Logger::writeLines(const std::string& lines) {
+    std::lock_guard<std::mutex> lock(outputMutex);
+    if (consoleOutput) {
+        std::cout.write(lines.data(), static_cast<std::streamsize>(lines.size()));
+        std::cout.flush();
+    }
+    if (logFile.is_open()) {
+        logFile.write(lines.data(), static_cast<std::streamsize>(lines.size()));
+        logFile.flush();
+    }
+}
+
+void Logger::startAsync(const AsyncLogOptions& options) {
+    std::lock_guard<std::mutex> lock(asyncMutex);
+    AsyncLogBackend* fresh = new AsyncLogBackend(*this, options);
+    AsyncLogBackend* old = backend.exchange(fresh);
+    while (activeProducers.load() != 0)
+        std::this_thread::yield();
+    delete old;
+}
+
+void Logger::stopAsync() {
+    std::lock_guard<std::mutex> lock(asyncMutex);
+    AsyncLogBackend* old = backend.exchange(nullptr);
+    if (!old)
+        return;
+    while (activeProducers.load() != 0)
+        std::this_thread::yield();
+    delete old;
+}
+
+void Logger::flush() {
+    if (AsyncLogBackend* async = backend.load()) {
+        // Под asyncMutex очередь не может быть удалена во время ожидания
+        std::lock_guard<std::mutex> lock(asyncMutex);
+        if (backend.load() == async)
+            async->flush();
+    }
+    std::lock_guard<std::mutex> lock(outputMutex);
+    if (consoleOutput)
+        std::cout.flush();
+    if (logFile.is_open())
+        logFile.flush();
+}
+
+Logger::~Logger() {
+    stopAsync();
+    if (logFile.is_open()) {
+        logFile.close();
+    }
+}
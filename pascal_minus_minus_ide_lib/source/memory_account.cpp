@@ -0,0 +1,53 @@
+#include "memory_account.h"
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace {
+
+// Оценка служебного блока make_shared (счётчики ссылок) на каждый узел
+constexpr std::size_t SHARED_CONTROL_BYTES = 2 * sizeof(long) + sizeof(void*);
+
+} // namespace
+
+void MemoryAccount::charge(MemoryCategory category, std::size_t bytes) {
+    if (limit && bytes > limit - std::min(total, limit))
+        throw MemoryLimitExceeded{ category, bytes };
+    total += bytes;
+    byCategory[static_cast<std::size_t>(category)] += bytes;
+    if (total > peakBytes)
+        peakBytes = total;
+}
+
+void MemoryAccount::release(MemoryCategory category, std::size_t bytes) {
+    std::size_t& used = byCategory[static_cast<std::size_t>(category)];
+    bytes = std::min(bytes, used);
+    used -= bytes;
+    total -= bytes;
+}
+
+// Короткая строка хранится внутри объекта: её данные лежат в пределах самого std::string
+std::size_t MemoryAccount::heapBytes(const std::string& text) {
+    const char* data = text.data();
+    const char* self = reinterpret_cast<const char*>(&text);
+    if (data >= self && data < self + sizeof(text))
+        return 0;
+    return text.capacity() + 1;
+}
+
+// Обход без рекурсии: глубина дерева ограничена только парсером
+std::size_t MemoryAccount::astBytes(const ASTNode& root) {
+    std::size_t bytes = 0;
+    std::vector<const ASTNode*> pending{ &root };
+    while (!pending.empty()) {
+        const ASTNode* node = pending.back();
+        pending.pop_back();
+        bytes += sizeof(ASTNode) + SHARED_CONTROL_BYTES + heapBytes(node->value)
+               + node->children.capacity() * sizeof(std::shared_ptr<ASTNode>);
+        for (const auto& child : node->children) {
+            if (child)
+                pending.push_back(child.get());
+        }
+    }
+    return bytes;
+}
@@ -0,0 +1,235 @@
+#include "metrics.h"
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+std::atomic<std::uint64_t> nextRegistryId{ 1 };
+
+// Сегмент потока в последнем реестре, куда он писал
+struct ShardCache {
+    std::uint64_t registry = 0;
+    void* shard = nullptr;
+};
+thread_local ShardCache cache;
+
+// Экранирование для строк JSON и значений меток Prometheus
+std::string escape(const std::string& text, bool json) {
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c : text) {
+        if (c == '"' || c == '\\')
+            escaped += '\\';
+        if (c == '\n') {
+            escaped += "\\n";
+            continue;
+        }
+        if (json && static_cast<unsigned char>(c) < 0x20) {
+            escaped += ' ';
+            continue;
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+std::string prometheusLabels(const MetricLabels& labels, const std::string& extra = std::string()) {
+    if (labels.empty() && extra.empty())
+        return std::string();
+    std::string text = "{";
+    for (const auto& label : labels) {
+        if (text.size() > 1)
+            text += ',';
+        text += label.first + "=\"" + escape(label.second, false) + '"';
+    }
+    if (!extra.empty()) {
+        if (text.size() > 1)
+            text += ',';
+        text += extra;
+    }
+    return text + '}';
+}
+
+bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+} // namespace
+
+void MetricsRegistry::Histogram::observe(std::uint64_t value) const {
+    if (!registry)
+        return;
+    std::size_t bucket = std::lower_bound(bounds->begin(), bounds->end(), value) - bounds->begin();
+    registry->increment(slot + bucket, 1);
+    registry->increment(slot + bounds->size() + 1, value);
+    registry->increment(slot + bounds->size() + 2, 1);
+}
+
+MetricsRegistry::MetricsRegistry() : id(nextRegistryId.fetch_add(1)) {}
+
+MetricsRegistry::Shard& MetricsRegistry::shard() {
+    if (cache.registry == id)
+        return *static_cast<Shard*>(cache.shard);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::thread::id self = std::this_thread::get_id();
+    Shard* found = nullptr;
+    for (auto& candidate : shards) {
+        if (candidate->thread == self)
+            found = candidate.get();
+    }
+    if (!found) {
+        auto created = std::make_unique<Shard>();
+        created->thread = self;
+        for (auto& cell : created->slots)
+            cell.store(0, std::memory_order_relaxed);
+        found = created.get();
+        shards.push_back(std::move(created));
+    }
+    cache.registry = id;
+    cache.shard = found;
+    return *found;
+}
+
+const MetricsRegistry::Metric* MetricsRegistry::find(const std::string& name, const MetricLabels& labels) const {
+    for (const Metric& metric : metrics) {
+        if (metric.name == name && metric.labels == labels)
+            return &metric;
+    }
+    return nullptr;
+}
+
+MetricsRegistry::Counter MetricsRegistry::counter(const std::string& name, const std::string& help,
+                                                  const MetricLabels& labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Counter handle;
+    handle.registry = this;
+    if (const Metric* existing = find(name, labels)) {
+        handle.slot = existing->slot;
+        return handle;
+    }
+    if (slotsUsed + 1 > MAX_SLOTS)
+        throw std::length_error("Реестр метрик заполнен: " + name);
+    metrics.push_back(Metric{ name, help, labels, Kind::Counter, slotsUsed, {} });
+    handle.slot = slotsUsed++;
+    return handle;
+}
+
+MetricsRegistry::Histogram MetricsRegistry::histogram(const std::string& name, const std::string& help,
+                                                      const std::vector<std::uint64_t>& bounds, const MetricLabels& labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const Metric* metric = find(name, labels);
+    if (!metric) {
+        std::size_t slots = bounds.size() + 3;
+        if (slotsUsed + slots > MAX_SLOTS)
+            throw std::length_error("Реестр метрик заполнен: " + name);
+        metrics.push_back(Metric{ name, help, labels, Kind::Histogram, slotsUsed, bounds });
+        slotsUsed += slots;
+        metric = &metrics.back();
+    }
+    Histogram handle;
+    handle.registry = this;
+    handle.slot = metric->slot;
+    handle.bounds = &metric->bounds;
+    return handle;
+}
+
+// Вызывается под mutex
+std::uint64_t MetricsRegistry::total(std::size_t slot) const {
+    std::uint64_t sum = 0;
+    for (const auto& shard : shards)
+        sum += shard->slots[slot].load(std::memory_order_relaxed);
+    return sum;
+}
+
+std::uint64_t MetricsRegistry::value(const std::string& name, const MetricLabels& labels) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const Metric* metric = find(name, labels);
+    if (!metric)
+        return 0;
+    return total(metric->kind == Kind::Counter ? metric->slot : metric->slot + metric->bounds.size() + 2);
+}
+
+void MetricsRegistry::writeJson(std::ostream& out) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    out << "{\"metrics\":[";
+    bool first = true;
+    for (const Metric& metric : metrics) {
+        out << (first ? "\n" : ",\n");
+        first = false;
+        out << "{\"name\":\"" << escape(metric.name, true) << "\",\"type\":\""
+            << (metric.kind == Kind::Counter ? "counter" : "histogram") << "\",\"help\":\""
+            << escape(metric.help, true) << "\",\"labels\":{";
+        for (std::size_t i = 0; i < metric.labels.size(); ++i) {
+            out << (i ? "," : "") << '"' << escape(metric.labels[i].first, true) << "\":\""
+                << escape(metric.labels[i].second, true) << '"';
+        }
+        out << '}';
+        if (metric.kind == Kind::Counter) {
+            out << ",\"value\":" << total(metric.slot) << '}';
+            continue;
+        }
+        out << ",\"buckets\":[";
+        for (std::size_t i = 0; i <= metric.bounds.size(); ++i) {
+            out << (i ? "," : "") << "{\"le\":";
+            if (i < metric.bounds.size())
+                out << metric.bounds[i];
+            else
+                out << "\"+Inf\"";
+            out << ",\"count\":" << total(metric.slot + i) << '}';
+        }
+        out << "],\"sum\":" << total(metric.slot + metric.bounds.size() + 1)
+            << ",\"count\":" << total(metric.slot + metric.bounds.size() + 2) << '}';
+    }
+    out << "\n]}\n";
+}
+
+void MetricsRegistry::writePrometheus(std::ostream& out) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    // HELP и TYPE печатаются один раз на имя, метрики с одним именем - подряд
+    std::vector<const std::string*> names;
+    for (const Metric& metric : metrics) {
+        bool seen = std::any_of(names.begin(), names.end(), [&](const std::string* name) { return *name == metric.name; });
+        if (!seen)
+            names.push_back(&metric.name);
+    }
+    for (const std::string* name : names) {
+        bool header = false;
+        for (const Metric& metric : metrics) {
+            if (metric.name != *name)
+                continue;
+            if (!header) {
+                out << "# HELP " << metric.name << ' ' << metric.help << '\n';
+                out << "# TYPE " << metric.name << ' ' << (metric.kind == Kind::Counter ? "counter" : "histogram") << '\n';
+                header = true;
+            }
+            if (metric.kind == Kind::Counter) {
+                out << metric.name << prometheusLabels(metric.labels) << ' ' << total(metric.slot) << '\n';
+                continue;
+            }
+            // Корзины Prometheus накопительные
+            std::uint64_t cumulative = 0;
+            for (std::size_t i = 0; i <= metric.bounds.size(); ++i) {
+                cumulative += total(metric.slot + i);
+                std::string le = i < metric.bounds.size() ? std::to_string(metric.bounds[i]) : "+Inf";
+                out << metric.name << "_bucket" << prometheusLabels(metric.labels, "le=\"" + le + "\"")
+                    << ' ' << cumulative << '\n';
+            }
+            out << metric.name << "_sum" << prometheusLabels(metric.labels) << ' '
+                << total(metric.slot + metric.bounds.size() + 1) << '\n';
+            out << metric.name << "_count" << prometheusLabels(metric.labels) << ' '
+                << total(metric.slot + metric.bounds.size() + 2) << '\n';
+        }
+    }
+}
+
+void MetricsRegistry::writeFile(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary);
+    if (endsWith(path, ".json"))
+        writeJson(file);
+    else
+        writePrometheus(file);
+    if (!file)
+        throw std::runtime_error("Не удалось записать метрики: " + path);
+}
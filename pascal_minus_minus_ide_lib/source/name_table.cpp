@@ -0,0 +1,39 @@
+#include "name_table.h"
+#include <limits>
+#include <stdexcept>
+
+// Номер 0 зарезервирован за NO_NAME и соответствует пустой строке
+NameTable::NameTable() : texts(1) {}
+
+NameId NameTable::intern(std::string_view text) {
+    auto it = ids.find(text);
+    if (it != ids.end())
+        return it->second;
+
+    if (texts.size() > std::numeric_limits<NameId>::max())
+        throw std::runtime_error("Переполнение таблицы имён");
+    NameId id = static_cast<NameId>(texts.size());
+    const std::string& stored = texts.emplace_back(text);
+    ids.emplace(std::string_view(stored), id);
+    return id;
+}
+
+NameId NameTable::find(std::string_view text) const {
+    auto it = ids.find(text);
+    return it != ids.end() ? it->second : NO_NAME;
+}
+
+NameId NameTable::resolve(NameId id, std::string_view text) {
+    if (id == NO_NAME)
+        return intern(text);
+    if (id >= texts.size() || texts[id] != text)
+        throw std::logic_error("Имя '" + std::string(text) + "' пронумеровано другой таблицей имён");
+    return id;
+}
+
+const std::string& NameTable::text(NameId id) const {
+    if (id >= texts.size())
+        throw std::out_of_range("Неизвестный номер имени: " + std::to_string(id));
+    return texts[id];
+}
+
@@ -0,0 +1,145 @@
+#include "node_profiler.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+const char* typeName(ASTNodeType type) {
+    switch (type) {
+    case ASTNodeType::Program: return "Program";
+    case ASTNodeType::Block: return "Block";
+    case ASTNodeType::ConstSection: return "ConstSection";
+    case ASTNodeType::ConstDecl: return "ConstDecl";
+    case ASTNodeType::VarSection: return "VarSection";
+    case ASTNodeType::VarDecl: return "VarDecl";
+    case ASTNodeType::Assignment: return "Assignment";
+    case ASTNodeType::If: return "If";
+    case ASTNodeType::While: return "While";
+    case ASTNodeType::Write: return "Write";
+    case ASTNodeType::Writeln: return "Writeln";
+    case ASTNodeType::Read: return "Read";
+    case ASTNodeType::Readln: return "Readln";
+    case ASTNodeType::Expression: return "Expression";
+    case ASTNodeType::Number: return "Number";
+    case ASTNodeType::Real: return "Real";
+    case ASTNodeType::String: return "String";
+    case ASTNodeType::Boolean: return "Boolean";
+    case ASTNodeType::Identifier: return "Identifier";
+    case ASTNodeType::BinOp: return "BinOp";
+    case ASTNodeType::UnOp: return "UnOp";
+    case ASTNodeType::ForLoop: return "For";
+    }
+    return "Node";
+}
+
+double seconds(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration<double>(duration).count();
+}
+
+} // namespace
+
+void NodeProfiler::enter(const ASTNode* node) {
+    auto found = index.find(node);
+    std::size_t entry;
+    if (found != index.end()) {
+        entry = found->second;
+    } else {
+        entry = entries.size();
+        entries.push_back(Entry{ node, stack.empty() ? NO_PARENT : stack.back().entry });
+        index.emplace(node, entry);
+    }
+    ++entries[entry].count;
+    stack.push_back(Frame{ entry, Clock::now() });
+}
+
+void NodeProfiler::leave() {
+    Clock::duration elapsed = Clock::now() - stack.back().start;
+    std::size_t entry = stack.back().entry;
+    stack.pop_back();
+    entries[entry].inclusive += elapsed;
+    if (!stack.empty())
+        entries[stack.back().entry].children += elapsed;
+}
+
+void NodeProfiler::reset() {
+    entries.clear();
+    index.clear();
+    stack.clear();
+}
+
+std::vector<NodeProfile> NodeProfiler::results() const {
+    std::vector<NodeProfile> profiles;
+    profiles.reserve(entries.size());
+    for (const Entry& entry : entries) {
+        NodeProfile profile;
+        profile.node = entry.node;
+        profile.label = label(*entry.node);
+        profile.line = entry.node->line;
+        profile.column = entry.node->column;
+        profile.count = entry.count;
+        profile.inclusiveSeconds = seconds(entry.inclusive);
+        profile.exclusiveSeconds = seconds(std::max(entry.inclusive - entry.children, Clock::duration::zero()));
+        profiles.push_back(std::move(profile));
+    }
+    std::stable_sort(profiles.begin(), profiles.end(), [](const NodeProfile& a, const NodeProfile& b) {
+        return a.exclusiveSeconds > b.exclusiveSeconds;
+    });
+    return profiles;
+}
+
+void NodeProfiler::writeReport(std::ostream& out, std::size_t top) const {
+    std::vector<NodeProfile> profiles = results();
+    double total = 0;
+    for (const NodeProfile& profile : profiles)
+        total += profile.exclusiveSeconds;
+    if (top == 0 || top > profiles.size())
+        top = profiles.size();
+
+    // Заголовок выровнен вручную: printf считает байты, а не буквы кириллицы
+    out << "  выполнений     вкл., мс  собств., мс    доля  узел\n";
+    char line[96];
+    for (std::size_t i = 0; i < top; ++i) {
+        const NodeProfile& profile = profiles[i];
+        std::snprintf(line, sizeof(line), "%12llu %12.3f %12.3f %6.1f%%  ",
+                      static_cast<unsigned long long>(profile.count), profile.inclusiveSeconds * 1000,
+                      profile.exclusiveSeconds * 1000, total > 0 ? profile.exclusiveSeconds / total * 100 : 0.0);
+        out << line << profile.label << '\n';
+    }
+}
+
+void NodeProfiler::writeFoldedStacks(std::ostream& out) const {
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        const Entry& entry = entries[i];
+        auto exclusive = std::chrono::duration_cast<std::chrono::microseconds>(entry.inclusive - entry.children).count();
+        if (exclusive > 0)
+            out << stackOf(i) << ' ' << exclusive << '\n';
+    }
+}
+
+std::string NodeProfiler::stackOf(std::size_t entry) const {
+    std::vector<std::size_t> chain;
+    for (std::size_t i = entry; i != NO_PARENT; i = entries[i].parent)
+        chain.push_back(i);
+    std::string stack;
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+        if (!stack.empty())
+            stack += ';';
+        stack += label(*entries[*it].node);
+    }
+    return stack;
+}
+
+std::string NodeProfiler::label(const ASTNode& node) {
+    std::string text = typeName(node.type);
+    std::string value = node.value.substr(0, node.value.find('|'));  // "i|downto" у цикла for
+    if (!value.empty()) {
+        if (value.size() > 24)
+            value = value.substr(0, 21) + "...";
+        std::replace(value.begin(), value.end(), ';', ',');
+        std::replace(value.begin(), value.end(), '\n', ' ');
+        text += ' ' + value;
+    }
+    if (node.line > 0)
+        text += " (" + std::to_string(node.line) + ":" + std::to_string(node.column) + ")";
+    return text;
+}
@@ -0,0 +1,123 @@
+#include "output_sink.h"
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+std::size_t writeValue(IOutputSink& sink, const Value& value) {
+    char digits[32];
+    switch (value.type) {
+    case ValueType::Integer: {
+        auto result = std::to_chars(digits, digits + sizeof(digits), value.intValue);
+        sink.write(digits, result.ptr - digits);
+        return result.ptr - digits;
+    }
+    case ValueType::Real: {
+        auto result = std::to_chars(digits, digits + sizeof(digits), value.realValue, std::chars_format::general, 6);
+        sink.write(digits, result.ptr - digits);
+        return result.ptr - digits;
+    }
+    case ValueType::Boolean:
+        if (value.boolValue) {
+            sink.write("true", 4);
+            return 4;
+        }
+        sink.write("false", 5);
+        return 5;
+    case ValueType::String:
+        sink.write(value.stringValue.data(), value.stringValue.size());
+        return value.stringValue.size();
+    }
+    return 0;
+}
+
+BufferedOutputSink::BufferedOutputSink(std::size_t capacity, FlushPolicy policy)
+    : buffer(capacity ? capacity : 1), used(0), policy(policy) {}
+
+void BufferedOutputSink::write(const char* data, std::size_t size) {
+    if (used + size > buffer.size()) {
+        if (used) {
+            drain(buffer.data(), used);
+            used = 0;
+        }
+        // Блок больше буфера передаётся напрямую, без копирования
+        if (size >= buffer.size()) {
+            drain(data, size);
+            if (policy == FlushPolicy::EachWrite)
+                sync();
+            return;
+        }
+    }
+    std::memcpy(buffer.data() + used, data, size);
+    used += size;
+    if (policy == FlushPolicy::EachWrite)
+        flush();
+}
+
+void BufferedOutputSink::endLine() {
+    write("\n", 1);
+    if (policy == FlushPolicy::EachLine)
+        flush();
+}
+
+void BufferedOutputSink::flush() {
+    if (used) {
+        // Буфер считается переданным, даже если получатель сообщил об ошибке
+        std::size_t size = used;
+        used = 0;
+        drain(buffer.data(), size);
+    }
+    sync();
+}
+
+void BufferedOutputSink::flushQuietly() noexcept {
+    try {
+        flush();
+    } catch (...) {
+    }
+}
+
+StreamOutputSink::StreamOutputSink(std::ostream& stream, std::size_t capacity, FlushPolicy policy)
+    : BufferedOutputSink(capacity, policy), stream(stream) {}
+
+StreamOutputSink::~StreamOutputSink() {
+    flushQuietly();
+}
+
+void StreamOutputSink::drain(const char* data, std::size_t size) {
+    stream.write(data, static_cast<std::streamsize>(size));
+}
+
+void StreamOutputSink::sync() {
+    stream.flush();
+}
+
+FdOutputSink::FdOutputSink(int fd, std::size_t capacity, FlushPolicy policy)
+    : BufferedOutputSink(capacity, policy), fd(fd) {}
+
+FdOutputSink::~FdOutputSink() {
+    flushQuietly();
+}
+
+void FdOutputSink::drain(const char* data, std::size_t size) {
+    while (size > 0) {
+#ifdef _WIN32
+        int written = _write(fd, data, static_cast<unsigned>(size > 0x40000000 ? 0x40000000 : size));
+#else
+        ssize_t written = ::write(fd, data, size);
+#endif
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error("Ошибка записи в дескриптор " + std::to_string(fd) + ": " + std::strerror(errno));
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+}
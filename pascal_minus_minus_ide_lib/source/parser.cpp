@@ -1,4 +1,5 @@
 #include "parser.h"
+#include "allocation_profiler.h"
 #include "lexer.h"
 #include "error_reporter.h"
 #include <iostream>
@@ -18,6 +19,9 @@ Parser::Parser(std::shared_ptr<IErrorReporter> errorReporter)
 Parser::Parser(const vector<Token>& tokens, std::shared_ptr<IErrorReporter> errorReporter) 
     : tokens(tokens), pos(0), errorReporter(errorReporter ? errorReporter : std::make_shared<ErrorReporter>()) {}
 
+Parser::Parser(vector<Token>&& tokens, std::shared_ptr<IErrorReporter> errorReporter)
+    : tokens(std::move(tokens)), pos(0), errorReporter(errorReporter ? errorReporter : std::make_shared<ErrorReporter>()) {}
+
 const Token& Parser::current() const {
     if (pos >= tokens.size())
         throw runtime_error("Неожиданный конец входных данных");
@@ -41,11 +45,20 @@ void Parser::expect(TokenType type, const string& errorMsg) {
 }
 
 shared_ptr<ASTNode> Parser::parse() {
-    return parseProgram();
+    AllocationProfiler::PhaseScope phase(AllocationPhase::Parsing);
+    AllocationProfiler::SiteScope site(AllocationSite::Ast);
+    try {
+        shared_ptr<ASTNode> program = parseProgram();
+        errorReporter->flush();
+        return program;
+    } catch (...) {
+        errorReporter->flush();
+        throw;
+    }
 }
 
 shared_ptr<ASTNode> Parser::parseProgram() {
-    auto programNode = std::make_shared<ASTNode>(ASTNodeType::Program);
+    auto programNode = makeNode(current(), ASTNodeType::Program);
     
     // Пропускаем ключевое слово program
     if (current().type == TokenType::Program) {
@@ -104,7 +117,7 @@ shared_ptr<ASTNode> Parser::parseProgram() {
 }
 
 shared_ptr<ASTNode> Parser::parseBlock() {
-    auto blockNode = std::make_shared<ASTNode>(ASTNodeType::Block);
+    auto blockNode = makeNode(current(), ASTNodeType::Block);
     
     // Пропускаем begin
     if (current().type == TokenType::Begin) {
@@ -187,9 +200,11 @@ shared_ptr<ASTNode> Parser::parseStatement() {
 // Разбор секции констант
 shared_ptr<ASTNode> Parser::parseConstSection() {
     expect(TokenType::Const, "Ожидалось 'const'");
-    auto section = make_shared<ASTNode>(ASTNodeType::ConstSection);
+    auto section = makeNode(previous(), ASTNodeType::ConstSection);
     while (current().type == TokenType::Identifier) {
+        const Token& start = current();
         string name = current().value;
+        NameId nameId = current().name;
         expect(TokenType::Identifier, "Ожидался идентификатор");
         string typeName;
         if (match(TokenType::Colon)) {
@@ -201,8 +216,8 @@ shared_ptr<ASTNode> Parser::parseConstSection() {
         expect(TokenType::Equal, "Ожидался '='");
         auto value = parseExpression();
         expect(TokenType::Semicolon, "Ожидалась ';'");
-        auto decl = make_shared<ASTNode>(ASTNodeType::ConstDecl, name);
-        decl->children.push_back(make_shared<ASTNode>(ASTNodeType::Identifier, typeName));
+        auto decl = makeNode(start, ASTNodeType::ConstDecl, name, nameId);
+        decl->children.push_back(makeNode(start, ASTNodeType::Identifier, typeName));
         decl->children.push_back(value);
         section->children.push_back(decl);
     }
@@ -212,15 +227,15 @@ shared_ptr<ASTNode> Parser::parseConstSection() {
 // Разбор секции переменных: var x, y: integer;
 shared_ptr<ASTNode> Parser::parseVarSection() {
     expect(TokenType::Var, "Ожидалось 'var'");
-    auto section = make_shared<ASTNode>(ASTNodeType::VarSection);
+    auto section = makeNode(previous(), ASTNodeType::VarSection);
     while (current().type == TokenType::Identifier) {
         // Собираем имена переменных через запятую
-        vector<string> names;
-        names.push_back(current().value);
+        vector<const Token*> names;
+        names.push_back(&current());
         expect(TokenType::Identifier, "Ожидался идентификатор");
         while (match(TokenType::Comma)) {
             expect(TokenType::Identifier, "Ожидался идентификатор после запятой");
-            names.push_back(tokens[pos - 1].value);
+            names.push_back(&tokens[pos - 1]);
         }
         expect(TokenType::Colon, "Ожидалось ':' после списка имён");
         string typeName;
@@ -238,9 +253,9 @@ shared_ptr<ASTNode> Parser::parseVarSection() {
         }
         expect(TokenType::Semicolon, "Ожидалась ';' после объявления переменных");
         // Для всех имён создаём отдельные VarDecl с общим типом
-        for (const auto& name : names) {
-            auto decl = make_shared<ASTNode>(ASTNodeType::VarDecl, name);
-            auto typeNode = make_shared<ASTNode>(ASTNodeType::Identifier, typeName);
+        for (const Token* name : names) {
+            auto decl = makeNode(*name, ASTNodeType::VarDecl, name->value, name->name);
+            auto typeNode = makeNode(*name, ASTNodeType::Identifier, typeName);
             decl->children.push_back(typeNode);
             section->children.push_back(decl);
         }
@@ -250,8 +265,10 @@ shared_ptr<ASTNode> Parser::parseVarSection() {
 
 // Разбор for
 shared_ptr<ASTNode> Parser::parseFor() {
+    const Token& start = current();
     expect(TokenType::For, "Ожидалось 'for'");
     string varName = current().value;
+    NameId varId = current().name;
     expect(TokenType::Identifier, "Ожидался идентификатор переменной цикла");
     expect(TokenType::Assign, "Ожидалось ':='");
     auto fromExpr = parseExpression();
@@ -271,7 +288,7 @@ shared_ptr<ASTNode> Parser::parseFor() {
     expect(TokenType::Do, "Ожидалось 'do'");
     auto body = parseStatement();
 
-    auto forNode = make_shared<ASTNode>(ASTNodeType::ForLoop, varName);
+    auto forNode = makeNode(start, ASTNodeType::ForLoop, varName, varId);
     forNode->children.push_back(fromExpr);
     forNode->children.push_back(toExpr);
     forNode->children.push_back(body);
@@ -282,15 +299,16 @@ shared_ptr<ASTNode> Parser::parseFor() {
 
 // Разбор присваивания: <id> := <выражение>
 shared_ptr<ASTNode> Parser::parseAssignment() {
-    auto assign = make_shared<ASTNode>(ASTNodeType::Assignment);
+    auto assign = makeNode(current(), ASTNodeType::Assignment);
     if (current().type != TokenType::Identifier)
         throw runtime_error("Ожидался идентификатор в левой части присваивания");
 
     string name = current().value;
+    NameId nameId = current().name;
     pos++;
 
     {
-        assign->children.push_back(make_shared<ASTNode>(ASTNodeType::Identifier, name));
+        assign->children.push_back(makeNode(previous(), ASTNodeType::Identifier, name, nameId));
     }
 
     expect(TokenType::Assign, "Ожидался ':='");
@@ -301,7 +319,7 @@ shared_ptr<ASTNode> Parser::parseAssignment() {
 // Разбор условного оператора if ... then ... [else ...]
 shared_ptr<ASTNode> Parser::parseIf() {
     expect(TokenType::If, "Ожидалось 'if'");
-    auto node = make_shared<ASTNode>(ASTNodeType::If);
+    auto node = makeNode(previous(), ASTNodeType::If);
     node->children.push_back(parseExpression());
     expect(TokenType::Then, "Ожидалось 'then'");
     node->children.push_back(parseStatement());
@@ -313,7 +331,7 @@ shared_ptr<ASTNode> Parser::parseIf() {
 // Разбор цикла while ... do ...
 shared_ptr<ASTNode> Parser::parseWhile() {
     expect(TokenType::While, "Ожидалось 'while'");
-    auto node = make_shared<ASTNode>(ASTNodeType::While);
+    auto node = makeNode(previous(), ASTNodeType::While);
     node->children.push_back(parseExpression());
     expect(TokenType::Do, "Ожидалось 'do'");
     node->children.push_back(parseStatement());
@@ -323,7 +341,7 @@ shared_ptr<ASTNode> Parser::parseWhile() {
 // Разбор оператора write(...)
 shared_ptr<ASTNode> Parser::parseWrite() {
     expect(TokenType::Write, "Ожидалось 'Write'");
-    auto node = make_shared<ASTNode>(ASTNodeType::Write);
+    auto node = makeNode(previous(), ASTNodeType::Write);
     expect(TokenType::LParen, "Ожидалась '(' после Write");
     if (current().type != TokenType::RParen) {
         node->children.push_back(parseExpression());
@@ -337,7 +355,7 @@ shared_ptr<ASTNode> Parser::parseWrite() {
 // Разбор оператора read(...)
 shared_ptr<ASTNode> Parser::parseRead() {
     expect(TokenType::Read, "Ожидалось 'read'");
-    auto node = make_shared<ASTNode>(ASTNodeType::Read);
+    auto node = makeNode(previous(), ASTNodeType::Read);
     expect(TokenType::LParen, "Ожидалась '(' после read");
     node->children.push_back(parseExpression());
     expect(TokenType::RParen, "Ожидалась ')' после read");
@@ -347,7 +365,7 @@ shared_ptr<ASTNode> Parser::parseRead() {
 // Разбор оператора writeln(...)
 shared_ptr<ASTNode> Parser::parseWriteln() {
     expect(TokenType::Writeln, "Ожидалось 'Writeln'");
-    auto node = make_shared<ASTNode>(ASTNodeType::Writeln);
+    auto node = makeNode(previous(), ASTNodeType::Writeln);
     expect(TokenType::LParen, "Ожидалась '(' после 'Writeln'");
     // Поддержка zero или более аргументов
     if (current().type != TokenType::RParen) {
@@ -362,7 +380,7 @@ shared_ptr<ASTNode> Parser::parseWriteln() {
 // Разбор оператора readln(...)
 shared_ptr<ASTNode> Parser::parseReadln() {
     expect(TokenType::Readln, "Ожидалось 'readln'");
-    auto node = make_shared<ASTNode>(ASTNodeType::Readln);
+    auto node = makeNode(previous(), ASTNodeType::Readln);
     expect(TokenType::LParen, "Ожидалась '(' после 'readln'");
     // Поддержка одного и более аргументов (чтобы знать, куда читать)
     if (current().type != TokenType::RParen) {
@@ -383,7 +401,7 @@ shared_ptr<ASTNode> Parser::parseExpression() {
         current().type == TokenType::Greater || current().type == TokenType::GreaterEqual) {
         auto op = current(); pos++;
         auto right = parseSimpleExpression();
-        auto bin = make_shared<ASTNode>(ASTNodeType::BinOp, op.value);
+        auto bin = makeNode(op, ASTNodeType::BinOp, op.value);
         bin->children = { left, right };
         left = bin;
     }
@@ -397,7 +415,7 @@ shared_ptr<ASTNode> Parser::parseSimpleExpression() {
         current().type == TokenType::Or) {
         auto op = current(); pos++;
         auto right = parseTerm();
-        auto bin = make_shared<ASTNode>(ASTNodeType::BinOp, op.value);
+        auto bin = makeNode(op, ASTNodeType::BinOp, op.value);
         bin->children = { left, right };
         left = bin;
     }
@@ -411,7 +429,7 @@ shared_ptr<ASTNode> Parser::parseTerm() {
         current().type == TokenType::And || current().type == TokenType::DivKeyword || current().type == TokenType::Mod) {
         auto op = current(); pos++;
         auto right = parseFactor();
-        auto bin = make_shared<ASTNode>(ASTNodeType::BinOp, op.value);
+        auto bin = makeNode(op, ASTNodeType::BinOp, op.value);
         bin->children = { left, right };
         left = bin;
     }
@@ -426,39 +444,40 @@ shared_ptr<ASTNode> Parser::parseFactor() {
         return expr;
     }
     if (current().type == TokenType::RealLiteral) {
-        auto node = make_shared<ASTNode>(ASTNodeType::Real, current().value);
+        auto node = makeNode(current(), ASTNodeType::Real, current().value);
         pos++;
         return node;
     }
     if (current().type == TokenType::Number) {
-        auto node = make_shared<ASTNode>(ASTNodeType::Number, current().value);
+        auto node = makeNode(current(), ASTNodeType::Number, current().value);
         pos++;
         return node;
     }
     if (current().type == TokenType::True || current().type == TokenType::False) {
         string val = (current().type == TokenType::True) ? "true" : "false";
-        auto node = make_shared<ASTNode>(ASTNodeType::Boolean, val);
+        auto node = makeNode(current(), ASTNodeType::Boolean, val);
         pos++;
         return node;
     }
     if (current().type == TokenType::StringLiteral) {
-        auto node = make_shared<ASTNode>(ASTNodeType::String, current().value);
+        auto node = makeNode(current(), ASTNodeType::String, current().value);
         pos++;
         return node;
     }
     if (current().type == TokenType::Identifier) {
         string name = current().value;
+        NameId nameId = current().name;
         pos++;
         // Функциональность массивов удалена
-        return make_shared<ASTNode>(ASTNodeType::Identifier, name);
+        return makeNode(previous(), ASTNodeType::Identifier, name, nameId);
     }
     if (match(TokenType::Minus)) {
-        auto node = make_shared<ASTNode>(ASTNodeType::UnOp, "-");
+        auto node = makeNode(previous(), ASTNodeType::UnOp, "-");
         node->children.push_back(parseFactor());
         return node;
     }
     if (match(TokenType::Not)) {
-        auto node = make_shared<ASTNode>(ASTNodeType::UnOp, "not");
+        auto node = makeNode(previous(), ASTNodeType::UnOp, "not");
         node->children.push_back(parseFactor());
         return node;
     }
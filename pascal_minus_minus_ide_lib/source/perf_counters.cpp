@@ -0,0 +1,166 @@
+#include "perf_counters.h"
+#include <cstdio>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char* const EVENT_NAMES[PERF_EVENT_COUNT] = { "такты", "инструкции", "промахи кэша", "ошибки предсказания" };
+
+#ifdef __linux__
+
+const std::uint64_t EVENT_CONFIGS[PERF_EVENT_COUNT] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES,
+};
+
+std::string describeError(int code) {
+    switch (code) {
+    case EACCES:
+    case EPERM:
+        return "нет прав (см. kernel.perf_event_paranoid)";
+    case ENOENT:
+    case EOPNOTSUPP:
+    case ENODEV:
+        return "процессор или виртуальная машина не поддерживает счётчик";
+    case ENOSYS:
+        return "ядро не поддерживает perf_event_open";
+    default:
+        return std::strerror(code);
+    }
+}
+
+#endif
+
+// Колонка отчёта: число или "-", если счётчик недоступен
+std::string column(bool valid, const char* format, double value) {
+    if (!valid)
+        return "-";
+    char text[32];
+    std::snprintf(text, sizeof(text), format, value);
+    return text;
+}
+
+} // namespace
+
+double PerfReading::ipc() const {
+    if (!has(PerfEvent::Cycles) || !has(PerfEvent::Instructions) || get(PerfEvent::Cycles) == 0)
+        return 0;
+    return static_cast<double>(get(PerfEvent::Instructions)) / get(PerfEvent::Cycles);
+}
+
+double PerfReading::mpki(PerfEvent event) const {
+    if (!has(event) || !has(PerfEvent::Instructions) || get(PerfEvent::Instructions) == 0)
+        return 0;
+    return static_cast<double>(get(event)) * 1000 / get(PerfEvent::Instructions);
+}
+
+PerfReading PerfReading::since(const PerfReading& earlier) const {
+    PerfReading delta;
+    for (std::size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+        delta.valid[i] = valid[i] && earlier.valid[i];
+        // Масштабированные значения могут слегка уменьшаться при мультиплексировании
+        delta.values[i] = delta.valid[i] && values[i] > earlier.values[i] ? values[i] - earlier.values[i] : 0;
+    }
+    delta.seconds = seconds - earlier.seconds;
+    return delta;
+}
+
+#ifdef __linux__
+
+PerfCounters::PerfCounters() : opened(std::chrono::steady_clock::now()) {
+    for (std::size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+        perf_event_attr attr {};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = EVENT_CONFIGS[i];
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        // Счётчики не объединены в группу: недоступность одного не отключает остальные
+        fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        if (fds[i] < 0 && reason.empty())
+            reason = std::string(EVENT_NAMES[i]) + ": " + describeError(errno);
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for (int fd : fds) {
+        if (fd >= 0)
+            close(fd);
+    }
+}
+
+PerfReading PerfCounters::read() const {
+    PerfReading reading;
+    for (std::size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+        if (fds[i] < 0)
+            continue;
+        std::uint64_t data[3];  // Значение, время включения, время работы
+        if (::read(fds[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data[2] == 0)
+            continue;
+        reading.values[i] = data[2] == data[1]
+            ? data[0]
+            : static_cast<std::uint64_t>(static_cast<double>(data[0]) * data[1] / data[2]);
+        reading.valid[i] = true;
+    }
+    reading.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - opened).count();
+    return reading;
+}
+
+#else
+
+PerfCounters::PerfCounters() : opened(std::chrono::steady_clock::now()), reason("perf_event_open есть только в Linux") {
+    fds.fill(-1);
+}
+
+PerfCounters::~PerfCounters() {
+}
+
+PerfReading PerfCounters::read() const {
+    PerfReading reading;
+    reading.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - opened).count();
+    return reading;
+}
+
+#endif
+
+bool PerfCounters::available() const {
+    for (int fd : fds) {
+        if (fd >= 0)
+            return true;
+    }
+    return false;
+}
+
+void PhaseCounters::writeReport(std::ostream& out) const {
+    if (!counters.unavailableReason().empty())
+        out << (available() ? "Часть счётчиков недоступна: " : "Счётчики недоступны: ")
+            << counters.unavailableReason() << '\n';
+
+    // Заголовок выровнен вручную: printf считает байты, а не буквы кириллицы
+    out << "   время, мс         такты    инструкции    IPC  пром. кэша   MPKI  ош. ветвл.   MPKI  фаза\n";
+    char line[160];
+    for (const PhaseReport& phase : phases) {
+        const PerfReading& c = phase.counts;
+        bool ipc = c.has(PerfEvent::Cycles) && c.has(PerfEvent::Instructions);
+        std::snprintf(line, sizeof(line), "%12.3f %13s %13s %6s %11s %6s %11s %6s  ",
+            c.seconds * 1000,
+            column(c.has(PerfEvent::Cycles), "%.0f", static_cast<double>(c.get(PerfEvent::Cycles))).c_str(),
+            column(c.has(PerfEvent::Instructions), "%.0f", static_cast<double>(c.get(PerfEvent::Instructions))).c_str(),
+            column(ipc, "%.2f", c.ipc()).c_str(),
+            column(c.has(PerfEvent::CacheMisses), "%.0f", static_cast<double>(c.get(PerfEvent::CacheMisses))).c_str(),
+            column(c.has(PerfEvent::CacheMisses) && c.has(PerfEvent::Instructions), "%.2f", c.mpki(PerfEvent::CacheMisses)).c_str(),
+            column(c.has(PerfEvent::BranchMisses), "%.0f", static_cast<double>(c.get(PerfEvent::BranchMisses))).c_str(),
+            column(c.has(PerfEvent::BranchMisses) && c.has(PerfEvent::Instructions), "%.2f", c.mpki(PerfEvent::BranchMisses)).c_str());
+        out << line << phase.name << '\n';
+    }
+}
@@ -4,8 +4,10 @@
 #include <stdexcept>
 #include <cmath>
 #include <algorithm>
-#include "interpreter.h" // Для доступа к типу Value
+#include "value.h" // Для доступа к типу Value
 #include "logger.h"
+#include "memory_account.h"
+#include "allocation_profiler.h"
 
 // Вспомогательная функция: возвращает true, если строка — число (целое или вещественное)
 static bool is_number(const string& s) {
@@ -20,35 +22,38 @@ static bool is_number(const string& s) {
 // Вычисляет значение выражения в постфиксной записи (Reverse Polish Notation)
 // Использует стек для хранения промежуточных результатов
 // Конструктор для PostfixCalculator
-PostfixCalculator::PostfixCalculator() {
-    initOperatorMap();
-}
+PostfixCalculator::PostfixCalculator() : operatorMap(operatorTable()), logger(&Logger::getInstance()) {}
 
-// Инициализация таблицы операторов с приоритетами
-void PostfixCalculator::initOperatorMap() {
-    // Арифметические операторы
-    operatorMap["+"] = {OperatorType::Plus, 2, false, false};
-    operatorMap["-"] = {OperatorType::Minus, 2, false, false};
-    operatorMap["*"] = {OperatorType::Multiply, 3, false, false};
-    operatorMap["/"] = {OperatorType::Divide, 3, false, false};
-    operatorMap["div"] = {OperatorType::IntegerDivide, 3, false, false};
-    operatorMap["mod"] = {OperatorType::Modulus, 3, false, false};
+// Таблица операторов с приоритетами: строится один раз на процесс и общая для всех калькуляторов
+const std::map<std::string, OperatorInfo>& PostfixCalculator::operatorTable() {
+    static const std::map<std::string, OperatorInfo> table = [] {
+        std::map<std::string, OperatorInfo> operatorMap;
+        // Арифметические операторы
+        operatorMap["+"] = {OperatorType::Plus, 2, false, false};
+        operatorMap["-"] = {OperatorType::Minus, 2, false, false};
+        operatorMap["*"] = {OperatorType::Multiply, 3, false, false};
+        operatorMap["/"] = {OperatorType::Divide, 3, false, false};
+        operatorMap["div"] = {OperatorType::IntegerDivide, 3, false, false};
+        operatorMap["mod"] = {OperatorType::Modulus, 3, false, false};
     
-    // Операторы сравнения
-    operatorMap["="] = {OperatorType::Equal, 1, false, false};
-    operatorMap["<>"] = {OperatorType::NotEqual, 1, false, false};
-    operatorMap["<"] = {OperatorType::Less, 1, false, false};
-    operatorMap["<="] = {OperatorType::LessEqual, 1, false, false};
-    operatorMap[">"] = {OperatorType::Greater, 1, false, false};
-    operatorMap[">="] = {OperatorType::GreaterEqual, 1, false, false};
+        // Операторы сравнения
+        operatorMap["="] = {OperatorType::Equal, 1, false, false};
+        operatorMap["<>"] = {OperatorType::NotEqual, 1, false, false};
+        operatorMap["<"] = {OperatorType::Less, 1, false, false};
+        operatorMap["<="] = {OperatorType::LessEqual, 1, false, false};
+        operatorMap[">"] = {OperatorType::Greater, 1, false, false};
+        operatorMap[">="] = {OperatorType::GreaterEqual, 1, false, false};
     
-    // Логические операторы
-    operatorMap["and"] = {OperatorType::And, 0, false, false};
-    operatorMap["or"] = {OperatorType::Or, 0, false, false};
-    operatorMap["not"] = {OperatorType::Not, 4, true, true};
+        // Логические операторы
+        operatorMap["and"] = {OperatorType::And, 0, false, false};
+        operatorMap["or"] = {OperatorType::Or, 0, false, false};
+        operatorMap["not"] = {OperatorType::Not, 4, true, true};
     
-    // Унарные операторы
-    operatorMap["u-"] = {OperatorType::Minus, 4, true, true}; // Унарный минус
+        // Унарные операторы
+        operatorMap["u-"] = {OperatorType::Minus, 4, true, true}; // Унарный минус
+        return operatorMap;
+    }();
+    return table;
 }
 
 // Проверка, является ли токен оператором
@@ -228,19 +233,61 @@ Value PostfixCalculator::performUnaryOperation(const std::string& op, const Valu
     return result;
 }
 
+// Реализация метода из интерфейса IPostfixCalculator
+// Поиск в карте переменных по тексту имени
+static VariableLookup mapLookup(const std::map<std::string, Value>& variables) {
+    return [&variables](NameId, const std::string& text) -> const Value* {
+        auto it = variables.find(text);
+        return it != variables.end() ? &it->second : nullptr;
+    };
+}
+
 // Реализация метода из интерфейса IPostfixCalculator
 Value PostfixCalculator::evaluate(const std::shared_ptr<ASTNode>& node, const std::map<std::string, Value>& variables) {
-    // Преобразуем AST в постфиксную запись
-    std::vector<std::string> postfix = astToPostfix(node);
+    return evaluate(node, mapLookup(variables));
+}
+
+// Вычисление выражения с поиском переменных через функцию (например, в таблице с областями видимости)
+Value PostfixCalculator::evaluate(const std::shared_ptr<ASTNode>& node, const VariableLookup& lookup) {
+    AllocationProfiler::SiteScope site(AllocationSite::Postfix);
+    // Преобразуем AST в постфиксную запись, сохраняя имена идентификаторов
+    std::vector<NameId> names;
+    std::vector<std::string> postfix = astToPostfix(node, names);
+    if (!memory)
+        return evaluatePostfix(postfix, names, lookup);
+    // Стек значений не бывает глубже числа токенов
+    MemoryAccount::ScopedCharge evaluation(*memory, MemoryCategory::Evaluation,
+        postfix.capacity() * sizeof(std::string) + names.capacity() * sizeof(NameId) + postfix.size() * sizeof(Value));
     // Вычисляем значение постфиксного выражения
-    return evaluatePostfix(postfix, variables);
+    return evaluatePostfix(postfix, names, lookup);
 }
 
 // Вычисление выражения в постфиксной форме с учетом переменных
 Value PostfixCalculator::evaluatePostfix(const std::vector<std::string>& tokens, const std::map<std::string, Value>& variables) {
-    std::stack<Value> valueStack;
+    return evaluatePostfix(tokens, mapLookup(variables));
+}
+
+// Токены без связанных имён: переменные находятся функцией поиска по тексту
+Value PostfixCalculator::evaluatePostfix(const std::vector<std::string>& tokens, const VariableLookup& lookup) {
+    return evaluatePostfix(tokens, std::vector<NameId>(tokens.size(), NO_NAME), lookup);
+}
+
+Value PostfixCalculator::evaluatePostfix(const std::vector<std::string>& tokens, const std::vector<NameId>& names, const VariableLookup& lookup) {
+    // Стек не глубже числа токенов: одно выделение на вычисление, из арены запуска, если она задана
+    std::vector<Value, ArenaAllocator<Value>> valueStack{ ArenaAllocator<Value>(arena) };
+    valueStack.reserve(tokens.size());
+    // Дальше кучу занимают только строки значений
+    AllocationProfiler::SiteScope site(AllocationSite::Strings);
     
-    for (const auto& token : tokens) {
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        const std::string& token = tokens[i];
+        // Если токен - идентификатор из АСТ, ищем переменную сразу по номеру имени
+        if (names[i] != NO_NAME) {
+            if (const Value* variable = lookup(names[i], token)) {
+                valueStack.push_back(*variable);
+                continue;
+            }
+        }
         // Если токен - число
         if (is_number(token)) {
             Value val;
@@ -252,51 +299,49 @@ Value PostfixCalculator::evaluatePostfix(const std::vector<std::string>& tokens,
                 val.type = ValueType::Integer;
                 val.intValue = std::stoi(token);
             }
-            valueStack.push(val);
+            valueStack.push_back(std::move(val));
         }
         // Если токен - строковый литерал (начинается и заканчивается кавычками)
         else if (!token.empty() && token.front() == '"' && token.back() == '"') {
             Value val;
             val.type = ValueType::String;
             val.stringValue = token.substr(1, token.size() - 2);
-            valueStack.push(val);
+            valueStack.push_back(std::move(val));
         }
         // Если токен - булево значение
         else if (token == "true" || token == "false") {
             Value val;
             val.type = ValueType::Boolean;
             val.boolValue = (token == "true");
-            valueStack.push(val);
-        }
-        // Если токен - переменная
-        else if (variables.find(token) != variables.end()) {
-            valueStack.push(variables.at(token));
+            valueStack.push_back(std::move(val));
         }
         // Если токен - оператор
         else if (isOperator(token)) {
             // Проверяем, достаточно ли операндов в стеке
             const auto& opInfo = getOperatorInfo(token);
+            if (operatorCounters)
+                operatorCounters[static_cast<std::size_t>(opInfo.type)].add();
             
             if (opInfo.isUnary) {
                 if (valueStack.empty()) {
                     throw std::runtime_error("Недостаточно операндов для унарного оператора " + token);
                 }
-                Value a = valueStack.top();
-                valueStack.pop();
-                std::vector<Value> operands = {a};
-                valueStack.push(performOperation(token, operands));
+                // Операция выполняется над вершиной стека без промежуточного вектора операндов
+                valueStack.back() = performUnaryOperation(token, valueStack.back());
             } else {
                 if (valueStack.size() < 2) {
                     throw std::runtime_error("Недостаточно операндов для бинарного оператора " + token);
                 }
-                Value b = valueStack.top();
-                valueStack.pop();
-                Value a = valueStack.top();
-                valueStack.pop();
-                std::vector<Value> operands = {a, b};
-                valueStack.push(performOperation(token, operands));
+                Value result = performBinaryOperation(token, valueStack[valueStack.size() - 2], valueStack.back());
+                valueStack.pop_back();
+                valueStack.back() = std::move(result);
             }
         }
+        // Если токен - переменная без номера имени (операторы проверены раньше,
+        // чтобы не искать переменную на каждом знаке операции)
+        else if (const Value* variable = lookup(NO_NAME, token)) {
+            valueStack.push_back(*variable);
+        }
         // Неизвестный токен
         else {
             throw std::runtime_error("Неизвестный токен: " + token);
@@ -311,7 +356,7 @@ Value PostfixCalculator::evaluatePostfix(const std::vector<std::string>& tokens,
         throw std::runtime_error("Лишние операнды в выражении");
     }
     
-    return valueStack.top();
+    return std::move(valueStack.back());
 }
 
 // Возвращает приоритет оператора (чем выше число — тем выше приоритет)
@@ -430,13 +475,19 @@ std::vector<std::string> PostfixCalculator::infixToPostfix(const std::vector<std
 
 // Преобразует АСТ в последовательность токенов в постфиксной форме
 std::vector<std::string> PostfixCalculator::astToPostfix(const std::shared_ptr<ASTNode>& node) {
+    std::vector<NameId> names;
+    return astToPostfix(node, names);
+}
+
+std::vector<std::string> PostfixCalculator::astToPostfix(const std::shared_ptr<ASTNode>& node, std::vector<NameId>& names) {
     std::vector<std::string> output;
+    names.clear();
     if (!node) return output;
     
     // Рекурсивно обрабатываем дерево
-    processASTNode(node, output);
+    processASTNode(node, output, names);
     
-    LOG_DEBUG("Постфиксная форма: " + [&output]() {
+    LOG_TO(logger, LogLevel::Debug, "Постфиксная форма: " + [&output]() {
         std::string result;
         for (const auto& token : output) {
             result += token + " ";
@@ -448,7 +499,7 @@ std::vector<std::string> PostfixCalculator::astToPostfix(const std::shared_ptr<A
 }
 
 // Рекурсивный метод для преобразования АСТ в постфиксную форму
-void PostfixCalculator::processASTNode(const std::shared_ptr<ASTNode>& node, std::vector<std::string>& output) {
+void PostfixCalculator::processASTNode(const std::shared_ptr<ASTNode>& node, std::vector<std::string>& output, std::vector<NameId>& names) {
     if (!node) return;
     
     switch (node->type) {
@@ -456,35 +507,41 @@ void PostfixCalculator::processASTNode(const std::shared_ptr<ASTNode>& node, std
         case ASTNodeType::Number:
         case ASTNodeType::Real:
             output.push_back(node->value);
+            names.push_back(NO_NAME);
             break;
             
         // Строковые литералы
         case ASTNodeType::String:
             output.push_back("'" + node->value + "'");
+            names.push_back(NO_NAME);
             break;
             
         // Булевы литералы
         case ASTNodeType::Boolean:
             output.push_back(node->value); // true или false
+            names.push_back(NO_NAME);
             break;
             
         // Идентификаторы (переменные)
         case ASTNodeType::Identifier:
             output.push_back(node->value);
+            names.push_back(node->name);
             break;
             
         // Унарные операторы
         case ASTNodeType::UnOp:
             if (!node->children.empty()) {
-                processASTNode(node->children[0], output);
+                processASTNode(node->children[0], output, names);
                 
                 // Унарный минус
                 if (node->value == "-") {
                     output.push_back("u-"); // Помечаем как унарный минус
+                    names.push_back(NO_NAME);
                 }
                 // Отрицание
                 else if (node->value == "not") {
                     output.push_back("not");
+                    names.push_back(NO_NAME);
                 }
             }
             break;
@@ -492,16 +549,17 @@ void PostfixCalculator::processASTNode(const std::shared_ptr<ASTNode>& node, std
         // Бинарные операторы
         case ASTNodeType::BinOp:
             if (node->children.size() >= 2) {
-                processASTNode(node->children[0], output);
-                processASTNode(node->children[1], output);
+                processASTNode(node->children[0], output, names);
+                processASTNode(node->children[1], output, names);
                 output.push_back(node->value); // Оператор
+                names.push_back(NO_NAME);
             }
             break;
             
         // Выражения
         case ASTNodeType::Expression:
             for (const auto& child : node->children) {
-                processASTNode(child, output);
+                processASTNode(child, output, names);
             }
             break;
             
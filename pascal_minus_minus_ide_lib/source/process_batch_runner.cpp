@@ -0,0 +1,513 @@
+#include "process_batch_runner.h"
+#include <stdexcept>
+
+#ifdef _WIN32
+
+std::vector<BatchResult> ProcessBatchRunner::run(const std::vector<BatchJob>&) {
+    throw std::runtime_error("Многопроцессный режим поддерживается только в POSIX-системах");
+}
+
+#else
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#endif
+
+namespace {
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free,
+              "Атомарные операции в разделяемой памяти должны быть без блокировок");
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex ожидает 32-битное слово");
+
+constexpr uint32_t SLOT_EMPTY = 0;
+constexpr uint32_t SLOT_FULL = 1;
+
+// Код завершения рабочего, которому не хватило памяти под ограничением memoryLimitBytes
+constexpr int EXIT_OUT_OF_MEMORY = 3;
+
+int64_t nowNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Ждёт, пока слово в разделяемой памяти отличается от expected (futex в Linux, иначе короткий сон)
+void waitWord(std::atomic<uint32_t>& word, uint32_t expected, int timeoutMs) {
+#ifdef __linux__
+    timespec timeout{ timeoutMs / 1000, (timeoutMs % 1000) * 1000000L };
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+#else
+    (void)timeoutMs;
+    if (word.load(std::memory_order_acquire) == expected)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+#endif
+}
+
+void wakeWord(std::atomic<uint32_t>& word) {
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#else
+    (void)word;
+#endif
+}
+
+// Общее состояние очереди
+struct QueueHeader {
+    std::atomic<uint32_t> jobsPosted{ 0 };      // Увеличивается при добавлении заданий и закрытии
+    std::atomic<uint32_t> resultsPosted{ 0 };   // Увеличивается рабочими при готовности результата
+    std::atomic<uint32_t> closed{ 0 };          // Новых заданий не будет
+    alignas(64) std::atomic<uint64_t> head{ 0 }; // Следующая позиция для рабочих
+};
+
+// Ячейка кольцевой очереди: номер позиции, как в очереди асинхронного логгера
+struct QueueCell {
+    std::atomic<uint64_t> sequence;
+    std::atomic<uint64_t> job;      // Читается до захвата позиции, поэтому атомарный
+};
+
+// Расположение текста задания в общей области
+struct JobRecord {
+    uint64_t nameOffset, nameSize;
+    uint64_t sourceOffset, sourceSize;
+    uint64_t inputOffset, inputSize;
+};
+
+// Участок рабочего процесса: текущее задание и почтовый ящик результата
+struct alignas(64) WorkerSlot {
+    std::atomic<uint32_t> state{ SLOT_EMPTY };
+    std::atomic<int64_t> currentJob{ -1 };
+    std::atomic<int64_t> startedAt{ 0 };
+    uint64_t job = 0;
+    uint32_t success = 0;
+    uint32_t truncated = 0;
+    double seconds = 0;
+    uint64_t memoryBytes = 0, peakMemoryBytes = 0;
+    uint64_t outputSize = 0, diagnosticsSize = 0, errorSize = 0;
+
+    char* data() { return reinterpret_cast<char*>(this + 1); }
+};
+
+std::size_t alignUp(std::size_t value) {
+    return (value + 63) & ~std::size_t(63);
+}
+
+/**
+ * Анонимное разделяемое отображение, созданное до fork: его видят все рабочие,
+ * включая перезапущенные
+ */
+class SharedArea {
+public:
+    SharedArea(const std::vector<BatchJob>& jobs, std::size_t queueCapacity, std::size_t workers, std::size_t resultCapacity)
+        : jobCount(jobs.size()), workerCount(workers), resultCapacity(resultCapacity) {
+        capacity = 2;
+        while (capacity < queueCapacity)
+            capacity *= 2;
+        std::size_t payload = 0;
+        for (const auto& job : jobs)
+            payload += job.name.size() + job.source.size() + job.input.size();
+
+        cellsOffset = alignUp(sizeof(QueueHeader));
+        recordsOffset = alignUp(cellsOffset + capacity * sizeof(QueueCell));
+        payloadOffset = alignUp(recordsOffset + jobCount * sizeof(JobRecord));
+        slotsOffset = alignUp(payloadOffset + payload);
+        slotStride = alignUp(sizeof(WorkerSlot) + resultCapacity);
+        size = slotsOffset + workerCount * slotStride;
+
+        void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED)
+            throw std::runtime_error("Не удалось выделить разделяемую память: " + std::string(std::strerror(errno)));
+        base = static_cast<char*>(memory);
+
+        new (base) QueueHeader();
+        for (std::size_t i = 0; i < capacity; ++i) {
+            QueueCell* cell = new (base + cellsOffset + i * sizeof(QueueCell)) QueueCell();
+            cell->sequence.store(i, std::memory_order_relaxed);
+        }
+        char* text = base + payloadOffset;
+        std::size_t used = 0;
+        auto place = [&](const std::string& value, uint64_t& offset, uint64_t& length) {
+            std::memcpy(text + used, value.data(), value.size());
+            offset = used;
+            length = value.size();
+            used += value.size();
+        };
+        for (std::size_t i = 0; i < jobCount; ++i) {
+            JobRecord& record = records()[i];
+            place(jobs[i].name, record.nameOffset, record.nameSize);
+            place(jobs[i].source, record.sourceOffset, record.sourceSize);
+            place(jobs[i].input, record.inputOffset, record.inputSize);
+        }
+        for (std::size_t i = 0; i < workerCount; ++i)
+            new (base + slotsOffset + i * slotStride) WorkerSlot();
+    }
+
+    ~SharedArea() { munmap(base, size); }
+
+    SharedArea(const SharedArea&) = delete;
+    SharedArea& operator=(const SharedArea&) = delete;
+
+    QueueHeader& header() { return *reinterpret_cast<QueueHeader*>(base); }
+    QueueCell& cell(uint64_t position) {
+        return reinterpret_cast<QueueCell*>(base + cellsOffset)[position & (capacity - 1)];
+    }
+    JobRecord* records() { return reinterpret_cast<JobRecord*>(base + recordsOffset); }
+    WorkerSlot& slot(std::size_t index) { return *reinterpret_cast<WorkerSlot*>(base + slotsOffset + index * slotStride); }
+
+    BatchJob job(std::size_t index) {
+        const JobRecord& record = records()[index];
+        const char* text = base + payloadOffset;
+        return { std::string(text + record.nameOffset, record.nameSize),
+                 std::string(text + record.sourceOffset, record.sourceSize),
+                 std::string(text + record.inputOffset, record.inputSize) };
+    }
+
+    // Координатор (единственный производитель) ставит задание, если есть место
+    bool push(uint64_t position) {
+        QueueCell& target = cell(position);
+        if (target.sequence.load(std::memory_order_acquire) != position)
+            return false;
+        target.job.store(position, std::memory_order_relaxed);
+        target.sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Рабочий забирает задание. Номер задания (он же позиция в очереди)
+     * записывается в участок до захвата позиции, чтобы падение процесса в любой
+     * момент оставляло след; захватил ли рабочий позицию на самом деле,
+     * координатор проверяет по head (см. claimed и held)
+     */
+    bool pop(WorkerSlot& slot, uint64_t& job) {
+        QueueHeader& queue = header();
+        uint64_t position = queue.head.load(std::memory_order_relaxed);
+        for (;;) {
+            QueueCell& source = cell(position);
+            uint64_t sequence = source.sequence.load(std::memory_order_acquire);
+            int64_t difference = static_cast<int64_t>(sequence) - static_cast<int64_t>(position + 1);
+            if (difference == 0) {
+                job = source.job.load(std::memory_order_relaxed);
+                slot.startedAt.store(nowNanoseconds(), std::memory_order_relaxed);
+                slot.currentJob.store(static_cast<int64_t>(job));
+                if (queue.head.compare_exchange_weak(position, position + 1)) {
+                    source.sequence.store(position + capacity, std::memory_order_release);
+                    return true;
+                }
+                slot.currentJob.store(-1);
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = queue.head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Позицию задания уже захватил какой-то рабочий
+    bool claimed(uint64_t job) { return header().head.load() > job; }
+
+    /**
+     * Задание числится за рабочим: в его участке или в почтовом ящике. Рабочий,
+     * проигравший захват, тоже ненадолго показывает его в участке
+     */
+    bool held(uint64_t job) {
+        for (std::size_t index = 0; index < workerCount; ++index) {
+            WorkerSlot& candidate = slot(index);
+            // Рабочий сбрасывает currentJob после публикации результата, поэтому участок читается первым
+            if (candidate.currentJob.load() == static_cast<int64_t>(job))
+                return true;
+            if (candidate.state.load(std::memory_order_acquire) == SLOT_FULL && candidate.job == job)
+                return true;
+        }
+        return false;
+    }
+
+    std::size_t resultBytes() const { return resultCapacity; }
+
+private:
+    char* base = nullptr;
+    std::size_t size = 0;
+    std::size_t capacity = 0;
+    std::size_t jobCount;
+    std::size_t workerCount;
+    std::size_t resultCapacity;
+    std::size_t cellsOffset = 0, recordsOffset = 0, payloadOffset = 0, slotsOffset = 0, slotStride = 0;
+};
+
+// Копирует результат в почтовый ящик; при нехватке места первым обрезается вывод
+void storeResult(SharedArea& area, WorkerSlot& slot, uint64_t job, const BatchResult& result) {
+    std::size_t capacity = area.resultBytes();
+    std::size_t errorSize = std::min(result.error.size(), capacity);
+    std::size_t diagnosticsSize = std::min(result.diagnostics.size(), capacity - errorSize);
+    std::size_t outputSize = std::min(result.output.size(), capacity - errorSize - diagnosticsSize);
+    char* data = slot.data();
+    std::memcpy(data, result.error.data(), errorSize);
+    std::memcpy(data + errorSize, result.diagnostics.data(), diagnosticsSize);
+    std::memcpy(data + errorSize + diagnosticsSize, result.output.data(), outputSize);
+    slot.job = job;
+    slot.success = result.success;
+    slot.truncated = errorSize < result.error.size() || diagnosticsSize < result.diagnostics.size()
+                  || outputSize < result.output.size();
+    slot.seconds = result.seconds;
+    slot.memoryBytes = result.memoryBytes;
+    slot.peakMemoryBytes = result.peakMemoryBytes;
+    slot.errorSize = errorSize;
+    slot.diagnosticsSize = diagnosticsSize;
+    slot.outputSize = outputSize;
+}
+
+BatchResult loadResult(WorkerSlot& slot) {
+    BatchResult result;
+    const char* data = slot.data();
+    result.error.assign(data, slot.errorSize);
+    result.diagnostics.assign(data + slot.errorSize, slot.diagnosticsSize);
+    result.output.assign(data + slot.errorSize + slot.diagnosticsSize, slot.outputSize);
+    result.success = slot.success != 0;
+    result.seconds = slot.seconds;
+    result.memoryBytes = static_cast<std::size_t>(slot.memoryBytes);
+    result.peakMemoryBytes = static_cast<std::size_t>(slot.peakMemoryBytes);
+    if (slot.truncated)
+        result.diagnostics += "Результат задания обрезан до " + std::to_string(slot.errorSize + slot.diagnosticsSize + slot.outputSize) + " байт\n";
+    return result;
+}
+
+// Цикл рабочего: забирает задания, пока координатор не закроет очередь
+[[noreturn]] void serveJobs(SharedArea& area, std::size_t index) {
+    QueueHeader& queue = area.header();
+    WorkerSlot& slot = area.slot(index);
+    for (;;) {
+        // Следующее задание - только после того, как координатор забрал результат
+        while (slot.state.load(std::memory_order_acquire) == SLOT_FULL)
+            waitWord(slot.state, SLOT_FULL, 100);
+
+        uint32_t posted = queue.jobsPosted.load(std::memory_order_acquire);
+        uint64_t job;
+        if (!area.pop(slot, job)) {
+            if (queue.closed.load(std::memory_order_acquire))
+                _exit(0);
+            waitWord(queue.jobsPosted, posted, 100);
+            continue;
+        }
+
+        storeResult(area, slot, job, BatchRunner::runJob(area.job(job)));
+        slot.state.store(SLOT_FULL, std::memory_order_release);
+        slot.currentJob.store(-1, std::memory_order_release);
+        queue.resultsPosted.fetch_add(1, std::memory_order_release);
+        wakeWord(queue.resultsPosted);
+    }
+}
+
+[[noreturn]] void workerMain(SharedArea& area, std::size_t index, const ProcessRunnerOptions& options, pid_t coordinator) {
+#ifdef __linux__
+    // Рабочий не переживает координатора
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+    if (getppid() != coordinator)
+        _exit(1);
+#else
+    (void)coordinator;
+#endif
+    if (options.memoryLimitBytes) {
+        rlimit limit{ options.memoryLimitBytes, options.memoryLimitBytes };
+        setrlimit(RLIMIT_AS, &limit);
+        // Нехватка памяти завершает процесс: задание считается нарушившим ограничение, рабочий перезапускается
+        std::set_new_handler([] { _exit(EXIT_OUT_OF_MEMORY); });
+    }
+    try {
+        serveJobs(area, index);
+    } catch (...) {
+        // Исключение не должно выйти из рабочего в копию кода координатора
+        _exit(1);
+    }
+}
+
+std::string describeExit(int status, bool timedOut, const ProcessRunnerOptions& options) {
+    if (timedOut)
+        return "Превышено ограничение времени (" + std::to_string(options.timeLimitSeconds) + " с)";
+    if (options.memoryLimitBytes && WIFEXITED(status) && WEXITSTATUS(status) == EXIT_OUT_OF_MEMORY)
+        return "Превышено ограничение памяти (" + std::to_string(options.memoryLimitBytes) + " байт)";
+    if (WIFSIGNALED(status))
+        return "Рабочий процесс завершён сигналом " + std::to_string(WTERMSIG(status));
+    return "Рабочий процесс завершился с кодом " + std::to_string(WEXITSTATUS(status));
+}
+
+// Рабочие процессы; оставшиеся при выходе из run() (например, по исключению) принудительно завершаются
+struct WorkerGroup {
+    std::vector<pid_t> pids;
+    std::vector<bool> timedOut;
+
+    explicit WorkerGroup(std::size_t count) : pids(count, -1), timedOut(count, false) {}
+
+    ~WorkerGroup() {
+        for (pid_t pid : pids) {
+            if (pid > 0) {
+                kill(pid, SIGKILL);
+                waitpid(pid, nullptr, 0);
+            }
+        }
+    }
+};
+
+} // namespace
+
+std::vector<BatchResult> ProcessBatchRunner::run(const std::vector<BatchJob>& jobs) {
+    auto start = std::chrono::steady_clock::now();
+    summary = BatchSummary();
+    summary.programs = jobs.size();
+    std::vector<BatchResult> results(jobs.size());
+    if (jobs.empty())
+        return results;
+
+    std::size_t workers = options.workers ? options.workers : std::thread::hardware_concurrency();
+    if (workers == 0)
+        workers = 1;
+    summary.threads = workers;
+
+    SharedArea area(jobs, options.queueCapacity, workers, options.resultCapacity);
+    QueueHeader& queue = area.header();
+    WorkerGroup group(workers);
+    pid_t coordinator = getpid();
+
+    auto spawn = [&](std::size_t index) {
+        WorkerSlot& slot = area.slot(index);
+        slot.state.store(SLOT_EMPTY);
+        slot.currentJob.store(-1);
+        group.timedOut[index] = false;
+        pid_t pid = fork();
+        if (pid < 0)
+            throw std::runtime_error("Не удалось создать рабочий процесс: " + std::string(std::strerror(errno)));
+        if (pid == 0)
+            workerMain(area, index, options, coordinator);
+        group.pids[index] = pid;
+    };
+    for (std::size_t i = 0; i < workers; ++i)
+        spawn(i);
+
+    std::vector<bool> done(jobs.size(), false);
+    std::size_t completed = 0;
+    // Задания умерших рабочих, для которых ещё не ясно, успел ли рабочий их захватить
+    struct Orphan {
+        std::size_t job;
+        BatchResult failure;
+    };
+    std::vector<Orphan> orphans;
+    auto finish = [&](std::size_t job, BatchResult&& result) {
+        if (done[job])
+            return;
+        done[job] = true;
+        result.name = jobs[job].name;
+        results[job] = std::move(result);
+        ++completed;
+    };
+    auto collect = [&](std::size_t index) {
+        WorkerSlot& slot = area.slot(index);
+        if (slot.state.load(std::memory_order_acquire) != SLOT_FULL)
+            return;
+        finish(slot.job, loadResult(slot));
+        slot.state.store(SLOT_EMPTY, std::memory_order_release);
+        wakeWord(slot.state);
+    };
+
+    uint64_t tail = 0;
+    int64_t limit = static_cast<int64_t>(options.timeLimitSeconds * 1e9);
+    while (completed < jobs.size()) {
+        uint32_t seen = queue.resultsPosted.load(std::memory_order_acquire);
+
+        bool posted = false;
+        while (tail < jobs.size() && area.push(tail)) {
+            ++tail;
+            posted = true;
+        }
+        if (posted) {
+            queue.jobsPosted.fetch_add(1, std::memory_order_release);
+            wakeWord(queue.jobsPosted);
+        }
+
+        for (std::size_t i = 0; i < workers; ++i)
+            collect(i);
+
+        for (std::size_t i = 0; i < workers; ++i) {
+            int status = 0;
+            if (group.pids[i] <= 0 || waitpid(group.pids[i], &status, WNOHANG) != group.pids[i])
+                continue;
+            group.pids[i] = -1;
+            collect(i);
+            WorkerSlot& slot = area.slot(i);
+            int64_t job = slot.currentJob.load();
+            if (job >= 0 && !done[job]) {
+                BatchResult failure;
+                failure.error = describeExit(status, group.timedOut[i], options);
+                failure.seconds = (nowNanoseconds() - slot.startedAt.load()) / 1e9;
+                orphans.push_back({ static_cast<std::size_t>(job), std::move(failure) });
+            }
+            if (completed < jobs.size()) {
+                spawn(i);
+                ++summary.restarts;
+            }
+        }
+
+        // Задание умершего рабочего проваливается, только если он успел его захватить:
+        // позиция пройдена, а ни у кого из живых задания нет. Не захваченное остаётся в очереди
+        for (auto orphan = orphans.begin(); orphan != orphans.end();) {
+            std::size_t job = orphan->job;
+            if (!done[job] && area.claimed(job) && !area.held(job))
+                finish(job, std::move(orphan->failure));
+            if (done[job] || !area.claimed(job))
+                orphan = orphans.erase(orphan);
+            else
+                ++orphan;
+        }
+
+        if (limit > 0) {
+            int64_t now = nowNanoseconds();
+            for (std::size_t i = 0; i < workers; ++i) {
+                WorkerSlot& slot = area.slot(i);
+                int64_t job = slot.currentJob.load();
+                if (group.pids[i] > 0 && !group.timedOut[i] && job >= 0 && !done[job]
+                    && now - slot.startedAt.load() > limit) {
+                    kill(group.pids[i], SIGKILL);
+                    group.timedOut[i] = true;
+                }
+            }
+        }
+
+        if (completed < jobs.size())
+            waitWord(queue.resultsPosted, seen, 10);
+    }
+
+    queue.closed.store(1, std::memory_order_release);
+    queue.jobsPosted.fetch_add(1, std::memory_order_release);
+    wakeWord(queue.jobsPosted);
+    for (auto& pid : group.pids) {
+        if (pid > 0) {
+            waitpid(pid, nullptr, 0);
+            pid = -1;
+        }
+    }
+
+    summary.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (const auto& result : results) {
+        if (result.success)
+            ++summary.succeeded;
+        summary.jobSeconds += result.seconds;
+    }
+    summary.failed = summary.programs - summary.succeeded;
+    if (summary.wallSeconds > 0)
+        summary.programsPerSecond = summary.programs / summary.wallSeconds;
+    return results;
+}
+
+#endif
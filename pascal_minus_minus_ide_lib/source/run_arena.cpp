@@ -0,0 +1,96 @@
+#include "run_arena.h"
+
+RunArena::RunArena(std::size_t chunkSize) : chunkSize(roundUp(chunkSize < MAX_CLASS_SIZE ? MAX_CLASS_SIZE : chunkSize)) {}
+
+RunArena::~RunArena() {
+    for (char* chunk : chunks)
+        ::operator delete(chunk);
+    for (char* block : large)
+        ::operator delete(block);
+}
+
+void* RunArena::allocate(std::size_t bytes, std::size_t alignment) {
+    if (alignment > ALIGNMENT)
+        throw std::bad_alloc();
+    std::size_t size = roundUp(bytes ? bytes : 1);
+    if (size <= MAX_CLASS_SIZE) {
+        FreeBlock*& list = freeLists[size / ALIGNMENT - 1];
+        if (list) {
+            FreeBlock* block = list;
+            list = block->next;
+            inUse += size;
+            return block;
+        }
+    } else if (void* block = takeLarge(size)) {
+        inUse += size;
+        return block;
+    } else if (size > chunkSize / 4) {
+        // Крупный запрос не дробит блоки: отдельное выделение до reset()
+        large.reserve(large.size() + 1);
+        char* block = static_cast<char*>(::operator new(size));
+        large.push_back(block);
+        reserved += size;
+        inUse += size;
+        return block;
+    }
+    inUse += size;
+    return bump(size);
+}
+
+void* RunArena::bump(std::size_t size) {
+    if (static_cast<std::size_t>(limit - cursor) < size) {
+        // Остаток блока теряется до reset(): он меньше четверти блока
+        chunks.reserve(chunks.size() + 1);
+        char* chunk = static_cast<char*>(::operator new(chunkSize));
+        chunks.push_back(chunk);
+        reserved += chunkSize;
+        ++chunkAllocationCount;
+        cursor = chunk;
+        limit = chunk + chunkSize;
+    }
+    void* result = cursor;
+    cursor += size;
+    return result;
+}
+
+// Крупные фрагменты разного размера редки, поэтому список просматривается целиком
+void* RunArena::takeLarge(std::size_t size) {
+    for (LargeFreeBlock** link = &largeFree; *link; link = &(*link)->next) {
+        LargeFreeBlock* block = *link;
+        if (block->size == size) {
+            *link = block->next;
+            return block;
+        }
+    }
+    return nullptr;
+}
+
+void RunArena::deallocate(void* pointer, std::size_t bytes) noexcept {
+    if (!pointer)
+        return;
+    std::size_t size = roundUp(bytes ? bytes : 1);
+    inUse -= size;
+    if (size <= MAX_CLASS_SIZE) {
+        FreeBlock*& list = freeLists[size / ALIGNMENT - 1];
+        list = new (pointer) FreeBlock{ list };
+    } else {
+        largeFree = new (pointer) LargeFreeBlock{ largeFree, size };
+    }
+}
+
+void RunArena::reset() {
+    for (char* block : large)
+        ::operator delete(block);
+    large.clear();
+    for (std::size_t i = 1; i < chunks.size(); ++i)
+        ::operator delete(chunks[i]);
+    if (chunks.size() > 1)
+        chunks.resize(1);
+    for (FreeBlock*& list : freeLists)
+        list = nullptr;
+    largeFree = nullptr;
+    reserved = chunks.size() * chunkSize;
+    inUse = 0;
+    cursor = chunks.empty() ? nullptr : chunks.front();
+    limit = chunks.empty() ? nullptr : chunks.front() + chunkSize;
+}
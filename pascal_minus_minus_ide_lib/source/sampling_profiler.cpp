@@ -0,0 +1,222 @@
+#include "sampling_profiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace {
+
+// Обработчик сигнала находит профилировщик через эту переменную
+std::atomic<SamplingProfiler*> activeSampler{ nullptr };
+
+} // namespace
+
+#ifdef __linux__
+
+struct SamplingProfiler::Timer {
+    timer_t id;
+};
+
+// Обработчик остаётся установленным и после stop(): сигнал, уже поставленный
+// в очередь к моменту timer_delete, не должен завершить процесс
+void SamplingProfiler::onSignal(int) {
+    int savedErrno = errno;
+    SamplingProfiler* self = activeSampler.load(std::memory_order_relaxed);
+    if (self)
+        self->sample();
+    errno = savedErrno;
+}
+
+void SamplingProfiler::start(const ExecutionPosition& target) {
+    if (running)
+        return;
+    SamplingProfiler* expected = nullptr;
+    if (!activeSampler.compare_exchange_strong(expected, this))
+        throw std::logic_error("Выборочный профилировщик уже запущен в этом процессе");
+    position = &target;
+
+    static std::once_flag installed;
+    std::call_once(installed, []() {
+        struct sigaction action {};
+        action.sa_handler = &SamplingProfiler::onSignal;
+        action.sa_flags = SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGPROF, &action, nullptr);
+    });
+
+    // Сигнал адресован потоку интерпретатора и приходит по его процессорному времени
+    sigevent event {};
+    event.sigev_notify = SIGEV_THREAD_ID;
+    event.sigev_signo = SIGPROF;
+    event._sigev_un._tid = static_cast<pid_t>(syscall(SYS_gettid));
+    timer = new Timer;
+    itimerspec period {};
+    period.it_interval.tv_sec = static_cast<time_t>(interval.count() / 1000000);
+    period.it_interval.tv_nsec = static_cast<long>(interval.count() % 1000000 * 1000);
+    period.it_value = period.it_interval;
+    if (timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &timer->id) != 0) {
+        int code = errno;
+        delete timer;
+        timer = nullptr;
+        activeSampler.store(nullptr);
+        throw std::runtime_error("Не удалось создать таймер профилировщика: " + std::string(std::strerror(code)));
+    }
+    timer_settime(timer->id, 0, &period, nullptr);
+    running = true;
+}
+
+void SamplingProfiler::stop() {
+    if (!running)
+        return;
+    timer_delete(timer->id);
+    delete timer;
+    timer = nullptr;
+    activeSampler.store(nullptr);
+    running = false;
+}
+
+#else
+
+struct SamplingProfiler::Timer {
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+};
+
+void SamplingProfiler::onSignal(int) {
+}
+
+void SamplingProfiler::start(const ExecutionPosition& target) {
+    if (running)
+        return;
+    SamplingProfiler* expected = nullptr;
+    if (!activeSampler.compare_exchange_strong(expected, this))
+        throw std::logic_error("Выборочный профилировщик уже запущен в этом процессе");
+    position = &target;
+    timer = new Timer;
+    timer->thread = std::thread([this]() {
+        std::unique_lock<std::mutex> lock(timer->mutex);
+        while (!timer->wake.wait_for(lock, interval, [this]() { return timer->stopping; }))
+            sample();
+    });
+    running = true;
+}
+
+void SamplingProfiler::stop() {
+    if (!running)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(timer->mutex);
+        timer->stopping = true;
+    }
+    timer->wake.notify_all();
+    timer->thread.join();
+    delete timer;
+    timer = nullptr;
+    activeSampler.store(nullptr);
+    running = false;
+}
+
+#endif
+
+SamplingProfiler::SamplingProfiler(std::chrono::microseconds interval, std::size_t capacity)
+    : interval(std::max(interval, std::chrono::microseconds(10))), samples(capacity) {}
+
+SamplingProfiler::~SamplingProfiler() {
+    stop();
+}
+
+// Единственный писатель - обработчик сигнала или поток выборок, поэтому хватает load/store
+void SamplingProfiler::sample() {
+    std::size_t slot = recorded.load(std::memory_order_relaxed);
+    if (slot >= samples.size()) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    samples[slot] = position->load(std::memory_order_relaxed);
+    recorded.store(slot + 1, std::memory_order_release);
+}
+
+void SamplingProfiler::reset() {
+    recorded.store(0);
+    dropped.store(0);
+}
+
+std::uint64_t SamplingProfiler::sampleCount() const {
+    return recorded.load(std::memory_order_acquire);
+}
+
+std::uint64_t SamplingProfiler::idleSamples() const {
+    std::size_t count = recorded.load(std::memory_order_acquire);
+    return static_cast<std::uint64_t>(std::count(samples.begin(), samples.begin() + count, nullptr));
+}
+
+std::vector<LineSamples> SamplingProfiler::hotLines() const {
+    std::size_t count = recorded.load(std::memory_order_acquire);
+    std::map<int, std::uint64_t> perLine;
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (samples[i]) {
+            ++perLine[samples[i]->line];
+            ++total;
+        }
+    }
+
+    std::vector<LineSamples> lines;
+    lines.reserve(perLine.size());
+    for (const auto& entry : perLine) {
+        LineSamples line;
+        line.line = entry.first;
+        line.samples = entry.second;
+        line.share = static_cast<double>(entry.second) / total;
+        lines.push_back(line);
+    }
+    std::stable_sort(lines.begin(), lines.end(), [](const LineSamples& a, const LineSamples& b) {
+        return a.samples > b.samples;
+    });
+    return lines;
+}
+
+void SamplingProfiler::writeReport(std::ostream& out, std::size_t top, const std::string& source) const {
+    std::vector<std::string> text;
+    std::istringstream stream(source);
+    for (std::string line; std::getline(stream, line);) {
+        line.erase(0, line.find_first_not_of(" \t"));
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        text.push_back(line);
+    }
+
+    std::vector<LineSamples> lines = hotLines();
+    if (top == 0 || top > lines.size())
+        top = lines.size();
+    out << "Выборок: " << sampleCount() << " (вне программы: " << idleSamples()
+        << ", отброшено: " << droppedSamples() << "), период " << interval.count() << " мкс\n";
+    out << "   выборок    доля  строка\n";
+    char row[64];
+    for (std::size_t i = 0; i < top; ++i) {
+        const LineSamples& line = lines[i];
+        std::snprintf(row, sizeof(row), "%10llu %6.1f%%  %6d  ",
+                      static_cast<unsigned long long>(line.samples), line.share * 100, line.line);
+        out << row;
+        if (line.line > 0 && static_cast<std::size_t>(line.line) <= text.size())
+            out << text[line.line - 1];
+        out << '\n';
+    }
+}
@@ -0,0 +1,76 @@
+#include "scoped_symbol_table.h"
+#include <stdexcept>
+
+ScopedSymbolTable::ScopedSymbolTable(std::shared_ptr<NameTable> table)
+    : names(table ? std::move(table) : std::make_shared<NameTable>()), visibleCount(0) {}
+
+// Номера другой таблицы имён несравнимы с текущими: индекс строится заново
+void ScopedSymbolTable::setNames(std::shared_ptr<NameTable> table) {
+    if (!table)
+        throw std::invalid_argument("Таблица символов без таблицы имён");
+    clear();
+    std::vector<size_t>().swap(index);
+    names = std::move(table);
+}
+
+// Вход в область видимости: достаточно запомнить вершину стека привязок
+void ScopedSymbolTable::enterScope() {
+    frames.push_back(bindings.size());
+}
+
+// Выход из области видимости: снимаем привязки кадра в обратном порядке
+void ScopedSymbolTable::exitScope() {
+    if (frames.empty())
+        throw std::runtime_error("Попытка выйти из глобальной области видимости");
+
+    size_t mark = frames.back();
+    frames.pop_back();
+    while (bindings.size() > mark) {
+        const Binding& binding = bindings.back();
+        index[binding.name] = binding.shadowed;
+        if (binding.shadowed == NO_BINDING)
+            --visibleCount;
+        bindings.pop_back();
+    }
+}
+
+// Объявление символа в текущей области видимости
+Value* ScopedSymbolTable::declare(NameId name, const Value& value) {
+    if (name == NO_NAME)
+        throw std::invalid_argument("Объявление символа без имени");
+    if (name >= index.size())
+        index.resize(static_cast<size_t>(name) + 1, NO_BINDING);
+
+    size_t shadowed = index[name];
+    if (shadowed != NO_BINDING) {
+        Binding& visible = bindings[shadowed];
+        if (visible.scope == frames.size()) {
+            // Повторное объявление в той же области
+            visible.value = value;
+            return &visible.value;
+        }
+    }
+    else
+        ++visibleCount;
+
+    bindings.push_back(Binding{ name, value, frames.size(), shadowed });
+    index[name] = bindings.size() - 1;
+    return &bindings.back().value;
+}
+
+void ScopedSymbolTable::clear() {
+    index.clear();
+    bindings.clear();
+    frames.clear();
+    visibleCount = 0;
+}
+
+// Видимой является привязка, на которую указывает индекс её имени
+std::map<std::string, Value> ScopedSymbolTable::snapshot() const {
+    std::map<std::string, Value> result;
+    for (size_t i = 0; i < bindings.size(); ++i) {
+        if (index[bindings[i].name] == i)
+            result.emplace(names->text(bindings[i].name), bindings[i].value);
+    }
+    return result;
+}
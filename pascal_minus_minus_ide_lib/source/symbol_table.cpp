@@ -1,89 +1,267 @@
 #include "symbol_table.h"
-#include <functional>
+#include <cstring>
+#include <new>
 
-// Конструктор SymbolInfo
-SymbolInfo::SymbolInfo(const string& n, const string& t, const string& v) : name(n), type(t), value(v), table(nullptr) {}
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SYMBOL_TABLE_SSE2 1
+#include <emmintrin.h>
+#endif
 
-// Конструктор SymbolTable
-SymbolTable::SymbolTable(size_t cap) : capacity(cap), count(0) {
-    buckets = new ChainNode * [capacity];
-    for (size_t i = 0; i < capacity; ++i)
-        buckets[i] = nullptr;
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+// Индекс младшего установленного бита (маска не должна быть нулевой)
+inline unsigned lowestBit(uint32_t mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+// Группа из 16 управляющих байтов, сравниваемых одновременно
+struct Group {
+#ifdef SYMBOL_TABLE_SSE2
+    __m128i bytes;
+
+    explicit Group(const uint8_t* p) : bytes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) {}
+
+    // Маска слотов, у которых управляющий байт равен h2
+    uint32_t match(uint8_t h2) const {
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(h2)), bytes)));
+    }
+
+    // Маска пустых слотов (у пустого слота установлен старший бит)
+    uint32_t matchEmpty() const {
+        return static_cast<uint32_t>(_mm_movemask_epi8(bytes));
+    }
+#else
+    const uint8_t* bytes;
+
+    explicit Group(const uint8_t* p) : bytes(p) {}
+
+    uint32_t match(uint8_t h2) const {
+        uint32_t mask = 0;
+        for (unsigned i = 0; i < 16; ++i)
+            if (bytes[i] == h2)
+                mask |= 1u << i;
+        return mask;
+    }
+
+    uint32_t matchEmpty() const {
+        uint32_t mask = 0;
+        for (unsigned i = 0; i < 16; ++i)
+            if (bytes[i] & 0x80)
+                mask |= 1u << i;
+        return mask;
+    }
+#endif
+};
+
+// Младшие 7 бит хеша хранятся в управляющем байте, остальные задают начальный слот
+inline uint8_t hashH2(size_t hash) { return static_cast<uint8_t>(hash & 0x7F); }
+inline size_t hashH1(size_t hash) { return hash >> 7; }
+
+// Округление вместимости вверх до степени двойки
+size_t roundCapacity(size_t cap, size_t minimum) {
+    size_t result = minimum;
+    while (result < cap)
+        result <<= 1;
+    return result;
+}
+
+} // namespace
+
+// Конструктор SymbolInfo; номер имени назначает таблица при добавлении
+SymbolInfo::SymbolInfo(const string& n, const string& t, const string& v)
+    : name(n), id(NO_NAME), type(t), value(v), table(nullptr) {}
+
+// Текст имени подставит таблица, выдавшая номер
+SymbolInfo::SymbolInfo(NameId n, const string& t, const string& v)
+    : id(n), type(t), value(v), table(nullptr) {}
+
+// Конструктор SymbolTable: вместимость округляется до степени двойки не меньше GROUP_WIDTH
+SymbolTable::SymbolTable(size_t cap) : ctrl(nullptr), slots(nullptr), capacity(0), count(0) {
+    allocate(roundCapacity(cap, GROUP_WIDTH));
 }
 
 SymbolTable::~SymbolTable() {
+    release();
+}
+
+// Номера имён идут подряд, поэтому перемешиваем их мультипликативным хешем
+size_t SymbolTable::hashKey(NameId key) const {
+    uint64_t h = static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull;
+    return static_cast<size_t>(h ^ (h >> 32));
+}
+
+// Выделение пустых массивов управляющих байтов и слотов
+void SymbolTable::allocate(size_t cap) {
+    capacity = cap;
+    count = 0;
+    ctrl = new uint8_t[capacity + GROUP_WIDTH - 1];
+    memset(ctrl, CTRL_EMPTY, capacity + GROUP_WIDTH - 1);
+    slots = static_cast<SymbolInfo*>(::operator new(sizeof(SymbolInfo) * capacity));
+}
+
+// Уничтожение занятых слотов и освобождение памяти
+void SymbolTable::release() {
     for (size_t i = 0; i < capacity; ++i) {
-        ChainNode* node = buckets[i];
-        while (node) {
-            ChainNode* tmp = node;
-            node = node->next;
-            delete tmp;
+        if (!(ctrl[i] & CTRL_EMPTY))
+            slots[i].~SymbolInfo();
+    }
+    delete[] ctrl;
+    ::operator delete(slots);
+    ctrl = nullptr;
+    slots = nullptr;
+}
+
+// Запись управляющего байта; первые GROUP_WIDTH - 1 байтов дублируются в хвосте,
+// чтобы группу можно было читать с любой позиции без перехода через границу
+void SymbolTable::setCtrl(size_t index, uint8_t value) {
+    ctrl[index] = value;
+    if (index < GROUP_WIDTH - 1)
+        ctrl[capacity + index] = value;
+}
+
+// Поиск слота с указанным именем; возвращает capacity, если символ не найден
+size_t SymbolTable::findSlot(NameId id, size_t hash) const {
+    const size_t mask = capacity - 1;
+    const uint8_t h2 = hashH2(hash);
+    size_t pos = hashH1(hash) & mask;
+    for (size_t probed = 0; probed < capacity; probed += GROUP_WIDTH) {
+        Group group(ctrl + pos);
+        for (uint32_t m = group.match(h2); m != 0; m &= m - 1) {
+            size_t idx = (pos + lowestBit(m)) & mask;
+            if (slots[idx].id == id)
+                return idx;
         }
+        // Пустой слот в группе обрывает цепочку пробирования
+        if (group.matchEmpty() != 0)
+            return capacity;
+        pos = (pos + GROUP_WIDTH) & mask;
     }
-    delete[] buckets;
+    return capacity;
 }
 
-size_t SymbolTable::hashKey(const string& key) const {
-    return hash<string>{}(key) % capacity;
+// Перестроение таблицы с новой вместимостью
+void SymbolTable::rehash(size_t newCapacity) {
+    uint8_t* oldCtrl = ctrl;
+    SymbolInfo* oldSlots = slots;
+    size_t oldCapacity = capacity;
+    size_t oldCount = count;
+
+    allocate(newCapacity);
+    const size_t mask = capacity - 1;
+    for (size_t i = 0; i < oldCapacity; ++i) {
+        if (oldCtrl[i] & CTRL_EMPTY)
+            continue;
+        size_t hash = hashKey(oldSlots[i].id);
+        size_t pos = hashH1(hash) & mask;
+        while (true) {
+            uint32_t empty = Group(ctrl + pos).matchEmpty();
+            if (empty != 0) {
+                size_t idx = (pos + lowestBit(empty)) & mask;
+                new (&slots[idx]) SymbolInfo(std::move(oldSlots[i]));
+                setCtrl(idx, hashH2(hash));
+                break;
+            }
+            pos = (pos + GROUP_WIDTH) & mask;
+        }
+        oldSlots[i].~SymbolInfo();
+    }
+    count = oldCount;
+
+    delete[] oldCtrl;
+    ::operator delete(oldSlots);
 }
 
 // Метод для добавления символа
 void SymbolTable::addSymbol(const SymbolInfo& symbol) {
-    size_t idx = hashKey(symbol.name);
-    ChainNode* node = buckets[idx];
-    while (node) {
-        if (node->data.name == symbol.name) {
-            // Перезаписываем
-            node->data.type = symbol.type;
-            node->data.value = symbol.value;
-            return;
+    NameId id = symbol.id != NO_NAME ? symbol.id : names.intern(symbol.name);
+    const string& name = names.text(id);    // Номер, не выданный таблицей имён, отвергается (out_of_range)
+    size_t hash = hashKey(id);
+    size_t idx = findSlot(id, hash);
+    if (idx != capacity) {
+        // Перезаписываем
+        slots[idx].type = symbol.type;
+        slots[idx].value = symbol.value;
+        return;
+    }
+
+    // Рост при превышении допустимого заполнения
+    if ((count + 1) * MAX_LOAD_DEN > capacity * MAX_LOAD_NUM)
+        rehash(capacity * 2);
+
+    // Вставляем в первый пустой слот, начиная с начальной позиции
+    const size_t mask = capacity - 1;
+    size_t pos = hashH1(hash) & mask;
+    while (true) {
+        uint32_t empty = Group(ctrl + pos).matchEmpty();
+        if (empty != 0) {
+            idx = (pos + lowestBit(empty)) & mask;
+            break;
         }
-        node = node->next;
+        pos = (pos + GROUP_WIDTH) & mask;
     }
-    // Вставляем в голову списка
-    buckets[idx] = new ChainNode(symbol, buckets[idx]);
+    new (&slots[idx]) SymbolInfo(symbol);
+    slots[idx].id = id;
+    slots[idx].name = name;
+    setCtrl(idx, hashH2(hash));
     ++count;
 }
 
 // Метод для поиска символа
+SymbolInfo* SymbolTable::findSymbol(NameId id) {
+    size_t idx = findSlot(id, hashKey(id));
+    return idx != capacity ? &slots[idx] : nullptr;
+}
+
+// Ещё не интернированное имя заведомо отсутствует в таблице
 SymbolInfo* SymbolTable::findSymbol(const string& name) {
-    size_t idx = hashKey(name);
-    ChainNode* node = buckets[idx];
-    while (node) {
-        if (node->data.name == name)
-            return &node->data;
-        node = node->next;
-    }
-    return nullptr;
+    NameId id = names.find(name);
+    return id != NO_NAME ? findSymbol(id) : nullptr;
 }
 
-// Метод для удаления символа
-void SymbolTable::removeSymbol(const string& name) {
-    size_t idx = hashKey(name);
-    ChainNode* node = buckets[idx];
-    ChainNode* prev = nullptr;
-    while (node) {
-        if (node->data.name == name) {
-            if (prev)
-                prev->next = node->next;
-            else
-                buckets[idx] = node->next;
-            delete node;
-            --count;
-            return;
+// Метод для удаления символа: освободившийся слот заполняется обратным сдвигом
+// следующих элементов цепочки, поэтому "надгробия" не нужны
+void SymbolTable::removeSymbol(NameId id) {
+    size_t hole = findSlot(id, hashKey(id));
+    if (hole == capacity)
+        return;
+
+    const size_t mask = capacity - 1;
+    slots[hole].~SymbolInfo();
+    for (size_t j = (hole + 1) & mask; !(ctrl[j] & CTRL_EMPTY); j = (j + 1) & mask) {
+        size_t home = hashH1(hashKey(slots[j].id)) & mask;
+        // Элемент можно сдвинуть в дыру, если она лежит между его начальной позицией и текущей
+        if (((j - home) & mask) >= ((j - hole) & mask)) {
+            new (&slots[hole]) SymbolInfo(std::move(slots[j]));
+            slots[j].~SymbolInfo();
+            setCtrl(hole, ctrl[j]);
+            hole = j;
         }
-        prev = node;
-        node = node->next;
     }
+    setCtrl(hole, CTRL_EMPTY);
+    --count;
+}
+
+void SymbolTable::removeSymbol(const string& name) {
+    NameId id = names.find(name);
+    if (id != NO_NAME)
+        removeSymbol(id);
 }
 
 // Метод для вывода таблицы символов
 void SymbolTable::printTable() {
     for (size_t i = 0; i < capacity; ++i) {
-        ChainNode* node = buckets[i];
-        while (node) {
-            cout << "Name: " << node->data.name << ", Type: " << node->data.type << ", Value: " << node->data.value << endl;
-            node = node->next;
-        }
+        if (ctrl[i] & CTRL_EMPTY)
+            continue;
+        cout << "Name: " << slots[i].name << ", Type: " << slots[i].type << ", Value: " << slots[i].value << endl;
     }
-}
\ No newline at end of file
+}
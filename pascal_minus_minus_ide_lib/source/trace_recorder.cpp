@@ -0,0 +1,123 @@
+#include "trace_recorder.h"
+#include <cstdio>
+
+namespace {
+
+std::atomic<std::uint64_t> nextRecorderId{ 1 };
+
+// Буфер потока в последней трассе, куда он писал
+struct BufferCache {
+    std::uint64_t recorder = 0;
+    void* buffer = nullptr;
+};
+thread_local BufferCache cache;
+
+void writeString(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (char c : text) {
+        switch (c) {
+        case '"': out << "\\\""; break;
+        case '\\': out << "\\\\"; break;
+        case '\n': out << "\\n"; break;
+        case '\r': out << "\\r"; break;
+        case '\t': out << "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                out << escaped;
+            } else {
+                out << c;   // UTF-8 передаётся как есть
+            }
+        }
+    }
+    out << '"';
+}
+
+} // namespace
+
+void TraceRecorder::Span::setArg(const char* key, std::int64_t value) {
+    if (!recorder)
+        return;
+    if (!args.empty())
+        args += ',';
+    args += '"';
+    args += key;
+    args += "\":";
+    args += std::to_string(value);
+}
+
+TraceRecorder::TraceRecorder(std::size_t maxEventsPerThread)
+    : id(nextRecorderId.fetch_add(1)), maxEvents(maxEventsPerThread), origin(std::chrono::steady_clock::now()) {}
+
+std::int64_t TraceRecorder::now() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+TraceRecorder::ThreadBuffer& TraceRecorder::buffer() {
+    if (cache.recorder == id)
+        return *static_cast<ThreadBuffer*>(cache.buffer);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::thread::id self = std::this_thread::get_id();
+    ThreadBuffer* found = nullptr;
+    for (auto& candidate : buffers) {
+        if (candidate->thread == self)
+            found = candidate.get();
+    }
+    if (!found) {
+        auto created = std::make_unique<ThreadBuffer>();
+        created->thread = self;
+        created->tid = static_cast<std::uint32_t>(buffers.size() + 1);
+        created->name = "поток " + std::to_string(created->tid);
+        created->events.reserve(1024);
+        found = created.get();
+        buffers.push_back(std::move(created));
+    }
+    cache.recorder = id;
+    cache.buffer = found;
+    return *found;
+}
+
+void TraceRecorder::complete(const char* category, std::string name, std::int64_t start, std::int64_t duration,
+                             std::string args) {
+    ThreadBuffer& target = buffer();
+    if (target.events.size() >= maxEvents) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    target.events.push_back(TraceEvent{ std::move(name), category, start, duration, std::move(args) });
+}
+
+void TraceRecorder::setThreadName(const std::string& name) {
+    buffer().name = name;
+}
+
+std::size_t TraceRecorder::eventCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::size_t count = 0;
+    for (const auto& thread : buffers)
+        count += thread->events.size();
+    return count;
+}
+
+void TraceRecorder::writeJson(std::ostream& out) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Pascal--\"}}";
+    for (const auto& thread : buffers) {
+        out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->tid << ",\"args\":{\"name\":";
+        writeString(out, thread->name);
+        out << "}}";
+        for (const TraceEvent& event : thread->events) {
+            out << ",\n{\"name\":";
+            writeString(out, event.name);
+            out << ",\"cat\":\"" << event.category << "\",\"ph\":\"X\",\"ts\":" << event.start
+                << ",\"dur\":" << event.duration << ",\"pid\":1,\"tid\":" << thread->tid;
+            if (!event.args.empty())
+                out << ",\"args\":{" << event.args << '}';
+            out << '}';
+        }
+    }
+    out << "\n]}\n";
+}
@@ -0,0 +1,93 @@
+#include "value.h"
+#include <sstream>
+#include <stdexcept>
+
+// Реализация конструкторов Value (универсального контейнера значений)
+// ========================
+
+// Конструктор по умолчанию: значение типа Integer, равное 0
+Value::Value() : type(ValueType::Integer), intValue(0), realValue(0.0), boolValue(false), stringValue("") {}
+
+// Конструктор для целого значения
+Value::Value(int v) : type(ValueType::Integer), intValue(v), realValue(0.0), boolValue(false), stringValue("") {}
+
+// Конструктор для вещественного значения
+Value::Value(double v) : type(ValueType::Real), intValue(0), realValue(v), boolValue(false), stringValue("") {}
+
+// Конструктор для булевого значения
+Value::Value(bool v) : type(ValueType::Boolean), intValue(0), realValue(0.0), boolValue(v), stringValue("") {}
+
+// Конструктор для строкового значения
+Value::Value(const std::string& v) : type(ValueType::String), intValue(0), realValue(0.0), boolValue(false), stringValue(v) {}
+
+// Методы преобразования типов
+int Value::toInt() const {
+    switch (type) {
+        case ValueType::Integer:
+            return intValue;
+        case ValueType::Real:
+            return static_cast<int>(realValue);
+        case ValueType::Boolean:
+            return boolValue ? 1 : 0;
+        case ValueType::String:
+            try {
+                return std::stoi(stringValue);
+            } catch (const std::exception&) {
+                throw std::runtime_error("Невозможно преобразовать строку \"" + stringValue + "\" в целое число");
+            }
+        default:
+            throw std::runtime_error("Неподдерживаемый тип для преобразования в целое");
+    }
+}
+
+double Value::toReal() const {
+    switch (type) {
+        case ValueType::Integer:
+            return static_cast<double>(intValue);
+        case ValueType::Real:
+            return realValue;
+        case ValueType::Boolean:
+            return boolValue ? 1.0 : 0.0;
+        case ValueType::String:
+            try {
+                return std::stod(stringValue);
+            } catch (const std::exception&) {
+                throw std::runtime_error("Невозможно преобразовать строку \"" + stringValue + "\" в вещественное число");
+            }
+        default:
+            throw std::runtime_error("Неподдерживаемый тип для преобразования в вещественное");
+    }
+}
+
+bool Value::toBool() const {
+    switch (type) {
+        case ValueType::Boolean:
+            return boolValue;
+        case ValueType::Integer:
+            return intValue != 0;
+        case ValueType::Real:
+            return realValue != 0.0;
+        case ValueType::String:
+            return !stringValue.empty() && stringValue != "0" && stringValue != "false";
+        default:
+            throw std::runtime_error("Неподдерживаемый тип для преобразования в логический");
+    }
+}
+
+std::string Value::toString() const {
+    std::ostringstream oss;
+    switch (type) {
+        case ValueType::String:
+            return stringValue;
+        case ValueType::Integer:
+            oss << intValue;
+            return oss.str();
+        case ValueType::Real:
+            oss << realValue;
+            return oss.str();
+        case ValueType::Boolean:
+            return boolValue ? "true" : "false";
+        default:
+            throw std::runtime_error("Неподдерживаемый тип для преобразования в строку");
+    }
+}
@@ -0,0 +1,135 @@
+#include "work_stealing_pool.h"
+#include <cstdint>
+
+namespace {
+
+// Пул и номер очереди текущего рабочего потока
+thread_local const WorkStealingPool* currentPool = nullptr;
+thread_local std::size_t currentIndex = 0;
+
+// Начальная жертва перехвата выбирается случайно, чтобы потоки не толпились у одной очереди
+std::size_t nextRandom() {
+    thread_local std::uint64_t state = 0x9E3779B97F4A7C15ull ^ reinterpret_cast<std::uintptr_t>(&state);
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return static_cast<std::size_t>(state);
+}
+
+} // namespace
+
+WorkStealingPool::WorkStealingPool(std::size_t threads) {
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+    if (threads == 0)
+        threads = 1;
+    for (std::size_t i = 0; i < threads; ++i)
+        queues.push_back(std::make_unique<Queue>());
+    for (std::size_t i = 0; i < threads; ++i)
+        workers.emplace_back([this, i]() { workerLoop(i); });
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    try {
+        wait();
+    } catch (...) {
+        // Ошибка задачи, которую никто не забрал через wait(), отбрасывается
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping.store(true);
+    }
+    wake.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+}
+
+void WorkStealingPool::submit(Task task) {
+    std::size_t target = currentPool == this
+        ? currentIndex
+        : nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    unfinished.fetch_add(1, std::memory_order_relaxed);
+    queued.fetch_add(1, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(queues[target]->mutex);
+        queues[target]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wake.notify_one();
+}
+
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    done.wait(lock, [&]() { return unfinished.load(std::memory_order_acquire) == 0; });
+    if (firstError) {
+        std::exception_ptr error = firstError;
+        firstError = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void WorkStealingPool::workerLoop(std::size_t index) {
+    currentPool = this;
+    currentIndex = index;
+    Task task;
+    for (;;) {
+        if (popLocal(index, task) || steal(index, task)) {
+            execute(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [&]() { return stopping.load() || queued.load(std::memory_order_acquire) != 0; });
+        if (stopping.load() && queued.load(std::memory_order_acquire) == 0)
+            return;
+    }
+}
+
+// Свои задачи берутся с конца очереди (последняя поставленная - самая «тёплая»)
+bool WorkStealingPool::popLocal(std::size_t index, Task& task) {
+    Queue& queue = *queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+        return false;
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    queued.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+// Чужие задачи забираются с начала очереди, подальше от её владельца
+bool WorkStealingPool::steal(std::size_t index, Task& task) {
+    std::size_t count = queues.size();
+    std::size_t start = nextRandom();
+    for (std::size_t i = 0; i < count; ++i) {
+        std::size_t victim = (start + i) % count;
+        if (victim == index)
+            continue;
+        Queue& queue = *queues[victim];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+            continue;
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        stolen.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::execute(Task& task) {
+    try {
+        task();
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        if (!firstError)
+            firstError = std::current_exception();
+    }
+    task = nullptr;
+    if (unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        done.notify_all();
+    }
+}
@@ -0,0 +1,463 @@
+#include "allocation_profiler.h"
+#include "batch_runner.h"
+#include "compiled_program.h"
+#include "error_reporter.h"
+#include "fork_server.h"
+#include "green_scheduler.h"
+#include "input_source.h"
+#include "interpreter.h"
+#include "lexer.h"
+#include "metrics.h"
+#include "node_profiler.h"
+#include "output_sink.h"
+#include "parser.h"
+#include "perf_counters.h"
+#include "process_batch_runner.h"
+#include "sampling_profiler.h"
+#include "trace_recorder.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+extern char** environ;
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+void printUsage() {
+    std::cerr << "Использование: pascal_minus_minus_ide_runner <каталог|список|программа.pas> [-j потоков] [--out каталог]" << std::endl;
+    std::cerr << "       [--processes N] [--time-limit секунд] [--memory-limit МБ] [--fork-latency N]" << std::endl;
+    std::cerr << "       [--green] [--slice N] [--profile файл] [--sample] [--perf] [--trace файл]" << std::endl;
+    std::cerr << "       [--metrics файл] [--alloc]" << std::endl;
+    std::cerr << "  каталог   - выполнить все *.pas (ввод из одноимённого .in)" << std::endl;
+    std::cerr << "  список    - файл со строками \"программа.pas [ввод.in]\"" << std::endl;
+    std::cerr << "  программа - выполнить одну программу (ввод из одноимённого .in)" << std::endl;
+    std::cerr << "  -j N      - число потоков (по умолчанию - все ядра)" << std::endl;
+    std::cerr << "  --out DIR - сохранить вывод каждой программы в DIR/<имя>.out" << std::endl;
+    std::cerr << "  --processes N      - выполнять в N рабочих процессах (0 - по числу ядер)" << std::endl;
+    std::cerr << "  --time-limit S     - ограничение времени задания (кроме --green)" << std::endl;
+    std::cerr << "  --memory-limit MB  - ограничение памяти: процесса с --processes, иначе интерпретатора (кроме --green)" << std::endl;
+    std::cerr << "  --green            - выполнять программы в сопрограммах на -j потоках" << std::endl;
+    std::cerr << "  --slice N          - обратных переходов циклов в кванте (только с --green)" << std::endl;
+    std::cerr << "  --fork-latency N   - сравнить задержку запуска программы через fork-сервер" << std::endl;
+    std::cerr << "                       и N отдельными процессами (только для одной программы)" << std::endl;
+    std::cerr << "  --profile FILE     - профиль по узлам AST: отчёт в stdout, свёрнутые стеки" << std::endl;
+    std::cerr << "                       для flame graph в FILE (только для одной программы)" << std::endl;
+    std::cerr << "  --sample           - выборочный профиль по строкам (только для одной программы)" << std::endl;
+    std::cerr << "  --perf             - аппаратные счётчики по фазам: разбор, выполнение обходом дерева," << std::endl;
+    std::cerr << "                       компиляция и выполнение замыканий (только для одной программы)" << std::endl;
+    std::cerr << "  --trace FILE       - временная шкала Chrome trace_event в FILE: задания по потокам," << std::endl;
+    std::cerr << "                       фазы, операторы главного блока и циклы (только пул потоков)" << std::endl;
+    std::cerr << "  --metrics FILE     - счётчики выполнения в FILE: JSON для *.json, иначе формат" << std::endl;
+    std::cerr << "                       Prometheus (только пул потоков)" << std::endl;
+    std::cerr << "  --alloc            - выделения памяти по фазам, структурам данных и операторам" << std::endl;
+    std::cerr << "                       (только для одной программы)" << std::endl;
+}
+
+// Имя файла результата: путь программы без каталога задания
+std::string outputName(const std::string& program) {
+    return fs::path(program).stem().string() + ".out";
+}
+
+// Выполняет задания в сопрограммах кооперативного планировщика
+std::vector<BatchResult> runGreen(const std::vector<BatchJob>& jobs, const GreenSchedulerOptions& options,
+                                  BatchSummary& summary, std::size_t& slices) {
+    auto start = std::chrono::steady_clock::now();
+    GreenScheduler scheduler(options);
+    for (const auto& job : jobs)
+        scheduler.spawn(job);
+    scheduler.wait();
+
+    std::vector<BatchResult> results;
+    results.reserve(jobs.size());
+    summary = BatchSummary();
+    summary.programs = jobs.size();
+    summary.threads = scheduler.threadCount();
+    slices = 0;
+    for (std::size_t i = 0; i < jobs.size(); ++i) {
+        GreenTaskInfo info = scheduler.info(i);
+        slices += info.slices;
+        summary.jobSeconds += info.cpuSeconds;
+        if (info.result.success)
+            ++summary.succeeded;
+        results.push_back(std::move(info.result));
+    }
+    summary.failed = summary.programs - summary.succeeded;
+    summary.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (summary.wallSeconds > 0)
+        summary.programsPerSecond = summary.programs / summary.wallSeconds;
+    return results;
+}
+
+void printLatency(const char* title, std::vector<double> seconds) {
+    std::sort(seconds.begin(), seconds.end());
+    double total = 0;
+    for (double value : seconds)
+        total += value;
+    char line[160];
+    std::snprintf(line, sizeof(line), "%s медиана %9.3f мс, среднее %9.3f мс, максимум %9.3f мс",
+                  title, seconds[seconds.size() / 2] * 1000, total / seconds.size() * 1000, seconds.back() * 1000);
+    std::cout << line << std::endl;
+}
+
+// Выполняет программу с точным профилировщиком по узлам AST (foldedPath) или с выборочным по строкам
+int profileProgram(const std::string& program, const std::string& foldedPath, bool sampling) {
+    try {
+        BatchJob job = loadBatchProgram(program);
+        std::ostringstream diagnostics;
+        auto reporter = std::make_shared<ErrorReporter>(diagnostics);
+        auto output = std::make_shared<MemoryOutputSink>();
+        Lexer lexer(job.source, reporter);
+        Parser parser(lexer.tokenize(), reporter);
+        std::shared_ptr<ASTNode> ast = parser.parse();
+        if (!ast) {
+            std::cerr << diagnostics.str();
+            return 1;
+        }
+
+        NodeProfiler profiler;
+        SamplingProfiler sampler;
+        Interpreter interpreter(reporter, output, std::make_shared<MemoryInputSource>(job.input));
+        interpreter.setNames(lexer.getNames());
+        if (sampling)
+            sampler.start(interpreter.getPosition());
+        else
+            interpreter.setProfiler(&profiler);
+        auto start = std::chrono::steady_clock::now();
+        interpreter.run(ast);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        sampler.stop();
+
+        if (sampling) {
+            std::cerr << diagnostics.str();
+            std::printf("Выполнено за %.3f мс\n", seconds * 1000);
+            sampler.writeReport(std::cout, 20, job.source);
+            return reporter->hasErrors() ? 1 : 0;
+        }
+
+        std::ofstream folded(foldedPath, std::ios::binary);
+        profiler.writeFoldedStacks(folded);
+        if (!folded) {
+            std::cerr << "Не удалось записать " << foldedPath << std::endl;
+            return 2;
+        }
+        std::cerr << diagnostics.str();
+        std::printf("Выполнено за %.3f мс (с профилированием), узлов: %zu\n", seconds * 1000, profiler.results().size());
+        profiler.writeReport(std::cout, 30);
+        return reporter->hasErrors() ? 1 : 0;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+}
+
+// Считает выделения памяти при разборе и выполнении программы
+int profileAllocations(const std::string& program) {
+    try {
+        BatchJob job = loadBatchProgram(program);
+        std::ostringstream diagnostics;
+        auto reporter = std::make_shared<ErrorReporter>(diagnostics);
+        auto output = std::make_shared<MemoryOutputSink>();
+        AllocationProfiler profiler;
+        profiler.start();
+        Lexer lexer(job.source, reporter);
+        Parser parser(lexer.tokenize(), reporter);
+        std::shared_ptr<ASTNode> ast = parser.parse();
+        if (!ast) {
+            profiler.stop();
+            std::cerr << diagnostics.str();
+            return 1;
+        }
+        {
+            Interpreter interpreter(reporter, output, std::make_shared<MemoryInputSource>(job.input));
+            interpreter.setNames(lexer.getNames());
+            interpreter.setAllocationProfiler(&profiler);
+            interpreter.run(ast);
+        }
+        profiler.stop();
+
+        std::cerr << diagnostics.str();
+        profiler.writeReport(std::cout, 20);
+        return reporter->hasErrors() ? 1 : 0;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+}
+
+// Замеряет фазы обработки программы аппаратными счётчиками
+int measurePhases(const std::string& program) {
+    try {
+        BatchJob job = loadBatchProgram(program);
+        std::ostringstream diagnostics;
+        auto reporter = std::make_shared<ErrorReporter>(diagnostics);
+        PhaseCounters counters;
+        auto names = std::make_shared<NameTable>();
+        std::vector<Token> tokens;
+        std::shared_ptr<ASTNode> ast;
+        {
+            PhaseCounters::Phase phase(counters, "лексический анализ");
+            tokens = Lexer(job.source, reporter, names).tokenize();
+        }
+        {
+            PhaseCounters::Phase phase(counters, "синтаксический анализ");
+            ast = Parser(std::move(tokens), reporter).parse();
+        }
+        if (!ast) {
+            std::cerr << diagnostics.str();
+            return 1;
+        }
+        {
+            PhaseCounters::Phase phase(counters, "выполнение обходом дерева");
+            Interpreter interpreter(reporter, std::make_shared<MemoryOutputSink>(),
+                std::make_shared<MemoryInputSource>(job.input));
+            interpreter.setNames(names);
+            interpreter.run(ast);
+        }
+
+        // Компиляция в замыкания - необязательная фаза: не всякая программа компилируется
+        try {
+            std::shared_ptr<const CompiledProgram> compiled;
+            {
+                PhaseCounters::Phase phase(counters, "компиляция в замыкания");
+                compiled = CompiledProgram::compile(ast, names);
+            }
+            std::istringstream input(job.input);
+            std::ostringstream output;
+            PhaseCounters::Phase phase(counters, "выполнение замыканий");
+            ExecutionContext context(*compiled, input, output, std::make_shared<ErrorReporter>(diagnostics));
+            compiled->run(context);
+        } catch (const std::exception& e) {
+            diagnostics << "Компиляция в замыкания: " << e.what() << '\n';
+        }
+
+        std::cerr << diagnostics.str();
+        counters.writeReport(std::cout);
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+}
+
+// Сравнивает запуск программы из прогретого fork-сервера с запуском нового процесса раннера
+int measureForkLatency(const char* self, const std::string& program, std::size_t runs, double timeLimitSeconds) {
+#ifdef _WIN32
+    (void)self; (void)program; (void)runs; (void)timeLimitSeconds;
+    std::cerr << "Fork-сервер поддерживается только в POSIX-системах" << std::endl;
+    return 2;
+#else
+    BatchJob job = loadBatchProgram(program);
+    std::vector<double> cold, startup, warm, preloaded;
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+    std::string exe = fs::exists("/proc/self/exe") ? fs::read_symlink("/proc/self/exe").string() : self;
+    std::vector<char*> args = { &exe[0], &job.name[0], nullptr };
+    for (std::size_t i = 0; i < runs; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        pid_t pid;
+        if (posix_spawn(&pid, exe.c_str(), &actions, nullptr, args.data(), environ) != 0) {
+            std::cerr << "Не удалось запустить " << exe << std::endl;
+            return 2;
+        }
+        waitpid(pid, nullptr, 0);
+        cold.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    posix_spawn_file_actions_destroy(&actions);
+
+    try {
+        ForkServer server(timeLimitSeconds);
+        for (std::size_t i = 0; i < runs; ++i) {
+            ForkResult response = server.run(job);
+            startup.push_back(response.startupSeconds);
+            warm.push_back(response.totalSeconds);
+        }
+        server.preload(job.source);
+        for (std::size_t i = 0; i < runs; ++i)
+            preloaded.push_back(server.run(job.input).totalSeconds);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+
+    printLatency("Новый процесс:           ", cold);
+    printLatency("Fork-сервер, запуск:     ", startup);
+    printLatency("Fork-сервер, с разбором: ", warm);
+    printLatency("Fork-сервер, загружена:  ", preloaded);
+    return 0;
+#endif
+}
+
+} // namespace
+
+// Пакетный запуск программ Pascal-- на пуле потоков с перехватом задач, в сопрограммах или в рабочих процессах
+int main(int argc, char** argv) {
+    std::string target, outDir;
+    std::size_t threads = 0;
+    bool processes = false;
+    bool green = false;
+    std::size_t latencyRuns = 0;
+    std::size_t slices = 0;
+    std::string profilePath;
+    bool sampling = false;
+    bool perf = false;
+    std::string tracePath;
+    std::string metricsPath;
+    bool allocations = false;
+    GreenSchedulerOptions greenOptions;
+    ProcessRunnerOptions processOptions;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) {
+            threads = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--out" && i + 1 < argc) {
+            outDir = argv[++i];
+        } else if (arg == "--processes" && i + 1 < argc) {
+            processes = true;
+            processOptions.workers = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--time-limit" && i + 1 < argc) {
+            processOptions.timeLimitSeconds = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--memory-limit" && i + 1 < argc) {
+            processOptions.memoryLimitBytes = std::strtoull(argv[++i], nullptr, 10) << 20;
+        } else if (arg == "--green") {
+            green = true;
+        } else if (arg == "--slice" && i + 1 < argc) {
+            greenOptions.sliceBackEdges = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--profile" && i + 1 < argc) {
+            profilePath = argv[++i];
+        } else if (arg == "--sample") {
+            sampling = true;
+        } else if (arg == "--perf") {
+            perf = true;
+        } else if (arg == "--trace" && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (arg == "--alloc") {
+            allocations = true;
+        } else if (arg == "--metrics" && i + 1 < argc) {
+            metricsPath = argv[++i];
+        } else if (arg == "--fork-latency" && i + 1 < argc) {
+            latencyRuns = std::strtoul(argv[++i], nullptr, 10);
+        } else if (target.empty() && arg[0] != '-') {
+            target = arg;
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+    bool single = fs::path(target).extension() == ".pas";
+    if (target.empty() || ((latencyRuns || sampling || perf || allocations || !profilePath.empty()) && !single)
+        || ((!tracePath.empty() || !metricsPath.empty()) && (processes || green))) {
+        printUsage();
+        return 2;
+    }
+    if (latencyRuns)
+        return measureForkLatency(argv[0], target, latencyRuns, processOptions.timeLimitSeconds);
+    if (perf)
+        return measurePhases(target);
+    if (allocations)
+        return profileAllocations(target);
+    if (sampling || !profilePath.empty())
+        return profileProgram(target, profilePath, sampling);
+
+    std::vector<BatchJob> jobs;
+    try {
+        if (fs::is_directory(target))
+            jobs = loadBatchDirectory(target);
+        else if (single)
+            jobs.push_back(loadBatchProgram(target));
+        else
+            jobs = loadBatchManifest(target);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+
+    std::vector<BatchResult> results;
+    BatchSummary summary;
+    TraceRecorder tracer;
+    MetricsRegistry metrics;
+    try {
+        if (processes) {
+            ProcessBatchRunner runner(processOptions);
+            results = runner.run(jobs);
+            summary = runner.getSummary();
+        } else if (green) {
+            greenOptions.threads = threads;
+            results = runGreen(jobs, greenOptions, summary, slices);
+        } else {
+            BatchRunner runner(threads, processOptions.timeLimitSeconds, processOptions.memoryLimitBytes);
+            if (!tracePath.empty())
+                runner.setTracer(&tracer);
+            if (!metricsPath.empty())
+                runner.setMetrics(&metrics);
+            results = runner.run(jobs);
+            summary = runner.getSummary();
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+
+    if (!tracePath.empty()) {
+        std::ofstream file(tracePath, std::ios::binary);
+        tracer.writeJson(file);
+        if (!file) {
+            std::cerr << "Не удалось записать " << tracePath << std::endl;
+            return 2;
+        }
+    }
+    if (!metricsPath.empty()) {
+        try {
+            metrics.writeFile(metricsPath);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 2;
+        }
+    }
+
+    if (!outDir.empty())
+        fs::create_directories(outDir);
+    for (const auto& result : results) {
+        char timing[64];
+        std::snprintf(timing, sizeof(timing), "%10.3f ms %9.1f KB", result.seconds * 1000, result.peakMemoryBytes / 1024.0);
+        std::cout << (result.success ? "OK    " : "FAIL  ") << timing << "  " << result.name;
+        if (!result.error.empty())
+            std::cout << "  (" << result.error << ")";
+        std::cout << '\n';
+        if (!outDir.empty()) {
+            std::ofstream file(fs::path(outDir) / outputName(result.name), std::ios::binary);
+            file << result.output;
+        }
+    }
+
+    char totals[256];
+    if (processes)
+        std::snprintf(totals, sizeof(totals), "%.3f с, %.1f программ/с, процессов: %zu, перезапусков: %zu, время заданий: %.3f с",
+                      summary.wallSeconds, summary.programsPerSecond, summary.threads, summary.restarts, summary.jobSeconds);
+    else if (green)
+        std::snprintf(totals, sizeof(totals), "%.3f с, %.1f программ/с, потоков: %zu, квантов: %zu, время заданий: %.3f с",
+                      summary.wallSeconds, summary.programsPerSecond, summary.threads, slices, summary.jobSeconds);
+    else
+        std::snprintf(totals, sizeof(totals), "%.3f с, %.1f программ/с, потоков: %zu, перехвачено: %zu, время заданий: %.3f с",
+                      summary.wallSeconds, summary.programsPerSecond, summary.threads, summary.stolen, summary.jobSeconds);
+    std::cout << "Программ: " << summary.programs << ", успешно: " << summary.succeeded
+              << ", с ошибками: " << summary.failed << std::endl;
+    std::cout << totals << std::endl;
+    return summary.failed == 0 ? 0 : 1;
+}
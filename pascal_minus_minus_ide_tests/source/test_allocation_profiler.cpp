@@ -0,0 +1,186 @@
+#include <gtest.h>
+#include "allocation_profiler.h"
+#include "coroutine.h"
+#include "interpreter.h"
+#include "parser.h"
+#include "lexer.h"
+#include "error_reporter.h"
+#include "input_source.h"
+#include "output_sink.h"
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Long enough to defeat the small string optimization
+const char* INPUT = "a_word_longer_than_small_string_buffers";
+
+const char* STRINGS =
+    "program Strings;\n"
+    "var i: Integer;\n"
+    "    s: String;\n"
+    "begin\n"
+    "  read(s);\n"
+    "  for i := 1 to 5 do\n"
+    "    s := s + s;\n"
+    "  writeln(i);\n"
+    "end.";
+
+std::shared_ptr<ASTNode> parse(const std::shared_ptr<ErrorReporter>& reporter, const std::shared_ptr<NameTable>& names) {
+    Lexer lexer(STRINGS, reporter, names);
+    Parser parser(lexer.tokenize(), reporter);
+    return parser.parse();
+}
+
+// The tree is returned because the profile refers to its nodes
+std::shared_ptr<ASTNode> runStrings(AllocationProfiler* profiler) {
+    auto reporter = std::make_shared<ErrorReporter>();
+    Interpreter interpreter(reporter, std::make_shared<MemoryOutputSink>(), std::make_shared<MemoryInputSource>(INPUT));
+    std::shared_ptr<ASTNode> ast = parse(reporter, interpreter.getNames());
+    interpreter.setAllocationProfiler(profiler);
+    interpreter.run(ast);
+    return ast;
+}
+
+// Keeps the optimizer from eliding the allocation
+volatile char sink = 0;
+
+} // namespace
+
+TEST(AllocationProfilerTest, HooksAreLinkedIntoTests) {
+    EXPECT_TRUE(AllocationProfiler::hooksInstalled());
+}
+
+TEST(AllocationProfilerTest, TracksLiveAndPeakBytes) {
+    AllocationProfiler profiler;
+    profiler.start();
+    {
+        std::vector<char> block(4096, 'x');
+        sink = block[100];
+        EXPECT_GE(profiler.total().liveBytes, 4096);
+    }
+    profiler.stop();
+
+    AllocationStats total = profiler.total();
+    EXPECT_GE(total.allocations, 1u);
+    EXPECT_GE(total.bytes, 4096u);
+    EXPECT_GE(total.peakLiveBytes, 4096);
+    EXPECT_LT(total.liveBytes, 4096);
+    EXPECT_EQ(profiler.stats(AllocationPhase::Other, AllocationSite::Other).allocations, total.allocations);
+}
+
+TEST(AllocationProfilerTest, IgnoresAllocationsWhileStopped) {
+    AllocationProfiler profiler;
+    std::vector<char> before(1000, 'x');
+    profiler.start();
+    before = std::vector<char>();
+    profiler.stop();
+    std::vector<char> after(1000, 'y');
+    sink = after[0];
+    EXPECT_EQ(profiler.total().allocations, 0u);
+    EXPECT_EQ(profiler.total().liveBytes, 0);
+}
+
+TEST(AllocationProfilerTest, OnlyOneProfilerIsActive) {
+    AllocationProfiler first;
+    AllocationProfiler second;
+    first.start();
+    first.start();
+    EXPECT_TRUE(first.running());
+    EXPECT_THROW(second.start(), std::logic_error);
+    first.stop();
+    second.start();
+    EXPECT_TRUE(second.running());
+}
+
+TEST(AllocationProfilerTest, CoroutineScopesDoNotLeakIntoCaller) {
+    auto first = std::make_unique<Coroutine>([] {
+        AllocationProfiler::PhaseScope phase(AllocationPhase::Execution);
+        AllocationProfiler::SiteScope site(AllocationSite::Symbols);
+        Coroutine::yield();
+    });
+    auto second = std::make_unique<Coroutine>([] {
+        AllocationProfiler::PhaseScope phase(AllocationPhase::Parsing);
+        Coroutine::yield();
+    });
+
+    AllocationProfiler profiler;
+    profiler.start();
+    first->resume();
+    second->resume();
+    std::vector<char> suspended(1000, 'x');
+    sink = suspended[0];
+    // Destroyed out of order, the coroutines unwind their scopes on their own stacks
+    first.reset();
+    second.reset();
+    std::vector<char> finished(1000, 'y');
+    sink = finished[0];
+    profiler.stop();
+
+    EXPECT_GE(profiler.total().allocations, 2u);
+    EXPECT_EQ(profiler.stats(AllocationPhase::Other, AllocationSite::Other).allocations, profiler.total().allocations);
+}
+
+TEST(AllocationProfilerTest, AttributesPhasesAndStructures) {
+    AllocationProfiler profiler;
+    profiler.start();
+    auto reporter = std::make_shared<ErrorReporter>();
+    auto names = std::make_shared<NameTable>();
+    std::shared_ptr<ASTNode> ast = parse(reporter, names);
+    {
+        Interpreter interpreter(reporter, std::make_shared<MemoryOutputSink>(), std::make_shared<MemoryInputSource>(INPUT));
+        interpreter.setNames(names);
+        interpreter.run(ast);
+    }
+    profiler.stop();
+
+    EXPECT_GT(profiler.stats(AllocationPhase::Lexing, AllocationSite::Tokens).allocations, 0u);
+    EXPECT_GT(profiler.stats(AllocationPhase::Parsing, AllocationSite::Ast).allocations, 0u);
+    EXPECT_GT(profiler.stats(AllocationPhase::Execution, AllocationSite::Postfix).allocations, 0u);
+    EXPECT_GT(profiler.stats(AllocationPhase::Execution, AllocationSite::Strings).allocations, 0u);
+    EXPECT_GT(profiler.stats(AllocationPhase::Execution, AllocationSite::Symbols).allocations, 0u);
+
+    std::uint64_t phases = 0;
+    for (AllocationPhase phase : { AllocationPhase::Other, AllocationPhase::Lexing, AllocationPhase::Parsing,
+                                   AllocationPhase::Execution })
+        phases += profiler.stats(phase).allocations;
+    EXPECT_EQ(phases, profiler.total().allocations);
+    // Without setAllocationProfiler no statements are recorded
+    EXPECT_TRUE(profiler.statements().empty());
+}
+
+TEST(AllocationProfilerTest, CountsOwnAllocationsPerStatement) {
+    AllocationProfiler profiler;
+    profiler.start();
+    std::shared_ptr<ASTNode> ast = runStrings(&profiler);
+    profiler.stop();
+
+    std::vector<StatementAllocations> statements = profiler.statements();
+    ASSERT_FALSE(statements.empty());
+    const StatementAllocations* body = nullptr;
+    const StatementAllocations* loop = nullptr;
+    std::uint64_t sum = 0;
+    for (const StatementAllocations& entry : statements) {
+        sum += entry.allocations;
+        if (entry.node->line == 7)
+            body = &entry;
+        if (entry.node->type == ASTNodeType::ForLoop)
+            loop = &entry;
+    }
+    ASSERT_NE(body, nullptr);
+    ASSERT_NE(loop, nullptr);
+    EXPECT_EQ(body->executions, 5u);
+    // Concatenation allocates on every execution
+    EXPECT_GE(body->allocations, 5u);
+    EXPECT_EQ(loop->executions, 1u);
+    EXPECT_LT(loop->allocations, body->allocations);
+    EXPECT_LE(sum, profiler.stats(AllocationPhase::Execution).allocations);
+
+    std::ostringstream report;
+    profiler.writeReport(report, 5);
+    EXPECT_NE(report.str().find("выполнение"), std::string::npos);
+    EXPECT_NE(report.str().find("Assignment (7:5)"), std::string::npos) << report.str();
+}
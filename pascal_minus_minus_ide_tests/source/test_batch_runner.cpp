@@ -0,0 +1,148 @@
+#include <gtest.h>
+#include "batch_runner.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string sumProgram(int factor) {
+    return
+        "program Sum;\n"
+        "var i, n, total: Integer;\n"
+        "begin\n"
+        "  read(n);\n"
+        "  total := 0;\n"
+        "  for i := 1 to n do\n"
+        "    total := total + i * " + std::to_string(factor) + ";\n"
+        "  writeln(total);\n"
+        "end.";
+}
+
+void writeFile(const std::filesystem::path& path, const std::string& text) {
+    std::ofstream file(path, std::ios::binary);
+    file << text;
+}
+
+} // namespace
+
+TEST(BatchRunnerTest, RunsJobsWithOwnInputAndOutput) {
+    std::vector<BatchJob> jobs;
+    for (int k = 0; k < 500; ++k)
+        jobs.push_back({ "job" + std::to_string(k), sumProgram(k), std::to_string(k % 20 + 1) });
+
+    BatchRunner runner(4);
+    std::vector<BatchResult> results = runner.run(jobs);
+
+    ASSERT_EQ(jobs.size(), results.size());
+    for (int k = 0; k < 500; ++k) {
+        int n = k % 20 + 1;
+        EXPECT_EQ("job" + std::to_string(k), results[k].name);
+        EXPECT_TRUE(results[k].success) << results[k].error;
+        EXPECT_EQ(std::to_string(k * n * (n + 1) / 2) + "\n", results[k].output);
+    }
+    const BatchSummary& summary = runner.getSummary();
+    EXPECT_EQ(500u, summary.programs);
+    EXPECT_EQ(500u, summary.succeeded);
+    EXPECT_EQ(0u, summary.failed);
+    EXPECT_EQ(4u, summary.threads);
+    EXPECT_GT(summary.programsPerSecond, 0.0);
+}
+
+TEST(BatchRunnerTest, FailureIsIsolatedToItsJob) {
+    std::vector<BatchJob> jobs = {
+        { "good", sumProgram(1), "3" },
+        { "broken", "program Broken;\nbegin\n  x := ;\nend.", "" },
+        { "undeclared", "program U;\nbegin\n  y := 1;\nend.", "" },
+        { "good2", sumProgram(2), "3" },
+    };
+
+    BatchRunner runner(2);
+    std::vector<BatchResult> results = runner.run(jobs);
+
+    EXPECT_TRUE(results[0].success);
+    EXPECT_FALSE(results[1].success);
+    EXPECT_FALSE(results[1].error.empty());
+    EXPECT_FALSE(results[2].success);
+    EXPECT_FALSE(results[2].diagnostics.empty());
+    EXPECT_TRUE(results[3].success);
+    EXPECT_EQ("12\n", results[3].output);
+    EXPECT_EQ(2u, runner.getSummary().failed);
+}
+
+TEST(BatchRunnerTest, TimeLimitInterruptsRunawayJob) {
+    std::vector<BatchJob> jobs = {
+        { "runaway",
+          "program Loop;\n"
+          "var i, j, s: Integer;\n"
+          "begin\n"
+          "  for i := 1 to 10000 do\n"
+          "    for j := 1 to 10000 do\n"
+          "      s := s + 1;\n"
+          "end.", "" },
+        { "quick", sumProgram(2), "4" },
+    };
+
+    BatchRunner runner(2, 0.1);
+    std::vector<BatchResult> results = runner.run(jobs);
+
+    EXPECT_FALSE(results[0].success);
+    EXPECT_NE(std::string::npos, results[0].error.find("истёк срок выполнения")) << results[0].error;
+    EXPECT_LT(results[0].seconds, 0.5);
+    EXPECT_TRUE(results[1].success);
+    EXPECT_EQ("20\n", results[1].output);
+}
+
+TEST(BatchRunnerTest, ReportsMemoryAndEnforcesMemoryLimit) {
+    const std::string echo =
+        "program Echo;\n"
+        "var s: String;\n"
+        "begin\n"
+        "  read(s);\n"
+        "  writeln(s);\n"
+        "end.";
+    std::vector<BatchJob> jobs = {
+        { "small", echo, "hello" },
+        { "large", echo, std::string(1 << 20, 'x') },
+    };
+
+    BatchRunner runner(2, 0, 256 * 1024);
+    std::vector<BatchResult> results = runner.run(jobs);
+
+    EXPECT_TRUE(results[0].success);
+    EXPECT_GT(results[0].peakMemoryBytes, 0u);
+    EXPECT_GE(results[0].peakMemoryBytes, results[0].memoryBytes);
+    EXPECT_FALSE(results[1].success);
+    EXPECT_NE(std::string::npos, results[1].error.find("превышен лимит памяти")) << results[1].error;
+    EXPECT_LE(results[1].peakMemoryBytes, 256u * 1024);
+}
+
+TEST(BatchRunnerTest, LoadsDirectoryAndManifest) {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "pmm_batch_runner_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    writeFile(dir / "b.pas", sumProgram(1));
+    writeFile(dir / "b.in", "4");
+    writeFile(dir / "a.pas", sumProgram(10));
+    writeFile(dir / "notes.txt", "not a program");
+    writeFile(dir / "list.txt", "# programs\nb.pas other.in\n\na.pas\n");
+    writeFile(dir / "other.in", "2");
+
+    std::vector<BatchJob> fromDirectory = loadBatchDirectory(dir.string());
+    ASSERT_EQ(2u, fromDirectory.size());
+    EXPECT_EQ("a.pas", fs::path(fromDirectory[0].name).filename().string());
+    EXPECT_EQ("", fromDirectory[0].input);
+    EXPECT_EQ("4", fromDirectory[1].input);
+
+    std::vector<BatchJob> fromManifest = loadBatchManifest((dir / "list.txt").string());
+    ASSERT_EQ(2u, fromManifest.size());
+    EXPECT_EQ("b.pas", fs::path(fromManifest[0].name).filename().string());
+    EXPECT_EQ("2", fromManifest[0].input);
+    EXPECT_EQ(sumProgram(10), fromManifest[1].source);
+
+    EXPECT_THROW(loadBatchDirectory((dir / "missing").string()), std::runtime_error);
+    fs::remove_all(dir);
+}
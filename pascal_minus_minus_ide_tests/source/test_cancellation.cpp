@@ -0,0 +1,133 @@
+#include <gtest.h>
+#include "cancellation.h"
+#include "interpreter.h"
+#include "parser.h"
+#include "lexer.h"
+#include "error_reporter.h"
+#include "output_sink.h"
+#include <chrono>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// 10^8 iterations of nested while loops: minutes of work unless interrupted.
+// while swallows std::exception, so this also checks the interrupt is not caught there
+const char* RUNAWAY =
+    "program Runaway;\n"
+    "var i, j, n: Integer;\n"
+    "begin\n"
+    "  n := 0;\n"
+    "  i := 0;\n"
+    "  while i < 10000 do\n"
+    "  begin\n"
+    "    j := 0;\n"
+    "    while j < 10000 do\n"
+    "    begin\n"
+    "      n := n + 1;\n"
+    "      j := j + 1;\n"
+    "    end;\n"
+    "    i := i + 1;\n"
+    "  end;\n"
+    "end.";
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+class CancellationTest : public ::testing::Test {
+protected:
+    std::ostringstream diagnostics;
+    std::shared_ptr<ErrorReporter> reporter = std::make_shared<ErrorReporter>(diagnostics);
+    std::shared_ptr<MemoryOutputSink> output = std::make_shared<MemoryOutputSink>();
+    Interpreter interpreter{ reporter, output };
+
+    std::shared_ptr<ASTNode> parse(const std::string& source) {
+        Lexer lexer(source, reporter, interpreter.getNames());
+        Parser parser(lexer.tokenize(), reporter);
+        return parser.parse();
+    }
+};
+
+} // namespace
+
+TEST_F(CancellationTest, CancelFromAnotherThreadStopsPromptly) {
+    auto program = parse(RUNAWAY);
+    auto token = std::make_shared<CancellationToken>();
+    interpreter.setCancellationToken(token);
+
+    Clock::time_point cancelledAt;
+    std::thread canceller([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        cancelledAt = Clock::now();
+        token->cancel();
+    });
+    InterruptReason reason = InterruptReason::DeadlineExceeded;
+    try {
+        interpreter.run(program);
+        ADD_FAILURE() << "run() finished without interruption";
+    } catch (const ExecutionInterrupted& e) {
+        reason = e.getReason();
+    }
+    canceller.join();
+
+    EXPECT_EQ(InterruptReason::Cancelled, reason);
+    EXPECT_LT(millisecondsSince(cancelledAt), 100.0);
+}
+
+TEST_F(CancellationTest, DeadlineStopsRunawayProgramNearTheLimit) {
+    auto program = parse(RUNAWAY);
+    auto start = Clock::now();
+    interpreter.setDeadline(start + std::chrono::milliseconds(50));
+
+    try {
+        interpreter.run(program);
+        ADD_FAILURE() << "run() finished without interruption";
+    } catch (const ExecutionInterrupted& e) {
+        EXPECT_EQ(InterruptReason::DeadlineExceeded, e.getReason());
+    }
+    double elapsed = millisecondsSince(start);
+    EXPECT_GE(elapsed, 50.0);
+    EXPECT_LT(elapsed, 150.0);
+}
+
+TEST_F(CancellationTest, StateRemainsInspectableAfterInterruption) {
+    auto program = parse(RUNAWAY);
+    interpreter.setDeadline(Clock::now() + std::chrono::milliseconds(10));
+
+    EXPECT_THROW(interpreter.run(program), ExecutionInterrupted);
+
+    // The interruption is reported as a distinct diagnostic, and the variables keep their values
+    EXPECT_NE(std::string::npos, diagnostics.str().find("истёк срок выполнения")) << diagnostics.str();
+    int n = interpreter.getVariable("n").intValue;
+    int i = interpreter.getVariable("i").intValue;
+    EXPECT_GT(n, 0);
+    EXPECT_LT(i, 10000);
+    EXPECT_GE(n, i * 10000 - 10000);
+    EXPECT_LE(n, i * 10000 + 10000);
+}
+
+TEST_F(CancellationTest, ResetTokenAllowsTheNextRun) {
+    auto program = parse(
+        "program Short;\n"
+        "var x: Integer;\n"
+        "begin\n"
+        "  x := 42;\n"
+        "  writeln(x);\n"
+        "end.");
+    auto token = std::make_shared<CancellationToken>();
+    interpreter.setCancellationToken(token);
+
+    token->cancel();
+    EXPECT_THROW(interpreter.run(program), ExecutionInterrupted);
+    EXPECT_EQ("", output->str());
+
+    token->reset();
+    EXPECT_NO_THROW(interpreter.run(program));
+    EXPECT_EQ("42\n", output->str());
+    EXPECT_EQ(42, interpreter.getVariable("x").intValue);
+}
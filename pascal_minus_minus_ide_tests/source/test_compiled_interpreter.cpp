@@ -0,0 +1,228 @@
+#include <gtest.h>
+#include "compiled_interpreter.h"
+#include "interpreter.h"
+#include "parser.h"
+#include "lexer.h"
+#include <iostream>
+#include <memory>
+#include <sstream>
+
+// Records messages instead of printing them, so both engines can be compared
+class RecordingReporter : public IErrorReporter {
+public:
+    std::vector<std::string> messages;
+
+    void reportError(const std::string& message, int, int) override { messages.push_back("E:" + message); }
+    void reportWarning(const std::string& message, int, int) override { messages.push_back("W:" + message); }
+    bool hasErrors() const override {
+        for (const auto& m : messages)
+            if (m.rfind("E:", 0) == 0)
+                return true;
+        return false;
+    }
+};
+
+struct RunResult {
+    std::map<std::string, Value> symbols;
+    std::string output;
+    std::vector<std::string> messages;
+    bool threw = false;
+};
+
+class CompiledInterpreterTest : public ::testing::Test {
+protected:
+    static std::shared_ptr<ASTNode> parse(const std::string& source, const std::shared_ptr<NameTable>& names) {
+        Lexer lexer(source, nullptr, names);
+        Parser parser(lexer.tokenize());
+        return parser.parse();
+    }
+
+    static RunResult runWith(IInterpreter& interpreter, RecordingReporter& reporter, const std::shared_ptr<ASTNode>& ast) {
+        RunResult result;
+        std::ostringstream captured;
+        std::streambuf* old = std::cout.rdbuf(captured.rdbuf());
+        try {
+            interpreter.run(ast);
+        } catch (const std::exception&) {
+            result.threw = true;
+        }
+        std::cout.rdbuf(old);
+        result.output = captured.str();
+        result.symbols = interpreter.getAllSymbols();
+        result.messages = reporter.messages;
+        return result;
+    }
+
+    // Runs the program with both engines and checks they behave identically
+    static RunResult expectSameBehaviour(const std::string& source) {
+        auto names = std::make_shared<NameTable>();
+        auto ast = parse(source, names);
+        auto treeReporter = std::make_shared<RecordingReporter>();
+        auto compiledReporter = std::make_shared<RecordingReporter>();
+        // CompiledInterpreter writes to std::cout, so the tree-walker is given the same stream
+        Interpreter tree(treeReporter, std::make_shared<StreamOutputSink>(std::cout));
+        tree.setNames(names);
+        CompiledInterpreter compiled(compiledReporter);
+        compiled.setNames(names);
+
+        RunResult expected = runWith(tree, *treeReporter, ast);
+        RunResult actual = runWith(compiled, *compiledReporter, ast);
+
+        EXPECT_EQ(expected.output, actual.output);
+        EXPECT_EQ(expected.messages, actual.messages);
+        EXPECT_EQ(expected.threw, actual.threw);
+        EXPECT_EQ(expected.symbols.size(), actual.symbols.size());
+        for (const auto& entry : expected.symbols) {
+            auto it = actual.symbols.find(entry.first);
+            if (it == actual.symbols.end()) {
+                ADD_FAILURE() << "missing symbol " << entry.first;
+                continue;
+            }
+            EXPECT_EQ(entry.second.type, it->second.type) << entry.first;
+            EXPECT_EQ(entry.second.toString(), it->second.toString()) << entry.first;
+        }
+        return actual;
+    }
+};
+
+TEST_F(CompiledInterpreterTest, ArithmeticMatchesInterpreter) {
+    RunResult result = expectSameBehaviour(
+        "program Test;\n"
+        "var a, b, c: integer; x, y: real; f: boolean;\n"
+        "begin\n"
+        "  a := 17; b := 5;\n"
+        "  c := a div b + a mod b * 2 - -a;\n"
+        "  x := a / b;\n"
+        "  y := x * 2 + c;\n"
+        "  f := (a > b) and not (x = y) or false;\n"
+        "  writeln(a, b, c, x, y, f);\n"
+        "end.");
+    EXPECT_EQ(24, result.symbols["c"].intValue);
+}
+
+TEST_F(CompiledInterpreterTest, LoopsMatchInterpreter) {
+    RunResult result = expectSameBehaviour(
+        "program Test;\n"
+        "var i, j, sum, n: integer;\n"
+        "begin\n"
+        "  sum := 0;\n"
+        "  for i := 1 to 10 do\n"
+        "    for j := 10 downto i do\n"
+        "      if (i + j) mod 3 = 0 then sum := sum + i * j else sum := sum - 1;\n"
+        "  n := 0;\n"
+        "  while n < 25 do begin n := n + 2; write(n) end;\n"
+        "  writeln(sum);\n"
+        "end.");
+    EXPECT_EQ(26, result.symbols["n"].intValue);
+}
+
+TEST_F(CompiledInterpreterTest, ForLoopVariableIsScoped) {
+    RunResult result = expectSameBehaviour(
+        "program Test;\n"
+        "var i, last: integer;\n"
+        "begin\n"
+        "  i := 100;\n"
+        "  for i := 1 to 3 do last := i;\n"
+        "end.");
+    EXPECT_EQ(100, result.symbols["i"].intValue);
+    EXPECT_EQ(3, result.symbols["last"].intValue);
+}
+
+TEST_F(CompiledInterpreterTest, AssignmentConvertsToVariableType) {
+    RunResult result = expectSameBehaviour(
+        "program Test;\n"
+        "var i: integer; r: real; b: boolean; s: string;\n"
+        "begin\n"
+        "  i := 7 / 2;\n"
+        "  r := 3;\n"
+        "  b := 1;\n"
+        "  s := r * 2;\n"
+        "end.");
+    EXPECT_EQ(3, result.symbols["i"].intValue);
+    EXPECT_EQ("6", result.symbols["s"].stringValue);
+}
+
+TEST_F(CompiledInterpreterTest, RuntimeErrorsMatchInterpreter) {
+    RunResult result = expectSameBehaviour(
+        "program Test;\n"
+        "var a, b: integer; f: boolean;\n"
+        "begin\n"
+        "  b := 0;\n"
+        "  a := 10 div b;\n"
+        "  f := a < true;\n"
+        "  if a div b = 1 then a := 1;\n"
+        "  writeln(a mod b, 1);\n"
+        "  c := 1;\n"
+        "end.");
+    EXPECT_TRUE(result.threw); // Assignment to an undeclared variable is fatal
+    EXPECT_FALSE(result.messages.empty());
+}
+
+TEST_F(CompiledInterpreterTest, IterationLimitMatchesInterpreter) {
+    RunResult result = expectSameBehaviour(
+        "program Test;\n"
+        "var n: integer;\n"
+        "begin\n"
+        "  n := 0;\n"
+        "  while true do n := n + 1;\n"
+        "end.");
+    EXPECT_EQ(10001, result.symbols["n"].intValue);
+}
+
+TEST_F(CompiledInterpreterTest, CompileOnceExecuteMany) {
+    CompiledInterpreter interpreter;
+    auto program = interpreter.compile(parse(
+        "program Test;\n"
+        "var total, i: integer;\n"
+        "begin\n"
+        "  total := 0;\n"
+        "  for i := 1 to 100 do total := total + i;\n"
+        "end.", interpreter.getNames()));
+
+    interpreter.execute(*program);
+    EXPECT_EQ(5050, interpreter.getVariable("total").intValue);
+    interpreter.setVariable("total", Value(1));
+    interpreter.execute(*program);
+    EXPECT_EQ(5050, interpreter.getVariable("total").intValue);
+}
+
+TEST_F(CompiledInterpreterTest, HostVariablesAreVisibleToProgram) {
+    CompiledInterpreter interpreter;
+    interpreter.setVariable("limit", Value(4));
+    interpreter.run(parse(
+        "program Test;\n"
+        "var f, k: integer;\n"
+        "begin\n"
+        "  f := 1;\n"
+        "  for k := 2 to limit do f := f * k;\n"
+        "end.", interpreter.getNames()));
+
+    EXPECT_EQ(24, interpreter.getVariable("f").intValue);
+    EXPECT_TRUE(interpreter.isDeclared("limit"));
+    EXPECT_TRUE(interpreter.isDeclared("k"));
+    EXPECT_FALSE(interpreter.isDeclared("unused"));
+    EXPECT_EQ(3u, interpreter.getAllSymbols().size());
+
+    interpreter.clearSymbols();
+    EXPECT_FALSE(interpreter.isDeclared("f"));
+    EXPECT_THROW(interpreter.getVariable("f"), std::runtime_error);
+}
+
+TEST_F(CompiledInterpreterTest, StringLiteralsEvaluateToStrings) {
+    CompiledInterpreter interpreter;
+    std::ostringstream captured;
+    std::streambuf* old = std::cout.rdbuf(captured.rdbuf());
+    interpreter.run(parse(
+        "program Test;\n"
+        "var s: string; same: boolean;\n"
+        "begin\n"
+        "  s := 'abc';\n"
+        "  same := s = 'abc';\n"
+        "  writeln('s is', s);\n"
+        "end.", interpreter.getNames()));
+    std::cout.rdbuf(old);
+
+    EXPECT_EQ("abc", interpreter.getVariable("s").stringValue);
+    EXPECT_TRUE(interpreter.getVariable("same").boolValue);
+    EXPECT_EQ("s is abc\n", captured.str());
+}
@@ -0,0 +1,176 @@
+#include <gtest.h>
+#include "compiled_program.h"
+#include "parser.h"
+#include "lexer.h"
+#include "error_reporter.h"
+#include <sstream>
+#include <thread>
+
+namespace {
+
+// Counts flushes of the stream it backs
+class CountingBuffer : public std::stringbuf {
+public:
+    int syncs = 0;
+protected:
+    int sync() override {
+        ++syncs;
+        return std::stringbuf::sync();
+    }
+};
+
+} // namespace
+
+class CompiledProgramTest : public ::testing::Test {
+protected:
+    static std::shared_ptr<const CompiledProgram> compile(const std::string& source,
+        const std::map<std::string, Value>& inputs = {}) {
+        Lexer lexer(source);
+        Parser parser(lexer.tokenize());
+        return CompiledProgram::compile(parser.parse(), lexer.getNames(), inputs);
+    }
+};
+
+TEST_F(CompiledProgramTest, ContextsAreIndependent) {
+    auto program = compile(
+        "program Test;\n"
+        "var total: integer;\n"
+        "begin\n"
+        "  total := n * 2;\n"
+        "end.",
+        { { "n", Value(0) } });
+
+    ExecutionContext first(*program);
+    ExecutionContext second(*program);
+    first.setVariable("n", Value(5));
+    program->run(first);
+    program->run(second);
+
+    EXPECT_EQ(10, first.getVariable("total").intValue);
+    EXPECT_EQ(0, second.getVariable("total").intValue);
+    EXPECT_EQ(0, second.getVariable("n").intValue);
+}
+
+TEST_F(CompiledProgramTest, RunsConcurrentlyFromSharedProgram) {
+    auto program = compile(
+        "program Test;\n"
+        "var i, sum: integer;\n"
+        "begin\n"
+        "  sum := 0;\n"
+        "  for i := 1 to n do sum := sum + i;\n"
+        "  writeln(sum);\n"
+        "end.",
+        { { "n", Value(0) } });
+
+    const int THREADS = 8;
+    std::vector<std::string> outputs(THREADS);
+    std::vector<int> sums(THREADS);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int repeat = 0; repeat < 50; ++repeat) {
+                std::istringstream in;
+                std::ostringstream out;
+                ExecutionContext context(*program, in, out);
+                context.setVariable("n", Value(100 + t));
+                program->run(context);
+                outputs[t] = out.str();
+                sums[t] = context.getVariable("sum").intValue;
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    for (int t = 0; t < THREADS; ++t) {
+        int n = 100 + t;
+        EXPECT_EQ(n * (n + 1) / 2, sums[t]);
+        EXPECT_EQ(std::to_string(n * (n + 1) / 2) + "\n", outputs[t]);
+    }
+}
+
+TEST_F(CompiledProgramTest, ReadsFromContextInput) {
+    auto program = compile(
+        "program Test;\n"
+        "var a, b: integer;\n"
+        "begin\n"
+        "  read(a);\n"
+        "  read(b);\n"
+        "  writeln(a + b);\n"
+        "end.");
+
+    std::istringstream in("3\n4\n");
+    std::ostringstream out;
+    ExecutionContext context(*program, in, out);
+    program->run(context);
+
+    EXPECT_EQ("7\n", out.str());
+}
+
+TEST_F(CompiledProgramTest, SetVariableConvertsToDeclaredType) {
+    auto program = compile(
+        "program Test;\n"
+        "var r: real;\n"
+        "begin\n"
+        "end.",
+        { { "k", Value(0) } });
+
+    ExecutionContext context(*program);
+    context.setVariable("k", Value(2.9));
+    context.setVariable("r", Value(3));
+
+    EXPECT_EQ(ValueType::Integer, context.getVariable("k").type);
+    EXPECT_EQ(2, context.getVariable("k").intValue);
+    EXPECT_EQ(ValueType::Real, context.getVariable("r").type);
+    EXPECT_DOUBLE_EQ(3.0, context.getVariable("r").realValue);
+}
+
+TEST_F(CompiledProgramTest, UnknownVariablesAreRejected) {
+    auto program = compile(
+        "program Test;\n"
+        "var a: integer;\n"
+        "begin\n"
+        "end.");
+
+    ExecutionContext context(*program);
+    EXPECT_FALSE(context.isDeclared("a"));
+    EXPECT_THROW(context.getVariable("a"), std::runtime_error);
+    EXPECT_THROW(context.setVariable("missing", Value(1)), std::runtime_error);
+
+    auto other = compile("program Other;\nbegin\nend.");
+    EXPECT_THROW(other->run(context), std::runtime_error);
+}
+
+TEST_F(CompiledProgramTest, UnknownStatementIsReportedToErrorReporter) {
+    auto root = std::make_shared<ASTNode>(ASTNodeType::Program);
+    root->children.push_back(std::make_shared<ASTNode>(ASTNodeType::Expression));
+    auto program = CompiledProgram::compile(root, std::make_shared<NameTable>());
+
+    std::ostringstream diagnostics;
+    auto reporter = std::make_shared<ErrorReporter>(diagnostics);
+    std::istringstream in;
+    std::ostringstream out;
+    ExecutionContext context(*program, in, out, reporter);
+
+    EXPECT_THROW(program->run(context), std::runtime_error);
+    EXPECT_TRUE(reporter->hasErrors());
+}
+
+TEST_F(CompiledProgramTest, WritelnDoesNotFlushEveryLine) {
+    auto program = compile(
+        "program Test;\n"
+        "var i: integer;\n"
+        "begin\n"
+        "  for i := 1 to 3 do\n"
+        "    writeln(i);\n"
+        "end.");
+
+    CountingBuffer buffer;
+    std::ostream out(&buffer);
+    std::istringstream in;
+    ExecutionContext context(*program, in, out);
+    program->run(context);
+
+    EXPECT_EQ("1\n2\n3\n", buffer.str());
+    EXPECT_EQ(1, buffer.syncs);
+}
@@ -0,0 +1,95 @@
+#include <gtest.h>
+#include "coroutine.h"
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Recursion keeps frames alive across the yields
+void countDown(std::vector<int>& trace, int depth) {
+    trace.push_back(depth);
+    Coroutine::yield();
+    if (depth > 0)
+        countDown(trace, depth - 1);
+}
+
+} // namespace
+
+TEST(CoroutineTest, YieldsAndResumesFromNestedCalls) {
+    std::vector<int> trace;
+    Coroutine coroutine([&]() { countDown(trace, 3); });
+    EXPECT_TRUE(trace.empty());
+
+    for (int step = 0; step < 4; ++step) {
+        EXPECT_FALSE(coroutine.resume());
+        EXPECT_EQ(step + 1u, trace.size());
+        EXPECT_EQ(3 - step, trace.back());
+    }
+    EXPECT_TRUE(coroutine.resume());
+    EXPECT_TRUE(coroutine.finished());
+    EXPECT_TRUE(coroutine.resume());
+}
+
+TEST(CoroutineTest, CurrentAndYieldOutsideCoroutine) {
+    EXPECT_EQ(nullptr, Coroutine::current());
+    Coroutine::yield();  // No-op outside a coroutine
+
+    Coroutine* seen = nullptr;
+    Coroutine coroutine([&]() { seen = Coroutine::current(); });
+    coroutine.resume();
+    EXPECT_EQ(&coroutine, seen);
+    EXPECT_EQ(nullptr, Coroutine::current());
+}
+
+TEST(CoroutineTest, ExceptionPropagatesToResume) {
+    Coroutine coroutine([]() {
+        Coroutine::yield();
+        throw std::runtime_error("boom");
+    });
+    EXPECT_FALSE(coroutine.resume());
+    EXPECT_THROW(coroutine.resume(), std::runtime_error);
+    EXPECT_TRUE(coroutine.finished());
+}
+
+TEST(CoroutineTest, DestroyingSuspendedCoroutineUnwindsStack) {
+    auto resource = std::make_shared<int>(1);
+    bool caughtByStdHandler = false;
+    {
+        Coroutine coroutine([&]() {
+            std::shared_ptr<int> held = resource;
+            try {
+                for (;;)
+                    Coroutine::yield();
+            } catch (const std::exception&) {
+                caughtByStdHandler = true;
+            }
+        });
+        coroutine.resume();
+        EXPECT_EQ(2, resource.use_count());
+    }
+    EXPECT_EQ(1, resource.use_count());
+    EXPECT_FALSE(caughtByStdHandler);
+}
+
+TEST(CoroutineTest, NestedCoroutines) {
+    std::string trace;
+    Coroutine inner([&]() {
+        trace += "i1";
+        Coroutine::yield();
+        trace += "i2";
+    });
+    Coroutine outer([&]() {
+        trace += "o1";
+        inner.resume();
+        trace += "o2";
+        Coroutine::yield();
+        inner.resume();
+        trace += "o3";
+    });
+    EXPECT_FALSE(outer.resume());
+    EXPECT_TRUE(outer.resume());
+    EXPECT_TRUE(inner.finished());
+    EXPECT_EQ("o1i1o2i2o3", trace);
+}
@@ -0,0 +1,136 @@
+#include <gtest.h>
+#include "error_reporter.h"
+#include "interpreter.h"
+#include "parser.h"
+#include "lexer.h"
+#include <memory>
+#include <sstream>
+
+namespace {
+
+// Counts write calls that reach the stream buffer
+class CountingBuffer : public std::stringbuf {
+public:
+    int writes = 0;
+
+protected:
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        ++writes;
+        return std::stringbuf::xsputn(s, n);
+    }
+};
+
+size_t countOccurrences(const std::string& text, const std::string& needle) {
+    size_t count = 0;
+    for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1))
+        ++count;
+    return count;
+}
+
+} // namespace
+
+TEST(ErrorReporterTest, CountsErrorsAndWarnings) {
+    std::ostringstream out;
+    ErrorReporter reporter(out);
+    EXPECT_FALSE(reporter.hasErrors());
+    EXPECT_FALSE(reporter.hasWarnings());
+
+    reporter.reportWarning("w", 1, 1);
+    EXPECT_FALSE(reporter.hasErrors());
+    EXPECT_TRUE(reporter.hasWarnings());
+
+    reporter.reportError("e", 2, 3);
+    reporter.reportError("e", 2, 3);
+    EXPECT_TRUE(reporter.hasErrors());
+    EXPECT_EQ(2u, reporter.getErrorCount());
+    EXPECT_EQ(1u, reporter.getWarningCount());
+
+    reporter.clear();
+    EXPECT_FALSE(reporter.hasErrors());
+    EXPECT_FALSE(reporter.hasWarnings());
+    EXPECT_TRUE(reporter.getMessages().empty());
+}
+
+TEST(ErrorReporterTest, DeduplicatesIdenticalMessages) {
+    std::ostringstream out;
+    ErrorReporter reporter(out);
+    for (int i = 0; i < 100; ++i)
+        reporter.reportWarning("loop", 4, 2);
+    reporter.reportWarning("loop", 5, 2);   // Other line
+    reporter.reportError("loop", 4, 2);     // Other level
+
+    const auto& messages = reporter.getMessages();
+    ASSERT_EQ(3u, messages.size());
+    EXPECT_EQ(100u, messages[0].count);
+    EXPECT_EQ(1u, messages[1].count);
+    EXPECT_EQ(ErrorReporter::Message::Level::Error, messages[2].level);
+    EXPECT_EQ(101u, reporter.getWarningCount());
+}
+
+TEST(ErrorReporterTest, CapsStoredMessages) {
+    std::ostringstream out;
+    ErrorReporter reporter(out, 3);
+    for (int i = 0; i < 10; ++i)
+        reporter.reportError("error " + std::to_string(i), i);
+    reporter.reportError("error 0", 0);     // Repeat of a stored message is still counted
+
+    EXPECT_EQ(3u, reporter.getMessages().size());
+    EXPECT_EQ(2u, reporter.getMessages()[0].count);
+    EXPECT_EQ(7u, reporter.getSuppressedCount());
+    EXPECT_EQ(11u, reporter.getErrorCount());
+
+    reporter.flush();
+    EXPECT_NE(std::string::npos, out.str().find(": 7"));
+}
+
+TEST(ErrorReporterTest, WritesOnceOnFlush) {
+    CountingBuffer buffer;
+    std::ostream out(&buffer);
+    ErrorReporter reporter(out);
+    reporter.reportError("first", 1, 1);
+    reporter.reportWarning("second");
+    reporter.reportError("first", 1, 1);
+    EXPECT_EQ(0, buffer.writes);
+
+    reporter.flush();
+    EXPECT_EQ(1, buffer.writes);
+    std::string text = buffer.str();
+    EXPECT_NE(std::string::npos, text.find("Ошибка [Строка 1] [Позиция 1]: first (повторений: 2)"));
+    EXPECT_NE(std::string::npos, text.find("Предупреждение: second"));
+
+    // Nothing new: no output
+    reporter.flush();
+    EXPECT_EQ(1, buffer.writes);
+
+    // A later repeat is reported as a delta, not as a new message
+    reporter.reportError("first", 1, 1);
+    reporter.flush();
+    EXPECT_EQ(2, buffer.writes);
+    EXPECT_EQ(1u, countOccurrences(buffer.str(), "(ещё повторений: 1)"));
+}
+
+TEST(ErrorReporterTest, RepeatedLoopWarningIsStoredOnce) {
+    std::ostringstream out;
+    auto reporter = std::make_shared<ErrorReporter>(out);
+    Lexer lexer(
+        "program Test;\n"
+        "var i, j: Integer;\n"
+        "var r: Real;\n"
+        "begin\n"
+        "  r := 1.5;\n"
+        "  for i := 1 to 50 do\n"
+        "    for j := r to 2 do\n"
+        "      r := 1.5;\n"
+        "end.", reporter);
+    Parser parser(lexer.tokenize(), reporter);
+    Interpreter interpreter(reporter);
+    interpreter.setNames(lexer.getNames());
+    interpreter.run(parser.parse());
+
+    EXPECT_EQ(50u, reporter->getWarningCount());
+    ASSERT_EQ(1u, reporter->getMessages().size());
+    EXPECT_EQ(50u, reporter->getMessages()[0].count);
+    // run() flushed the reporter: one line for all 50 warnings
+    EXPECT_EQ(1u, countOccurrences(out.str(), "Предупреждение"));
+    EXPECT_NE(std::string::npos, out.str().find("(повторений: 50)"));
+}
@@ -0,0 +1,109 @@
+#include <gtest.h>
+#include "fork_server.h"
+#include <stdexcept>
+#include <string>
+
+#ifndef _WIN32
+
+namespace {
+
+std::string sumProgram(int factor) {
+    return
+        "program Sum;\n"
+        "var i, n, total: Integer;\n"
+        "begin\n"
+        "  read(n);\n"
+        "  total := 0;\n"
+        "  for i := 1 to n do\n"
+        "    total := total + i * " + std::to_string(factor) + ";\n"
+        "  writeln(total);\n"
+        "end.";
+}
+
+// Deep enough nesting to overflow the recursive descent parser's stack
+std::string crashingProgram() {
+    const int depth = 1000000;
+    return "program Crash;\nvar x: Integer;\nbegin\n  x := " + std::string(depth, '(') + "1" +
+           std::string(depth, ')') + ";\nend.";
+}
+
+// Each loop stays under the iteration cap, but together they run for hours
+const char* SLOW_PROGRAM =
+    "program Slow;\n"
+    "var i, j, k, s: Integer;\n"
+    "begin\n"
+    "  s := 0;\n"
+    "  for i := 1 to 10000 do\n"
+    "    for j := 1 to 10000 do\n"
+    "      for k := 1 to 10000 do\n"
+    "        s := s + 1;\n"
+    "  writeln(s);\n"
+    "end.";
+
+} // namespace
+
+TEST(ForkServerTest, PreloadedProgramRunsWithEachInput) {
+    ForkServer server;
+    EXPECT_FALSE(server.hasProgram());
+    server.preload(sumProgram(2));
+    ASSERT_TRUE(server.hasProgram());
+
+    for (int n = 1; n <= 10; ++n) {
+        ForkResult response = server.run(std::to_string(n));
+        EXPECT_TRUE(response.result.success) << response.result.error;
+        EXPECT_EQ(std::to_string(n * (n + 1)) + "\n", response.result.output);
+        EXPECT_GE(response.startupSeconds, 0.0);
+        EXPECT_GE(response.totalSeconds, response.startupSeconds);
+    }
+}
+
+TEST(ForkServerTest, RunsJobSourceInChild) {
+    ForkServer server;
+    ForkResult response = server.run(BatchJob{ "job", sumProgram(3), "4" });
+    EXPECT_EQ("job", response.result.name);
+    EXPECT_TRUE(response.result.success) << response.result.error;
+    EXPECT_EQ("30\n", response.result.output);
+
+    response = server.run(BatchJob{ "broken", "program B;\nbegin\n  y := 1;\nend.", "" });
+    EXPECT_FALSE(response.result.success);
+    EXPECT_FALSE(response.result.diagnostics.empty() && response.result.error.empty());
+}
+
+TEST(ForkServerTest, CrashedChildIsReported) {
+    ForkServer server;
+    ForkResult response = server.run(BatchJob{ "crash", crashingProgram(), "" });
+    EXPECT_FALSE(response.result.success);
+    EXPECT_NE(std::string::npos, response.result.error.find("Процесс")) << response.result.error;
+
+    // The server itself is unaffected
+    response = server.run(BatchJob{ "after", sumProgram(1), "3" });
+    EXPECT_TRUE(response.result.success);
+    EXPECT_EQ("6\n", response.result.output);
+}
+
+TEST(ForkServerTest, SlowChildIsKilledAtDeadline) {
+    ForkServer server(0.5);
+    ForkResult response = server.run(BatchJob{ "slow", SLOW_PROGRAM, "" });
+    EXPECT_FALSE(response.result.success);
+    EXPECT_NE(std::string::npos, response.result.error.find("ограничение времени")) << response.result.error;
+    EXPECT_LT(response.totalSeconds, 10.0);
+
+    server.preload(SLOW_PROGRAM);
+    response = server.run(std::string());
+    EXPECT_FALSE(response.result.success);
+    EXPECT_NE(std::string::npos, response.result.error.find("ограничение времени")) << response.result.error;
+
+    // A fast request still completes within the limit
+    response = server.run(BatchJob{ "fast", sumProgram(1), "3" });
+    EXPECT_TRUE(response.result.success) << response.result.error;
+    EXPECT_EQ("6\n", response.result.output);
+}
+
+TEST(ForkServerTest, PreloadRejectsInvalidProgram) {
+    ForkServer server;
+    EXPECT_THROW(server.preload("program B;\nbegin\n  x := ;\nend."), std::runtime_error);
+    EXPECT_FALSE(server.hasProgram());
+    EXPECT_THROW(server.run(std::string("1")), std::runtime_error);
+}
+
+#endif
@@ -0,0 +1,152 @@
+#include <gtest.h>
+#include "green_scheduler.h"
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string sumProgram(int factor) {
+    return
+        "program Sum;\n"
+        "var i, n, total: Integer;\n"
+        "begin\n"
+        "  read(n);\n"
+        "  total := 0;\n"
+        "  for i := 1 to n do\n"
+        "    total := total + i * " + std::to_string(factor) + ";\n"
+        "  writeln(total);\n"
+        "end.";
+}
+
+// Reads a count, then runs a long loop: 'rounds' outer iterations of 1000 back-edges each
+std::string busyProgram() {
+    return
+        "program Busy;\n"
+        "var i, j, rounds, total: Integer;\n"
+        "begin\n"
+        "  read(rounds);\n"
+        "  total := 0;\n"
+        "  for i := 1 to rounds do\n"
+        "    for j := 1 to 1000 do\n"
+        "      total := total + 1;\n"
+        "  writeln(total);\n"
+        "end.";
+}
+
+} // namespace
+
+TEST(GreenSchedulerTest, RunsManyProgramsOnOneThread) {
+    GreenSchedulerOptions options;
+    options.threads = 1;
+    options.sliceBackEdges = 50;
+    GreenScheduler scheduler(options);
+    EXPECT_EQ(1u, scheduler.threadCount());
+
+    std::vector<GreenScheduler::TaskId> ids;
+    for (int k = 0; k < 1000; ++k)
+        ids.push_back(scheduler.spawn({ "job" + std::to_string(k), sumProgram(k), std::to_string(k % 300 + 1) }));
+    scheduler.wait();
+
+    EXPECT_EQ(1000u, scheduler.taskCount());
+    for (int k = 0; k < 1000; ++k) {
+        GreenTaskInfo info = scheduler.info(ids[k]);
+        int n = k % 300 + 1;
+        ASSERT_EQ(GreenTaskState::Finished, info.state);
+        EXPECT_TRUE(info.result.success) << info.result.error;
+        EXPECT_EQ("job" + std::to_string(k), info.result.name);
+        EXPECT_EQ(std::to_string(k * n * (n + 1) / 2) + "\n", info.result.output);
+        EXPECT_EQ(static_cast<std::size_t>(n / 50 + 1), info.slices);
+    }
+}
+
+TEST(GreenSchedulerTest, WaitingTaskResumesOnInput) {
+    GreenScheduler scheduler;
+    GreenScheduler::TaskId id = scheduler.spawn({ "interactive", sumProgram(1), "" }, 0, true);
+    scheduler.wait();
+    GreenTaskInfo info = scheduler.info(id);
+    EXPECT_EQ(GreenTaskState::WaitingInput, info.state);
+    EXPECT_EQ(1u, info.inputWaits);
+
+    scheduler.provideInput(id, "1");    // No delimiter yet: the number may continue
+    scheduler.wait();
+    EXPECT_EQ(GreenTaskState::WaitingInput, scheduler.info(id).state);
+
+    scheduler.provideInput(id, "0\n");
+    scheduler.wait();
+    info = scheduler.info(id);
+    EXPECT_EQ(GreenTaskState::Finished, info.state);
+    EXPECT_EQ("55\n", info.result.output);
+    EXPECT_EQ(2u, info.inputWaits);
+}
+
+TEST(GreenSchedulerTest, ClosedInputEndsRead) {
+    GreenScheduler scheduler;
+    GreenScheduler::TaskId id = scheduler.spawn({ "eof", sumProgram(1), "" }, 0, true);
+    scheduler.wait();
+    scheduler.closeInput(id);
+    scheduler.wait();
+    GreenTaskInfo info = scheduler.info(id);
+    EXPECT_EQ(GreenTaskState::Finished, info.state);
+    EXPECT_FALSE(info.result.success);
+}
+
+TEST(GreenSchedulerTest, RoundRobinInterleavesSlices) {
+    GreenSchedulerOptions options;
+    options.sliceBackEdges = 100;
+    GreenScheduler scheduler(options);
+    GreenScheduler::TaskId first = scheduler.spawn({ "first", busyProgram(), "" }, 0, true);
+    GreenScheduler::TaskId second = scheduler.spawn({ "second", busyProgram(), "" }, 0, true);
+    scheduler.wait();
+    scheduler.provideInput(first, "50\n");
+    scheduler.provideInput(second, "50\n");
+    scheduler.wait();
+
+    GreenTaskInfo a = scheduler.info(first);
+    GreenTaskInfo b = scheduler.info(second);
+    EXPECT_EQ("50000\n", a.result.output);
+    EXPECT_EQ("50000\n", b.result.output);
+    // Each task's slices are spread over the other's
+    EXPECT_GT(a.lastSlice - a.firstSlice + 1, a.slices);
+    EXPECT_GT(b.lastSlice - b.firstSlice + 1, b.slices);
+    EXPECT_LT(a.firstSlice, b.lastSlice);
+    EXPECT_LT(b.firstSlice, a.lastSlice);
+}
+
+TEST(GreenSchedulerTest, PriorityRunsHigherPriorityFirst) {
+    GreenSchedulerOptions options;
+    options.sliceBackEdges = 100;
+    options.policy = SchedulingPolicy::Priority;
+    GreenScheduler scheduler(options);
+    GreenScheduler::TaskId low = scheduler.spawn({ "low", busyProgram(), "50" }, 1);
+    GreenScheduler::TaskId high = scheduler.spawn({ "high", busyProgram(), "20" }, 5);
+    scheduler.wait();
+
+    GreenTaskInfo lowInfo = scheduler.info(low);
+    GreenTaskInfo highInfo = scheduler.info(high);
+    EXPECT_EQ("50000\n", lowInfo.result.output);
+    EXPECT_EQ("20000\n", highInfo.result.output);
+    // Once ready, the high-priority task keeps the thread until it finishes
+    EXPECT_EQ(highInfo.lastSlice - highInfo.firstSlice + 1, highInfo.slices);
+    EXPECT_GT(lowInfo.lastSlice, highInfo.lastSlice);
+}
+
+TEST(GreenSchedulerTest, ParseErrorFinishesTask) {
+    GreenScheduler scheduler;
+    GreenScheduler::TaskId id = scheduler.spawn({ "broken", "program B;\nbegin\n  x := ;\nend.", "" });
+    scheduler.wait();
+    GreenTaskInfo info = scheduler.info(id);
+    EXPECT_EQ(GreenTaskState::Finished, info.state);
+    EXPECT_FALSE(info.result.success);
+    EXPECT_THROW(scheduler.info(id + 1), std::out_of_range);
+}
+
+TEST(GreenSchedulerTest, DestroyingSchedulerAbandonsWaitingTasks) {
+    GreenSchedulerOptions options;
+    options.threads = 3;
+    GreenScheduler scheduler(options);
+    for (int k = 0; k < 30; ++k)
+        scheduler.spawn({ "waiting" + std::to_string(k), busyProgram(), "" }, 0, true);
+    scheduler.wait();
+    for (int k = 0; k < 30; ++k)
+        EXPECT_EQ(GreenTaskState::WaitingInput, scheduler.info(k).state);
+}
@@ -0,0 +1,219 @@
+#include <gtest.h>
+#include "input_source.h"
+#include "interpreter.h"
+#include "parser.h"
+#include "lexer.h"
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <unistd.h>
+#endif
+
+TEST(InputSourceTest, ReadsNumbersAcrossWhitespace) {
+    MemoryInputSource source("  42\t-7\r\n+13 \v\f 2147483647                    \t\t\n -2147483648");
+    int value = 0;
+    EXPECT_TRUE(source.readInt(value));
+    EXPECT_EQ(42, value);
+    EXPECT_TRUE(source.readInt(value));
+    EXPECT_EQ(-7, value);
+    EXPECT_TRUE(source.readInt(value));
+    EXPECT_EQ(13, value);
+    EXPECT_TRUE(source.readInt(value));
+    EXPECT_EQ(2147483647, value);
+    EXPECT_TRUE(source.readInt(value));
+    EXPECT_EQ(-2147483648LL, value);
+    EXPECT_FALSE(source.readInt(value));
+}
+
+TEST(InputSourceTest, FailedReadLeavesTokenInInput) {
+    MemoryInputSource source("abc 12xyz 99999999999 5");
+    int value = 1;
+    std::string word;
+    EXPECT_FALSE(source.readInt(value));
+    EXPECT_EQ(1, value);
+    EXPECT_TRUE(source.readWord(word));
+    EXPECT_EQ("abc", word);
+
+    EXPECT_TRUE(source.readInt(value));   // Digits are taken, the rest stays
+    EXPECT_EQ(12, value);
+    EXPECT_TRUE(source.readWord(word));
+    EXPECT_EQ("xyz", word);
+
+    EXPECT_FALSE(source.readInt(value));  // Overflow consumes the digits
+    EXPECT_TRUE(source.readInt(value));
+    EXPECT_EQ(5, value);
+}
+
+TEST(InputSourceTest, ReadsReals) {
+    MemoryInputSource source("1.5 -2e3 .25 +4 inf 7");
+    double value = 0;
+    EXPECT_TRUE(source.readReal(value));
+    EXPECT_DOUBLE_EQ(1.5, value);
+    EXPECT_TRUE(source.readReal(value));
+    EXPECT_DOUBLE_EQ(-2000.0, value);
+    EXPECT_TRUE(source.readReal(value));
+    EXPECT_DOUBLE_EQ(0.25, value);
+    EXPECT_TRUE(source.readReal(value));
+    EXPECT_DOUBLE_EQ(4.0, value);
+    EXPECT_FALSE(source.readReal(value));  // Not accepted by operator>> either
+    std::string word;
+    EXPECT_TRUE(source.readWord(word));
+    EXPECT_EQ("inf", word);
+    EXPECT_TRUE(source.readReal(value));
+    EXPECT_DOUBLE_EQ(7.0, value);
+}
+
+TEST(InputSourceTest, SkipLineDropsRestOfLine) {
+    MemoryInputSource source("1 2 3\n4\n\n5");
+    int value = 0;
+    EXPECT_TRUE(source.readInt(value));
+    source.skipLine();
+    EXPECT_TRUE(source.readInt(value));
+    EXPECT_EQ(4, value);
+    source.skipLine();
+    source.skipLine();
+    EXPECT_TRUE(source.readInt(value));
+    EXPECT_EQ(5, value);
+    source.skipLine();
+    EXPECT_FALSE(source.readInt(value));
+}
+
+TEST(InputSourceTest, TokensSpanRefills) {
+    // A tiny buffer forces refills in the middle of tokens and growth for long ones
+    std::istringstream stream("123456789 1 " + std::string(40, ' ') + "22 longer_than_buffer\n-5");
+    StreamInputSource source(stream, 4);
+    int value = 0;
+    std::string word;
+    EXPECT_TRUE(source.readInt(value));
+    EXPECT_EQ(123456789, value);
+    EXPECT_TRUE(source.readInt(value));
+    EXPECT_EQ(1, value);
+    EXPECT_TRUE(source.readInt(value));
+    EXPECT_EQ(22, value);
+    EXPECT_TRUE(source.readWord(word));
+    EXPECT_EQ("longer_than_buffer", word);
+    EXPECT_TRUE(source.readInt(value));
+    EXPECT_EQ(-5, value);
+    EXPECT_FALSE(source.readWord(word));
+}
+
+TEST(InputSourceTest, MatchesIstreamOnRandomInput) {
+    std::mt19937 random(7);
+    std::string text;
+    const char* separators[] = { " ", "\n", "\t", "   ", "\r\n", "                   " };
+    for (int i = 0; i < 5000; ++i) {
+        text += std::to_string(static_cast<int>(random()) / 3);
+        text += separators[random() % 6];
+    }
+
+    std::istringstream expected(text);
+    std::istringstream stream(text);
+    StreamInputSource source(stream, 64);
+    int a, b;
+    while (expected >> a) {
+        ASSERT_TRUE(source.readInt(b));
+        ASSERT_EQ(a, b);
+    }
+    EXPECT_FALSE(source.readInt(b));
+}
+
+TEST(InputSourceTest, FdSourceReadsDescriptor) {
+    int fds[2];
+#ifdef _WIN32
+    ASSERT_EQ(0, _pipe(fds, 4096, _O_BINARY));
+    ASSERT_EQ(8, _write(fds[1], "10 20\n30", 8));
+    _close(fds[1]);
+#else
+    ASSERT_EQ(0, pipe(fds));
+    ASSERT_EQ(8, write(fds[1], "10 20\n30", 8));
+    close(fds[1]);
+#endif
+    {
+        FdInputSource source(fds[0], 3);
+        int value = 0;
+        EXPECT_TRUE(source.readInt(value));
+        EXPECT_EQ(10, value);
+        source.skipLine();
+        EXPECT_TRUE(source.readInt(value));
+        EXPECT_EQ(30, value);
+        EXPECT_FALSE(source.readInt(value));
+    }
+#ifdef _WIN32
+    _close(fds[0]);
+#else
+    close(fds[0]);
+#endif
+}
+
+TEST(InputSourceTest, MappedFileSource) {
+    const char* path = "pmm_input_source_test.txt";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "3 true word\n";
+    }
+    {
+        MappedFileInputSource source(path);
+        int value = 0;
+        std::string word;
+        EXPECT_TRUE(source.readInt(value));
+        EXPECT_EQ(3, value);
+        EXPECT_TRUE(source.readWord(word));
+        EXPECT_EQ("true", word);
+        EXPECT_TRUE(source.readWord(word));
+        EXPECT_EQ("word", word);
+        EXPECT_FALSE(source.readWord(word));
+    }
+    std::remove(path);
+    EXPECT_THROW(MappedFileInputSource("pmm_missing_input.txt"), std::runtime_error);
+}
+
+TEST(InputSourceTest, PushSourceWaitsForMoreInput) {
+    PushInputSource* self = nullptr;
+    int waits = 0;
+    const char* parts[] = { "1", "2 3", "4\n" };
+    PushInputSource source([&]() {
+        // Each wait delivers the next part, then closes the input
+        if (waits < 3)
+            self->push(parts[waits]);
+        else
+            self->close();
+        ++waits;
+    });
+    self = &source;
+    EXPECT_FALSE(source.ready());
+
+    int value = 0;
+    EXPECT_TRUE(source.readInt(value));
+    EXPECT_EQ(12, value);   // "1" and "2" arrive in separate parts but form one number
+    EXPECT_TRUE(source.readInt(value));
+    EXPECT_EQ(34, value);
+    EXPECT_FALSE(source.readInt(value));
+    EXPECT_EQ(4, waits);
+    EXPECT_TRUE(source.ready());
+}
+
+TEST(InputSourceTest, InterpreterReadsFromInjectedSource) {
+    auto output = std::make_shared<MemoryOutputSink>();
+    auto input = std::make_shared<MemoryInputSource>("4 ignored\n2.5 yes x");
+    Interpreter interpreter(std::make_shared<ErrorReporter>(), output, input);
+    Lexer lexer(
+        "program Test;\n"
+        "var n: integer; r: real; b: boolean;\n"
+        "begin\n"
+        "  readln(n);\n"
+        "  read(r);\n"
+        "  read(b);\n"
+        "  writeln(n, r, b);\n"
+        "end.");
+    Parser parser(lexer.tokenize());
+    interpreter.setNames(lexer.getNames());
+    interpreter.run(parser.parse());
+
+    EXPECT_EQ("4 2.5 true\n", output->str());
+}
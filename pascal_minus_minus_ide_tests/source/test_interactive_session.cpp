@@ -0,0 +1,111 @@
+#include <gtest.h>
+#include "interactive_session.h"
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Echoes the running total after every number until it reads 0
+const char* ACCUMULATOR =
+    "program Accumulator;\n"
+    "var x, total: Integer;\n"
+    "begin\n"
+    "  total := 0;\n"
+    "  writeln(-1);\n"
+    "  read(x);\n"
+    "  while x <> 0 do\n"
+    "  begin\n"
+    "    total := total + x;\n"
+    "    writeln(total);\n"
+    "    read(x);\n"
+    "  end;\n"
+    "end.";
+
+// Records how many bytes were flushed, to check what the user saw before each suspension
+class RecordingSink : public IOutputSink {
+public:
+    void write(const char* data, std::size_t size) override { pending.append(data, size); }
+    void flush() override {
+        visible += pending;
+        pending.clear();
+    }
+
+    std::string pending;
+    std::string visible;
+};
+
+} // namespace
+
+TEST(InteractiveSessionTest, SuspendsOnReadAndResumesWithInput) {
+    InteractiveSession session(ACCUMULATOR);
+    EXPECT_EQ(SessionStatus::Ready, session.getStatus());
+
+    EXPECT_EQ(SessionStatus::NeedsInput, session.start());
+    EXPECT_EQ("-1\n", session.takeOutput());
+
+    EXPECT_EQ(SessionStatus::NeedsInput, session.provideInput("5\n"));
+    EXPECT_EQ("5\n", session.takeOutput());
+    EXPECT_EQ(5, session.getInterpreter().getVariable("total").intValue);
+
+    // Several numbers at once run several iterations before the next suspension
+    EXPECT_EQ(SessionStatus::NeedsInput, session.provideInput("1 2\n3\n"));
+    EXPECT_EQ("6\n8\n11\n", session.takeOutput());
+
+    EXPECT_EQ(SessionStatus::Finished, session.provideInput("0\n"));
+    EXPECT_TRUE(session.succeeded()) << session.getError() << session.getDiagnostics();
+    EXPECT_EQ("", session.takeOutput());
+    EXPECT_THROW(session.start(), std::logic_error);
+}
+
+TEST(InteractiveSessionTest, OutputIsFlushedBeforeSuspension) {
+    auto sink = std::make_shared<RecordingSink>();
+    InteractiveSession session(ACCUMULATOR, sink);
+    session.start();
+    EXPECT_EQ("-1\n", sink->visible);
+    EXPECT_EQ("", sink->pending);
+
+    session.provideInput("4\n");
+    EXPECT_EQ("-1\n4\n", sink->visible);
+    EXPECT_EQ("", session.takeOutput());   // A custom sink receives all output
+}
+
+TEST(InteractiveSessionTest, PartialNumberWaitsForDelimiter) {
+    InteractiveSession session(ACCUMULATOR);
+    session.start();
+    EXPECT_EQ(SessionStatus::NeedsInput, session.provideInput("1"));
+    EXPECT_EQ(SessionStatus::NeedsInput, session.provideInput("2"));
+    EXPECT_EQ(SessionStatus::NeedsInput, session.provideInput(" "));
+    EXPECT_EQ(12, session.getInterpreter().getVariable("total").intValue);
+}
+
+TEST(InteractiveSessionTest, ClosedInputFinishesProgram) {
+    InteractiveSession session(ACCUMULATOR);
+    session.start();
+    session.provideInput("7\n");
+    EXPECT_EQ(SessionStatus::Finished, session.closeInput());
+    EXPECT_FALSE(session.succeeded());
+}
+
+TEST(InteractiveSessionTest, OneThreadServesManySessions) {
+    std::vector<std::unique_ptr<InteractiveSession>> sessions;
+    for (int k = 0; k < 500; ++k) {
+        sessions.push_back(std::make_unique<InteractiveSession>(ACCUMULATOR));
+        EXPECT_EQ(SessionStatus::NeedsInput, sessions.back()->start());
+    }
+    for (int round = 1; round <= 3; ++round) {
+        for (int k = 0; k < 500; ++k)
+            EXPECT_EQ(SessionStatus::NeedsInput, sessions[k]->provideInput(std::to_string(k + 1) + "\n"));
+    }
+    for (int k = 0; k < 500; ++k) {
+        EXPECT_EQ(SessionStatus::Finished, sessions[k]->provideInput("0\n"));
+        EXPECT_EQ(3 * (k + 1), sessions[k]->getInterpreter().getVariable("total").intValue);
+    }
+    // Sessions abandoned while waiting for input are unwound on destruction
+    sessions.clear();
+}
+
+TEST(InteractiveSessionTest, ParseErrorThrows) {
+    EXPECT_THROW(InteractiveSession("program B;\nbegin\n  x := ;\nend."), std::runtime_error);
+}
@@ -5,6 +5,8 @@
 #include "error_reporter.h"
 #include <memory>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 class InterpreterTest : public ::testing::Test {
 protected:
@@ -19,7 +21,7 @@ protected:
     // Helper method to parse and interpret a program
     void interpretProgram(const std::string& source) {
         // Tokenize
-        Lexer lexer(source, errorReporter);
+        Lexer lexer(source, errorReporter, interpreter->getNames());
         std::vector<Token> tokens = lexer.tokenize();
         
         // Parse
@@ -172,4 +174,87 @@ TEST_F(InterpreterTest, InterpretBooleanOperations) {
     EXPECT_TRUE(getVariableValue("b").boolValue);  // true or false = true
     EXPECT_FALSE(getVariableValue("c").boolValue); // not true = false
     EXPECT_TRUE(getVariableValue("d").boolValue);  // (true) and (true) = true
-}
\ No newline at end of file
+}
+
+TEST_F(InterpreterTest, ForLoopVariableIsRestoredAfterLoop) {
+    std::string source =
+        "program Test;\n"
+        "var i, last: Integer;\n"
+        "begin\n"
+        "  i := 42;\n"
+        "  for i := 1 to 5 do\n"
+        "    last := i;\n"
+        "end.";
+
+    interpretProgram(source);
+
+    // The loop variable lives in its own scope, the outer value is restored
+    EXPECT_EQ(5, getVariableValue("last").intValue);
+    EXPECT_EQ(42, getVariableValue("i").intValue);
+}
+
+TEST_F(InterpreterTest, StringVariableDefaultsToEmptyString) {
+    std::string source =
+        "program Test;\n"
+        "var s: String;\n"
+        "begin\n"
+        "end.";
+
+    interpretProgram(source);
+
+    Value value = getVariableValue("s");
+    EXPECT_EQ(ValueType::String, value.type);
+    EXPECT_EQ("", value.stringValue);
+}
+
+// Many interpreters, each with its own input, output and reporter, run on several threads;
+// every program uses its own identifiers so the shared name table is interned concurrently
+TEST(InterpreterConcurrencyTest, ThousandsOfProgramsRunInParallel) {
+    const int THREADS = 8;
+    const int PROGRAMS_PER_THREAD = 250;
+    std::vector<int> failures(THREADS, 0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([t, &failures]() {
+            for (int p = 0; p < PROGRAMS_PER_THREAD; ++p) {
+                int k = t * PROGRAMS_PER_THREAD + p;
+                std::string acc = "acc_" + std::to_string(k);
+                std::string source =
+                    "program P;\n"
+                    "var i, n, " + acc + ": Integer;\n"
+                    "var r: Real;\n"
+                    "begin\n"
+                    "  read(n);\n"
+                    "  " + acc + " := 0;\n"
+                    "  for i := 1 to n do\n"
+                    "    " + acc + " := " + acc + " + i * " + std::to_string(k) + ";\n"
+                    "  r := 1.5;\n"
+                    "  for i := r to 1 do\n"
+                    "    n := n;\n"
+                    "  writeln(" + acc + ");\n"
+                    "end.";
+                int n = k % 50 + 1;
+
+                std::ostringstream diagnostics;
+                auto reporter = std::make_shared<ErrorReporter>(diagnostics);
+                auto output = std::make_shared<MemoryOutputSink>();
+                Lexer lexer(source, reporter);
+                Parser parser(lexer.tokenize(), reporter);
+                Interpreter interpreter(reporter, output, std::make_shared<MemoryInputSource>(std::to_string(n)));
+                interpreter.setNames(lexer.getNames());
+                interpreter.run(parser.parse());
+
+                long long expected = static_cast<long long>(k) * n * (n + 1) / 2;
+                if (output->str() != std::to_string(expected) + "\n" ||
+                    interpreter.getVariable(acc).intValue != expected ||
+                    reporter->hasErrors() || reporter->getWarningCount() != 1)
+                    ++failures[t];
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    for (int t = 0; t < THREADS; ++t)
+        EXPECT_EQ(0, failures[t]) << "thread " << t;
+}
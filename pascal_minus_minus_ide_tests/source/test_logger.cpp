@@ -0,0 +1,129 @@
+#include <gtest.h>
+#include "logger.h"
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <thread>
+#include <vector>
+
+class LoggerTest : public ::testing::Test {
+protected:
+    const char* path = "pmm_logger_test.log";
+
+    void SetUp() override {
+        std::remove(path);
+        Logger& logger = Logger::getInstance();
+        logger.setConsoleOutput(false);
+        logger.setLogFile(path);
+        logger.setLogLevel(LogLevel::Debug);
+    }
+
+    void TearDown() override {
+        Logger& logger = Logger::getInstance();
+        logger.stopAsync();
+        logger.setLogFile("");
+        logger.setConsoleOutput(true);
+        logger.setLogLevel(LogLevel::Info);
+        std::remove(path);
+    }
+
+    std::vector<std::string> readLines() {
+        std::ifstream file(path);
+        std::vector<std::string> lines;
+        std::string line;
+        while (std::getline(file, line))
+            lines.push_back(line);
+        return lines;
+    }
+};
+
+TEST_F(LoggerTest, SynchronousFormat) {
+    LOG_WARNING("first");
+    LOG_INFO("second");
+    // DEBUG is compiled out under NDEBUG (see LOG_MIN_LEVEL)
+#if LOG_MIN_LEVEL == 0
+    LOG_DEBUG("third");
+#endif
+    auto lines = readLines();
+#if LOG_MIN_LEVEL == 0
+    ASSERT_EQ(3u, lines.size());
+    EXPECT_NE(std::string::npos, lines[2].find(" [DEBUG  ] third"));
+#else
+    ASSERT_EQ(2u, lines.size());
+#endif
+    // "YYYY-MM-DD HH:MM:SS [LEVEL  ] message"
+    EXPECT_EQ(19u, lines[0].find(" [WARNING] first"));
+    EXPECT_NE(std::string::npos, lines[1].find(" [INFO   ] second"));
+}
+
+TEST_F(LoggerTest, DisabledLevelDoesNotEvaluateMessage) {
+    Logger::getInstance().setLogLevel(LogLevel::Error);
+    int evaluated = 0;
+    LOG_INFO((++evaluated, std::string("skipped")));
+    LOG_ERROR((++evaluated, std::string("written")));
+    EXPECT_EQ(1, evaluated);
+    EXPECT_EQ(1u, readLines().size());
+}
+
+TEST_F(LoggerTest, AsyncKeepsPerThreadOrder) {
+    Logger& logger = Logger::getInstance();
+    unsigned long long droppedBefore = logger.droppedCount();
+    logger.startAsync({ 64, LogOverflow::Block });
+
+    const int THREADS = 4;
+    const int MESSAGES = 2000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([t]() {
+            for (int i = 0; i < MESSAGES; ++i)
+                LOG_INFO("t" + std::to_string(t) + " " + std::to_string(i));
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    logger.flush();
+
+    auto lines = readLines();
+    ASSERT_EQ(static_cast<size_t>(THREADS * MESSAGES), lines.size());
+    std::map<int, int> next;
+    for (const auto& line : lines) {
+        size_t start = line.find("] t") + 3;
+        int thread = std::stoi(line.substr(start));
+        int index = std::stoi(line.substr(line.find(' ', start) + 1));
+        EXPECT_EQ(next[thread]++, index);
+    }
+    EXPECT_EQ(droppedBefore, logger.droppedCount());
+}
+
+TEST_F(LoggerTest, AsyncDropPolicyAccountsForEveryMessage) {
+    Logger& logger = Logger::getInstance();
+    unsigned long long droppedBefore = logger.droppedCount();
+    logger.startAsync({ 4, LogOverflow::Drop });
+    for (int i = 0; i < 5000; ++i)
+        LOG_INFO("message " + std::to_string(i));
+    logger.stopAsync();
+
+    unsigned long long dropped = logger.droppedCount() - droppedBefore;
+    size_t written = 0;
+    unsigned long long reported = 0;
+    for (const auto& line : readLines()) {
+        if (line.find("[INFO   ] message ") != std::string::npos)
+            ++written;
+        else
+            reported += std::stoull(line.substr(line.rfind(' ') + 1));
+    }
+    EXPECT_EQ(5000u, written + dropped);
+    EXPECT_EQ(dropped, reported);
+}
+
+TEST_F(LoggerTest, AsyncTruncatesLongMessages) {
+    Logger& logger = Logger::getInstance();
+    logger.startAsync();
+    LOG_INFO(std::string(LOG_RECORD_TEXT + 50, 'x'));
+    logger.stopAsync();
+
+    auto lines = readLines();
+    ASSERT_EQ(1u, lines.size());
+    EXPECT_NE(std::string::npos, lines[0].find(std::string(LOG_RECORD_TEXT, 'x') + "..."));
+    EXPECT_EQ(std::string::npos, lines[0].find(std::string(LOG_RECORD_TEXT + 1, 'x')));
+}
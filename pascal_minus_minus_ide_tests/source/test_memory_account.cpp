@@ -0,0 +1,175 @@
+#include <gtest.h>
+#include "memory_account.h"
+#include "interpreter.h"
+#include "parser.h"
+#include "lexer.h"
+#include "error_reporter.h"
+#include "input_source.h"
+#include "output_sink.h"
+#include <memory>
+#include <sstream>
+#include <string>
+
+namespace {
+
+// Reads two words; the second one is stored only if it fits the limit
+const char* TWO_WORDS =
+    "program Words;\n"
+    "var s, t: String;\n"
+    "begin\n"
+    "  read(s);\n"
+    "  t := s;\n"
+    "  writeln(t);\n"
+    "  read(s);\n"
+    "  writeln(s);\n"
+    "end.";
+
+class InterpreterMemoryTest : public ::testing::Test {
+protected:
+    std::ostringstream diagnostics;
+    std::shared_ptr<ErrorReporter> reporter = std::make_shared<ErrorReporter>(diagnostics);
+    std::shared_ptr<MemoryOutputSink> output = std::make_shared<MemoryOutputSink>();
+
+    std::unique_ptr<Interpreter> makeInterpreter(const std::string& input) {
+        auto interpreter = std::make_unique<Interpreter>(reporter, output, std::make_shared<MemoryInputSource>(input));
+        return interpreter;
+    }
+
+    // Names are numbered by the table of the interpreter that runs the program
+    std::shared_ptr<ASTNode> parse(const std::string& source, const Interpreter& interpreter) {
+        Lexer lexer(source, reporter, interpreter.getNames());
+        Parser parser(lexer.tokenize(), reporter);
+        return parser.parse();
+    }
+};
+
+} // namespace
+
+TEST(MemoryAccountTest, TracksCurrentPeakAndCategories) {
+    MemoryAccount account;
+    account.charge(MemoryCategory::Ast, 100);
+    account.charge(MemoryCategory::Strings, 50);
+    account.release(MemoryCategory::Ast, 100);
+    account.resize(MemoryCategory::Strings, 50, 20);
+
+    EXPECT_EQ(20u, account.current());
+    EXPECT_EQ(0u, account.current(MemoryCategory::Ast));
+    EXPECT_EQ(20u, account.current(MemoryCategory::Strings));
+    EXPECT_EQ(150u, account.peak());
+
+    account.resetPeak();
+    EXPECT_EQ(20u, account.peak());
+    {
+        MemoryAccount::ScopedCharge scoped(account, MemoryCategory::Evaluation, 30);
+        EXPECT_EQ(50u, account.current());
+    }
+    EXPECT_EQ(20u, account.current());
+    EXPECT_EQ(50u, account.peak());
+}
+
+TEST(MemoryAccountTest, ChargeOverLimitThrowsAndChargesNothing) {
+    MemoryAccount account(100);
+    account.charge(MemoryCategory::Symbols, 60);
+    try {
+        account.charge(MemoryCategory::Strings, 41);
+        FAIL() << "charge over the limit succeeded";
+    } catch (const MemoryLimitExceeded& e) {
+        EXPECT_EQ(MemoryCategory::Strings, e.category);
+        EXPECT_EQ(41u, e.requested);
+    }
+    EXPECT_EQ(60u, account.current());
+    EXPECT_NO_THROW(account.charge(MemoryCategory::Strings, 40));
+    EXPECT_EQ(100u, account.peak());
+}
+
+TEST(MemoryAccountTest, ShortStringsHaveNoHeapPart) {
+    EXPECT_EQ(0u, MemoryAccount::heapBytes(std::string("abc")));
+    std::string text(1000, 'x');
+    EXPECT_GT(MemoryAccount::heapBytes(text), 1000u);
+}
+
+TEST_F(InterpreterMemoryTest, UsageIsQueryableAfterRun) {
+    std::string word(10000, 'w');
+    auto interpreter = makeInterpreter(word + " short");
+    interpreter->run(parse(TWO_WORDS, *interpreter));
+    ASSERT_EQ(word + "\nshort\n", output->str());
+
+    const MemoryAccount& memory = interpreter->getMemoryAccount();
+    // t still holds the long word; the tree is released when run() returns
+    EXPECT_GT(memory.current(MemoryCategory::Strings), 10000u);
+    EXPECT_GT(memory.current(MemoryCategory::Symbols), 0u);
+    EXPECT_EQ(0u, memory.current(MemoryCategory::Ast));
+    EXPECT_EQ(0u, memory.current(MemoryCategory::Evaluation));
+    // While both s and t held the word, and the tree was charged, usage was higher
+    EXPECT_GT(memory.peak(), memory.current() + 10000u);
+
+    interpreter->clearSymbols();
+    EXPECT_EQ(0u, memory.current(MemoryCategory::Strings));
+}
+
+TEST_F(InterpreterMemoryTest, LimitStopsProgramWithCleanDiagnostic) {
+    auto interpreter = makeInterpreter("abc " + std::string(1 << 20, 'x'));
+    interpreter->setMemoryLimit(64 * 1024);
+
+    try {
+        interpreter->run(parse(TWO_WORDS, *interpreter));
+        FAIL() << "run() finished without interruption";
+    } catch (const ExecutionInterrupted& e) {
+        EXPECT_EQ(InterruptReason::MemoryLimit, e.getReason());
+    }
+
+    EXPECT_NE(std::string::npos, diagnostics.str().find("превышен лимит памяти")) << diagnostics.str();
+    EXPECT_EQ("abc\n", output->str());
+    // The oversized word was never stored
+    EXPECT_EQ("abc", interpreter->getVariable("s").stringValue);
+    EXPECT_LE(interpreter->getMemoryAccount().peak(), 64u * 1024);
+}
+
+TEST_F(InterpreterMemoryTest, LimitIsNotSwallowedByWhileLoop) {
+    auto interpreter = makeInterpreter("a b c " + std::string(1 << 20, 'x') + " d");
+    interpreter->setMemoryLimit(64 * 1024);
+    auto program = parse(
+        "program Loop;\n"
+        "var s: String;\n"
+        "var n: Integer;\n"
+        "begin\n"
+        "  n := 0;\n"
+        "  while n < 10 do\n"
+        "  begin\n"
+        "    read(s);\n"
+        "    n := n + 1;\n"
+        "  end;\n"
+        "  writeln(n);\n"
+        "end.", *interpreter);
+
+    EXPECT_THROW(interpreter->run(program), ExecutionInterrupted);
+    EXPECT_EQ(3, interpreter->getVariable("n").intValue);
+    EXPECT_EQ("", output->str());
+}
+
+TEST_F(InterpreterMemoryTest, ProgramLargerThanLimitDoesNotStart) {
+    auto interpreter = makeInterpreter("");
+    interpreter->setMemoryLimit(256);
+
+    EXPECT_THROW(interpreter->run(parse(TWO_WORDS, *interpreter)), ExecutionInterrupted);
+    EXPECT_EQ("", output->str());
+    EXPECT_EQ(0u, interpreter->getMemoryAccount().current());
+}
+
+TEST_F(InterpreterMemoryTest, SymbolChargeIgnoresNamesOfOtherPrograms) {
+    // A program with far more names than the limit below can index
+    std::string source = "program Many;\nvar v0";
+    for (int i = 1; i < 20000; ++i)
+        source += ", v" + std::to_string(i);
+    source += ": Integer;\nbegin\nend.";
+    auto many = makeInterpreter("");
+    many->run(parse(source, *many));
+    output->clear();
+
+    auto interpreter = makeInterpreter("abc def");
+    interpreter->setMemoryLimit(64 * 1024);
+    interpreter->run(parse(TWO_WORDS, *interpreter));
+
+    EXPECT_EQ("abc\ndef\n", output->str());
+    EXPECT_LT(interpreter->getMemoryAccount().current(MemoryCategory::Symbols), 1024u);
+}
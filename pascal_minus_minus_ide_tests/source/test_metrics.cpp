@@ -0,0 +1,142 @@
+#include <gtest.h>
+#include "metrics.h"
+#include "batch_runner.h"
+#include "interpreter.h"
+#include "parser.h"
+#include "lexer.h"
+#include "error_reporter.h"
+#include "input_source.h"
+#include "output_sink.h"
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const char* PROGRAM =
+    "program Counted;\n"
+    "var i, n: Integer;\n"
+    "    x: Real;\n"
+    "begin\n"
+    "  read(n);\n"
+    "  x := n;\n"
+    "  for i := 1 to 3 do\n"
+    "    n := n + i * 2;\n"
+    "  writeln(n, x);\n"
+    "end.";
+
+std::string runCounted(const InterpreterMetrics& metrics) {
+    auto reporter = std::make_shared<ErrorReporter>();
+    auto output = std::make_shared<MemoryOutputSink>();
+    Interpreter interpreter(reporter, output, std::make_shared<MemoryInputSource>("4"));
+    interpreter.setMetrics(&metrics);
+    Lexer lexer(PROGRAM, reporter, interpreter.getNames());
+    Parser parser(lexer.tokenize(), reporter);
+    interpreter.run(parser.parse());
+    return output->str();
+}
+
+} // namespace
+
+TEST(MetricsTest, UnboundHandlesDoNothing) {
+    MetricsRegistry::Counter counter;
+    counter.add(5);
+    MetricsRegistry::Histogram histogram;
+    histogram.observe(5);
+}
+
+TEST(MetricsTest, CountersSumAcrossThreads) {
+    MetricsRegistry registry;
+    MetricsRegistry::Counter counter = registry.counter("work_total", "Work done");
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; ++t) {
+        workers.emplace_back([counter]() {
+            for (int i = 0; i < 10000; ++i)
+                counter.add();
+        });
+    }
+    for (auto& worker : workers)
+        worker.join();
+    counter.add(3);
+    EXPECT_EQ(registry.value("work_total"), 40003u);
+    EXPECT_EQ(registry.value("missing_total"), 0u);
+}
+
+TEST(MetricsTest, RegistrationIsIdempotentPerLabels) {
+    MetricsRegistry registry;
+    registry.counter("ops_total", "Ops", { { "op", "+" } }).add(2);
+    registry.counter("ops_total", "Ops", { { "op", "+" } }).add(3);
+    registry.counter("ops_total", "Ops", { { "op", "-" } }).add(7);
+    EXPECT_EQ(registry.value("ops_total", { { "op", "+" } }), 5u);
+    EXPECT_EQ(registry.value("ops_total", { { "op", "-" } }), 7u);
+}
+
+TEST(MetricsTest, ThrowsWhenSlotsRunOut) {
+    MetricsRegistry registry;
+    std::vector<std::uint64_t> bounds(MetricsRegistry::MAX_SLOTS - 3);
+    for (std::size_t i = 0; i < bounds.size(); ++i)
+        bounds[i] = i;
+    registry.histogram("big", "Fills the registry", bounds);
+    EXPECT_THROW(registry.counter("one_more", "No room"), std::length_error);
+}
+
+TEST(MetricsTest, WritesHistogramInBothFormats) {
+    MetricsRegistry registry;
+    MetricsRegistry::Histogram histogram = registry.histogram("latency", "Latency", { 10, 100 }, { { "job", "a\"b" } });
+    histogram.observe(5);
+    histogram.observe(10);
+    histogram.observe(50);
+    histogram.observe(500);
+    EXPECT_EQ(registry.value("latency", { { "job", "a\"b" } }), 4u);
+
+    std::ostringstream json;
+    registry.writeJson(json);
+    EXPECT_NE(json.str().find("\"labels\":{\"job\":\"a\\\"b\"}"), std::string::npos) << json.str();
+    EXPECT_NE(json.str().find("\"buckets\":[{\"le\":10,\"count\":2},{\"le\":100,\"count\":1},{\"le\":\"+Inf\",\"count\":1}],"
+                              "\"sum\":565,\"count\":4}"), std::string::npos) << json.str();
+
+    std::ostringstream text;
+    registry.writePrometheus(text);
+    EXPECT_NE(text.str().find("# TYPE latency histogram\n"), std::string::npos);
+    // Prometheus buckets are cumulative
+    EXPECT_NE(text.str().find("latency_bucket{job=\"a\\\"b\",le=\"100\"} 3\n"), std::string::npos) << text.str();
+    EXPECT_NE(text.str().find("latency_bucket{job=\"a\\\"b\",le=\"+Inf\"} 4\n"), std::string::npos);
+    EXPECT_NE(text.str().find("latency_sum{job=\"a\\\"b\"} 565\n"), std::string::npos);
+}
+
+TEST(MetricsTest, InterpreterCountsExecution) {
+    MetricsRegistry registry;
+    InterpreterMetrics metrics(registry);
+    EXPECT_EQ(runCounted(metrics), "16 4\n");
+
+    EXPECT_EQ(registry.value("pmm_programs_total"), 1u);
+    EXPECT_EQ(registry.value("pmm_operators_total", { { "operator", "+" } }), 3u);
+    EXPECT_EQ(registry.value("pmm_operators_total", { { "operator", "*" } }), 3u);
+    EXPECT_EQ(registry.value("pmm_conversions_total", { { "from", "Integer" }, { "to", "Real" } }), 1u);
+    EXPECT_EQ(registry.value("pmm_input_values_total"), 1u);
+    // read(n), x := n, three loop steps and three assignments in the body
+    EXPECT_EQ(registry.value("pmm_variable_writes_total"), 8u);
+    // "16 4" and the newline
+    EXPECT_EQ(registry.value("pmm_output_bytes_total"), 5u);
+    EXPECT_EQ(registry.value("pmm_loop_iterations"), 1u);
+
+    std::ostringstream json;
+    registry.writeJson(json);
+    EXPECT_NE(json.str().find("{\"le\":10,\"count\":1}"), std::string::npos) << json.str();
+}
+
+TEST(MetricsTest, BatchRunnerSharesMetricsAcrossJobs) {
+    MetricsRegistry registry;
+    BatchRunner runner(2);
+    runner.setMetrics(&registry);
+    std::vector<BatchJob> jobs = { { "a.pas", PROGRAM, "4" }, { "b.pas", PROGRAM, "4" }, { "c.pas", PROGRAM, "4" } };
+    auto results = runner.run(jobs);
+    ASSERT_EQ(results.size(), 3u);
+    EXPECT_EQ(results[2].output, "16 4\n");
+    EXPECT_EQ(registry.value("pmm_programs_total"), 3u);
+    EXPECT_EQ(registry.value("pmm_variable_writes_total"), 24u);
+    EXPECT_EQ(registry.value("pmm_warnings_total"), 0u);
+}
@@ -0,0 +1,153 @@
+#include <gtest.h>
+#include "name_table.h"
+#include "lexer.h"
+#include "parser.h"
+#include "symbol_table.h"
+#include "interpreter.h"
+#include "error_reporter.h"
+#include "input_source.h"
+#include "output_sink.h"
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+class NameTableTest : public ::testing::Test {
+protected:
+    NameTable table;
+};
+
+TEST_F(NameTableTest, ResolveAcceptsOnlyOwnIds) {
+    NameId x = table.intern("x");
+
+    EXPECT_EQ(x, table.resolve(x, "x"));
+    EXPECT_EQ(table.intern("fresh"), table.resolve(NO_NAME, "fresh"));
+    EXPECT_THROW(table.resolve(x, "y"), std::logic_error);
+    EXPECT_THROW(table.resolve(x + 100, "x"), std::logic_error);
+}
+
+TEST_F(NameTableTest, SameTextGivesSameId) {
+    NameId first = table.intern("counter");
+    NameId second = table.intern(std::string("coun") + "ter");
+
+    EXPECT_NE(NO_NAME, first);
+    EXPECT_EQ(first, second);
+    EXPECT_NE(first, table.intern("Counter")); // Names are case-sensitive
+    EXPECT_EQ(2u, table.size());
+}
+
+TEST_F(NameTableTest, FindDoesNotIntern) {
+    EXPECT_EQ(NO_NAME, table.find("unknown"));
+    EXPECT_EQ(0u, table.size());
+
+    NameId id = table.intern("known");
+    EXPECT_EQ(id, table.find("known"));
+}
+
+TEST_F(NameTableTest, TextIsStableAcrossGrowth) {
+    NameId first = table.intern("first");
+    const std::string* text = &table.text(first);
+
+    // Enough names to grow the storage several times
+    for (int i = 0; i < 5000; ++i)
+        table.intern("name" + std::to_string(i));
+
+    EXPECT_EQ(text, &table.text(first));
+    EXPECT_EQ("first", table.text(first));
+    EXPECT_EQ("name4999", table.text(table.find("name4999")));
+    EXPECT_EQ("", table.text(NO_NAME));
+    EXPECT_THROW(table.text(100000), std::out_of_range);
+}
+
+TEST_F(NameTableTest, TablesNumberNamesIndependently) {
+    for (int i = 0; i < 1000; ++i)
+        table.intern("busy" + std::to_string(i));
+
+    NameTable other;
+    EXPECT_EQ(1u, other.intern("first"));
+    EXPECT_EQ(0u, other.find("busy0"));
+    EXPECT_EQ(1000u, table.size());
+}
+
+TEST(NameInterningTest, LexerAndParserCarryNameIds) {
+    Lexer lexer("program p; var total: integer; begin total := total + 1 end.");
+    auto tokens = lexer.tokenize();
+
+    NameId total = lexer.getNames()->find("total");
+    ASSERT_NE(NO_NAME, total);
+    for (const auto& token : tokens) {
+        if (token.type == TokenType::Identifier) {
+            EXPECT_EQ(lexer.getNames()->find(token.value), token.name);
+        } else {
+            EXPECT_EQ(NO_NAME, token.name);
+        }
+    }
+
+    Parser parser(tokens);
+    auto program = parser.parse();
+    ASSERT_NE(nullptr, program);
+
+    // Every node naming the variable refers to the same handle
+    std::vector<std::shared_ptr<ASTNode>> pending{ program };
+    int uses = 0;
+    while (!pending.empty()) {
+        auto node = pending.back();
+        pending.pop_back();
+        if (node->value == "total") {
+            EXPECT_EQ(total, node->name);
+            ++uses;
+        }
+        for (const auto& child : node->children)
+            pending.push_back(child);
+    }
+    EXPECT_EQ(3, uses); // Declaration, assignment target and operand
+}
+
+TEST(NameInterningTest, SymbolTableKeyedByNameId) {
+    SymbolTable symbols;
+    symbols.addSymbol(SymbolInfo("alpha", "integer", "1"));
+
+    NameId alpha = symbols.getNames().find("alpha");
+    ASSERT_NE(NO_NAME, alpha);
+    ASSERT_NE(nullptr, symbols.findSymbol(alpha));
+    EXPECT_EQ(symbols.findSymbol(alpha), symbols.findSymbol("alpha"));
+    EXPECT_EQ(nullptr, symbols.findSymbol("never_interned_symbol"));
+
+    symbols.addSymbol(SymbolInfo(alpha, "integer", "2"));
+    EXPECT_EQ(1u, symbols.size());
+    EXPECT_EQ("2", symbols.findSymbol("alpha")->value);
+
+    symbols.removeSymbol(alpha);
+    EXPECT_EQ(nullptr, symbols.findSymbol("alpha"));
+}
+
+TEST(NameInterningTest, InterpreterSharesLexerNames) {
+    auto output = std::make_shared<MemoryOutputSink>();
+    Interpreter interpreter(std::make_shared<ErrorReporter>(), output, std::make_shared<MemoryInputSource>(""));
+    auto run = [&interpreter](const std::string& source) {
+        Lexer lexer(source, nullptr, interpreter.getNames());
+        Parser parser(lexer.tokenize());
+        interpreter.run(parser.parse());
+    };
+
+    // Programs lexed with the interpreter's table keep their variables' numbers
+    run("program A; var x, y: integer; begin x := 1; y := 2 end.");
+    NameId y = interpreter.getNames()->find("y");
+    ASSERT_NE(NO_NAME, y);
+    run("program B; begin y := y + 1; writeln(y) end.");
+
+    EXPECT_EQ("3\n", output->str());
+    EXPECT_EQ(y, interpreter.getNames()->find("y"));
+    EXPECT_EQ(1, interpreter.getVariable("x").intValue);
+}
+
+TEST(NameInterningTest, InterpreterRejectsTreeOfOtherTable) {
+    Interpreter interpreter(std::make_shared<ErrorReporter>(), std::make_shared<MemoryOutputSink>(),
+        std::make_shared<MemoryInputSource>(""));
+    interpreter.getNames()->intern("unrelated");
+
+    // The lexer numbers "x" with its own table, where the number means another name
+    Lexer lexer("program A; var x: integer; begin x := 1 end.");
+    Parser parser(lexer.tokenize());
+    EXPECT_THROW(interpreter.run(parser.parse()), std::logic_error);
+}
@@ -0,0 +1,168 @@
+#include <gtest.h>
+#include "node_profiler.h"
+#include "interpreter.h"
+#include "parser.h"
+#include "lexer.h"
+#include "error_reporter.h"
+#include "input_source.h"
+#include "output_sink.h"
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* COUNTING_LOOP =
+    "program Count;\n"
+    "var i, total: Integer;\n"
+    "begin\n"
+    "  total := 0;\n"
+    "  for i := 1 to 7 do\n"
+    "    total := total + i;\n"
+    "  writeln(total);\n"
+    "end.";
+
+// The programs here are run by several interpreters, so they all share one name table
+const std::shared_ptr<NameTable>& programNames() {
+    static const std::shared_ptr<NameTable> names = std::make_shared<NameTable>();
+    return names;
+}
+
+std::shared_ptr<ASTNode> parseProgram(const std::string& source) {
+    auto reporter = std::make_shared<ErrorReporter>();
+    Lexer lexer(source, reporter, programNames());
+    Parser parser(lexer.tokenize(), reporter);
+    return parser.parse();
+}
+
+std::string runProfiled(const std::shared_ptr<ASTNode>& program, NodeProfiler* profiler) {
+    auto output = std::make_shared<MemoryOutputSink>();
+    Interpreter interpreter(std::make_shared<ErrorReporter>(), output, std::make_shared<MemoryInputSource>(""));
+    interpreter.setNames(programNames());
+    interpreter.setProfiler(profiler);
+    interpreter.run(program);
+    return output->str();
+}
+
+const NodeProfile* findProfile(const std::vector<NodeProfile>& profiles, ASTNodeType type, int line) {
+    for (const NodeProfile& profile : profiles) {
+        if (profile.node->type == type && profile.line == line)
+            return &profile;
+    }
+    return nullptr;
+}
+
+} // namespace
+
+TEST(NodeProfilerTest, ParserRecordsSourcePositions) {
+    auto program = parseProgram(COUNTING_LOOP);
+    ASSERT_NE(program, nullptr);
+    EXPECT_EQ(program->line, 1);
+    EXPECT_EQ(program->column, 1);
+
+    NodeProfiler profiler;
+    runProfiled(program, &profiler);
+    std::vector<NodeProfile> profiles = profiler.results();
+    const NodeProfile* loop = findProfile(profiles, ASTNodeType::ForLoop, 5);
+    ASSERT_NE(loop, nullptr);
+    EXPECT_EQ(loop->column, 3);
+}
+
+TEST(NodeProfilerTest, CountsExecutionsPerNode) {
+    auto program = parseProgram(COUNTING_LOOP);
+    NodeProfiler profiler;
+    EXPECT_EQ(runProfiled(program, &profiler), "28\n");
+
+    std::vector<NodeProfile> profiles = profiler.results();
+    const NodeProfile* loop = findProfile(profiles, ASTNodeType::ForLoop, 5);
+    const NodeProfile* body = findProfile(profiles, ASTNodeType::Assignment, 6);
+    const NodeProfile* init = findProfile(profiles, ASTNodeType::Assignment, 4);
+    ASSERT_NE(loop, nullptr);
+    ASSERT_NE(body, nullptr);
+    ASSERT_NE(init, nullptr);
+    EXPECT_EQ(loop->count, 1u);
+    EXPECT_EQ(body->count, 7u);
+    EXPECT_EQ(init->count, 1u);
+}
+
+TEST(NodeProfilerTest, ExclusiveTimeNeverExceedsInclusive) {
+    auto program = parseProgram(COUNTING_LOOP);
+    NodeProfiler profiler;
+    runProfiled(program, &profiler);
+
+    std::vector<NodeProfile> profiles = profiler.results();
+    ASSERT_FALSE(profiles.empty());
+    for (std::size_t i = 0; i < profiles.size(); ++i) {
+        EXPECT_GE(profiles[i].exclusiveSeconds, 0.0);
+        EXPECT_LE(profiles[i].exclusiveSeconds, profiles[i].inclusiveSeconds + 1e-12);
+        if (i > 0) {
+            EXPECT_GE(profiles[i - 1].exclusiveSeconds, profiles[i].exclusiveSeconds);
+        }
+    }
+}
+
+TEST(NodeProfilerTest, StatisticsAccumulateAcrossRunsUntilReset) {
+    auto program = parseProgram(COUNTING_LOOP);
+    NodeProfiler profiler;
+    runProfiled(program, &profiler);
+    runProfiled(program, &profiler);
+    std::vector<NodeProfile> profiles = profiler.results();
+    const NodeProfile* body = findProfile(profiles, ASTNodeType::Assignment, 6);
+    ASSERT_NE(body, nullptr);
+    EXPECT_EQ(body->count, 14u);
+
+    profiler.reset();
+    EXPECT_TRUE(profiler.results().empty());
+}
+
+TEST(NodeProfilerTest, FoldedStacksFollowTreePath) {
+    auto program = parseProgram(COUNTING_LOOP);
+    NodeProfiler profiler;
+    runProfiled(program, &profiler);
+
+    std::ostringstream folded;
+    profiler.writeFoldedStacks(folded);
+    std::istringstream lines(folded.str());
+    std::string line;
+    while (std::getline(lines, line)) {
+        std::size_t space = line.rfind(' ');
+        ASSERT_NE(space, std::string::npos) << line;
+        EXPECT_EQ(line.compare(0, 8, "Program "), 0) << line;
+        std::string weight = line.substr(space + 1);
+        EXPECT_FALSE(weight.empty());
+        EXPECT_EQ(weight.find_first_not_of("0123456789"), std::string::npos) << line;
+        if (line.find("Assignment (6:5)") != std::string::npos) {
+            EXPECT_NE(line.find("For i (5:3);"), std::string::npos) << line;
+        }
+    }
+}
+
+TEST(NodeProfilerTest, ReportListsNodes) {
+    auto program = parseProgram(COUNTING_LOOP);
+    NodeProfiler profiler;
+    runProfiled(program, &profiler);
+
+    std::ostringstream report;
+    profiler.writeReport(report, 2);
+    std::string text = report.str();
+    EXPECT_EQ(std::count(text.begin(), text.end(), '\n'), 3);
+
+    std::ostringstream full;
+    profiler.writeReport(full);
+    EXPECT_NE(full.str().find("For i (5:3)"), std::string::npos);
+}
+
+TEST(NodeProfilerTest, LabelReplacesFrameSeparator) {
+    ASTNode node(ASTNodeType::String, "a;b");
+    node.line = 3;
+    node.column = 9;
+    EXPECT_EQ(NodeProfiler::label(node), "String a,b (3:9)");
+}
+
+TEST(NodeProfilerTest, DisabledProfilerLeavesOutputUnchanged) {
+    auto program = parseProgram(COUNTING_LOOP);
+    NodeProfiler profiler;
+    EXPECT_EQ(runProfiled(program, nullptr), runProfiled(program, &profiler));
+}
@@ -0,0 +1,184 @@
+#include <gtest.h>
+#include "output_sink.h"
+#include "interpreter.h"
+#include "parser.h"
+#include "lexer.h"
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <unistd.h>
+#endif
+
+// Counts how often the buffered sink hands data over to its destination
+class CountingSink : public BufferedOutputSink {
+public:
+    using BufferedOutputSink::BufferedOutputSink;
+
+    std::string delivered;
+    int drains = 0;
+
+protected:
+    void drain(const char* data, std::size_t size) override {
+        delivered.append(data, size);
+        ++drains;
+    }
+};
+
+static std::string format(const Value& value) {
+    MemoryOutputSink sink;
+    writeValue(sink, value);
+    return sink.str();
+}
+
+TEST(OutputSinkTest, NumbersAreFormattedLikeIostream) {
+    const int ints[] = { 0, -1, 42, std::numeric_limits<int>::max(), std::numeric_limits<int>::min() };
+    for (int v : ints) {
+        std::ostringstream expected;
+        expected << v;
+        EXPECT_EQ(expected.str(), format(Value(v)));
+    }
+
+    const double reals[] = { 0.0, -0.0, 0.5, 3.5, 1.0 / 3.0, 123456.0, 1234567.0, 1e-5, 2.5e20, -7.25,
+                             std::numeric_limits<double>::infinity() };
+    for (double v : reals) {
+        std::ostringstream expected;
+        expected << v;
+        EXPECT_EQ(expected.str(), format(Value(v))) << v;
+    }
+
+    EXPECT_EQ("true", format(Value(true)));
+    EXPECT_EQ("false", format(Value(false)));
+    EXPECT_EQ("text", format(Value(std::string("text"))));
+}
+
+TEST(OutputSinkTest, BuffersUntilFullOrFlushed) {
+    CountingSink sink(8);
+    sink.write("abc", 3);
+    sink.endLine();
+    EXPECT_EQ(0, sink.drains);
+    EXPECT_EQ(4u, sink.pending());
+
+    sink.write("defgh", 5);   // Does not fit: the buffered part is drained first
+    EXPECT_EQ(1, sink.drains);
+    EXPECT_EQ("abc\n", sink.delivered);
+
+    sink.flush();
+    EXPECT_EQ("abc\ndefgh", sink.delivered);
+    EXPECT_EQ(0u, sink.pending());
+}
+
+TEST(OutputSinkTest, LargeWritesBypassBuffer) {
+    CountingSink sink(4);
+    sink.write("ab", 2);
+    sink.write("0123456789", 10);
+    EXPECT_EQ(2, sink.drains);
+    EXPECT_EQ("ab0123456789", sink.delivered);
+}
+
+TEST(OutputSinkTest, FlushPolicies) {
+    CountingSink lines(1024, FlushPolicy::EachLine);
+    lines.write("a", 1);
+    EXPECT_EQ(0, lines.drains);
+    lines.endLine();
+    EXPECT_EQ("a\n", lines.delivered);
+
+    CountingSink writes(1024, FlushPolicy::EachWrite);
+    writes.write("a", 1);
+    writes.write("b", 1);
+    EXPECT_EQ(2, writes.drains);
+    EXPECT_EQ("ab", writes.delivered);
+}
+
+TEST(OutputSinkTest, StreamSinkWritesOnFlushAndDestruction) {
+    std::ostringstream stream;
+    {
+        StreamOutputSink sink(stream);
+        writeValue(sink, Value(7));
+        sink.endLine();
+        EXPECT_EQ("", stream.str());
+        sink.flush();
+        EXPECT_EQ("7\n", stream.str());
+        sink.write("tail", 4);
+    }
+    EXPECT_EQ("7\ntail", stream.str());
+}
+
+TEST(OutputSinkTest, FdSinkWritesToDescriptor) {
+    int fds[2];
+#ifdef _WIN32
+    ASSERT_EQ(0, _pipe(fds, 4096, _O_BINARY));
+#else
+    ASSERT_EQ(0, pipe(fds));
+#endif
+    {
+        FdOutputSink sink(fds[1], 16);
+        for (int i = 0; i < 10; ++i) {
+            writeValue(sink, Value(i));
+            sink.endLine();
+        }
+    }
+#ifdef _WIN32
+    _close(fds[1]);
+    char buffer[64];
+    int read = _read(fds[0], buffer, sizeof(buffer));
+    _close(fds[0]);
+#else
+    close(fds[1]);
+    char buffer[64];
+    ssize_t read = ::read(fds[0], buffer, sizeof(buffer));
+    close(fds[0]);
+#endif
+    ASSERT_GT(read, 0);
+    EXPECT_EQ("0\n1\n2\n3\n4\n5\n6\n7\n8\n9\n", std::string(buffer, read));
+}
+
+TEST(OutputSinkTest, InterpreterWritesToInjectedSink) {
+    auto sink = std::make_shared<MemoryOutputSink>();
+    Interpreter interpreter(std::make_shared<ErrorReporter>(), sink);
+    Lexer lexer(
+        "program Test;\n"
+        "var i: integer; x: real;\n"
+        "begin\n"
+        "  x := 2.5;\n"
+        "  for i := 1 to 3 do write(i);\n"
+        "  writeln(x, true);\n"
+        "end.");
+    Parser parser(lexer.tokenize());
+    interpreter.setNames(lexer.getNames());
+    interpreter.run(parser.parse());
+
+    EXPECT_EQ("1232.5 true\n", sink->str());
+}
+
+TEST(OutputSinkTest, InterpreterWithReporterDoesNotUseConsole) {
+    Interpreter interpreter(std::make_shared<ErrorReporter>());
+    EXPECT_EQ(nullptr, interpreter.getLogger());
+    auto sink = std::dynamic_pointer_cast<MemoryOutputSink>(interpreter.getOutputSink());
+    ASSERT_NE(nullptr, sink);
+
+    Lexer lexer("program Test;\nbegin\n  writeln(7);\nend.", nullptr, interpreter.getNames());
+    Parser parser(lexer.tokenize());
+    interpreter.run(parser.parse());
+    EXPECT_EQ("7\n", sink->str());
+}
+
+TEST(OutputSinkTest, InterpreterFlushesAtProgramEnd) {
+    std::ostringstream stream;
+    auto sink = std::make_shared<StreamOutputSink>(stream);
+    Interpreter interpreter(nullptr, sink);
+    Lexer lexer(
+        "program Test;\n"
+        "begin\n"
+        "  writeln(1);\n"
+        "end.");
+    Parser parser(lexer.tokenize());
+    interpreter.run(parser.parse());
+
+    EXPECT_EQ("1\n", stream.str());
+    EXPECT_EQ(0u, sink->pending());
+}
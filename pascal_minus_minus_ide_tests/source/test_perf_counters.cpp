@@ -0,0 +1,101 @@
+#include <gtest.h>
+#include "perf_counters.h"
+#include <sstream>
+#include <string>
+
+namespace {
+
+PerfReading makeReading(std::uint64_t cycles, std::uint64_t instructions, std::uint64_t cacheMisses,
+                        std::uint64_t branchMisses, double seconds) {
+    PerfReading reading;
+    reading.values = { cycles, instructions, cacheMisses, branchMisses };
+    reading.valid.fill(true);
+    reading.seconds = seconds;
+    return reading;
+}
+
+// Keeps the optimizer from removing the measured work
+volatile long sink = 0;
+
+void spin() {
+    for (long i = 0; i < 2000000; ++i)
+        sink = sink + i;
+}
+
+} // namespace
+
+TEST(PerfCountersTest, DerivesIpcAndMpki) {
+    PerfReading reading = makeReading(2000, 3000, 6, 30, 0.5);
+    EXPECT_DOUBLE_EQ(reading.ipc(), 1.5);
+    EXPECT_DOUBLE_EQ(reading.mpki(PerfEvent::CacheMisses), 2.0);
+    EXPECT_DOUBLE_EQ(reading.mpki(PerfEvent::BranchMisses), 10.0);
+}
+
+TEST(PerfCountersTest, MissingCountersGiveZeroRatios) {
+    PerfReading reading = makeReading(2000, 3000, 6, 30, 0.5);
+    reading.valid[static_cast<std::size_t>(PerfEvent::Cycles)] = false;
+    EXPECT_EQ(reading.ipc(), 0.0);
+    EXPECT_DOUBLE_EQ(reading.mpki(PerfEvent::CacheMisses), 2.0);
+
+    reading.valid[static_cast<std::size_t>(PerfEvent::Instructions)] = false;
+    EXPECT_EQ(reading.mpki(PerfEvent::BranchMisses), 0.0);
+    EXPECT_EQ(PerfReading().ipc(), 0.0);
+}
+
+TEST(PerfCountersTest, SinceSubtractsEarlierReading) {
+    PerfReading earlier = makeReading(100, 200, 5, 7, 1.0);
+    PerfReading later = makeReading(1100, 2200, 4, 17, 1.25);
+    later.valid[static_cast<std::size_t>(PerfEvent::BranchMisses)] = false;
+
+    PerfReading delta = later.since(earlier);
+    EXPECT_EQ(delta.get(PerfEvent::Cycles), 1000u);
+    EXPECT_EQ(delta.get(PerfEvent::Instructions), 2000u);
+    // Scaled counters may step back under multiplexing: the difference is clamped
+    EXPECT_EQ(delta.get(PerfEvent::CacheMisses), 0u);
+    EXPECT_TRUE(delta.has(PerfEvent::CacheMisses));
+    EXPECT_FALSE(delta.has(PerfEvent::BranchMisses));
+    EXPECT_DOUBLE_EQ(delta.seconds, 0.25);
+}
+
+TEST(PerfCountersTest, CountsWorkOrExplainsWhyNot) {
+    PerfCounters counters;
+    PerfReading before = counters.read();
+    spin();
+    PerfReading after = counters.read();
+    EXPECT_GT(after.since(before).seconds, 0.0);
+
+    if (!counters.available()) {
+        EXPECT_FALSE(counters.unavailableReason().empty());
+        for (std::size_t i = 0; i < PERF_EVENT_COUNT; ++i)
+            EXPECT_FALSE(after.valid[i]);
+        return;
+    }
+    if (after.has(PerfEvent::Instructions)) {
+        EXPECT_GT(after.since(before).get(PerfEvent::Instructions), 2000000u);
+    }
+}
+
+TEST(PerfCountersTest, ReportsPhasesInOrder) {
+    PhaseCounters counters;
+    {
+        PhaseCounters::Phase phase(counters, "first");
+        spin();
+    }
+    {
+        PhaseCounters::Phase phase(counters, "second");
+    }
+
+    ASSERT_EQ(counters.results().size(), 2u);
+    EXPECT_EQ(counters.results()[0].name, "first");
+    EXPECT_EQ(counters.results()[1].name, "second");
+    EXPECT_GT(counters.results()[0].counts.seconds, 0.0);
+
+    std::ostringstream report;
+    counters.writeReport(report);
+    std::string text = report.str();
+    EXPECT_NE(text.find("IPC"), std::string::npos);
+    EXPECT_LT(text.find("first"), text.find("second"));
+    if (!counters.available()) {
+        EXPECT_NE(text.find("Счётчики недоступны"), std::string::npos);
+    }
+}
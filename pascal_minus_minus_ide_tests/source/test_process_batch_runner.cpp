@@ -0,0 +1,163 @@
+#include <gtest.h>
+#include "process_batch_runner.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+
+#include <unistd.h>
+
+namespace {
+
+std::string sumProgram(int factor) {
+    return
+        "program Sum;\n"
+        "var i, n, total: Integer;\n"
+        "begin\n"
+        "  read(n);\n"
+        "  total := 0;\n"
+        "  for i := 1 to n do\n"
+        "    total := total + i * " + std::to_string(factor) + ";\n"
+        "  writeln(total);\n"
+        "end.";
+}
+
+// Deep enough nesting to overflow the recursive descent parser's stack
+std::string crashingProgram() {
+    const int depth = 1000000;
+    return "program Crash;\nvar x: Integer;\nbegin\n  x := " + std::string(depth, '(') + "1" +
+           std::string(depth, ')') + ";\nend.";
+}
+
+} // namespace
+
+TEST(ProcessBatchRunnerTest, RunsJobsInWorkerProcesses) {
+    std::vector<BatchJob> jobs;
+    for (int k = 0; k < 300; ++k)
+        jobs.push_back({ "job" + std::to_string(k), sumProgram(k), std::to_string(k % 20 + 1) });
+
+    ProcessRunnerOptions options;
+    options.workers = 3;
+    options.queueCapacity = 16;     // Smaller than the batch: the coordinator refills the ring
+    ProcessBatchRunner runner(options);
+    std::vector<BatchResult> results = runner.run(jobs);
+
+    ASSERT_EQ(jobs.size(), results.size());
+    for (int k = 0; k < 300; ++k) {
+        int n = k % 20 + 1;
+        EXPECT_EQ("job" + std::to_string(k), results[k].name);
+        EXPECT_TRUE(results[k].success) << results[k].error;
+        EXPECT_EQ(std::to_string(k * n * (n + 1) / 2) + "\n", results[k].output);
+    }
+    EXPECT_EQ(300u, runner.getSummary().succeeded);
+    EXPECT_EQ(0u, runner.getSummary().restarts);
+    EXPECT_EQ(3u, runner.getSummary().threads);
+}
+
+TEST(ProcessBatchRunnerTest, CrashedWorkerIsRestarted) {
+    std::vector<BatchJob> jobs;
+    for (int k = 0; k < 20; ++k)
+        jobs.push_back({ "job" + std::to_string(k), sumProgram(1), "3" });
+    jobs[7] = { "crash", crashingProgram(), "" };
+
+    ProcessRunnerOptions options;
+    options.workers = 1;            // The jobs after the crash need the restarted worker
+    ProcessBatchRunner runner(options);
+    std::vector<BatchResult> results = runner.run(jobs);
+
+    EXPECT_FALSE(results[7].success);
+    EXPECT_NE(std::string::npos, results[7].error.find("Рабочий процесс")) << results[7].error;
+    for (int k = 0; k < 20; ++k) {
+        if (k != 7) {
+            EXPECT_TRUE(results[k].success) << k;
+            EXPECT_EQ("6\n", results[k].output);
+        }
+    }
+    EXPECT_EQ(1u, runner.getSummary().failed);
+    EXPECT_GE(runner.getSummary().restarts, 1u);
+}
+
+TEST(ProcessBatchRunnerTest, TimeLimitStopsRunawayProgram) {
+    std::vector<BatchJob> jobs = {
+        { "runaway",
+          "program Loop;\n"
+          "var i, j, k, s: Integer;\n"
+          "begin\n"
+          "  for i := 1 to 10000 do\n"
+          "    for j := 1 to 10000 do\n"
+          "      for k := 1 to 10000 do\n"
+          "        s := s + 1;\n"
+          "end.", "" },
+        { "quick", sumProgram(2), "4" },
+    };
+
+    ProcessRunnerOptions options;
+    options.workers = 2;
+    options.timeLimitSeconds = 0.3;
+    ProcessBatchRunner runner(options);
+    std::vector<BatchResult> results = runner.run(jobs);
+
+    EXPECT_FALSE(results[0].success);
+    EXPECT_NE(std::string::npos, results[0].error.find("ограничение времени")) << results[0].error;
+    EXPECT_TRUE(results[1].success);
+    EXPECT_EQ("20\n", results[1].output);
+}
+
+#ifdef __linux__
+
+TEST(ProcessBatchRunnerTest, MemoryLimitStopsGreedyProgramAndRestartsWorker) {
+    // Workers inherit the address space of this process, so the limit leaves a fixed margin above it
+    std::ifstream statm("/proc/self/statm");
+    std::size_t pages = 0;
+    ASSERT_TRUE(static_cast<bool>(statm >> pages));
+    std::size_t margin = std::size_t(32) << 20;
+
+    std::string sum = "1";
+    for (int k = 0; k < 2000000; ++k)
+        sum += "+1";
+    std::vector<BatchJob> jobs = {
+        // The token vector alone outgrows the margin
+        { "greedy", "program Greedy;\nvar x: Integer;\nbegin\n  x := " + sum + ";\nend.", "" },
+        { "quick", sumProgram(2), "4" },
+    };
+
+    ProcessRunnerOptions options;
+    options.workers = 1;            // The second job needs the restarted worker
+    options.memoryLimitBytes = pages * static_cast<std::size_t>(sysconf(_SC_PAGESIZE)) + margin;
+    ProcessBatchRunner runner(options);
+    std::vector<BatchResult> results = runner.run(jobs);
+
+    EXPECT_FALSE(results[0].success);
+    EXPECT_NE(std::string::npos, results[0].error.find("ограничение памяти")) << results[0].error;
+    EXPECT_TRUE(results[1].success) << results[1].error;
+    EXPECT_EQ("20\n", results[1].output);
+    EXPECT_GE(runner.getSummary().restarts, 1u);
+}
+
+#endif
+
+TEST(ProcessBatchRunnerTest, LargeOutputIsTruncatedToResultCapacity) {
+    std::vector<BatchJob> jobs = {
+        { "verbose",
+          "program Verbose;\n"
+          "var i: Integer;\n"
+          "begin\n"
+          "  for i := 1 to 5000 do\n"
+          "    writeln(i);\n"
+          "end.", "" },
+    };
+
+    ProcessRunnerOptions options;
+    options.workers = 1;
+    options.resultCapacity = 1000;
+    ProcessBatchRunner runner(options);
+    std::vector<BatchResult> results = runner.run(jobs);
+
+    EXPECT_TRUE(results[0].success);
+    EXPECT_EQ(1000u, results[0].output.size());
+    EXPECT_EQ(0u, results[0].output.find("1\n2\n3\n"));
+    EXPECT_NE(std::string::npos, results[0].diagnostics.find("обрезан"));
+}
+
+#endif
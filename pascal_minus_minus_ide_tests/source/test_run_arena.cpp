@@ -0,0 +1,139 @@
+#include <gtest.h>
+#include "run_arena.h"
+#include "interpreter.h"
+#include "parser.h"
+#include "lexer.h"
+#include "error_reporter.h"
+#include "input_source.h"
+#include "output_sink.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* SUM_OF_SQUARES =
+    "program Squares;\n"
+    "var i, n, total: Integer;\n"
+    "begin\n"
+    "  read(n);\n"
+    "  total := 0;\n"
+    "  for i := 1 to n do\n"
+    "    total := total + i * i;\n"
+    "  writeln(total);\n"
+    "end.";
+
+// The value stack of the loop body expression is larger than the biggest size class
+const char* LONG_EXPRESSION =
+    "program Long;\n"
+    "var i, n, total: Integer;\n"
+    "begin\n"
+    "  read(n);\n"
+    "  total := 0;\n"
+    "  for i := 1 to n do\n"
+    "    total := total + i * 2 + i * 3 - i * 4 + i * 5 - i * 6 + i * 7 - i * 8 + i * 9 - i * 7;\n"
+    "  writeln(total);\n"
+    "end.";
+
+// Parses and runs a program with its tree and temporaries in the arena
+std::string runInArena(RunArena& arena, const std::string& source, const std::string& input) {
+    auto reporter = std::make_shared<ErrorReporter>();
+    auto output = std::make_shared<MemoryOutputSink>();
+    Interpreter interpreter(reporter, output, std::make_shared<MemoryInputSource>(input));
+    interpreter.setArena(&arena);
+    Lexer lexer(source, reporter, interpreter.getNames());
+    Parser parser(lexer.tokenize(), reporter);
+    parser.setArena(&arena);
+    interpreter.run(parser.parse());
+    return output->str();
+}
+
+} // namespace
+
+TEST(RunArenaTest, FreedBlocksAreReusedBySizeClass) {
+    RunArena arena;
+    void* first = arena.allocate(40);
+    void* second = arena.allocate(48);
+    EXPECT_NE(first, second);
+    EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(first) % RunArena::ALIGNMENT);
+    EXPECT_EQ(96u, arena.bytesInUse());
+
+    // 40 and 48 bytes share a class, 100 bytes does not
+    arena.deallocate(first, 40);
+    EXPECT_NE(first, arena.allocate(100));
+    EXPECT_EQ(first, arena.allocate(33));
+}
+
+TEST(RunArenaTest, FreedLargeBlocksAreReusedBySize) {
+    RunArena arena(4096);
+    void* medium = arena.allocate(600);
+    void* large = arena.allocate(3000);
+    arena.deallocate(medium, 600);
+    arena.deallocate(large, 3000);
+    std::size_t reserved = arena.bytesReserved();
+
+    EXPECT_EQ(large, arena.allocate(3000));
+    EXPECT_EQ(medium, arena.allocate(600));
+    EXPECT_EQ(reserved, arena.bytesReserved());
+    EXPECT_EQ(3616u, arena.bytesInUse());
+}
+
+TEST(RunArenaTest, ResetReleasesEverythingAndKeepsFirstChunk) {
+    RunArena arena(4096);
+    for (int i = 0; i < 1000; ++i)
+        arena.allocate(64);
+    void* large = arena.allocate(100000);
+    ASSERT_NE(nullptr, large);
+    EXPECT_GT(arena.bytesReserved(), 100000u + 64000u);
+    std::size_t chunks = arena.chunkAllocations();
+
+    arena.reset();
+    EXPECT_EQ(0u, arena.bytesInUse());
+    EXPECT_EQ(4096u, arena.bytesReserved());
+
+    // The retained chunk serves the next run without asking the heap
+    arena.allocate(64);
+    EXPECT_EQ(chunks, arena.chunkAllocations());
+}
+
+TEST(RunArenaTest, OverAlignedRequestIsRejected) {
+    RunArena arena;
+    EXPECT_THROW(arena.allocate(64, 64), std::bad_alloc);
+}
+
+TEST(RunArenaTest, AllocatorWorksWithAndWithoutArena) {
+    RunArena arena;
+    std::vector<std::string, ArenaAllocator<std::string>> inArena{ ArenaAllocator<std::string>(&arena) };
+    std::vector<std::string, ArenaAllocator<std::string>> onHeap;
+    for (int i = 0; i < 100; ++i) {
+        inArena.push_back(std::to_string(i));
+        onHeap.push_back(std::to_string(i));
+    }
+    EXPECT_EQ("99", inArena.back());
+    EXPECT_EQ("99", onHeap.back());
+    EXPECT_GT(arena.bytesInUse(), 0u);
+    EXPECT_EQ(nullptr, onHeap.get_allocator().getArena());
+}
+
+TEST(RunArenaTest, ProgramRunsFromArenaAndLoopsDoNotGrowIt) {
+    RunArena arena;
+    EXPECT_EQ("55\n", runInArena(arena, SUM_OF_SQUARES, "5"));
+    EXPECT_EQ(0u, arena.bytesInUse());
+    std::size_t reserved = arena.bytesReserved();
+
+    // A thousand times more iterations reuse the same evaluation stacks
+    arena.reset();
+    EXPECT_EQ("333833500\n", runInArena(arena, SUM_OF_SQUARES, "1000"));
+    EXPECT_EQ(reserved, arena.bytesReserved());
+}
+
+TEST(RunArenaTest, LongExpressionsDoNotGrowArena) {
+    RunArena arena;
+    EXPECT_EQ("15\n", runInArena(arena, LONG_EXPRESSION, "5"));
+    std::size_t reserved = arena.bytesReserved();
+
+    arena.reset();
+    EXPECT_EQ("12502500\n", runInArena(arena, LONG_EXPRESSION, "5000"));
+    EXPECT_EQ(reserved, arena.bytesReserved());
+}
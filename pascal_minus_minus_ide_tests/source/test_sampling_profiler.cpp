@@ -0,0 +1,147 @@
+#include <gtest.h>
+#include "sampling_profiler.h"
+#include "interpreter.h"
+#include "parser.h"
+#include "lexer.h"
+#include "error_reporter.h"
+#include "input_source.h"
+#include "output_sink.h"
+#include <chrono>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// Line 6 does almost all of the work
+const char* HOT_LOOP =
+    "program Hot;\n"
+    "var i, j, s: Integer;\n"
+    "begin\n"
+    "  s := 0;\n"
+    "  for i := 1 to 100 do for j := 1 to 100 do\n"
+    "    s := (s + i * j mod 7 + j div 3 - i mod 5) mod 1000;\n"
+    "  writeln(s);\n"
+    "end.";
+
+// The programs here are run by several interpreters, so they all share one name table
+const std::shared_ptr<NameTable>& programNames() {
+    static const std::shared_ptr<NameTable> names = std::make_shared<NameTable>();
+    return names;
+}
+
+std::shared_ptr<ASTNode> parseProgram(const std::string& source) {
+    auto reporter = std::make_shared<ErrorReporter>();
+    Lexer lexer(source, reporter, programNames());
+    Parser parser(lexer.tokenize(), reporter);
+    return parser.parse();
+}
+
+std::unique_ptr<Interpreter> makeInterpreter() {
+    auto interpreter = std::make_unique<Interpreter>(std::make_shared<ErrorReporter>(),
+        std::make_shared<MemoryOutputSink>(), std::make_shared<MemoryInputSource>(""));
+    interpreter->setNames(programNames());
+    return interpreter;
+}
+
+// Runs the program repeatedly until the sampler has collected enough samples
+void runUntilSampled(const std::shared_ptr<ASTNode>& program, Interpreter& interpreter, SamplingProfiler& sampler) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (sampler.sampleCount() < 100 && std::chrono::steady_clock::now() < deadline)
+        interpreter.run(program);
+}
+
+} // namespace
+
+TEST(SamplingProfilerTest, AttributesSamplesToHotLine) {
+    auto program = parseProgram(HOT_LOOP);
+    auto owner = makeInterpreter();
+    Interpreter& interpreter = *owner;
+
+    SamplingProfiler sampler(std::chrono::microseconds(200));
+    sampler.start(interpreter.getPosition());
+    EXPECT_TRUE(sampler.isRunning());
+    runUntilSampled(program, interpreter, sampler);
+    sampler.stop();
+    EXPECT_FALSE(sampler.isRunning());
+
+    ASSERT_GE(sampler.sampleCount(), 100u);
+    auto lines = sampler.hotLines();
+    ASSERT_FALSE(lines.empty());
+    EXPECT_EQ(lines.front().line, 6);
+    EXPECT_GT(lines.front().share, 0.5);
+    double total = 0;
+    for (const auto& line : lines)
+        total += line.share;
+    EXPECT_NEAR(total, 1.0, 1e-9);
+}
+
+TEST(SamplingProfilerTest, PositionIsClearedAfterRun) {
+    auto program = parseProgram(HOT_LOOP);
+    auto owner = makeInterpreter();
+    Interpreter& interpreter = *owner;
+    EXPECT_EQ(interpreter.getPosition().load(), nullptr);
+    interpreter.run(program);
+    EXPECT_EQ(interpreter.getPosition().load(), nullptr);
+}
+
+TEST(SamplingProfilerTest, StopsCollectingAfterStop) {
+    auto program = parseProgram(HOT_LOOP);
+    auto owner = makeInterpreter();
+    Interpreter& interpreter = *owner;
+
+    SamplingProfiler sampler(std::chrono::microseconds(200));
+    sampler.start(interpreter.getPosition());
+    runUntilSampled(program, interpreter, sampler);
+    sampler.stop();
+    auto collected = sampler.sampleCount();
+    for (int i = 0; i < 3; ++i)
+        interpreter.run(program);
+    EXPECT_EQ(sampler.sampleCount(), collected);
+
+    sampler.reset();
+    EXPECT_EQ(sampler.sampleCount(), 0u);
+    EXPECT_TRUE(sampler.hotLines().empty());
+}
+
+TEST(SamplingProfilerTest, OnlyOneSamplerRunsAtATime) {
+    ExecutionPosition position{ nullptr };
+    SamplingProfiler first;
+    SamplingProfiler second;
+    first.start(position);
+    EXPECT_THROW(second.start(position), std::logic_error);
+    first.stop();
+    EXPECT_NO_THROW(second.start(position));
+    second.stop();
+}
+
+TEST(SamplingProfilerTest, DropsSamplesBeyondCapacity) {
+    auto program = parseProgram(HOT_LOOP);
+    auto owner = makeInterpreter();
+    Interpreter& interpreter = *owner;
+
+    SamplingProfiler sampler(std::chrono::microseconds(100), 5);
+    sampler.start(interpreter.getPosition());
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (sampler.droppedSamples() == 0 && std::chrono::steady_clock::now() < deadline)
+        interpreter.run(program);
+    sampler.stop();
+    EXPECT_EQ(sampler.sampleCount(), 5u);
+    EXPECT_GT(sampler.droppedSamples(), 0u);
+}
+
+TEST(SamplingProfilerTest, ReportShowsSourceLines) {
+    auto program = parseProgram(HOT_LOOP);
+    auto owner = makeInterpreter();
+    Interpreter& interpreter = *owner;
+
+    SamplingProfiler sampler(std::chrono::microseconds(200));
+    sampler.start(interpreter.getPosition());
+    runUntilSampled(program, interpreter, sampler);
+    sampler.stop();
+
+    std::ostringstream report;
+    sampler.writeReport(report, 1, HOT_LOOP);
+    EXPECT_NE(report.str().find("s := (s + i * j mod 7"), std::string::npos) << report.str();
+}
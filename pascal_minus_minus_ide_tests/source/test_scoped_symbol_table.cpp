@@ -0,0 +1,127 @@
+#include <gtest.h>
+#include "scoped_symbol_table.h"
+#include <memory>
+#include <string>
+
+class ScopedSymbolTableTest : public ::testing::Test {
+protected:
+    ScopedSymbolTable table;
+};
+
+TEST_F(ScopedSymbolTableTest, DeclareAndLookupInGlobalScope) {
+    table.declare("x", Value(10));
+
+    Value* value = table.lookup("x");
+    ASSERT_NE(nullptr, value);
+    EXPECT_EQ(10, value->intValue);
+    EXPECT_EQ(0u, table.depth());
+    EXPECT_EQ(nullptr, table.lookup("y"));
+}
+
+TEST_F(ScopedSymbolTableTest, InnerScopeShadowsAndRestoresOuter) {
+    table.declare("x", Value(1));
+
+    table.enterScope();
+    table.declare("x", Value(2));
+    EXPECT_EQ(2, table.lookup("x")->intValue);
+    EXPECT_EQ(1u, table.size()); // Only the innermost binding is visible
+
+    table.exitScope();
+    ASSERT_NE(nullptr, table.lookup("x"));
+    EXPECT_EQ(1, table.lookup("x")->intValue);
+}
+
+TEST_F(ScopedSymbolTableTest, ExitScopeRemovesLocalSymbols) {
+    table.declare("global", Value(true));
+
+    table.enterScope();
+    table.declare("local", Value(std::string("temp")));
+    EXPECT_TRUE(table.contains("local"));
+    EXPECT_TRUE(table.contains("global"));
+    table.exitScope();
+
+    EXPECT_FALSE(table.contains("local"));
+    EXPECT_TRUE(table.contains("global"));
+}
+
+TEST_F(ScopedSymbolTableTest, RedeclareInSameScopeOverwrites) {
+    table.enterScope();
+    table.declare("x", Value(1));
+    table.declare("x", Value(5));
+    EXPECT_EQ(5, table.lookup("x")->intValue);
+    table.exitScope();
+
+    EXPECT_EQ(nullptr, table.lookup("x"));
+}
+
+TEST_F(ScopedSymbolTableTest, WritesThroughLookupAffectInnermostBinding) {
+    table.declare("i", Value(100));
+
+    table.enterScope();
+    Value* inner = table.declare("i", Value(0));
+    *table.lookup("i") = Value(7);
+    EXPECT_EQ(7, inner->intValue);
+    table.exitScope();
+
+    EXPECT_EQ(100, table.lookup("i")->intValue);
+}
+
+TEST_F(ScopedSymbolTableTest, DeepNestingUnwindsInOrder) {
+    for (int depth = 0; depth < 100; depth++) {
+        table.enterScope();
+        table.declare("v", Value(depth));
+        table.declare("only" + std::to_string(depth), Value(depth));
+    }
+    EXPECT_EQ(100u, table.depth());
+    EXPECT_EQ(99, table.lookup("v")->intValue);
+
+    for (int depth = 99; depth >= 0; depth--) {
+        EXPECT_EQ(depth, table.lookup("v")->intValue);
+        table.exitScope();
+        EXPECT_FALSE(table.contains("only" + std::to_string(depth)));
+    }
+    EXPECT_FALSE(table.contains("v"));
+}
+
+TEST_F(ScopedSymbolTableTest, ExitGlobalScopeThrows) {
+    EXPECT_THROW(table.exitScope(), std::runtime_error);
+}
+
+TEST_F(ScopedSymbolTableTest, SnapshotContainsVisibleSymbols) {
+    table.declare("a", Value(1));
+    table.declare("b", Value(2));
+    table.enterScope();
+    table.declare("a", Value(3));
+
+    auto snapshot = table.snapshot();
+    ASSERT_EQ(2u, snapshot.size());
+    EXPECT_EQ(3, snapshot["a"].intValue);
+    EXPECT_EQ(2, snapshot["b"].intValue);
+}
+
+TEST_F(ScopedSymbolTableTest, StorageCountsOnlyOwnNames) {
+    ScopedSymbolTable busy;
+    for (int i = 0; i < 5000; ++i)
+        busy.declare("busy" + std::to_string(i), Value(i));
+
+    // Names of other tables do not widen this table's index
+    table.declare("x", Value(1));
+    EXPECT_LT(table.storageBytes(), 1024u);
+    EXPECT_GT(busy.storageBytes(), 5000u * sizeof(size_t));
+}
+
+TEST_F(ScopedSymbolTableTest, SetNamesDropsSymbolsAndIndex) {
+    for (int i = 0; i < 5000; ++i)
+        table.declare("busy" + std::to_string(i), Value(i));
+
+    auto names = std::make_shared<NameTable>();
+    table.setNames(names);
+    EXPECT_EQ(names, table.getNames());
+    EXPECT_EQ(0u, table.size());
+    EXPECT_EQ(nullptr, table.lookup("busy1"));
+
+    // The index is rebuilt for the new table's numbers only
+    table.declare(names->intern("x"), Value(1));
+    EXPECT_EQ(1, table.lookup("x")->intValue);
+    EXPECT_LT(table.storageBytes(), 1024u);
+}
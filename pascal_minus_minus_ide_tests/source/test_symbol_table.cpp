@@ -127,3 +127,72 @@ TEST_F(SymbolTableTest, CustomCapacityTable) {
     EXPECT_EQ("1", smallTable.findSymbol("x")->value);
     EXPECT_EQ("2", smallTable.findSymbol("y")->value);
 }
+
+TEST_F(SymbolTableTest, GrowsWhenLoadFactorExceeded) {
+    size_t initialCapacity = table.getCapacity();
+
+    for (int i = 0; i < 5000; i++) {
+        table.addSymbol(SymbolInfo("sym" + std::to_string(i), "Integer", std::to_string(i)));
+    }
+
+    EXPECT_EQ(5000u, table.size());
+    EXPECT_GT(table.getCapacity(), initialCapacity);
+    // Load factor must stay within 7/8 after growth
+    EXPECT_LE(table.size() * SymbolTable::MAX_LOAD_DEN, table.getCapacity() * SymbolTable::MAX_LOAD_NUM);
+
+    for (int i = 0; i < 5000; i++) {
+        SymbolInfo* symbol = table.findSymbol("sym" + std::to_string(i));
+        ASSERT_NE(nullptr, symbol);
+        EXPECT_EQ(std::to_string(i), symbol->value);
+    }
+}
+
+TEST_F(SymbolTableTest, RemoveKeepsRemainingSymbolsReachable) {
+    // Small table so that probe chains overlap heavily
+    SymbolTable smallTable(16);
+    for (int i = 0; i < 300; i++) {
+        smallTable.addSymbol(SymbolInfo("v" + std::to_string(i), "Integer", std::to_string(i)));
+    }
+
+    // Remove every third symbol
+    for (int i = 0; i < 300; i += 3) {
+        smallTable.removeSymbol("v" + std::to_string(i));
+    }
+    EXPECT_EQ(200u, smallTable.size());
+
+    for (int i = 0; i < 300; i++) {
+        SymbolInfo* symbol = smallTable.findSymbol("v" + std::to_string(i));
+        if (i % 3 == 0) {
+            EXPECT_EQ(nullptr, symbol);
+        } else {
+            ASSERT_NE(nullptr, symbol);
+            EXPECT_EQ(std::to_string(i), symbol->value);
+        }
+    }
+}
+
+TEST_F(SymbolTableTest, RepeatedAddRemoveDoesNotDegrade) {
+    // Without tombstones, churn must not fill the table with dead slots
+    size_t capacity = table.getCapacity();
+    for (int round = 0; round < 10000; round++) {
+        std::string name = "tmp" + std::to_string(round);
+        table.addSymbol(SymbolInfo(name, "Integer", "0"));
+        table.removeSymbol(name);
+    }
+
+    EXPECT_EQ(0u, table.size());
+    EXPECT_EQ(capacity, table.getCapacity());
+    EXPECT_EQ(nullptr, table.findSymbol("tmp9999"));
+
+    table.addSymbol(SymbolInfo("x", "Integer", "7"));
+    ASSERT_NE(nullptr, table.findSymbol("x"));
+    EXPECT_EQ("7", table.findSymbol("x")->value);
+}
+
+TEST_F(SymbolTableTest, RemoveNonExistentSymbol) {
+    table.addSymbol(SymbolInfo("a", "Integer", "1"));
+    table.removeSymbol("b");
+
+    EXPECT_EQ(1u, table.size());
+    ASSERT_NE(nullptr, table.findSymbol("a"));
+}
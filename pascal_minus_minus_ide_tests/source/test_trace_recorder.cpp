@@ -0,0 +1,130 @@
+#include <gtest.h>
+#include "trace_recorder.h"
+#include "batch_runner.h"
+#include "interpreter.h"
+#include "parser.h"
+#include "lexer.h"
+#include "error_reporter.h"
+#include "input_source.h"
+#include "output_sink.h"
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const char* LOOPS =
+    "program Loops;\n"
+    "var i, n: Integer;\n"
+    "begin\n"
+    "  n := 0;\n"
+    "  for i := 1 to 4 do\n"
+    "    n := n + i;\n"
+    "  while n > 0 do\n"
+    "    n := n - 5;\n"
+    "  writeln(n);\n"
+    "end.";
+
+std::string traceJson(const TraceRecorder& recorder) {
+    std::ostringstream out;
+    recorder.writeJson(out);
+    return out.str();
+}
+
+std::size_t occurrences(const std::string& text, const std::string& pattern) {
+    std::size_t count = 0;
+    for (std::size_t at = text.find(pattern); at != std::string::npos; at = text.find(pattern, at + 1))
+        ++count;
+    return count;
+}
+
+} // namespace
+
+TEST(TraceRecorderTest, SpanRecordsCompleteEventWithArgs) {
+    TraceRecorder recorder;
+    {
+        TraceRecorder::Span span(&recorder, "phase", "parse \"main\"");
+        span.setArg("tokens", 42);
+        span.setArg("lines", 7);
+    }
+    EXPECT_EQ(recorder.eventCount(), 1u);
+
+    std::string json = traceJson(recorder);
+    EXPECT_EQ(json.compare(0, 1, "{"), 0);
+    EXPECT_NE(json.find("\"name\":\"parse \\\"main\\\"\",\"cat\":\"phase\",\"ph\":\"X\""), std::string::npos) << json;
+    EXPECT_NE(json.find("\"args\":{\"tokens\":42,\"lines\":7}"), std::string::npos) << json;
+    EXPECT_NE(json.find("\"thread_name\""), std::string::npos);
+}
+
+TEST(TraceRecorderTest, SpanWithoutRecorderDoesNothing) {
+    TraceRecorder::Span span(nullptr, "phase", "nothing");
+    span.setArg("ignored", 1);
+}
+
+TEST(TraceRecorderTest, ThreadsGetSeparateTracks) {
+    TraceRecorder recorder;
+    recorder.setThreadName("main");
+    recorder.complete("job", "on main", recorder.now(), 1);
+    std::thread worker([&recorder]() {
+        recorder.complete("job", "on worker", recorder.now(), 1);
+        recorder.complete("job", "on worker again", recorder.now(), 1);
+    });
+    worker.join();
+
+    EXPECT_EQ(recorder.eventCount(), 3u);
+    std::string json = traceJson(recorder);
+    EXPECT_NE(json.find("\"args\":{\"name\":\"main\"}"), std::string::npos);
+    EXPECT_EQ(occurrences(json, "\"thread_name\""), 2u);
+    EXPECT_NE(json.find("\"name\":\"on main\",\"cat\":\"job\",\"ph\":\"X\",\"ts\":"), std::string::npos);
+    std::size_t workerEvent = json.find("\"on worker\"");
+    ASSERT_NE(workerEvent, std::string::npos);
+    EXPECT_NE(json.find("\"tid\":2", workerEvent), std::string::npos);
+}
+
+TEST(TraceRecorderTest, DropsEventsBeyondLimit) {
+    TraceRecorder recorder(2);
+    for (int i = 0; i < 5; ++i)
+        recorder.complete("loop", "event", recorder.now(), 0);
+    EXPECT_EQ(recorder.eventCount(), 2u);
+    EXPECT_EQ(recorder.droppedEvents(), 3u);
+}
+
+TEST(TraceRecorderTest, InterpreterTracesStatementsAndLoops) {
+    TraceRecorder recorder;
+    auto reporter = std::make_shared<ErrorReporter>();
+    auto output = std::make_shared<MemoryOutputSink>();
+    Interpreter interpreter(reporter, output, std::make_shared<MemoryInputSource>(""));
+    interpreter.setTracer(&recorder);
+    Lexer lexer(LOOPS, reporter, interpreter.getNames());
+    Parser parser(lexer.tokenize(), reporter);
+    interpreter.run(parser.parse());
+    EXPECT_EQ(output->str(), "0\n");
+
+    std::string json = traceJson(recorder);
+    // One span for the run, four top-level statements, two loops
+    EXPECT_EQ(occurrences(json, "\"cat\":\"phase\""), 1u);
+    EXPECT_EQ(occurrences(json, "\"cat\":\"statement\""), 4u);
+    EXPECT_EQ(occurrences(json, "\"cat\":\"loop\""), 2u);
+    EXPECT_NE(json.find("\"name\":\"For i (5:3)\",\"cat\":\"loop\""), std::string::npos) << json;
+    EXPECT_NE(json.find("\"iterations\":4}"), std::string::npos) << json;
+    EXPECT_NE(json.find("\"iterations\":2}"), std::string::npos) << json;
+}
+
+TEST(TraceRecorderTest, BatchRunnerTracesJobsAndPhases) {
+    TraceRecorder recorder;
+    BatchRunner runner(2);
+    runner.setTracer(&recorder);
+    std::vector<BatchJob> jobs = { { "a.pas", LOOPS, "" }, { "b.pas", LOOPS, "" }, { "c.pas", LOOPS, "" } };
+    auto results = runner.run(jobs);
+    ASSERT_EQ(results.size(), 3u);
+    EXPECT_TRUE(std::all_of(results.begin(), results.end(), [](const BatchResult& r) { return r.success; }));
+
+    std::string json = traceJson(recorder);
+    EXPECT_EQ(occurrences(json, "\"cat\":\"job\""), 3u);
+    EXPECT_NE(json.find("\"name\":\"b.pas\",\"cat\":\"job\""), std::string::npos);
+    EXPECT_EQ(occurrences(json, "\"cat\":\"phase\""), 9u);
+    EXPECT_EQ(occurrences(json, "\"success\":1"), 3u);
+}
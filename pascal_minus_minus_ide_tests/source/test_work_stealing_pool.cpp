@@ -0,0 +1,63 @@
+#include <gtest.h>
+#include "work_stealing_pool.h"
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST(WorkStealingPoolTest, RunsEveryTaskExactlyOnce) {
+    const int TASKS = 10000;
+    std::vector<std::atomic<int>> runs(TASKS);
+    WorkStealingPool pool(4);
+    for (int i = 0; i < TASKS; ++i)
+        pool.submit([&runs, i]() { runs[i].fetch_add(1); });
+    pool.wait();
+
+    for (int i = 0; i < TASKS; ++i)
+        EXPECT_EQ(1, runs[i].load()) << "task " << i;
+}
+
+TEST(WorkStealingPoolTest, WaitCoversTasksSubmittedByTasks) {
+    std::atomic<int> leaves{ 0 };
+    WorkStealingPool pool(4);
+    for (int i = 0; i < 8; ++i) {
+        pool.submit([&pool, &leaves]() {
+            for (int j = 0; j < 100; ++j)
+                pool.submit([&leaves]() { leaves.fetch_add(1); });
+        });
+    }
+    pool.wait();
+    EXPECT_EQ(800, leaves.load());
+}
+
+TEST(WorkStealingPoolTest, IdleWorkersStealFromBusyQueue) {
+    std::atomic<int> finished{ 0 };
+    WorkStealingPool pool(4);
+    // All tasks land in the queue of the worker that runs the spawner
+    pool.submit([&pool, &finished]() {
+        for (int i = 0; i < 32; ++i) {
+            pool.submit([&finished]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                finished.fetch_add(1);
+            });
+        }
+    });
+    pool.wait();
+    EXPECT_EQ(32, finished.load());
+    EXPECT_GT(pool.stolenCount(), 0u);
+}
+
+TEST(WorkStealingPoolTest, WaitRethrowsTaskException) {
+    std::atomic<int> finished{ 0 };
+    WorkStealingPool pool(2);
+    pool.submit([]() { throw std::runtime_error("task failed"); });
+    for (int i = 0; i < 10; ++i)
+        pool.submit([&finished]() { finished.fetch_add(1); });
+    EXPECT_THROW(pool.wait(), std::runtime_error);
+    EXPECT_EQ(10, finished.load());
+
+    // The error is reported once
+    pool.submit([]() {});
+    EXPECT_NO_THROW(pool.wait());
+}